@@ -45,9 +45,39 @@ struct bezier_curve : public  curve_abc<Time, Numeric, Dim, Safe, Point>
 		{
 			throw; // TODO 
 		}
-		for(; it != PointsEnd; ++it)
+		point_t p[4];
+		for(int i = 0; it != PointsEnd && i < 4; ++it, ++i)
 		{
-			pts_.push_back(*it);
+			p[i] = *it;
+		}
+		// the control points are converted once to the power basis x(u) = sum(c_i u^i), u in [0, 1]
+		for(int k = 0; k < Dim; ++k)
+		{
+			num_t* c = coefficients_ + k;
+			c[0] = c[Dim] = c[2*Dim] = c[3*Dim] = 0;
+			switch(size_)
+			{
+				case 0 :
+				break;
+				case 1 :
+					c[0] = p[0][k];
+				break;
+				case 2 :
+					c[0]     = p[0][k];
+					c[Dim]   = p[1][k] - p[0][k];
+				break;
+				case 3 :
+					c[0]     = p[0][k];
+					c[Dim]   = 2 * (p[1][k] - p[0][k]);
+					c[2*Dim] = p[0][k] - 2 * p[1][k] + p[2][k];
+				break;
+				default :
+					c[0]     = p[0][k];
+					c[Dim]   = 3 * (p[1][k] - p[0][k]);
+					c[2*Dim] = 3 * (p[0][k] - 2 * p[1][k] + p[2][k]);
+					c[3*Dim] = p[3][k] - p[0][k] + 3 * (p[1][k] - p[2][k]);
+				break;
+			}
 		}
 	}
 
@@ -68,39 +98,81 @@ struct bezier_curve : public  curve_abc<Time, Numeric, Dim, Safe, Point>
 	///  \param t : the time when to evaluate the spine
 	///  \param return : the value x(t)
 	virtual point_t operator()(time_t t) const
+	{
+		return derivate(t, 0);
+	}
+
+	///  \brief Evaluation of the derivative of order N of the curve at time t.
+	///  \param t : the time when to evaluate the curve
+	///  \param order : the order of the derivative, 0 evaluates the curve
+	///  \param return : the value x^(N)(t)
+	point_t derivate(time_t t, std::size_t order) const
 	{
 		num_t nT = (t - minBound_) / (maxBound_ - minBound_);
 		if(Safe &! (0 <= nT && nT <= 1))
 		{
 			throw std::exception(); // TODO
 		}
-		else
+		point_t p;
+		EvaluateNormalized(nT, p, order);
+		return p;
+	}
+
+	///  \brief Evaluation of the curve at several times.
+	virtual void evaluate(const time_t* times, std::size_t n, point_t* out) const
+	{
+		evaluate(times, n, out, 0);
+	}
+
+	///  \brief Evaluation of the derivative of order N at several times.
+	void evaluate(const time_t* times, std::size_t n, point_t* out, std::size_t order) const
+	{
+		num_t const invLength = 1 / (maxBound_ - minBound_);
+		for(std::size_t i = 0; i < n; ++i)
 		{
-			num_t dt = (1 - nT);
-			switch(size_)
-			{	
-				case 2 :
-					return pts_[0] * dt +  nT * pts_[1];
-				break;
-				case 3 :
-					return 	pts_[0] * dt * dt 
-                       				+ 2 * pts_[1] * nT * dt
-						+ pts_[2] * nT * nT;
-				break;
-				default :
-					return 	pts_[0] * dt * dt * dt
-						+ 3 * pts_[1] * nT * dt * dt 
-						+ 3 * pts_[2] * nT * nT * dt 
-						+ pts_[3] * nT * nT *nT;
-				break;
+			num_t nT = (times[i] - minBound_) * invLength;
+			if(Safe &! (0 <= nT && nT <= 1))
+			{
+				throw std::exception(); // TODO
 			}
+			EvaluateNormalized(nT, out[i], order);
 		}
 	}
+
 /*Operations*/
 
 /*Helpers*/
 	virtual time_t min() const{return minBound_;}
 	virtual time_t max() const{return maxBound_;}
+
+	private:
+	/// Horner evaluation in the normalized time, derivatives are scaled back to the curve time
+	void EvaluateNormalized(num_t u, point_t& p, std::size_t order) const
+	{
+		const num_t* c0 = coefficients_;
+		const num_t* c1 = c0 + Dim;
+		const num_t* c2 = c1 + Dim;
+		const num_t* c3 = c2 + Dim;
+		num_t const s = 1 / (maxBound_ - minBound_);
+		switch(order)
+		{
+			case 0 :
+				for(int k = 0; k < Dim; ++k) p[k] = c0[k] + u * (c1[k] + u * (c2[k] + u * c3[k]));
+			break;
+			case 1 :
+				for(int k = 0; k < Dim; ++k) p[k] = s * (c1[k] + u * (2 * c2[k] + u * 3 * c3[k]));
+			break;
+			case 2 :
+				for(int k = 0; k < Dim; ++k) p[k] = s * s * (2 * c2[k] + 6 * u * c3[k]);
+			break;
+			case 3 :
+				for(int k = 0; k < Dim; ++k) p[k] = s * s * s * 6 * c3[k];
+			break;
+			default :
+				for(int k = 0; k < Dim; ++k) p[k] = 0;
+			break;
+		}
+	}
 /*Helpers*/
 
 	public:
@@ -108,8 +180,7 @@ struct bezier_curve : public  curve_abc<Time, Numeric, Dim, Safe, Point>
 	const time_t minBound_, maxBound_;
 	
 	private:
-	typedef std::vector<Point,Eigen::aligned_allocator<Point> > T_Vector;
-	T_Vector  pts_;
+	num_t coefficients_[4 * Dim]; // c0, c1, c2, c3 of the power basis
 };
 }
 #endif //_CLASS_BEZIERCURVE
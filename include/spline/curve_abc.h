@@ -14,6 +14,7 @@
 
 #include "MathDefs.h"
 
+#include <cstddef>
 #include <functional>
 
 namespace spline
@@ -34,7 +35,7 @@ namespace spline
 		curve_abc(){};
 
 		///\brief Destructor
-		~curve_abc(){};
+		virtual ~curve_abc(){};
 		/* Constructors - destructors */
 
 		/*Operations*/
@@ -43,6 +44,18 @@ namespace spline
 		///  \param t : the time when to evaluate the spine
 		///  \param return : the value x(t)
 		virtual point_t operator()(time_t t) const = 0;
+
+		///  \brief Evaluation of the curve at several times.
+		///  \param times : the times when to evaluate the curve, preferably in increasing order
+		///  \param n : the number of times
+		///  \param out : receives the n values x(times[i])
+		virtual void evaluate(const time_t* times, std::size_t n, point_t* out) const
+		{
+			for(std::size_t i = 0; i < n; ++i)
+			{
+				out[i] = (*this)(times[i]);
+			}
+		}
 		/*Operations*/
 
 		/*Helpers*/
@@ -25,7 +25,9 @@
 
 #include "MathDefs.h"
 
+#include <algorithm>
 #include <functional>
+#include <stdexcept>
 #include <vector>
 
 namespace spline
@@ -42,10 +44,8 @@ struct exact_cubic : public curve_abc<Time, Numeric, Dim, Safe, Point>
 	typedef Eigen::Matrix<Numeric, Eigen::Dynamic, Eigen::Dynamic> MatrixX;
 	typedef Time 	time_t;
 	typedef Numeric	num_t;
-	typedef cubic_function<time_t, Numeric, Dim, Safe, Point> cubic_function_t;
-	typedef typename std::vector<cubic_function_t*> T_cubic;
-	typedef typename T_cubic::iterator IT_cubic;
-	typedef typename T_cubic::const_iterator CIT_cubic;
+	typedef std::vector<time_t> T_time;
+	typedef std::vector<num_t> T_coefficient;
 
 	/* Constructors - destructors */
 	public:
@@ -97,14 +97,14 @@ struct exact_cubic : public curve_abc<Time, Numeric, Dim, Safe, Point>
 			if( i+2 < size)
 			{
 				In it2(next); ++ it2;
-				num_t const dTi_1(1/((*it2).first - (*next).first));
+				num_t const dTi_1((*it2).first - (*next).first);
 				num_t const dTi_1sqr(dTi_1 * dTi_1);
 				// this can be optimized but let's focus on clarity as long as not needed
 				h1(i+1, i)   =  2 / dTi;
 				h1(i+1, i+1) =  4 / dTi + 4 / dTi_1;
 				h1(i+1, i+2) =  2 / dTi_1;
 				h2(i+1, i)   = -6 / dTi_sqr;
-				h2(i+1, i+1) = (6 / dTi_1sqr) - (6 / dTi_sqr);
+				h2(i+1, i+1) = (6 / dTi_sqr) - (6 / dTi_1sqr);
 				h2(i+1, i+2) =  6 / dTi_1sqr;
 			}
 			x.row(i)= (*it).second.transpose();
@@ -116,21 +116,30 @@ struct exact_cubic : public curve_abc<Time, Numeric, Dim, Safe, Point>
 		b = h1 * h2 * x; //h1 * b = h2 * x => b = (h1)^-1 * h2 * x
 		c = h3 * x + h4 * b;
 		d = h5 * x + h6 * b;
-		it= wayPointsBegin, next=wayPointsBegin; ++ next;
-		for(int i=0; next != wayPointsEnd; ++i, ++it, ++next)
+		// segment i covers [times_[i], times_[i+1]] ; its coefficients a, b, c, d are stored contiguously
+		std::size_t const segments(size > 1 ? size - 1 : 1);
+		times_.reserve(segments + 1);
+		coefficients_.resize(segments * 4 * Dim);
+		it = wayPointsBegin;
+		for(std::size_t i(0); i < segments; ++i, ++it)
 		{
-			subSplines_.push_back(new cubic_function_t(a.row(i), b.row(i), c.row(i), d.row(i), (*it).first, (*next).first));
+			times_.push_back((*it).first);
+			num_t* coeffs = &coefficients_[i * 4 * Dim];
+			for(int k(0); k < Dim; ++k)
+			{
+				coeffs[k]         = a(i,k);
+				coeffs[Dim + k]   = b(i,k);
+				coeffs[2*Dim + k] = c(i,k);
+				coeffs[3*Dim + k] = d(i,k);
+			}
 		}
-		subSplines_.push_back(new cubic_function_t(a.row(size-1), b.row(size-1), c.row(size-1), d.row(size-1), (*it).first, (*it).first));
+		times_.push_back(size > 1 ? (*it).first : times_.front());
 	}
 
 	///\brief Destructor
 	~exact_cubic()
 	{
-		for(IT_cubic it = subSplines_.begin(); it != subSplines_.end(); ++ it)
-		{
-			delete(*it);
-		}
+		// NOTHING
 	}
 
 	private:
@@ -145,28 +154,100 @@ struct exact_cubic : public curve_abc<Time, Numeric, Dim, Safe, Point>
 	///  \param return : the value x(t)
 	virtual point_t operator()(time_t t) const
 	{
+		if(Safe && (t < min() || t > max())){throw std::out_of_range("TODO");}
 		point_t p;
-    	if(Safe && (t < subSplines_.front()->t_min_ || t > subSplines_.back()->t_max_)){throw std::out_of_range("TODO");}
-		for(CIT_cubic it = subSplines_.begin(); it != subSplines_.end(); ++ it)
+		EvaluateSegment(FindSegment(t), Clamp(t), p);
+		return p;
+	}
+
+	///  \brief Evaluation of the derivative of order N of the spline at time t.
+	///  \param t : the time when to evaluate the spline
+	///  \param order : the order of the derivative, 0 evaluates the spline
+	///  \param return : the value x^(N)(t)
+	point_t derivate(time_t t, std::size_t order) const
+	{
+		if(Safe && (t < min() || t > max())){throw std::out_of_range("TODO");}
+		point_t p;
+		EvaluateSegment(FindSegment(t), Clamp(t), p, order);
+		return p;
+	}
+
+	///  \brief Evaluation of the spline at several times.
+	///  When times are sorted, the segment is found by moving from the previous one.
+	virtual void evaluate(const time_t* times, std::size_t n, point_t* out) const
+	{
+		evaluate(times, n, out, 0);
+	}
+
+	///  \brief Evaluation of the derivative of order N at several times.
+	void evaluate(const time_t* times, std::size_t n, point_t* out, std::size_t order) const
+	{
+		std::size_t segment(0);
+		for(std::size_t i(0); i < n; ++i)
 		{
-			if(t >= ((*it)->t_min_) && t <= ((*it)->t_max_))
+			if(Safe && (times[i] < min() || times[i] > max())){throw std::out_of_range("TODO");}
+			time_t const t(Clamp(times[i]));
+			if(t < times_[segment] || t > times_[segment + 1])
 			{
-				return (*it)->operator()(t);
+				segment = (segment + 2 < times_.size() && t > times_[segment + 1] && t <= times_[segment + 2]) ? segment + 1 : FindSegment(t);
 			}
+			EvaluateSegment(segment, t, out[i], order);
 		}
-		return p;
 	}
 	/*Operations*/
 
 	/*Helpers*/
 	public:
-	num_t virtual min() const{return subSplines_.front()->t_min_;}
-	num_t virtual max() const{return subSplines_.back()->t_max_;}
+	num_t virtual min() const{return times_.front();}
+	num_t virtual max() const{return times_.back();}
+	std::size_t nbSegments() const{return times_.size() - 1;}
+
+	private:
+	time_t Clamp(time_t t) const
+	{
+		return t < times_.front() ? times_.front() : (t > times_.back() ? times_.back() : t);
+	}
+
+	/// first segment whose end is not before t, as the former linear scan
+	std::size_t FindSegment(time_t t) const
+	{
+		typename T_time::const_iterator it = std::lower_bound(times_.begin() + 1, times_.end(), t);
+		return it == times_.end() ? nbSegments() - 1 : (std::size_t)(it - times_.begin()) - 1;
+	}
+
+	/// Horner evaluation of x(t) = a + b(t - t_min_) + c(t - t_min_)^2 + d(t - t_min_)^3 or of its derivatives
+	void EvaluateSegment(std::size_t segment, time_t t, point_t& p, std::size_t order = 0) const
+	{
+		const num_t* a = &coefficients_[segment * 4 * Dim];
+		const num_t* b = a + Dim;
+		const num_t* c = b + Dim;
+		const num_t* d = c + Dim;
+		num_t const dt(t - times_[segment]);
+		switch(order)
+		{
+			case 0:
+				for(int k(0); k < Dim; ++k) p[k] = a[k] + dt * (b[k] + dt * (c[k] + dt * d[k]));
+			break;
+			case 1:
+				for(int k(0); k < Dim; ++k) p[k] = b[k] + dt * (2 * c[k] + dt * 3 * d[k]);
+			break;
+			case 2:
+				for(int k(0); k < Dim; ++k) p[k] = 2 * c[k] + 6 * dt * d[k];
+			break;
+			case 3:
+				for(int k(0); k < Dim; ++k) p[k] = 6 * d[k];
+			break;
+			default:
+				for(int k(0); k < Dim; ++k) p[k] = 0;
+			break;
+		}
+	}
 	/*Helpers*/
 
 	/*Attributes*/
 	private:
-	T_cubic subSplines_;
+	T_time times_;
+	T_coefficient coefficients_;
 	/*Attributes*/
 };
 }
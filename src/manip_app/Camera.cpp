@@ -23,6 +23,7 @@ CameraFollow::CameraFollow(const matrices::Vector3& xyz, const matrices::Vector3
 
 void CameraFollow::DrawArrow()
 {
+#ifndef MANIP_HEADLESS
 	for(int i =0; i<3; ++i)
 	{
 		screenArrowPosition_(i) = xyz_[i] + arrowOffset_[i];
@@ -63,4 +64,5 @@ void CameraFollow::DrawArrow()
 	v3_[2] +=sign* 0.3; 
 	dsDrawTriangle (arrowExtr_, idMatrix, v3_, v2_, v1_, 1);
 	//glutSolidCone(/*GLdouble base*/0.05, /*GLdouble height*/0.05, /*GLint slices*/10, /*GLint stacks*/10);
+#endif
 }
@@ -3,7 +3,9 @@
 #define _CLASS_CAMERA
 
 #include "MatrixDefs.h"
+#ifndef MANIP_HEADLESS
 #include "drawstuff/drawstuff.h"
+#endif
 
 #include "API/RobotI.h"
 
@@ -54,7 +56,9 @@ public:
 				xyz_[i] = xyzInit_[i];
 				hpr_[i] = hprInit_[i];
 			}
+#ifndef MANIP_HEADLESS
 			dsSetViewpoint(xyzInit_, hprInit_);
+#endif
 		}
 	}
 
@@ -88,7 +92,9 @@ public:
 	{	
 		if(moved_ && !free_)
 		{
+#ifndef MANIP_HEADLESS
 			dsSetViewpoint(xyz_, hpr_);
+#endif
 			moved_ = false;
 		}
 	}
@@ -0,0 +1,396 @@
+
+#include "DrawBatch.h"
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifndef WIN32
+extern "C" void (*glXGetProcAddressARB(const GLubyte*))();
+#endif
+
+namespace
+{
+	// buffer objects are not in the 1.1 headers of windows, they are loaded once a context exists
+	typedef void (APIENTRY *t_glGenBuffers)   (GLsizei, GLuint*);
+	typedef void (APIENTRY *t_glDeleteBuffers)(GLsizei, const GLuint*);
+	typedef void (APIENTRY *t_glBindBuffer)   (GLenum, GLuint);
+	typedef void (APIENTRY *t_glBufferData)   (GLenum, ptrdiff_t, const GLvoid*, GLenum);
+	typedef void (APIENTRY *t_glBufferSubData)(GLenum, ptrdiff_t, ptrdiff_t, const GLvoid*);
+
+	const GLenum arrayBuffer = 0x8892;
+	const GLenum staticDraw  = 0x88E4;
+	const GLenum dynamicDraw = 0x88E8;
+
+	void* GetProc(const char* name)
+	{
+	#ifdef WIN32
+		return (void*)wglGetProcAddress(name);
+	#else
+		return (void*)glXGetProcAddressARB((const GLubyte*)name);
+	#endif
+	}
+
+	struct BufferFunctions
+	{
+		BufferFunctions()
+			: loaded_(false)
+			, available_(false)
+		{
+			// NOTHING
+		}
+
+		bool IsAvailable()
+		{
+			if(!loaded_)
+			{
+				loaded_ = true;
+				const char* version = (const char*)glGetString(GL_VERSION);
+				const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+				int major = 0, minor = 0;
+				const char* suffix = 0;
+				if(version && sscanf(version, "%d.%d", &major, &minor) == 2 && (major > 1 || minor >= 5))
+				{
+					suffix = "";
+				}
+				else if(extensions && strstr(extensions, "GL_ARB_vertex_buffer_object"))
+				{
+					suffix = "ARB";
+				}
+				if(suffix)
+				{
+					genBuffers_    = (t_glGenBuffers)   Load("glGenBuffers", suffix);
+					deleteBuffers_ = (t_glDeleteBuffers)Load("glDeleteBuffers", suffix);
+					bindBuffer_    = (t_glBindBuffer)   Load("glBindBuffer", suffix);
+					bufferData_    = (t_glBufferData)   Load("glBufferData", suffix);
+					bufferSubData_ = (t_glBufferSubData)Load("glBufferSubData", suffix);
+					available_ = genBuffers_ && deleteBuffers_ && bindBuffer_ && bufferData_ && bufferSubData_;
+				}
+			}
+			return available_;
+		}
+
+		void* Load(const char* name, const char* suffix)
+		{
+			char fullName[64];
+			sprintf(fullName, "%s%s", name, suffix);
+			return GetProc(fullName);
+		}
+
+		bool loaded_;
+		bool available_;
+		t_glGenBuffers    genBuffers_;
+		t_glDeleteBuffers deleteBuffers_;
+		t_glBindBuffer    bindBuffer_;
+		t_glBufferData    bufferData_;
+		t_glBufferSubData bufferSubData_;
+	};
+
+	BufferFunctions gl;
+
+	// same ratio as the diffuse colour of drawstuff materials
+	const float diffuse = 0.7f;
+
+	enum eBuffer
+	{
+		triangles = 0,
+		colors,
+		lines,
+		nbBuffers
+	};
+}
+
+struct DrawBatchPImpl
+{
+	DrawBatchPImpl()
+		: geometryDirty_(true)
+		, useBuffers_(false)
+	{
+		for(int i = 0; i < nbBuffers; ++i)
+		{
+			buffers_[i] = 0;
+		}
+		for(int i = 0; i < 4; ++i)
+		{
+			color_[i] = 1.f;
+			lineColor_[i] = i < 3 ? 0.f : 1.f;
+		}
+	}
+
+	~DrawBatchPImpl()
+	{
+		if(useBuffers_)
+		{
+			gl.deleteBuffers_(nbBuffers, buffers_);
+		}
+	}
+
+	int NumVertices() const
+	{
+		return (int)triangles_.size() / 6;
+	}
+
+	int Begin(const int instance) const
+	{
+		return first_[instance];
+	}
+
+	int End(const int instance) const
+	{
+		return instance + 1 < (int)first_.size() ? first_[instance + 1] : NumVertices();
+	}
+
+	void PushVertex(const float* position, const float* normal)
+	{
+		triangles_.insert(triangles_.end(), position, position + 3);
+		triangles_.insert(triangles_.end(), normal, normal + 3);
+		for(int i = 0; i < 3; ++i)
+		{
+			colors_.push_back(color_[i] * diffuse);
+		}
+		colors_.push_back(color_[3]);
+	}
+
+	template<typename T>
+	void Upload(const eBuffer buffer, const std::vector<T>& values, GLenum usage)
+	{
+		gl.bindBuffer_(arrayBuffer, buffers_[buffer]);
+		gl.bufferData_(arrayBuffer, values.size() * sizeof(T), values.empty() ? 0 : &values[0], usage);
+	}
+
+	// sends what changed since the last draw, everything if geometry was added
+	void Update()
+	{
+		if(!geometryDirty_ && dirty_.empty())
+		{
+			return;
+		}
+		if(!buffers_[0] && gl.IsAvailable())
+		{
+			gl.genBuffers_(nbBuffers, buffers_);
+			useBuffers_ = true;
+		}
+		if(useBuffers_)
+		{
+			if(geometryDirty_ || dirty_.size() * 2 > first_.size())
+			{
+				Upload(triangles, triangles_, staticDraw);
+				Upload(colors, colors_, dynamicDraw);
+				Upload(lines, lines_, staticDraw);
+			}
+			else
+			{
+				gl.bindBuffer_(arrayBuffer, buffers_[colors]);
+				for(std::vector<int>::const_iterator it = dirty_.begin(); it != dirty_.end(); ++it)
+				{
+					int begin = Begin(*it) * 4;
+					gl.bufferSubData_(arrayBuffer, begin * sizeof(float), (End(*it) * 4 - begin) * sizeof(float), &colors_[begin]);
+				}
+			}
+			gl.bindBuffer_(arrayBuffer, 0);
+		}
+		for(std::vector<int>::const_iterator it = dirty_.begin(); it != dirty_.end(); ++it)
+		{
+			isDirty_[*it] = false;
+		}
+		dirty_.clear();
+		geometryDirty_ = false;
+	}
+
+	const float* Bind(const eBuffer buffer, const std::vector<float>& values) const
+	{
+		if(useBuffers_)
+		{
+			gl.bindBuffer_(arrayBuffer, buffers_[buffer]);
+			return 0;
+		}
+		return &values[0];
+	}
+
+	std::vector<float> triangles_; // position and normal
+	std::vector<float> colors_;
+	std::vector<float> lines_;
+	std::vector<int> first_; // first vertex of each instance
+	std::vector<int> dirty_;
+	std::vector<bool> isDirty_;
+	float color_[4]; // of the instance being built
+	float lineColor_[4];
+	bool geometryDirty_;
+	bool useBuffers_;
+	GLuint buffers_[nbBuffers];
+};
+
+DrawBatch::DrawBatch()
+	: pImpl_(new DrawBatchPImpl)
+{
+	// NOTHING
+}
+
+DrawBatch::~DrawBatch()
+{
+	// NOTHING
+}
+
+int DrawBatch::AddInstance(const float* color)
+{
+	memcpy(pImpl_->color_, color, sizeof(pImpl_->color_));
+	pImpl_->first_.push_back(pImpl_->NumVertices());
+	pImpl_->isDirty_.push_back(false);
+	return (int)pImpl_->first_.size() - 1;
+}
+
+void DrawBatch::AddTriangle(const float* a, const float* b, const float* c, const float* normal)
+{
+	if(pImpl_->first_.empty())
+	{
+		const float white[4] = {1.f, 1.f, 1.f, 1.f};
+		AddInstance(white);
+	}
+	float u[3], v[3];
+	for(int i = 0; i < 3; ++i)
+	{
+		u[i] = b[i] - a[i];
+		v[i] = c[i] - a[i];
+	}
+	float orientation = (u[1] * v[2] - u[2] * v[1]) * normal[0]
+					  + (u[2] * v[0] - u[0] * v[2]) * normal[1]
+					  + (u[0] * v[1] - u[1] * v[0]) * normal[2];
+	pImpl_->PushVertex(a, normal);
+	pImpl_->PushVertex(orientation < 0 ? c : b, normal);
+	pImpl_->PushVertex(orientation < 0 ? b : c, normal);
+	pImpl_->geometryDirty_ = true;
+}
+
+void DrawBatch::AddQuad(const float* a, const float* b, const float* c, const float* d, const float* normal)
+{
+	AddTriangle(a, b, c, normal);
+	AddTriangle(a, c, d, normal);
+}
+
+void DrawBatch::AddLine(const float* from, const float* to)
+{
+	pImpl_->lines_.insert(pImpl_->lines_.end(), from, from + 3);
+	pImpl_->lines_.insert(pImpl_->lines_.end(), to, to + 3);
+	pImpl_->geometryDirty_ = true;
+}
+
+void DrawBatch::SetColor(const int instance, const float* color)
+{
+	DrawBatchPImpl& batch = *pImpl_;
+	int begin = batch.Begin(instance), end = batch.End(instance);
+	if(begin == end)
+	{
+		return;
+	}
+	float vertexColor[4] = {color[0] * diffuse, color[1] * diffuse, color[2] * diffuse, color[3]};
+	if(!memcmp(&batch.colors_[begin * 4], vertexColor, sizeof(vertexColor)))
+	{
+		return;
+	}
+	for(int v = begin; v < end; ++v)
+	{
+		memcpy(&batch.colors_[v * 4], vertexColor, sizeof(vertexColor));
+	}
+	if(!batch.isDirty_[instance])
+	{
+		batch.isDirty_[instance] = true;
+		batch.dirty_.push_back(instance);
+	}
+}
+
+void DrawBatch::SetLineColor(const float* color)
+{
+	memcpy(pImpl_->lineColor_, color, sizeof(pImpl_->lineColor_));
+}
+
+int DrawBatch::GetNumInstances() const
+{
+	return (int)pImpl_->first_.size();
+}
+
+bool DrawBatch::IsEmpty() const
+{
+	return pImpl_->triangles_.empty() && pImpl_->lines_.empty();
+}
+
+void DrawBatch::Clear()
+{
+	DrawBatchPImpl& batch = *pImpl_;
+	batch.triangles_.clear();
+	batch.colors_.clear();
+	batch.lines_.clear();
+	batch.first_.clear();
+	batch.dirty_.clear();
+	batch.isDirty_.clear();
+	batch.geometryDirty_ = true;
+}
+
+void DrawBatch::Draw(bool drawLines) const
+{
+	Draw(0, drawLines);
+}
+
+void DrawBatch::Draw(const double* transform, bool drawLines) const
+{
+	if(IsEmpty())
+	{
+		return;
+	}
+	DrawBatchPImpl& batch = *pImpl_;
+	batch.Update();
+	// leaves the state of drawstuff as it was
+	glPushAttrib(GL_ENABLE_BIT | GL_LIGHTING_BIT | GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT | GL_LINE_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	if(transform)
+	{
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glMultMatrixd(transform);
+	}
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_TEXTURE_GEN_S);
+	glDisable(GL_TEXTURE_GEN_T);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if(!batch.triangles_.empty())
+	{
+		glEnable(GL_LIGHTING);
+		glEnable(GL_COLOR_MATERIAL);
+		glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		const float* vertices = batch.Bind(triangles, batch.triangles_);
+		glVertexPointer(3, GL_FLOAT, 6 * sizeof(float), vertices);
+		glNormalPointer(GL_FLOAT, 6 * sizeof(float), vertices + 3);
+		glColorPointer(4, GL_FLOAT, 0, batch.Bind(colors, batch.colors_));
+		glDrawArrays(GL_TRIANGLES, 0, batch.NumVertices());
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+	}
+	if(drawLines && !batch.lines_.empty())
+	{
+		glDisable(GL_LIGHTING);
+		glDisable(GL_COLOR_MATERIAL);
+		glLineWidth(2);
+		glColor4fv(batch.lineColor_);
+		glVertexPointer(3, GL_FLOAT, 0, batch.Bind(lines, batch.lines_));
+		glDrawArrays(GL_LINES, 0, (GLsizei)batch.lines_.size() / 3);
+	}
+	if(batch.useBuffers_)
+	{
+		gl.bindBuffer_(arrayBuffer, 0);
+	}
+	if(transform)
+	{
+		glPopMatrix();
+	}
+	glPopClientAttrib();
+	glPopAttrib();
+}
@@ -0,0 +1,41 @@
+
+#ifndef _CLASS_DRAWBATCH
+#define _CLASS_DRAWBATCH
+
+#include <memory>
+
+struct DrawBatchPImpl;
+
+/* Retained geometry drawn in a single call. The triangles are grouped into instances with one colour each,
+and only the instances whose colour changed are uploaded again. Lines share a colour for the whole batch.
+Vertex buffer objects are used when the context provides them (GL 1.5), client side arrays otherwise.*/
+class DrawBatch {
+
+public:
+	 DrawBatch();
+	~DrawBatch();
+
+public:
+	int  AddInstance(const float* /*color*/); // rgba, following triangles belong to the instance
+	void AddTriangle(const float* /*a*/, const float* /*b*/, const float* /*c*/, const float* /*normal*/); // front face turned toward normal
+	void AddQuad(const float* /*a*/, const float* /*b*/, const float* /*c*/, const float* /*d*/, const float* /*normal*/);
+	void AddLine(const float* /*from*/, const float* /*to*/);
+
+	void SetColor(const int /*instance*/, const float* /*color*/);
+	void SetLineColor(const float* /*color*/);
+	int  GetNumInstances() const;
+	bool IsEmpty() const;
+	void Clear();
+
+	void Draw(bool drawLines = true) const;
+	void Draw(const double* /*transform*/, bool drawLines = true) const; // column major 4x4 applied to the geometry
+
+private:
+	DrawBatch(const DrawBatch&);
+	DrawBatch& operator=(const DrawBatch&);
+
+private:
+	std::auto_ptr<DrawBatchPImpl> pImpl_;
+}; // class DrawBatch
+
+#endif //_CLASS_DRAWBATCH
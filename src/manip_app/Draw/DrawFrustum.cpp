@@ -0,0 +1,91 @@
+
+#include "DrawFrustum.h"
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+
+#include <cmath>
+
+DrawFrustum::DrawFrustum()
+{
+	GLdouble projection[16], modelview[16], clip[16];
+	glGetDoublev(GL_PROJECTION_MATRIX, projection);
+	glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+	// column major, clip = projection * modelview
+	for(int c = 0; c < 4; ++c)
+	{
+		for(int r = 0; r < 4; ++r)
+		{
+			clip[4 * c + r] = 0;
+			for(int k = 0; k < 4; ++k)
+			{
+				clip[4 * c + r] += projection[4 * k + r] * modelview[4 * c + k];
+			}
+		}
+	}
+	// left, right, bottom, top, near, far from the rows of clip
+	for(int p = 0; p < 6; ++p)
+	{
+		int row = p / 2;
+		double sign = p % 2 ? -1 : 1;
+		double norm = 0;
+		for(int c = 0; c < 4; ++c)
+		{
+			planes_[p][c] = (float)(clip[4 * c + 3] + sign * clip[4 * c + row]);
+			norm += c < 3 ? planes_[p][c] * planes_[p][c] : 0;
+		}
+		norm = sqrt(norm);
+		for(int c = 0; norm > 0 && c < 4; ++c)
+		{
+			planes_[p][c] /= (float)norm;
+		}
+	}
+	// the modelview is a rigid transform, the eye is at -Rt * t
+	for(int i = 0; i < 3; ++i)
+	{
+		eye_[i] = -(float)(modelview[4 * i] * modelview[12] + modelview[4 * i + 1] * modelview[13] + modelview[4 * i + 2] * modelview[14]);
+	}
+}
+
+DrawFrustum::~DrawFrustum()
+{
+	// NOTHING
+}
+
+bool DrawFrustum::IsVisible(const float* min, const float* max) const
+{
+	for(int p = 0; p < 6; ++p)
+	{
+		// corner of the box the furthest along the plane normal
+		float distance = planes_[p][3];
+		for(int i = 0; i < 3; ++i)
+		{
+			distance += planes_[p][i] * (planes_[p][i] > 0 ? max[i] : min[i]);
+		}
+		if(distance < 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DrawFrustum::IsVisible(const float* center, const float radius) const
+{
+	for(int p = 0; p < 6; ++p)
+	{
+		if(planes_[p][0] * center[0] + planes_[p][1] * center[1] + planes_[p][2] * center[2] + planes_[p][3] < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+float DrawFrustum::Distance(const float* point) const
+{
+	float d[3] = {point[0] - eye_[0], point[1] - eye_[1], point[2] - eye_[2]};
+	return sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+}
@@ -0,0 +1,23 @@
+
+#ifndef _CLASS_DRAWFRUSTUM
+#define _CLASS_DRAWFRUSTUM
+
+/* View volume of the current OpenGL projection and modelview, as set by drawstuff for the frame.
+It is read when constructed, so build one at the beginning of a draw.*/
+class DrawFrustum {
+
+public:
+	 DrawFrustum();
+	~DrawFrustum();
+
+public:
+	bool IsVisible(const float* /*min*/, const float* /*max*/) const; // axis aligned box
+	bool IsVisible(const float* /*center*/, const float /*radius*/) const;
+	float Distance(const float* /*point*/) const; // to the eye
+
+private:
+	float planes_[6][4]; // pointing inside
+	float eye_[3];
+}; // class DrawFrustum
+
+#endif //_CLASS_DRAWFRUSTUM
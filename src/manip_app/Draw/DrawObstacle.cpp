@@ -1,5 +1,6 @@
 
 #include "DrawObstacle.h"
+#include "DrawBatch.h"
 #include <drawstuff/drawstuff.h> // The drawing library for ODE;
 #include "Simulation.h"
 
@@ -111,13 +112,70 @@ void DrawObstacle::Draw() const
 	// renforce les arrts
 	if(Simulation::GetInstance()->simpParams_.drawNormals_)
 	{
-		dsSetColorAlpha(1.f, 0, 0,0.7);
-		dsDrawLine(center_, normal_);
-		dsSetColorAlpha(r_, g_, bl_,transparency_);
+		DrawNormal();
 	}
 	dsSetColorAlpha(r_, g_, bl_,1);
 }
 
+void DrawObstacle::DrawNormal() const
+{
+	dsSetColorAlpha(1.f, 0, 0,0.7);
+	dsDrawLine(center_, normal_);
+	dsSetColorAlpha(r_, g_, bl_,transparency_);
+}
+
+void DrawObstacle::Fill(DrawBatch& batch) const
+{
+	float color[4] = {r_, g_, bl_, transparency_};
+	batch.AddInstance(color);
+	// faces of the box in world coordinates, the sides are flat without offset
+	float half[3] = {sides_[0] / 2, sides_[1] / 2, sides_[2] / 2};
+	for(int axis = 2; axis >= (half[2] > 0 ? 0 : 2); --axis)
+	{
+		int u = (axis + 1) % 3, v = (axis + 2) % 3;
+		for(float side = -1; side <= 1; side += 2)
+		{
+			float corners[4][3], normal[3];
+			const float signs[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+			for(int i = 0; i < 3; ++i)
+			{
+				normal[i] = side * R_[4 * i + axis];
+				for(int c = 0; c < 4; ++c)
+				{
+					corners[c][i] = pos_[i] + R_[4 * i + axis] * side * half[axis]
+							   + R_[4 * i + u] * signs[c][0] * half[u]
+							   + R_[4 * i + v] * signs[c][1] * half[v];
+				}
+			}
+			batch.AddQuad(corners[0], corners[1], corners[2], corners[3], normal);
+		}
+	}
+}
+
+void DrawObstacle::GetColor(float* color) const
+{
+	color[0] = r_; color[1] = g_; color[2] = bl_; color[3] = transparency_;
+}
+
+void DrawObstacle::GetCorners(matrices::Vector3* corners) const
+{
+	matrices::arrayToVect3(a_, corners[0]);
+	matrices::arrayToVect3(b_, corners[1]);
+	matrices::arrayToVect3(c_, corners[2]);
+	matrices::arrayToVect3(d_, corners[3]);
+}
+
+void DrawObstacle::GetBounds(float* min, float* max) const
+{
+	// the box drawn is centered on pos_
+	for(int i = 0; i < 3; ++i)
+	{
+		float extent = (fabs(R_[4 * i]) * sides_[0] + fabs(R_[4 * i + 1]) * sides_[1] + fabs(R_[4 * i + 2]) * sides_[2]) / 2;
+		min[i] = pos_[i] - extent;
+		max[i] = pos_[i] + extent;
+	}
+}
+
 void DrawObstacle::DrawWithTexture() const
 {
 	float id[12];
@@ -6,6 +6,7 @@
 #include "MatrixDefs.h"
 
 class Obstacle;
+class DrawBatch;
 
 class DrawObstacle {
 
@@ -21,6 +22,14 @@ public:
 	 void DrawWithTexture()const;
 	 void Draw()const;
 	 void DrawRed()const;
+	 void DrawNormal()const;
+	 void Fill(DrawBatch& /*batch*/)const; // adds the box drawn by Draw as an instance of the batch
+
+	 int  GetTexture()const { return texture_; }
+	 bool IsFlat()const { return sides_[2] == 0; }
+	 void GetColor(float* /*color*/)const; // rgba
+	 void GetCorners(matrices::Vector3* /*corners*/)const; // the 4 points given at construction
+	 void GetBounds(float* /*min*/, float* /*max*/)const;
 
 private:
 	void Init(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*upRight*/, const matrices::Vector3& /*downRight*/, const matrices::Vector3& /*downLeft*/);
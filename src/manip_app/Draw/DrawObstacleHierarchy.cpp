@@ -0,0 +1,400 @@
+
+#include "DrawObstacleHierarchy.h"
+#include "DrawBatch.h"
+#include "DrawFrustum.h"
+#include "Simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace std;
+using namespace matrices;
+
+namespace
+{
+	const int leafSize = 64; // faces per batch
+	const NUMBER quantum = 0.0001; // points closer are the same when merging
+	const NUMBER epsilon = 0.0001;
+
+	typedef vector<int> T_Index;
+
+	struct Point
+	{
+		Point(const Vector3& point)
+		{
+			for(int i = 0; i < 3; ++i)
+			{
+				v_[i] = (long)floor(point(i) / quantum + 0.5);
+			}
+		}
+
+		bool operator<(const Point& other) const
+		{
+			return lexicographical_compare(v_, v_ + 3, other.v_, other.v_ + 3);
+		}
+
+		bool operator==(const Point& other) const
+		{
+			return v_[0] == other.v_[0] && v_[1] == other.v_[1] && v_[2] == other.v_[2];
+		}
+
+		long v_[3];
+	};
+
+	typedef pair<Point, Point> T_Edge;
+	typedef map<T_Edge, pair<int, int> > T_Edges; // face and edge index
+
+	T_Edge MakeEdge(const Vector3& a, const Vector3& b)
+	{
+		Point pa(a), pb(b);
+		return pb < pa ? T_Edge(pb, pa) : T_Edge(pa, pb);
+	}
+
+	struct Face
+	{
+		Face(const DrawObstacle& obstacle, const int source)
+			: alive_(true)
+		{
+			obstacle.GetCorners(corners_);
+			obstacle.GetColor(color_);
+			sources_.push_back(source);
+			Vector3 e1 = corners_[1] - corners_[0], e3 = corners_[3] - corners_[0];
+			mergeable_ = obstacle.IsFlat() && obstacle.GetTexture() == 0
+					&& fabs(e1.dot(e3)) <= epsilon * e1.norm() * e3.norm()
+					&& (corners_[2] - corners_[1] - e3).norm() <= epsilon * (e1.norm() + e3.norm());
+			normal_ = (corners_[2] - corners_[3]).cross(corners_[0] - corners_[3]);
+			normal_.normalize();
+		}
+
+		bool CanMerge(const Face& other) const
+		{
+			return mergeable_ && other.mergeable_ && alive_ && other.alive_
+				&& !memcmp(color_, other.color_, sizeof(color_))
+				&& normal_.dot(other.normal_) > 1 - epsilon;
+		}
+
+		int Find(const Vector3& point) const
+		{
+			Point p(point);
+			for(int i = 0; i < 4; ++i)
+			{
+				if(Point(corners_[i]) == p)
+				{
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		// other shares the edge starting at corner edge, the face grows up to its far side
+		bool Merge(Face& other, const int edge)
+		{
+			int s = other.Find(corners_[edge]), t = other.Find(corners_[(edge + 1) % 4]);
+			if(s < 0 || t < 0)
+			{
+				return false;
+			}
+			int farS = (s + 1) % 4 == t ? (s + 3) % 4 : (s + 1) % 4;
+			int farT = (t + 1) % 4 == s ? (t + 3) % 4 : (t + 1) % 4;
+			// other must lie beyond the edge, not over the face
+			if((corners_[edge] - corners_[(edge + 3) % 4]).dot(other.corners_[farS] - corners_[edge]) <= 0)
+			{
+				return false;
+			}
+			corners_[edge] = other.corners_[farS];
+			corners_[(edge + 1) % 4] = other.corners_[farT];
+			sources_.insert(sources_.end(), other.sources_.begin(), other.sources_.end());
+			other.alive_ = false;
+			return true;
+		}
+
+		Vector3 corners_[4];
+		Vector3 normal_;
+		float color_[4];
+		T_Index sources_; // obstacles merged into the face
+		bool mergeable_;
+		bool alive_;
+	};
+
+	typedef vector<Face> T_Face;
+
+	// one face merges at most once per pass, the edges are collected again for the next.
+	// Merging first across the edges 0 and 2 only makes strips of a grid, which then merge into a single face
+	bool MergePass(T_Face& faces, const bool anyEdge)
+	{
+		T_Edges edges;
+		vector<bool> used(faces.size(), false);
+		bool merged = false;
+		for(int f = 0; f < (int)faces.size(); ++f)
+		{
+			Face& face = faces[f];
+			if(!face.mergeable_ || !face.alive_)
+			{
+				continue;
+			}
+			for(int e = 0; e < 4 && !used[f]; e += anyEdge ? 1 : 2)
+			{
+				T_Edge edge = MakeEdge(face.corners_[e], face.corners_[(e + 1) % 4]);
+				T_Edges::iterator it = edges.find(edge);
+				if(it == edges.end())
+				{
+					edges.insert(make_pair(edge, make_pair(f, e)));
+				}
+				else if(!used[it->second.first] && faces[it->second.first].CanMerge(face)
+						&& faces[it->second.first].Merge(face, it->second.second))
+				{
+					used[it->second.first] = used[f] = merged = true;
+				}
+			}
+		}
+		return merged;
+	}
+
+	struct Node
+	{
+		Node()
+			: left_(-1)
+			, right_(-1)
+			, batch_(0)
+		{
+			// NOTHING
+		}
+
+		float min_[3];
+		float max_[3];
+		int left_;
+		int right_;
+		DrawBatch* batch_; // leaves only
+	};
+
+	struct CenterLess
+	{
+		CenterLess(const vector<float>& bounds, const int axis)
+			: bounds_(bounds)
+			, axis_(axis)
+		{
+			// NOTHING
+		}
+
+		bool operator()(const int a, const int b) const
+		{
+			return bounds_[6 * a + axis_] + bounds_[6 * a + 3 + axis_] < bounds_[6 * b + axis_] + bounds_[6 * b + 3 + axis_];
+		}
+
+		const vector<float>& bounds_;
+		const int axis_;
+	};
+}
+
+struct DrawObstacleHierarchyPImpl
+{
+	DrawObstacleHierarchyPImpl()
+		: dirty_(false)
+	{
+		// NOTHING
+	}
+
+	~DrawObstacleHierarchyPImpl()
+	{
+		ClearNodes();
+	}
+
+	void ClearNodes()
+	{
+		for(vector<Node>::iterator it = nodes_.begin(); it != nodes_.end(); ++it)
+		{
+			delete it->batch_;
+		}
+		nodes_.clear();
+		bounds_.clear();
+		textured_.clear();
+	}
+
+	void Rebuild()
+	{
+		ClearNodes();
+		dirty_ = false;
+		T_Index order;
+		bounds_.resize(obstacles_.size() * 6);
+		for(int i = 0; i < (int)obstacles_.size(); ++i)
+		{
+			obstacles_[i].GetBounds(&bounds_[6 * i], &bounds_[6 * i + 3]);
+			(obstacles_[i].GetTexture() == 0 ? order : textured_).push_back(i);
+		}
+		if(!order.empty())
+		{
+			Build(order, 0, (int)order.size());
+		}
+	}
+
+	int Build(T_Index& order, const int begin, const int end)
+	{
+		Node node;
+		for(int i = 0; i < 3; ++i)
+		{
+			node.min_[i] = bounds_[6 * order[begin] + i];
+			node.max_[i] = bounds_[6 * order[begin] + 3 + i];
+			for(int o = begin + 1; o < end; ++o)
+			{
+				node.min_[i] = min(node.min_[i], bounds_[6 * order[o] + i]);
+				node.max_[i] = max(node.max_[i], bounds_[6 * order[o] + 3 + i]);
+			}
+		}
+		int index = (int)nodes_.size();
+		nodes_.push_back(node);
+		if(end - begin <= leafSize)
+		{
+			nodes_[index].batch_ = BuildLeaf(order, begin, end);
+		}
+		else
+		{
+			// median split along the longest side
+			int axis = 0;
+			for(int i = 1; i < 3; ++i)
+			{
+				axis = node.max_[i] - node.min_[i] > node.max_[axis] - node.min_[axis] ? i : axis;
+			}
+			int middle = (begin + end) / 2;
+			nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, CenterLess(bounds_, axis));
+			int left = Build(order, begin, middle);
+			int right = Build(order, middle, end);
+			nodes_[index].left_ = left;
+			nodes_[index].right_ = right;
+		}
+		return index;
+	}
+
+	// merging stays within the leaf, so that the faces are not larger than the culled boxes
+	DrawBatch* BuildLeaf(const T_Index& order, const int begin, const int end) const
+	{
+		T_Face faces;
+		for(int o = begin; o < end; ++o)
+		{
+			faces.push_back(Face(obstacles_[order[o]], order[o]));
+		}
+		// the thickness of offset obstacles depends on their width, they are never merged
+		while(MergePass(faces, false));
+		while(MergePass(faces, true));
+		DrawBatch* batch = new DrawBatch;
+		for(T_Face::iterator it = faces.begin(); it != faces.end(); ++it)
+		{
+			if(!it->alive_)
+			{
+				continue;
+			}
+			if(it->sources_.size() == 1)
+			{
+				obstacles_[it->sources_.front()].Fill(*batch);
+			}
+			else
+			{
+				DrawObstacle(it->corners_[0], it->corners_[1], it->corners_[2], it->corners_[3], it->color_, it->color_[3], 0).Fill(*batch);
+			}
+		}
+		// edges shared by neighbours are drawn once
+		set<T_Edge> edges;
+		for(int o = begin; o < end; ++o)
+		{
+			Vector3 corners[4];
+			obstacles_[order[o]].GetCorners(corners);
+			for(int e = 0; e < 4; ++e)
+			{
+				if(edges.insert(MakeEdge(corners[e], corners[(e + 1) % 4])).second)
+				{
+					float from[3], to[3];
+					matrices::vect3ToArray(from, corners[e]);
+					matrices::vect3ToArray(to, corners[(e + 1) % 4]);
+					batch->AddLine(from, to);
+				}
+			}
+		}
+		return batch;
+	}
+
+	void DrawNode(const int index, const DrawFrustum& frustum) const
+	{
+		const Node& node = nodes_[index];
+		if(!frustum.IsVisible(node.min_, node.max_))
+		{
+			return;
+		}
+		if(node.batch_)
+		{
+			node.batch_->Draw();
+		}
+		else
+		{
+			DrawNode(node.left_, frustum);
+			DrawNode(node.right_, frustum);
+		}
+	}
+
+	vector<DrawObstacle> obstacles_;
+	vector<float> bounds_; // min and max of each obstacle
+	vector<Node> nodes_;   // root first
+	T_Index textured_;
+	bool dirty_;
+};
+
+DrawObstacleHierarchy::DrawObstacleHierarchy()
+	: pImpl_(new DrawObstacleHierarchyPImpl)
+{
+	// NOTHING
+}
+
+DrawObstacleHierarchy::~DrawObstacleHierarchy()
+{
+	// NOTHING
+}
+
+void DrawObstacleHierarchy::Add(const DrawObstacle& obstacle)
+{
+	pImpl_->obstacles_.push_back(obstacle);
+	pImpl_->dirty_ = true;
+}
+
+void DrawObstacleHierarchy::Draw(const DrawFrustum& frustum) const
+{
+	DrawObstacleHierarchyPImpl& hierarchy = *pImpl_;
+	if(hierarchy.dirty_)
+	{
+		hierarchy.Rebuild();
+	}
+	if(!hierarchy.nodes_.empty())
+	{
+		hierarchy.DrawNode(0, frustum);
+	}
+	for(T_Index::const_iterator it = hierarchy.textured_.begin(); it != hierarchy.textured_.end(); ++it)
+	{
+		const DrawObstacle& obstacle = hierarchy.obstacles_[*it];
+		float min[3], max[3];
+		obstacle.GetBounds(min, max);
+		if(frustum.IsVisible(min, max))
+		{
+			obstacle.Draw();
+		}
+	}
+	if(Simulation::GetInstance()->simpParams_.drawNormals_)
+	{
+		for(vector<DrawObstacle>::const_iterator it = hierarchy.obstacles_.begin(); it != hierarchy.obstacles_.end(); ++it)
+		{
+			float min[3], max[3];
+			it->GetBounds(min, max);
+			if(it->GetTexture() == 0 && frustum.IsVisible(min, max))
+			{
+				it->DrawNormal();
+			}
+		}
+	}
+}
+
+void DrawObstacleHierarchy::Clear()
+{
+	pImpl_->ClearNodes();
+	pImpl_->obstacles_.clear();
+	pImpl_->dirty_ = false;
+}
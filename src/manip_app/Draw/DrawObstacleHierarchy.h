@@ -0,0 +1,35 @@
+
+#ifndef _CLASS_DRAWOBSTACLEHIERARCHY
+#define _CLASS_DRAWOBSTACLEHIERARCHY
+
+#include "DrawObstacle.h"
+
+#include <memory>
+
+struct DrawObstacleHierarchyPImpl;
+class DrawFrustum;
+
+/* Obstacles of a layer of the world, sorted in a hierarchy of bounding boxes culled against the view.
+Each leaf is retained in a DrawBatch, where adjacent coplanar rectangles of the same colour are merged
+into one face, their edges being kept. Textured obstacles are still drawn by drawstuff.
+The hierarchy is rebuilt at the first draw following an addition.*/
+class DrawObstacleHierarchy {
+
+public:
+	 DrawObstacleHierarchy();
+	~DrawObstacleHierarchy();
+
+public:
+	void Add(const DrawObstacle& /*obstacle*/);
+	void Draw(const DrawFrustum& /*frustum*/) const;
+	void Clear();
+
+private:
+	DrawObstacleHierarchy(const DrawObstacleHierarchy&);
+	DrawObstacleHierarchy& operator=(const DrawObstacleHierarchy&);
+
+private:
+	std::auto_ptr<DrawObstacleHierarchyPImpl> pImpl_;
+}; // class DrawObstacleHierarchy
+
+#endif //_CLASS_DRAWOBSTACLEHIERARCHY
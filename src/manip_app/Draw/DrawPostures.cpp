@@ -6,6 +6,7 @@
 
 #include "DrawPostures.h"
 #include "DrawRobot.h"
+#include "DrawFrustum.h"
 
 #include <drawstuff/drawstuff.h> // The drawing library for ODE;
 #include <vector>
@@ -14,6 +15,11 @@ using namespace std;
 using namespace matrices;
 using namespace manip_core;
 
+namespace
+{
+	const float linesDistance = 10.f; // beyond, the postures which are not selected are drawn as lines
+}
+
 struct DrawPosturePImpl
 {
 	DrawPosturePImpl()
@@ -28,14 +34,25 @@ struct DrawPosturePImpl
 		{
 			delete(*it);
 		}
+		for(T_RobotIT it = robots_.begin(); it != robots_.end(); ++it)
+		{
+			(*it)->Release();
+		}
 	}
 
 	virtual void OnPostureCreated(NUMBER time, const RobotI* pRobot)
 	{
-		drawRobots_.push_back(new DrawRobot(pRobot));
+		// the planner recycles its postures
+		RobotI* robot = pRobot->Copy();
+		robots_.push_back(robot);
+		drawRobots_.push_back(new DrawRobot(robot));
 		current_ = drawRobots_.begin();
 	}
 
+	typedef vector<RobotI*> T_Robot;
+	typedef T_Robot::iterator T_RobotIT;
+	T_Robot robots_;
+
 	typedef vector<DrawRobot*> T_DrawRobot;
 	typedef T_DrawRobot::iterator T_DrawRobotIT;
 	typedef T_DrawRobot::const_iterator T_DrawRobotCIT;
@@ -61,10 +78,27 @@ void DrawPostures::Draw(bool transparency) const
 	{
 		//(*(pImpl_->current_))->ToggleSupportPolygon(true);
 		(*(pImpl_->current_))->Draw(transparency);
-	}for(DrawPosturePImpl::T_DrawRobotCIT it = pImpl_->drawRobots_.begin(); it != pImpl_->drawRobots_.end(); ++it)
+	}
+	DrawFrustum frustum;
+	for(DrawPosturePImpl::T_DrawRobotCIT it = pImpl_->drawRobots_.begin(); it != pImpl_->drawRobots_.end(); ++it)
 	{
 		if (*it != *pImpl_->current_)
-		(*it)->DrawNoTexture();
+		{
+			float center[3], radius;
+			(*it)->GetBounds(center, radius);
+			if(!frustum.IsVisible(center, radius))
+			{
+				continue;
+			}
+			if(frustum.Distance(center) - radius > linesDistance)
+			{
+				(*it)->DrawLines();
+			}
+			else
+			{
+				(*it)->DrawNoTexture();
+			}
+		}
 	}
 }
 
@@ -17,6 +17,7 @@
 //#include "MainTools.h"
 #include <drawstuff/drawstuff.h> // The drawing library for ODE;
 
+#include <algorithm>
 #include <vector>
 
 using namespace std;
@@ -399,6 +400,35 @@ void DrawRobot::DrawNoTexture() const
 	//}
 }
 
+void DrawRobot::DrawLines() const
+{
+	dsSetTexture(0);
+	double currentTransform[16];
+	pImpl_->robot_->ToWorldCoordinates(currentTransform);
+	Matrix4 transform;
+	matrices::array16ToMatrix4(currentTransform, transform);
+	for(PImpl::T_TreeCIT it = pImpl_->drawTrees_.begin(); it!= pImpl_->drawTrees_.end(); ++it)
+	{
+		it->DrawLines(transform);
+	}
+}
+
+void DrawRobot::GetBounds(float* center, float& radius) const
+{
+	double currentTransform[16];
+	pImpl_->robot_->ToWorldCoordinates(currentTransform);
+	Matrix4 transform;
+	matrices::array16ToMatrix4(currentTransform, transform);
+	matrices::vect4ToArray(center, transform.col(3));
+	radius = 0;
+	for(PImpl::T_TreeCIT it = pImpl_->drawTrees_.begin(); it!= pImpl_->drawTrees_.end(); ++it)
+	{
+		radius = std::max(radius, (float)it->GetReach());
+	}
+	// widest shape drawn around the joints
+	radius += 0.25f;
+}
+
 //void DrawRobot::Visit(const Tree& tree, const Joint* anchor)
 //{
 //	pImpl_->drawTrees_.push_back(DrawTree(tree));
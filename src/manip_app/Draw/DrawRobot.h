@@ -23,6 +23,8 @@ public:
 	 void ToggleSupportPolygon(bool /*onoff*/);
 	 void Draw(bool transparency = false)const;
 	 void DrawNoTexture()const;
+	 void DrawLines()const; // cheaper DrawNoTexture for far away postures
+	 void GetBounds(float* /*center*/, float& /*radius*/)const; // sphere in world coordinates
 	 void SetTarget(const manip_core::RobotI* robot);
 	 const manip_core::RobotI* GetRobot();
 	
@@ -1,5 +1,6 @@
-
 #include "DrawSamples.h"
+#include "DrawBatch.h"
+#include "DrawFrustum.h"
 #include "MatrixDefs.h"
 #include "Simulation.h"
 
@@ -10,17 +11,99 @@
 
 #include <drawstuff/drawstuff.h> // The drawing library for ODE;
 
+#include <algorithm>
+
 using namespace matrices;
 using namespace manip_core;
+using namespace manip_core::enums;
 
 namespace matrices
 {
 	const Vector3 unitz(0,0,1);
 }
 
+namespace
+{
+	const float coarseDistance = 10.f; // between the eye and the bounds of the samples
+
+	void ToArray(float* tab, const Vector3& vect)
+	{
+		matrices::vect3ToArray(tab, vect);
+	}
+
+	// same shape as the effector cylinder of DrawTree
+	void AddCylinder(DrawBatch& batch, const Vector3& center, const Vector3& axis, const NUMBER length, const NUMBER radius)
+	{
+		const int nbSides = 8;
+		Matrix3 rotation; matrices::GetRotationMatrix(unitz, axis, rotation);
+		Vector3 top = center + axis * (length / 2), bottom = center - axis * (length / 2);
+		float fTop[3], fBottom[3], fAxis[3], fMinusAxis[3];
+		ToArray(fTop, top); ToArray(fBottom, bottom); ToArray(fAxis, axis); ToArray(fMinusAxis, -axis);
+		for(int i = 0; i < nbSides; ++i)
+		{
+			NUMBER a1 = 2 * Pi * i / nbSides, a2 = 2 * Pi * (i + 1) / nbSides;
+			Vector3 r1 = rotation * Vector3(cos(a1), sin(a1), 0);
+			Vector3 r2 = rotation * Vector3(cos(a2), sin(a2), 0);
+			float t1[3], t2[3], b1[3], b2[3], normal[3];
+			ToArray(t1, top + r1 * radius); ToArray(t2, top + r2 * radius);
+			ToArray(b1, bottom + r1 * radius); ToArray(b2, bottom + r2 * radius);
+			ToArray(normal, (r1 + r2).normalized());
+			batch.AddQuad(b1, b2, t2, t1, normal);
+			batch.AddTriangle(fTop, t1, t2, fAxis);
+			batch.AddTriangle(fBottom, b1, b2, fMinusAxis);
+		}
+	}
+
+	void AddSquare(DrawBatch& batch, const Vector3& center, const Vector3& axis, const NUMBER radius)
+	{
+		Matrix3 rotation; matrices::GetRotationMatrix(unitz, axis, rotation);
+		float corners[4][3], normal[3];
+		for(int i = 0; i < 4; ++i)
+		{
+			ToArray(corners[i], center + rotation * Vector3(i < 2 ? radius : -radius, i % 3 ? radius : -radius, 0));
+		}
+		ToArray(normal, axis);
+		batch.AddQuad(corners[0], corners[1], corners[2], corners[3], normal);
+	}
+
+	void IdColor(const int id, float* color)
+	{
+		switch(id)
+		{
+			case 1:
+			{
+				color[0] = 1; color[1] = 0; color[2] = 1;
+				break;
+			}
+			case 2:
+			{
+				color[0] = 0; color[1] = 1; color[2] = 1;
+				break;
+			}
+			case 3:
+			{
+				color[0] = 0; color[1] = 0; color[2] = 0;
+				break;
+			}
+			default:
+			{
+				color[0] = 0; color[1] = 0; color[2] = 1;
+				break;
+			}
+		}
+		color[3] = 1;
+	}
+}
+
 DrawSamples::DrawSamples(const manip_core::RobotI* robot, const manip_core::TreeI* tree, int id, bool collide)
-	: maxManip_(-1)
+	: batch_(new DrawBatch)
+	, coarse_(new DrawBatch)
+	, min_(0, 0, 0)
+	, max_(0, 0, 0)
+	, maxManip_(-1)
 	, id_(id)
+	, colorMode_(-1)
+	, colorMax_(-1)
 {
 	Simulation::GetInstance()->postureManager_->VisitSamples(robot, tree, this, false);
 }
@@ -37,38 +120,224 @@ DrawSamples::~DrawSamples()
 
 void DrawSamples::Visit(const manip_core::RobotI* robot, manip_core::TreeI* tree)
 {
-	trees_.push_back(tree);
 	Vector3 dir = Simulation::GetInstance()->simpParams_.initDir_;
-	double manip = tree->GetManipulability(dir(0), dir(1), dir(2));
+	Add(robot, tree, tree->GetManipulability(dir(0), dir(1), dir(2)));
+}
+
+void DrawSamples::VisitWithJacobianProduct(const manip_core::RobotI* robot, manip_core::TreeI* tree, const double* jacobianProduct)
+{
+	// same as TreeI::GetManipulability without rebuilding the jacobian
+	Vector3 dir = Simulation::GetInstance()->simpParams_.initDir_;
+	NUMBER r = 0;
+	for(int i = 0; i < 3; ++i)
+	{
+		for(int j = 0; j < 3; ++j)
+		{
+			r += dir(i) * jacobianProduct[4 * i + j] * dir(j);
+		}
+	}
+	Add(robot, tree, 1 / sqrt(r));
+}
+
+void DrawSamples::Add(const manip_core::RobotI* robot, manip_core::TreeI* tree, NUMBER manip)
+{
+	trees_.push_back(tree);
 	double normal[3];
-	if(tree->GetObstacleNormal(normal) && manip > 0)
+	bool hasNormal = tree->GetObstacleNormal(normal);
+	Vector3 vNormal(0, 0, 1);
+	if(hasNormal)
 	{
-		Vector3 vNormal; matrices::arrayToVect3(normal, vNormal);
+		matrices::arrayToVect3(normal, vNormal);
 		vNormal.normalize();
-		manip *= Simulation::GetInstance()->simpParams_.initDir_.dot(vNormal);
-		manip = manip < 0 ? 0 : manip;
+		if(manip > 0)
+		{
+			manip *= Simulation::GetInstance()->simpParams_.initDir_.dot(vNormal);
+			manip = manip < 0 ? 0 : manip;
+		}
 	}
 	maxManip_ = manip > maxManip_ ? manip : maxManip_;
 	if(maxManip_ > 200) maxManip_= 200;
-	drawTrees_.push_back(std::make_pair(manip, DrawTree(tree, 0.02f, 0.05f, id_)));
-}
+	manips_.push_back(manip);
 
+	// joint positions in the frame of the robot, as DrawTree computes them
+	Matrix4 transform = Matrix4::Identity();
+	const JointI* joint = tree->GetRootJointI();
+	int instance = -1;
+	firstJoint_.push_back((int)joints_.size());
+	while(joint)
+	{
+		double vect[3];
+		joint->Offset(vect);
+		Vector3 offset;
+		matrices::arrayToVect3(vect, offset);
+		Matrix4 jointTransform = Translate(offset);
+		switch(joint->GetRotation())
+		{
+			case rotation::X:
+				jointTransform = jointTransform + Rotx4(joint->GetAngle());
+				break;
+			case rotation::Y:
+				jointTransform = jointTransform + Roty4(joint->GetAngle());
+				break;
+			case rotation::Z:
+				jointTransform = jointTransform + Rotz4(joint->GetAngle());
+				break;
+		}
+		transform = transform * jointTransform;
+		Vector3 position(transform.block<3,1>(0,3));
+		bool first = trees_.size() == 1 && !joint->GetParent();
+		for(int i = 0; i < 3; ++i)
+		{
+			min_(i) = first ? position(i) : std::min(min_(i), position(i));
+			max_(i) = first ? position(i) : std::max(max_(i), position(i));
+		}
+		joints_.push_back(position);
+		jointSpheres_.push_back(joint->GetSon() && !joint->IsLocked());
+		if(!joint->GetSon() && hasNormal)
+		{
+			// the normal is in world coordinates, samples are drawn in the frame of the robot
+			double world[16];
+			robot->ToWorldCoordinates(world);
+			Matrix4 toWorld;
+			matrices::array16ToMatrix4(world, toWorld);
+			Vector3 axis = toWorld.block<3,3>(0,0).transpose() * vNormal;
+			float color[4];
+			IdColor(id_, color);
+			instance = batch_->AddInstance(color);
+			AddCylinder(*batch_, position, axis.normalized(), 0.05, 0.05);
+			coarse_->AddInstance(color);
+			AddSquare(*coarse_, position, axis.normalized(), 0.05);
+		}
+		joint = (joint->IsEffector() ? 0 : joint->GetSon());
+	}
+	instances_.push_back(instance);
+}
 
-void DrawSamples::Draw(const matrices::Matrix4& currentTransform, bool transparency) const
+void DrawSamples::UpdateColors() const
 {
-	for(T_DrawTree::const_iterator it = drawTrees_.begin(); it!= drawTrees_.end(); ++it)
+	int mode = Simulation::GetInstance()->simpParams_.drawManip_ ? 1 : 0;
+	if(mode == colorMode_ && (mode == 0 || colorMax_ == maxManip_))
+	{
+		return;
+	}
+	colorMode_ = mode;
+	colorMax_ = maxManip_;
+	for(std::size_t i = 0; i < instances_.size(); ++i)
 	{
-		if(Simulation::GetInstance()->simpParams_.drawManip_)
+		if(instances_[i] < 0)
+		{
+			continue;
+		}
+		float color[4];
+		if(mode)
 		{
-			(*it).second.Draw(currentTransform, transparency, true, (it->first) / maxManip_);
+			// from red to green
+			float ratio = (float)(manips_[i] / maxManip_);
+			color[0] = 1 - ratio; color[1] = ratio; color[2] = 0; color[3] = 1;
 		}
 		else
 		{
-			(*it).second.Draw(currentTransform, transparency, true, -1);
+			IdColor(id_, color);
 		}
-		
+		batch_->SetColor(instances_[i], color);
+		coarse_->SetColor(instances_[i], color);
 	}
 }
 
+void DrawSamples::Draw(const matrices::Matrix4& currentTransform, bool transparency) const
+{
+	if(trees_.empty())
+	{
+		return;
+	}
+	DrawFrustum frustum;
+	float center[3];
+	float radius = (float)((max_ - min_).norm() / 2 + 0.05);
+	matrices::vect3ToArray(center, matrices::matrix4TimesVect3(currentTransform, (min_ + max_) / 2));
+	if(!frustum.IsVisible(center, radius))
+	{
+		return;
+	}
+	UpdateColors();
+	double transform[16];
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			transform[4 * j + i] = currentTransform(i, j);
+		}
+	}
+	if(frustum.Distance(center) - radius > coarseDistance)
+	{
+		coarse_->Draw(transform, false);
+	}
+	else
+	{
+		batch_->Draw(transform, false);
+		if(Simulation::GetInstance()->simpParams_.drawArms_)
+		{
+			DrawArms(currentTransform, transparency);
+		}
+	}
+}
 
-
+void DrawSamples::DrawArms(const matrices::Matrix4& currentTransform, bool transparency) const
+{
+	// same ellipsoids as DrawTree draws for the samples, the last segment of each arm is lighter
+	float R[12];
+	matrixToArray(R, currentTransform);
+	dsSetTexture(transparency ? 0 : 1);
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		if(pass == 0 && transparency)
+		{
+			dsSetColorAlpha(0.54f,0.4f,0.32f, 0.8f);
+		}
+		else if(pass == 0)
+		{
+			dsSetColor(1.0,1.0,1.0);
+		}
+		else
+		{
+			dsSetColorAlpha(0.84f,0.7f,0.62f, 0.8f);
+		}
+		for(std::size_t i = 0; i < firstJoint_.size(); ++i)
+		{
+			int first = firstJoint_[i];
+			int end = i + 1 < firstJoint_.size() ? firstJoint_[i + 1] : (int)joints_.size();
+			for(int j = (pass == 0) ? first : end - 1; j < end; ++j)
+			{
+				float ps[3];
+				Vector3 vTo(matrices::matrix4TimesVect3(currentTransform, joints_[j]));
+				if(pass == 0 && jointSpheres_[j])
+				{
+					vect3ToArray(ps, vTo);
+					dsDrawSphere(ps, R, 0.02f);
+				}
+				if(j == first || (pass == 0 && j == end - 1))
+				{
+					continue;
+				}
+				Vector3 vFrom(matrices::matrix4TimesVect3(currentTransform, joints_[j - 1]));
+				Vector3 trans(vTo - vFrom);
+				NUMBER length = trans.norm();
+				if(length < 0.01) // co-located joints
+				{
+					continue;
+				}
+				float R2[12];
+				Matrix3 rotation;
+				GetRotationMatrix(unitz, trans / length, rotation);
+				Matrix3 scale = Matrix3::Zero();
+				scale(0,0) = 0.1;
+				scale(1,1) = 0.1;
+				scale(2,2) = 1;
+				matrix3ToArray(R2, rotation * scale);
+				vect3ToArray(ps, vFrom + trans / 2.);
+				dsDrawSphere(ps, R2, (float)(length - 0.01f) / 2);
+			}
+		}
+	}
+	dsSetTexture(0);
+	dsSetColorAlpha(1.0,1.0,1.0,1);
+}
@@ -3,8 +3,8 @@
 #define _CLASS_DRAWSAMPLES
 
 #include "MatrixDefs.h"
-#include "DrawTree.h"
 #include "API/SampleVisitorI.h"
+#include <memory>
 #include <vector>
 
 namespace manip_core
@@ -14,11 +14,16 @@ namespace manip_core
 	struct RobotI;
 }
 
+class DrawBatch;
+
+/* Effectors of the samples are retained in a batch when visited, one instance per effector.
+The colours are only computed again when the manipulability display changes.
+Arms are drawn with drawstuff as ellipsoids, from the joint positions kept at the visit.
+Far from the eye a coarse batch is drawn instead, with a square per effector and no arm.*/
 class DrawSamples : public manip_core::SampleVisitorI {
 
-	typedef std::pair<NUMBER,DrawTree> P_Tree;
-	typedef std::vector<P_Tree> T_DrawTree;
 	typedef std::vector<manip_core::TreeI*> T_Tree;
+	typedef std::vector<matrices::Vector3, Eigen::aligned_allocator<matrices::Vector3> > T_Points;
 
 public:
 	 DrawSamples(const manip_core::RobotI* /*robot*/, const manip_core::TreeI* /*tree*/, int /*id*/, bool collide = false);
@@ -26,16 +31,35 @@ public:
 
 public:
 	virtual void Visit(const manip_core::RobotI* /*robot*/, manip_core::TreeI* /*tree*/);
+	virtual void VisitWithJacobianProduct(const manip_core::RobotI* /*robot*/, manip_core::TreeI* /*tree*/, const double* /*jacobianProduct*/);
 
 public:
 	void Draw(const matrices::Matrix4& /*currentTransform*/, bool transparency = true)const;
 
+private:
+	void Add(const manip_core::RobotI* /*robot*/, manip_core::TreeI* /*tree*/, NUMBER /*manip*/);
+	void UpdateColors()const;
+	void DrawArms(const matrices::Matrix4& /*currentTransform*/, bool /*transparency*/)const;
+
+private:
+	DrawSamples(const DrawSamples&);
+	DrawSamples& operator=(const DrawSamples&);
 
 private:
-	T_DrawTree drawTrees_;
+	std::auto_ptr<DrawBatch> batch_;
+	std::auto_ptr<DrawBatch> coarse_; // same instances as batch_
+	matrices::Vector3 min_; // bounds in the frame of the robot
+	matrices::Vector3 max_;
 	T_Tree trees_;
+	std::vector<NUMBER> manips_;
+	std::vector<int> instances_; // in the batch, -1 without effector
+	T_Points joints_; // of all the samples, in the frame of the robot
+	std::vector<int> firstJoint_; // of each sample in joints_
+	std::vector<bool> jointSpheres_; // unlocked joints with a son
 	NUMBER maxManip_;
 	const int id_;
-}; // class DrawTree
+	mutable int colorMode_; // of the current colours, -1 before the first draw
+	mutable NUMBER colorMax_;
+}; // class DrawSamples
 
-#endif //_CLASS_DRAWSAMPLES
\ No newline at end of file
+#endif //_CLASS_DRAWSAMPLES
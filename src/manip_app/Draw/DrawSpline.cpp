@@ -5,10 +5,15 @@ using namespace matrices;
 
 DrawSpline::DrawSpline(const spline::curve_abc<>& spline)
 {
-	matrices::Vector3 val;
+	std::vector<NUMBER> times;
 	for(NUMBER t = 0; t < spline.max(); t = t +0.01)
 	{
-		points_.push_back(spline(t));
+		times.push_back(t);
+	}
+	points_.resize(times.size());
+	if(!times.empty())
+	{
+		spline.evaluate(&times[0], times.size(), &points_[0]);
 	}
 }
 
@@ -10,6 +10,8 @@
 
 #include <drawstuff/drawstuff.h> // The drawing library for ODE;
 
+#include <algorithm>
+
 using namespace matrices;
 using namespace manip_core;
 
@@ -18,6 +20,31 @@ namespace matrices
 	const Vector3 unitz(0,0,1);
 }
 
+namespace
+{
+	Matrix4 JointTransform(const JointI* joint)
+	{
+		double vect[3];
+		joint->Offset(vect);
+		Vector3 offset;
+		matrices::arrayToVect3(vect,offset);
+		Matrix4 jointTransform = Translate(offset); // translation of current joint
+		switch(joint->GetRotation())
+		{
+			case enums::rotation::X:
+				jointTransform = jointTransform + Rotx4(joint->GetAngle());
+				break;
+			case enums::rotation::Y:
+				jointTransform = jointTransform + Roty4(joint->GetAngle());
+				break;
+			case enums::rotation::Z:
+				jointTransform = jointTransform + Rotz4(joint->GetAngle());
+				break;
+		}
+		return jointTransform;
+	}
+}
+
 DrawTree::DrawTree(const TreeI* tree, const float width, const float effectorWidth, const int id)
 	: tree_(tree)
 	, hasAttach_(false)
@@ -157,6 +184,46 @@ void DrawTree::DrawNoTexture(const matrices::Matrix4& currentTransform) const
 }
 
 
+void DrawTree::DrawLines(const matrices::Matrix4& currentTransform) const
+{
+	matrices::Matrix4 m = currentTransform;
+	float from[3], to[3];
+	dsSetColorAlpha(1.0,1.0,1.0, 0.3);
+	if(hasAttach_)
+	{
+		matrices::vect3ToArray(from, matrices::matrix4TimesVect3(currentTransform, attach_));
+		matrices::vect3ToArray(to, matrices::matrix4TimesVect3(currentTransform, rootPos_));
+		dsDrawLine(from, to);
+	}
+	const JointI* joint = this->tree_->GetRootJointI();
+	while(joint)
+	{
+		vect4ToArray(from, m.col(3));
+		m = m * JointTransform(joint);
+		if(joint->GetParent())
+		{
+			vect4ToArray(to, m.col(3));
+			dsDrawLine(from, to);
+		}
+		joint = (joint->IsEffector() ? 0 : joint->GetSon());
+	}
+	dsSetColor(1.0,1.0,1.0);
+}
+
+NUMBER DrawTree::GetReach() const
+{
+	NUMBER reach = 0;
+	const JointI* joint = this->tree_->GetRootJointI();
+	while(joint)
+	{
+		double vect[3];
+		joint->Offset(vect);
+		reach += sqrt(vect[0] * vect[0] + vect[1] * vect[1] + vect[2] * vect[2]);
+		joint = (joint->IsEffector() ? 0 : joint->GetSon());
+	}
+	return hasAttach_ ? std::max(reach, (NUMBER)attach_.norm()) : reach;
+}
+
 //void DrawTree::Draw(const matrices::Matrix4& currentTransform) const
 //{
 //	matrices::Matrix4 m = currentTransform;
@@ -194,20 +261,7 @@ void DrawTree::DrawJoint(matrices::Matrix4& currentTransform, const JointI* join
 	joint->Offset(vect);
 	Vector3 offset;
 	matrices::arrayToVect3(vect,offset);
-	Matrix4 jointTransform = Translate(offset); // translation of current joint
-	switch(joint->GetRotation())
-	{
-		case rotation::X:
-			jointTransform = jointTransform + Rotx4(joint->GetAngle());
-			break;
-		case rotation::Y:
-			jointTransform = jointTransform + Roty4(joint->GetAngle());
-			break;
-		case rotation::Z:
-			jointTransform = jointTransform + Rotz4(joint->GetAngle());
-			break;
-	}
-	currentTransform = currentTransform * jointTransform;
+	currentTransform = currentTransform * JointTransform(joint);
 	float R[12];
 	matrixToArray(R, currentTransform);
 	float ps[3];
@@ -21,6 +21,8 @@ public:
 public:
 	void Draw(const matrices::Matrix4& /*currentTransform*/, bool transparency = false, bool wire = false, double color = -1)const;
 	void DrawNoTexture(const matrices::Matrix4& /*currentTransform*/)const;
+	void DrawLines(const matrices::Matrix4& /*currentTransform*/)const; // segments between the joints, for far away trees
+	NUMBER GetReach()const; // bound of the distance of the joints to the origin of the robot
 
 private:
 	void DrawJoint(matrices::Matrix4& /*currentTransform*/, const manip_core::JointI* /*joint*/, bool wire = false, double color = -1)const;
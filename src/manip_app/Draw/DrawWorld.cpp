@@ -1,6 +1,8 @@
 
 #include "DrawWorld.h"
 #include "DrawObstacle.h"
+#include "DrawFrustum.h"
+#include "DrawObstacleHierarchy.h"
 
 #include "world/World.h"
 #include "MatrixDefs.h"
@@ -26,12 +28,9 @@ struct PImpl
 		//NOTHING
 	}
 
-	typedef vector<DrawObstacle> T_Obstacle;
-	typedef T_Obstacle::iterator T_ObstacleIT;
-	typedef T_Obstacle::const_iterator T_ObstacleCIT;
-	T_Obstacle drawObstacles_;
-	T_Obstacle drawWalls_;
-    T_Obstacle drawGround_;
+	DrawObstacleHierarchy drawObstacles_;
+	DrawObstacleHierarchy drawWalls_;
+	DrawObstacleHierarchy drawGround_;
 };
 
 
@@ -51,40 +50,24 @@ DrawWorld::~DrawWorld()
 void DrawWorld::Draw() const
 {
 	dsSetTexture(0);
-	if (pImpl_->drawGround_.size() > 0){
-		for(PImpl::T_ObstacleCIT it = pImpl_->drawGround_.begin(); it!= pImpl_->drawGround_.end(); ++it)
-		{
-			it->Draw();
-		}
-	}
-	
-	if (pImpl_->drawWalls_.size() > 0){
-		for (PImpl::T_ObstacleCIT it = pImpl_->drawWalls_.begin(); it != pImpl_->drawWalls_.end(); ++it)
-		{
-			it->Draw();
-		}
-	}
-	
-	for(PImpl::T_ObstacleCIT it = pImpl_->drawObstacles_.begin(); it!= pImpl_->drawObstacles_.end(); ++it)
-	{
-		it->Draw();
-		//it->DrawWithTexture();
-	}
+	DrawFrustum frustum;
+	pImpl_->drawGround_.Draw(frustum);
+	pImpl_->drawWalls_.Draw(frustum);
+	pImpl_->drawObstacles_.Draw(frustum);
 	//dsSetTexture(0);
 }
 
 void DrawWorld::OnObstacleCreated(const matrices::Vector3& p1, const matrices::Vector3& p2, const matrices::Vector3& p3, const matrices::Vector3& p4, float* color, const float transparency, const int texture)
 {
-	pImpl_->drawObstacles_.push_back(DrawObstacle(p1, p2, p3, p4, color, transparency, texture));
+	pImpl_->drawObstacles_.Add(DrawObstacle(p1, p2, p3, p4, color, transparency, texture));
 }
 
 void DrawWorld::OnWallCreated(const matrices::Vector3& p1, const matrices::Vector3& p2, const matrices::Vector3& p3, const matrices::Vector3& p4, float* color, const float transparency, const int texture)
 {
-	pImpl_->drawWalls_.push_back(DrawObstacle(p1, p2, p3, p4, color, transparency, texture));
+	pImpl_->drawWalls_.Add(DrawObstacle(p1, p2, p3, p4, color, transparency, texture));
 }
 
 void DrawWorld::OnGroundCreated(const matrices::Vector3& p1, const matrices::Vector3& p2, const matrices::Vector3& p3, const matrices::Vector3& p4, float* color, const float transparency, const int texture)
 {
-	pImpl_->drawGround_.push_back(DrawObstacle(p1, p2, p3, p4, color, transparency, texture));
+	pImpl_->drawGround_.Add(DrawObstacle(p1, p2, p3, p4, color, transparency, texture));
 }
-
@@ -0,0 +1,83 @@
+
+#include "HeadlessRecorder.h"
+
+#include "API/RobotI.h"
+#include "API/TreeI.h"
+#include "API/JointI.h"
+
+#include <iomanip>
+
+using namespace manip_core;
+
+HeadlessRecorder::HeadlessRecorder(const std::string& filename, unsigned int splineSamples)
+	: file_(filename.c_str())
+	, splineSamples_(splineSamples < 2 ? 2 : splineSamples)
+	, nbPostures_(0)
+	, nbSplines_(0)
+{
+	file_ << std::setprecision(6);
+}
+
+HeadlessRecorder::~HeadlessRecorder()
+{
+	// NOTHING
+}
+
+bool HeadlessRecorder::IsOpen() const
+{
+	return file_.is_open();
+}
+
+void HeadlessRecorder::RecordFrame(const Timer::t_time time, const RobotI& robot)
+{
+	file_ << "frame " << time;
+	WriteRobot(robot);
+}
+
+void HeadlessRecorder::OnPostureCreated(double time, const RobotI* pRobot)
+{
+	// the planner recycles its postures, they are written right away
+	++nbPostures_;
+	file_ << "posture " << time;
+	WriteRobot(*pRobot);
+}
+
+void HeadlessRecorder::OnSplineCreated(const Timer::t_time time, int treeId, const spline::curve_abc<>& spline)
+{
+	++nbSplines_;
+	file_ << "spline " << time << " " << treeId << " " << splineSamples_;
+	double step = (spline.max() - spline.min()) / (splineSamples_ - 1);
+	for(unsigned int i = 0; i < splineSamples_; ++i)
+	{
+		spline::curve_abc<>::point_t p = spline(spline.min() + step * i);
+		file_ << " " << p(0) << " " << p(1) << " " << p(2);
+	}
+	file_ << "\n";
+}
+
+void HeadlessRecorder::WriteRobot(const RobotI& robot)
+{
+	double transform[16];
+	robot.ToWorldCoordinates(transform);
+	for(int i = 0; i < 16; ++i)
+	{
+		file_ << " " << transform[i];
+	}
+	for(unsigned int i = 0; i < robot.GetNumTrees(); ++i)
+	{
+		const TreeI* tree = robot.GetTreeI(i);
+		double target[3];
+		tree->GetTarget(target);
+		angles_.clear();
+		for(const JointI* joint = tree->GetRootJointI(); joint; joint = joint->GetSon())
+		{
+			angles_.push_back(joint->GetAngle());
+		}
+		file_ << " " << i << " " << tree->IsAnchored() << " " << target[0] << " " << target[1] << " " << target[2] << " " << angles_.size();
+		for(std::vector<double>::const_iterator it = angles_.begin(); it != angles_.end(); ++it)
+		{
+			file_ << " " << *it;
+		}
+	}
+	file_ << "\n";
+}
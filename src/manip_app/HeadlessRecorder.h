@@ -0,0 +1,54 @@
+
+#ifndef _CLASS_HEADLESSRECORDER
+#define _CLASS_HEADLESSRECORDER
+
+#include "API/PostureManagerI.h"
+#include "MotionHandler.h"
+#include "Timer.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace manip_core
+{
+	struct RobotI;
+}
+
+/* Writes the motion computed without display to a text file, one record per line :
+posture <time> <transform>, frame <time> <transform> followed by the trees of the robot,
+and spline <time> <tree id> <nbSamples> followed by the sampled positions.
+Transforms are 16 values in column-major order, each tree is written as
+<id> <anchored> <target> <nbJoints> <angles>.*/
+class HeadlessRecorder : public manip_core::PostureCreatedListenerI, public SplineCreatedListener_ABC
+{
+public:
+	explicit HeadlessRecorder(const std::string& /*filename*/, unsigned int splineSamples = 10);
+	~HeadlessRecorder();
+
+private:
+	HeadlessRecorder(const HeadlessRecorder&);
+	HeadlessRecorder& operator=(const HeadlessRecorder&);
+
+public:
+	bool IsOpen() const;
+	void RecordFrame(const Timer::t_time /*time*/, const manip_core::RobotI& /*robot*/);
+
+	virtual void OnPostureCreated(double /*time*/, const manip_core::RobotI* /*pRobot*/);
+	virtual void OnSplineCreated(const Timer::t_time /*time*/, int /*treeId*/, const spline::curve_abc<>& /*spline*/);
+
+	unsigned int GetNumPostures() const { return nbPostures_; }
+	unsigned int GetNumSplines () const { return nbSplines_; }
+
+private:
+	void WriteRobot(const manip_core::RobotI& /*robot*/);
+
+private:
+	std::ofstream file_;
+	const unsigned int splineSamples_;
+	unsigned int nbPostures_;
+	unsigned int nbSplines_;
+	std::vector<double> angles_;
+};
+
+#endif //_CLASS_HEADLESSRECORDER
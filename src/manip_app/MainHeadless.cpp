@@ -0,0 +1,99 @@
+
+#include "MatrixDefs.h"
+#include "Pi.h"
+
+#include "Simulation.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace matrices
+{
+	const Vector3 unitx = Vector3(1, 0, 0);
+	const Vector3 unity = Vector3(0, 1, 0);
+	const Vector3 unitz = Vector3(0, 0, 1);
+	const Vector3 zero  = Vector3(0, 0, 0);
+}
+
+using namespace matrices;
+using namespace std;
+
+/* Batch runner : loads a world, computes the motion for a fixed duration without opening a window
+and writes it to a file.
+usage : manip_headless world.xml|world.bin [--step ms] [--duration s] [--out file] [--move x y z] [--record file] [--postures file] [--footsteps n] [--root n]*/
+int main(int argc, char *argv[])
+{
+	if(argc < 2)
+	{
+		cerr << "usage : " << argv[0] << " world.xml|world.bin [--step ms] [--duration s] [--out file] [--move x y z] [--record file] [--postures file] [--footsteps n] [--root n]" << endl;
+		return 1;
+	}
+	Timer::t_time step = 40;
+	Timer::t_time duration = 10000;
+	std::string output("motion.txt");
+	std::string record;
+	std::string postures;
+	Vector3 move(0, 0, 0);
+	int footsteps = -1; // the horizon of the world file is kept if not given
+	int rootIterations = -1; // same for the root optimization
+	for(int i = 2; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "--step") && i + 1 < argc)
+		{
+			step = atof(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--duration") && i + 1 < argc)
+		{
+			duration = atof(argv[++i]) * 1000;
+		}
+		else if(!strcmp(argv[i], "--out") && i + 1 < argc)
+		{
+			output = argv[++i];
+		}
+		else if(!strcmp(argv[i], "--record") && i + 1 < argc)
+		{
+			record = argv[++i];
+		}
+		else if(!strcmp(argv[i], "--postures") && i + 1 < argc)
+		{
+			postures = argv[++i];
+		}
+		else if(!strcmp(argv[i], "--footsteps") && i + 1 < argc)
+		{
+			footsteps = atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--root") && i + 1 < argc)
+		{
+			rootIterations = atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--move") && i + 3 < argc)
+		{
+			move = Vector3(atof(argv[i + 1]), atof(argv[i + 2]), atof(argv[i + 3]));
+			i += 3;
+		}
+		else
+		{
+			cerr << "unknown option " << argv[i] << endl;
+			return 1;
+		}
+	}
+	Simulation* sim = Simulation::GetInstance();
+	sim->simpParams_.jumpToTarget_ = false;
+	if(!sim->Init(2, argv))
+	{
+		return 1;
+	}
+	if(footsteps >= 0)
+	{
+		sim->simpParams_.footstepHorizon_ = (unsigned int)footsteps;
+		sim->postureManager_->SetFootstepPlanning(sim->simpParams_.footstepHorizon_);
+	}
+	if(rootIterations >= 0)
+	{
+		sim->simpParams_.rootIterations_ = (unsigned int)rootIterations;
+		sim->postureManager_->SetRootOptimization(sim->simpParams_.rootIterations_);
+	}
+	return sim->RunHeadless(step, duration, output, move, record, postures) ? 0 : 1;
+}
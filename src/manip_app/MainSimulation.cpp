@@ -146,6 +146,7 @@ int main(int argc, char *argv[])
 	sim = Simulation::GetInstance();
 	sim->simpParams_.command = &command;
 	sim->simpParams_.jumpToTarget_ = false;
+	sim->simpParams_.plannerThread_ = true;
 	sim->Start(argc, argv);
 	
     return 0;
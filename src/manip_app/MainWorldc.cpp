@@ -0,0 +1,38 @@
+#include "WorldParser/WorldParserXml.h"
+#include "WorldParser/WorldParserBinary.h"
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+/* Converts an xml world into the binary format, which manip_app and manip_headless load without xerces.
+usage : manip_worldc world.xml world.bin*/
+int main(int argc, char *argv[])
+{
+	if(argc != 3)
+	{
+		cerr << "usage : " << argv[0] << " world.xml world.bin" << endl;
+		return 1;
+	}
+	WorldDescription description;
+	try
+	{
+		WorldParserXml().Read(argv[1], description);
+	}
+	catch(const std::exception& e)
+	{
+		cerr << "unable to read " << argv[1] << " : " << e.what() << endl;
+		return 1;
+	}
+	WorldParserBinary binary;
+	WorldDescription check;
+	if(!binary.Write(argv[2], description) || !binary.Read(argv[2], check))
+	{
+		cerr << "unable to write " << argv[2] << endl;
+		return 1;
+	}
+	cout << argv[2] << " : " << description.elements_.size() << " obstacles, " << description.waypoints_.size() << " waypoints" << endl;
+	return 0;
+}
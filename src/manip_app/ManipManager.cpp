@@ -103,149 +103,40 @@ void ManipManager::Initialize(bool collision)
 {
 	pWorldManager_->Initialize(collision);
 }
-	
+
 void ManipManager::GenerateChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER height, const unsigned int depth)
 {
-	// stop condition, depth = 0, flat rectangle
-	if(0 == depth)
-	{
-		Vector3 nUL (upLeft.x(), upLeft.y(), height);
-		Vector3 nBR (bottomRight.x(), bottomRight.y(), height);
-		Vector3 upRight(bottomRight.x(), upLeft.y(), height);
-		Vector3 downLeft(upLeft.x(), bottomRight.y(), height);
-		AddObstacle(nUL, upRight, nBR, downLeft);
-	}
-	else
-	{
-		Vector3 dx((bottomRight.x() - upLeft.x()) / 2., 0, 0);
-		Vector3 dy(0, (upLeft.y() - bottomRight.y()) / 2., 0);
-		//NUMBER dHeight = (1 == depth) ? 0.3 : 0.;
-		unsigned int newDepth = depth - 1;
-		GenerateChess(upLeft, upLeft + dx - dy, height, newDepth);
-		if(depth != 1)
-		{
-			GenerateChess(upLeft + dx, bottomRight + dy, height, newDepth);
-			GenerateChess(upLeft - dy, bottomRight - dx, height, newDepth);
-		}
-		GenerateChess(upLeft + dx - dy, bottomRight, height, newDepth);
-	}
+	ObstacleGenerator(*this).GenerateChess(upLeft, bottomRight, height, depth);
 }
 
 void ManipManager::GenerateUnevenChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER height, const unsigned int depth)
 {
-	// stop condition, depth = 0, flat rectangle
-	if(0 == depth)
-	{
-		Vector3 nUL (upLeft.x(), upLeft.y(), height);
-		Vector3 nBR (bottomRight.x(), bottomRight.y(), height);
-		Vector3 upRight(bottomRight.x(), upLeft.y(), height);
-		Vector3 downLeft(upLeft.x(), bottomRight.y(), height);
-		AddObstacle(nUL, upRight, nBR, downLeft);
-	}
-	else
-	{
-		Vector3 dx((bottomRight.x() - upLeft.x()) / 2., 0, 0);
-		Vector3 dy(0, (upLeft.y() - bottomRight.y()) / 2., 0);
-		//NUMBER dHeight = (1 == depth) ? 0.3 : 0.;
-		unsigned int newDepth = depth - 1;
-		GenerateUnevenChess(upLeft, upLeft + dx - dy, height, newDepth);
-		if(depth != 1)
-		{
-			GenerateUnevenChess(upLeft + dx, bottomRight + dy, height +0.2, newDepth);
-			GenerateUnevenChess(upLeft - dy, bottomRight - dx, height -0.2, newDepth);
-		}
-		GenerateUnevenChess(upLeft + dx - dy, bottomRight, height, newDepth);
-	}
+	ObstacleGenerator(*this).GenerateUnevenChess(upLeft, bottomRight, height, depth);
 }
 
-	
 void ManipManager::GenerateVerticalChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, const unsigned int depth)
 {
-	// stop condition, depth = 0, flat rectangle
-	if(0 == depth)
-	{
-		Vector3 upRight(bottomRight.x(), bottomRight.y(), upLeft.z());
-		Vector3 downLeft(upLeft.x(), upLeft.y(), bottomRight.z());
-		AddObstacle(upLeft, upRight, bottomRight, downLeft);
-	}
-	else
-	{
-		Vector3 dz(0, 0, (upLeft.z() - bottomRight.z()) / 2.);
-		Vector3 dy(0, (upLeft.y() - bottomRight.y()) / 2., 0);
-		//NUMBER dHeight = (1 == depth) ? 0.3 : 0.;
-		unsigned int newDepth = depth - 1;
-		GenerateVerticalChess(upLeft, upLeft - dy - dz, newDepth);
-		if(depth != 1)
-		{
-			GenerateVerticalChess(upLeft - dy, bottomRight + dz, newDepth);
-			GenerateVerticalChess(upLeft - dz, bottomRight + dy, newDepth);
-		}
-		GenerateVerticalChess(upLeft - dy - dz, bottomRight, newDepth);
-	}
+	ObstacleGenerator(*this).GenerateVerticalChess(upLeft, bottomRight, depth);
 }
 
 void ManipManager::GenerateXInclinedPlank(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight)
 {
-		Vector3 upRight(bottomRight.x(), upLeft.y(), upLeft.z());
-		Vector3 downLeft(upLeft.x(), bottomRight.y(), bottomRight.z());
-		AddObstacle(upLeft, upRight, bottomRight, downLeft);
+	ObstacleGenerator(*this).GenerateXInclinedPlank(upLeft, bottomRight);
 }
 
 void ManipManager::GenerateYInclinedPlank(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight)
 {
-		Vector3 upRight(bottomRight.x(), upLeft.y(), bottomRight.z());
-		Vector3 downLeft(upLeft.x(), bottomRight.y(), upLeft.z());
-		AddObstacle(upLeft, upRight, bottomRight, downLeft);
+	ObstacleGenerator(*this).GenerateYInclinedPlank(upLeft, bottomRight);
 }
 
 void ManipManager::GenerateStair(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER heightInit, NUMBER heightFinal, const unsigned int depth)
 {
-	NUMBER xLength = bottomRight.x() - upLeft.x();
-	NUMBER yLength = upLeft.y() - bottomRight.y();
-	bool xIsLonger = xLength > yLength;
-	NUMBER deltaHeight = (heightFinal - heightInit) / ((NUMBER) depth);
-	NUMBER deltaCaseWidth = xIsLonger ? (xLength / ((NUMBER) depth)) : (yLength / ((NUMBER) depth));
-	// stop condition, depth = 0, flat rectangle
-	for(unsigned int i = 0; i < depth; ++i)
-	{
-		if(xIsLonger)
-		{
-			Vector3 uL(upLeft.x() + deltaCaseWidth * i, upLeft.y(), heightInit + i * deltaHeight);
-			Vector3 bR(upLeft.x() + deltaCaseWidth * (i+1), bottomRight.y(), heightInit + i * deltaHeight);
-			GenerateXInclinedPlank(uL, bR);
-		}
-		else
-		{
-			Vector3 uL(upLeft.x()     , bottomRight.y() + deltaCaseWidth * (i + 1), heightInit + i * deltaHeight);
-			Vector3 bR(bottomRight.x(), bottomRight.y() + deltaCaseWidth * i      , heightInit + i * deltaHeight);
-			GenerateXInclinedPlank(uL, bR);
-		}
-	}
+	ObstacleGenerator(*this).GenerateStair(upLeft, bottomRight, heightInit, heightFinal, depth);
 }
 
 void ManipManager::GenerateStairChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER heightInit, NUMBER heightFinal, const unsigned int depth, const unsigned int chessdepth)
 {
-	NUMBER xLength = bottomRight.x() - upLeft.x();
-	NUMBER yLength = upLeft.y() - bottomRight.y();
-	bool xIsLonger = xLength > yLength;
-	NUMBER deltaHeight = (heightFinal - heightInit) / ((NUMBER) depth);
-	NUMBER deltaCaseWidth = xIsLonger ? (xLength / ((NUMBER) depth)) : (yLength / ((NUMBER) depth));
-	// stop condition, depth = 0, flat rectangle
-	for(unsigned int i = 0; i < depth; ++i)
-	{
-		if(xIsLonger)
-		{
-			Vector3 uL(upLeft.x() + deltaCaseWidth * i, upLeft.y(), 0);
-			Vector3 bR(upLeft.x() + deltaCaseWidth * (i+1), bottomRight.y(), 0);
-			GenerateChess(uL, bR, heightInit + i * deltaHeight, chessdepth);
-		}
-		else
-		{
-			Vector3 uL(upLeft.x()     , bottomRight.y() + deltaCaseWidth * (i + 1), 0);
-			Vector3 bR(bottomRight.x(), bottomRight.y() + deltaCaseWidth * i      , 0);
-			GenerateChess(uL, bR, heightInit + i * deltaHeight, chessdepth);
-		}
-	}
+	ObstacleGenerator(*this).GenerateStairChess(upLeft, bottomRight, heightInit, heightFinal, depth, chessdepth);
 }
 
 void ManipManager::RegisterObstacleCreatedListenerI(manip_core::ObstacleVisitor_ABC* listener)
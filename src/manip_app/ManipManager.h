@@ -8,6 +8,7 @@
 
 #include "API/WorldManagerI.h"
 #include "IKSolver/IKSolver.h"
+#include "world/ObstacleGenerator.h"
 
 namespace manip_core
 {
@@ -15,8 +16,6 @@ struct RobotI;
 
 class PostureManager;
 
-class ObstacleGenerator;
-
 struct ObstacleVisitor_ABC
 {
 public:
@@ -27,7 +26,7 @@ public:
 	virtual void OnGroundCreated(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*upRight*/, const matrices::Vector3& /*downRight*/, const matrices::Vector3& /*downLeft*/, float* color, const float transparenc, const int texture) = 0;	
 };
 
-class ManipManager
+class ManipManager : private ObstacleGenerator::Receiver_ABC
 {
 public:
 	 ManipManager();
@@ -36,7 +35,7 @@ public:
 public:
 	/**	Creates a planar obstacle. Points must be indicated clockwise from upLeft and be in a plan.
 	 */
-	void AddObstacle(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*upRight*/, const matrices::Vector3& /*downRight*/, const matrices::Vector3& /*downLeft*/);
+	virtual void AddObstacle(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*upRight*/, const matrices::Vector3& /*downRight*/, const matrices::Vector3& /*downLeft*/);
 	
 	void SetNextColor(const float r, const float g, const float b);
 	void SetNextTransparency(const float t){transparency_ = t;}
@@ -0,0 +1,127 @@
+
+#ifndef _CLASS_MOTIONFORMAT
+#define _CLASS_MOTIONFORMAT
+
+#include <string>
+
+/* Layout shared by MotionRecorder and MotionReader, in the byte order of the machine.
+header : magic, version, robot type, number of trees, number of joints of each tree, quantization steps (3 doubles)
+then chunks : number of frames, payload size in bytes, payload.
+A frame is a row of quantized values : time (microseconds), rotation (9), translation (3), anchored trees (bit mask),
+then the joint angles and the target of each tree. The first frame of a chunk is stored as is, the others as the
+difference with a linear prediction from the two previous frames. These residuals are written as varints,
+runs of zeros being merged.*/
+namespace motion_format
+{
+	typedef long long t_value;
+
+	const char magic[4] = {'M', 'M', 'O', 'T'};
+	const unsigned int version = 1;
+
+	const double angleStep    = 1e-4; // radians
+	const double positionStep = 1e-5; // meters, translation and targets
+	const double rotationStep = 1e-5;
+
+	const unsigned int rotationIndexes[9] = {0, 1, 2, 4, 5, 6, 8, 9, 10}; // in a column-major 4x4
+	const unsigned int translationIndexes[3] = {12, 13, 14};
+	const unsigned int maskValue = 13; // index of the anchored mask in a frame, 1 + 9 + 3
+	const unsigned int maxTrees = 32;
+
+	inline t_value Quantize(const double value, const double step)
+	{
+		double res = value / step;
+		return (t_value)(res < 0 ? res - 0.5 : res + 0.5);
+	}
+
+	// 0 for the first frame of a chunk
+	inline t_value Predict(const unsigned int frame, const unsigned int value, const t_value previous, const t_value beforePrevious)
+	{
+		if(frame == 0)
+		{
+			return 0;
+		}
+		return (frame == 1 || value == maskValue) ? previous : 2 * previous - beforePrevious;
+	}
+
+	inline void PutVarint(std::string& buffer, unsigned long long value)
+	{
+		while(value >= 0x80)
+		{
+			buffer.push_back((char)((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back((char)value);
+	}
+
+	// false if the varint does not end before end
+	inline bool GetVarint(const char*& cursor, const char* end, unsigned long long& value)
+	{
+		value = 0;
+		for(unsigned int shift = 0; cursor < end && shift < 64; shift += 7)
+		{
+			unsigned char byte = (unsigned char)*cursor++;
+			value |= (unsigned long long)(byte & 0x7f) << shift;
+			if(!(byte & 0x80))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// a residual is written as its zigzag code shifted by one, a run of zeros as (length - 1) shifted by one plus one
+	inline void PutResiduals(std::string& buffer, const t_value* residuals, const unsigned int size)
+	{
+		for(unsigned int i = 0; i < size;)
+		{
+			unsigned int run = 0;
+			while(i + run < size && residuals[i + run] == 0)
+			{
+				++run;
+			}
+			if(run > 0)
+			{
+				PutVarint(buffer, ((unsigned long long)(run - 1) << 1) | 1);
+				i += run;
+			}
+			else
+			{
+				unsigned long long zigzag = ((unsigned long long)residuals[i] << 1) ^ (unsigned long long)(residuals[i] >> 63);
+				PutVarint(buffer, zigzag << 1);
+				++i;
+			}
+		}
+	}
+
+	inline bool GetResiduals(const char*& cursor, const char* end, t_value* residuals, const unsigned int size)
+	{
+		for(unsigned int i = 0; i < size;)
+		{
+			unsigned long long token = 0;
+			if(!GetVarint(cursor, end, token))
+			{
+				return false;
+			}
+			if(token & 1)
+			{
+				unsigned long long run = (token >> 1) + 1;
+				if(run > size - i)
+				{
+					return false;
+				}
+				for(; run > 0; --run)
+				{
+					residuals[i++] = 0;
+				}
+			}
+			else
+			{
+				unsigned long long zigzag = token >> 1;
+				residuals[i++] = (t_value)(zigzag >> 1) ^ -(t_value)(zigzag & 1);
+			}
+		}
+		return true;
+	}
+}
+
+#endif //_CLASS_MOTIONFORMAT
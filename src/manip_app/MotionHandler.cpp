@@ -3,7 +3,9 @@
 
 #include "IKSolver/IKSolver.h"
 
+#ifndef MANIP_HEADLESS
 #include "Draw/DrawSpline.h"
+#endif
 
 #include "API/TreeI.h"
 #include "API/RobotI.h"
@@ -104,7 +106,9 @@ MotionHandler::MotionHandler(manip_core::ManipManager& manager, const float rota
 	, translationSpeed_(translationSpeed)
 	, solver_(manager.GetIkSolver())
 	, postureManager_(manager.GetPostureManager())
+	, planner_(0)
 	, previousDirection_(1,0,0)
+	, splineListener_(0)
 {
 
 }
@@ -135,7 +139,19 @@ void MotionHandler::Update(const Timer::t_time t, const Timer::t_time dt)
 	}
 
 	//now let's get more serious
-	if(findPosture)
+	if(planner_ && planner_->IsRunning())
+	{
+		if(findPosture)
+		{
+			planner_->Plan(*robot, previousDirection_);
+		}
+		manip_core::T_CubicTrajectory cubics;
+		while(planner_->Collect(*robot, cubics))
+		{
+			ReplaceSplines(t, cubics);
+		}
+	}
+	else if(findPosture)
 	{
 		manip_core::T_CubicTrajectory cubics;
 		/*if(sg->simpParams_.rotatewithsplinedir_)
@@ -147,17 +163,7 @@ void MotionHandler::Update(const Timer::t_time t, const Timer::t_time dt)
 		{*/
 			cubics = postureManager_->NextPosture(robot, previousDirection_);
 		//}
-		// replace previous splines
-		for(manip_core::IT_CubicTrajectory it = cubics.begin(); it!= cubics.end(); ++it)
-		{
-			IT_SplineManager it2 = splineManagers_.find(it->first);
-			if( it2 != splineManagers_.end())
-			{
-				delete(it2->second);
-				splineManagers_.erase(it2);
-			}
-			splineManagers_.insert(std::make_pair((it->first), new spline::SplineTimeManager(t, it->second)));
-		}
+		ReplaceSplines(t, cubics);
 	}
 	double targ[3];
 	if(! sg->simpParams_.jumpToTarget_)
@@ -192,11 +198,13 @@ void MotionHandler::Update(const Timer::t_time t, const Timer::t_time dt)
 					matrices::arrayToVect3(tar, target);
 					solver_.StepClamping(robot, robot->GetTreeI(i), target, previousDirection_);
 				}*/
+#ifndef MANIP_HEADLESS
 				if(sg->simpParams_.drawSplines_)
 				{
 					DrawSpline ds(itSpline->second->GetCubic());
 					ds.Draw();
 				}
+#endif
 			}
 			else
 			{
@@ -239,6 +247,78 @@ void MotionHandler::Update(const Timer::t_time t, const Timer::t_time dt)
 	}
 }
 
+// replace previous splines
+void MotionHandler::ReplaceSplines(const Timer::t_time t, manip_core::T_CubicTrajectory& cubics)
+{
+	TimerHandler& timerHandler = Simulation::GetInstance()->timerHandler_;
+	for(manip_core::IT_CubicTrajectory it = cubics.begin(); it!= cubics.end(); ++it)
+	{
+		IT_SplineManager it2 = splineManagers_.find(it->first);
+		if( it2 != splineManagers_.end())
+		{
+			ReleaseTrajectory(&it2->second->GetCubic());
+			delete(it2->second);
+			splineManagers_.erase(it2);
+		}
+		T_SplineEvent::iterator itEvent = splineEvents_.find(it->first);
+		if(itEvent != splineEvents_.end())
+		{
+			timerHandler.Cancel(itEvent->second);
+		}
+		spline::SplineTimeManager* manager = new spline::SplineTimeManager(t, it->second);
+		splineManagers_.insert(std::make_pair((it->first), manager));
+		splineEvents_[it->first] = timerHandler.Schedule(this, manager->GetEndTime() * 1000.);
+		if(splineListener_)
+		{
+			splineListener_->OnSplineCreated(t, it->first, *(it->second));
+		}
+	}
+}
+
+// trajectories go back through the planner while it runs
+void MotionHandler::ReleaseTrajectory(const spline::curve_abc<>* trajectory)
+{
+	if(planner_)
+	{
+		planner_->ReleaseTrajectory(trajectory);
+	}
+	else
+	{
+		postureManager_->ReleaseTrajectory(trajectory);
+	}
+}
+
+// end of a spline reached
+void MotionHandler::OnTimer(const Timer::t_time time, const unsigned long id)
+{
+	for(T_SplineEvent::iterator itEvent = splineEvents_.begin(); itEvent != splineEvents_.end(); ++itEvent)
+	{
+		if(itEvent->second != id)
+		{
+			continue;
+		}
+		const int treeId = itEvent->first;
+		splineEvents_.erase(itEvent);
+		IT_SplineManager itSpline = splineManagers_.find(treeId);
+		if(itSpline == splineManagers_.end())
+		{
+			return;
+		}
+		const spline::curve_abc<>& cubic = itSpline->second->GetCubic();
+		double targ[3];
+		matrices::vect3ToArray(targ, cubic(cubic.max()));
+		Simulation::GetInstance()->pRobot->GetTreeI(treeId)->SetTarget(targ);
+		ReleaseTrajectory(&cubic);
+		delete(itSpline->second);
+		splineManagers_.erase(itSpline);
+		if(splineListener_)
+		{
+			splineListener_->OnSplineCompleted(time / 1000., treeId);
+		}
+		return;
+	}
+}
+
 void MotionHandler::Reset()
 {
 	previousDirection_ = Simulation::GetInstance()->simpParams_.initDir_;
@@ -247,7 +327,28 @@ void MotionHandler::Reset()
 		delete actions_.front();
 		actions_.pop();
 	}
+	for(IT_SplineManager it = splineManagers_.begin(); it != splineManagers_.end(); ++it)
+	{
+		ReleaseTrajectory(&it->second->GetCubic());
+		delete(it->second);
+	}
 	splineManagers_.clear();
+	TimerHandler& timerHandler = Simulation::GetInstance()->timerHandler_;
+	for(T_SplineEvent::iterator it = splineEvents_.begin(); it != splineEvents_.end(); ++it)
+	{
+		timerHandler.Cancel(it->second);
+	}
+	splineEvents_.clear();
+}
+
+void MotionHandler::SetSplineListener(SplineCreatedListener_ABC* listener)
+{
+	splineListener_ = listener;
+}
+
+void MotionHandler::SetPlanner(PlannerThread* planner)
+{
+	planner_ = planner;
 }
 
 void MotionHandler::PushAction(MotionAction_ABC* action)
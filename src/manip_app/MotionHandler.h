@@ -7,6 +7,7 @@
 #include "IKSolver/IKSolver.h"
 #include "SplineTimeManager.h"
 #include "ManipManager.h"
+#include "PlannerThread.h"
 
 #include "API/TreeI.h"
 #include "API/RobotI.h"
@@ -29,7 +30,18 @@ public:
 	virtual void operator() (manip_core::RobotI& /*robot*/, const Timer::t_time /*dt*/) = 0;
 };
 
-class MotionHandler : public TimerHandled_ABC
+class SplineCreatedListener_ABC
+{
+public:
+	 SplineCreatedListener_ABC(){};
+	~SplineCreatedListener_ABC(){};
+
+	virtual void OnSplineCreated(const Timer::t_time /*time*/, int /*treeId*/, const spline::curve_abc<>& /*spline*/) = 0;
+	virtual void OnSplineCompleted(const Timer::t_time /*time*/, int /*treeId*/){};
+};
+
+// a spline is dropped by a timer event once its end is reached, its tree keeping the end as target
+class MotionHandler : public TimerHandled_ABC, public TimerEvent_ABC
 {
 public:
 	explicit MotionHandler(manip_core::ManipManager& manager, const float rotationSpeed = 1.f, const float translationSpeed = 1.f);
@@ -42,6 +54,7 @@ private:
 public:
 	virtual void Update(const Timer::t_time /*t*/, const Timer::t_time /*dt*/);
 	virtual void Reset();
+	virtual void OnTimer(const Timer::t_time /*time*/, const unsigned long /*id*/);
 
 public:
 	void PushAction(MotionAction_ABC* /*action*/); // done only at update
@@ -49,6 +62,8 @@ public:
 	void MoveBy(const matrices::Vector3& /*direction*/); // done only at update
 	void Rotate(const matrices::Matrix3& /*rotation*/); // done only at update
 	const matrices::Vector3& GetDirection() const{return previousDirection_;} // done only at update
+	void SetSplineListener(SplineCreatedListener_ABC* /*listener*/); // warned of each new limb trajectory, 0 to remove
+	void SetPlanner(PlannerThread* /*planner*/); // postures are computed on the planner while it runs, 0 to remove
 
 public:
 	const IKSolverApp& solver_;
@@ -59,13 +74,22 @@ public:
 	typedef T_SplineManager::iterator				IT_SplineManager;
 	typedef T_SplineManager::const_iterator			CIT_SplineManager;
 
+	typedef std::map<int, TimerWheel::t_id> T_SplineEvent; // end of the spline of each tree
+
 	typedef std::queue<MotionAction_ABC*> T_Action_;
 
+private:
+	void ReplaceSplines(const Timer::t_time /*t*/, manip_core::T_CubicTrajectory& /*cubics*/);
+	void ReleaseTrajectory(const spline::curve_abc<>* /*trajectory*/);
+
 private:
 	manip_core::PostureManager* postureManager_;
+	PlannerThread* planner_;
 	matrices::Vector3 previousDirection_;
 	T_SplineManager splineManagers_;
+	T_SplineEvent splineEvents_;
 	T_Action_ actions_;
+	SplineCreatedListener_ABC* splineListener_;
 };
 
 #endif //_CLASS_MOTIONHANDLER
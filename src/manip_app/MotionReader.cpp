@@ -0,0 +1,309 @@
+
+#include "MotionReader.h"
+#include "MotionFormat.h"
+
+#include "WorldParser/MappedFile.h"
+
+#include "API/RobotI.h"
+#include "API/TreeI.h"
+#include "API/JointI.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace manip_core;
+using namespace motion_format;
+
+namespace
+{
+	struct Chunk
+	{
+		const char* data_;
+		unsigned int size_;
+		unsigned int firstFrame_;
+		unsigned int nbFrames_;
+		t_value firstTime_;
+	};
+
+	template<typename T>
+	bool Read(const char*& cursor, const char* end, T& value)
+	{
+		if((std::size_t)(end - cursor) < sizeof(T))
+		{
+			return false;
+		}
+		memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+}
+
+struct MotionReaderPImpl
+{
+	explicit MotionReaderPImpl(const std::string& filename)
+		: file_(filename)
+		, open_(false)
+		, robotType_(0)
+		, nbValues_(0)
+		, nbFrames_(0)
+		, decoded_(-1)
+	{
+		open_ = file_.IsOpen() && Open();
+	}
+
+	bool Open();
+	bool Decode(const unsigned int /*chunk*/);
+	unsigned int FindChunk(const unsigned int /*frame*/) const;
+	const t_value* GetFrame(const unsigned int /*frame*/); // 0 if it cannot be decoded
+
+	MappedFile file_;
+	bool open_;
+	unsigned int robotType_;
+	std::vector<unsigned int> nbJoints_;
+	double steps_[3]; // angle, position, rotation
+	unsigned int nbValues_; // per frame
+	std::vector<Chunk> chunks_;
+	unsigned int nbFrames_;
+	int decoded_;
+	std::vector<t_value> values_; // frames of the decoded chunk
+	std::vector<double> angles_;
+};
+
+bool MotionReaderPImpl::Open()
+{
+	const char* cursor = file_.GetData();
+	const char* end = cursor + file_.GetSize();
+	unsigned int fileVersion = 0, nbTrees = 0;
+	if(file_.GetSize() < sizeof(magic) || memcmp(cursor, magic, sizeof(magic)) != 0)
+	{
+		return false;
+	}
+	cursor += sizeof(magic);
+	if(!Read(cursor, end, fileVersion) || fileVersion != version
+		|| !Read(cursor, end, robotType_) || !Read(cursor, end, nbTrees) || nbTrees == 0 || nbTrees > maxTrees)
+	{
+		return false;
+	}
+	nbValues_ = maskValue + 1;
+	nbJoints_.resize(nbTrees);
+	for(unsigned int i = 0; i < nbTrees; ++i)
+	{
+		if(!Read(cursor, end, nbJoints_[i]) || nbJoints_[i] > file_.GetSize())
+		{
+			return false;
+		}
+		nbValues_ += nbJoints_[i] + 3;
+	}
+	for(int i = 0; i < 3; ++i)
+	{
+		if(!Read(cursor, end, steps_[i]))
+		{
+			return false;
+		}
+	}
+	// chunk boundaries, a chunk cut by the end of the file is left out
+	unsigned int nbFrames = 0, size = 0;
+	std::vector<t_value> first(nbValues_);
+	while(Read(cursor, end, nbFrames) && Read(cursor, end, size) && size <= (std::size_t)(end - cursor) && nbFrames > 0)
+	{
+		Chunk chunk;
+		chunk.data_ = cursor;
+		chunk.size_ = size;
+		chunk.firstFrame_ = nbFrames_;
+		chunk.nbFrames_ = nbFrames;
+		// the first frame is stored as is, a run of zeros may go on past its time
+		const char* row = cursor;
+		if(!GetResiduals(row, cursor + size, &first[0], nbValues_))
+		{
+			break;
+		}
+		chunk.firstTime_ = first[0];
+		chunks_.push_back(chunk);
+		nbFrames_ += nbFrames;
+		cursor += size;
+	}
+	return true;
+}
+
+bool MotionReaderPImpl::Decode(const unsigned int index)
+{
+	if((int)index == decoded_)
+	{
+		return true;
+	}
+	decoded_ = -1;
+	const Chunk& chunk = chunks_[index];
+	const char* cursor = chunk.data_;
+	const char* end = chunk.data_ + chunk.size_;
+	values_.resize(chunk.nbFrames_ * nbValues_);
+	for(unsigned int f = 0; f < chunk.nbFrames_; ++f)
+	{
+		t_value* row = &values_[f * nbValues_];
+		if(!GetResiduals(cursor, end, row, nbValues_))
+		{
+			return false;
+		}
+		for(unsigned int v = 0; v < nbValues_; ++v)
+		{
+			row[v] += Predict(f, v, f > 0 ? (row - nbValues_)[v] : 0, f > 1 ? (row - 2 * nbValues_)[v] : 0);
+		}
+	}
+	decoded_ = (int)index;
+	return true;
+}
+
+unsigned int MotionReaderPImpl::FindChunk(const unsigned int frame) const
+{
+	unsigned int first = 0, last = (unsigned int)chunks_.size();
+	while(last - first > 1)
+	{
+		unsigned int middle = (first + last) / 2;
+		if(chunks_[middle].firstFrame_ <= frame)
+		{
+			first = middle;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	return first;
+}
+
+const t_value* MotionReaderPImpl::GetFrame(const unsigned int frame)
+{
+	if(!open_ || frame >= nbFrames_)
+	{
+		return 0;
+	}
+	unsigned int index = FindChunk(frame);
+	if(!Decode(index))
+	{
+		return 0;
+	}
+	return &values_[(frame - chunks_[index].firstFrame_) * nbValues_];
+}
+
+MotionReader::MotionReader(const std::string& filename)
+	: pImpl_(new MotionReaderPImpl(filename))
+{
+	// NOTHING
+}
+
+MotionReader::~MotionReader()
+{
+	// NOTHING
+}
+
+bool MotionReader::IsOpen() const
+{
+	return pImpl_->open_;
+}
+
+enums::robot::eRobots MotionReader::GetRobotType() const
+{
+	return (enums::robot::eRobots)pImpl_->robotType_;
+}
+
+unsigned int MotionReader::GetNumFrames() const
+{
+	return pImpl_->nbFrames_;
+}
+
+Timer::t_time MotionReader::GetTime(const unsigned int frame)
+{
+	const t_value* values = pImpl_->GetFrame(frame);
+	return values ? values[0] * 0.001 : 0;
+}
+
+unsigned int MotionReader::FindFrame(const Timer::t_time time)
+{
+	if(pImpl_->chunks_.empty())
+	{
+		return 0;
+	}
+	t_value t = Quantize(time, 0.001);
+	unsigned int first = 0, last = (unsigned int)pImpl_->chunks_.size();
+	while(last - first > 1)
+	{
+		unsigned int middle = (first + last) / 2;
+		if(pImpl_->chunks_[middle].firstTime_ <= t)
+		{
+			first = middle;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	const Chunk& chunk = pImpl_->chunks_[first];
+	unsigned int res = chunk.firstFrame_;
+	if(pImpl_->Decode(first))
+	{
+		for(unsigned int f = 1; f < chunk.nbFrames_ && pImpl_->values_[f * pImpl_->nbValues_] <= t; ++f)
+		{
+			res = chunk.firstFrame_ + f;
+		}
+	}
+	return res;
+}
+
+bool MotionReader::Load(const unsigned int frame, RobotI& robot)
+{
+	const t_value* values = pImpl_->GetFrame(frame);
+	if(!values || robot.GetType() != GetRobotType() || robot.GetNumTrees() != pImpl_->nbJoints_.size())
+	{
+		return false;
+	}
+	for(unsigned int i = 0; i < pImpl_->nbJoints_.size(); ++i)
+	{
+		unsigned int nbJoints = 0;
+		for(const JointI* joint = robot.GetTreeI(i)->GetRootJointI(); joint; joint = joint->GetSon())
+		{
+			++nbJoints;
+		}
+		if(nbJoints != pImpl_->nbJoints_[i])
+		{
+			return false;
+		}
+	}
+	const double angleStep = pImpl_->steps_[0], positionStep = pImpl_->steps_[1], rotationStep = pImpl_->steps_[2];
+	double transform[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+	++values;
+	for(int i = 0; i < 9; ++i, ++values)
+	{
+		transform[rotationIndexes[i]] = *values * rotationStep;
+	}
+	for(int i = 0; i < 3; ++i, ++values)
+	{
+		transform[translationIndexes[i]] = *values * positionStep;
+	}
+	robot.SetTransform(transform);
+	const t_value anchored = *values++;
+	for(unsigned int i = 0; i < pImpl_->nbJoints_.size(); ++i)
+	{
+		TreeI* tree = robot.GetTreeI(i);
+		const unsigned int nbJoints = pImpl_->nbJoints_[i];
+		pImpl_->angles_.resize(nbJoints);
+		for(unsigned int j = 0; j < nbJoints; ++j, ++values)
+		{
+			pImpl_->angles_[j] = *values * angleStep;
+		}
+		if(nbJoints > 0)
+		{
+			tree->SetAngles(&pImpl_->angles_[0]);
+		}
+		double target[3];
+		for(int j = 0; j < 3; ++j, ++values)
+		{
+			target[j] = *values * positionStep;
+		}
+		tree->SetTarget(target);
+		bool anchor = (anchored & ((t_value)1 << i)) != 0;
+		if(tree->IsAnchored() != anchor)
+		{
+			tree->SetAnchored(anchor);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+
+#ifndef _CLASS_MOTIONREADER
+#define _CLASS_MOTIONREADER
+
+#include "API/WorldManagerI.h"
+#include "Timer.h"
+
+#include <memory>
+#include <string>
+
+namespace manip_core
+{
+	struct RobotI;
+}
+
+struct MotionReaderPImpl;
+
+/* Replays a file written by MotionRecorder. The file is mapped and only its chunk boundaries are read when opened,
+a frame is decoded with the rest of its chunk when it is asked for, the last chunk decoded being kept.
+A truncated last chunk is ignored.*/
+class MotionReader
+{
+public:
+	explicit MotionReader(const std::string& /*filename*/);
+	~MotionReader();
+
+private:
+	MotionReader(const MotionReader&);
+	MotionReader& operator=(const MotionReader&);
+
+public:
+	bool IsOpen() const;
+	manip_core::enums::robot::eRobots GetRobotType() const; // to create the robot to load into
+	unsigned int GetNumFrames() const;
+	Timer::t_time GetTime(const unsigned int /*frame*/);
+	unsigned int FindFrame(const Timer::t_time /*time*/); // last frame not after time, 0 if none
+
+	// transform, joint values, targets and anchors, false if the frame or the robot do not match the file
+	bool Load(const unsigned int /*frame*/, manip_core::RobotI& /*robot*/);
+
+private:
+	std::auto_ptr<MotionReaderPImpl> pImpl_;
+};
+
+#endif //_CLASS_MOTIONREADER
@@ -0,0 +1,149 @@
+
+#include "MotionRecorder.h"
+
+#include "API/RobotI.h"
+#include "API/TreeI.h"
+#include "API/JointI.h"
+
+using namespace manip_core;
+using namespace motion_format;
+
+namespace
+{
+	template<typename T>
+	void Write(std::ofstream& file, const T& value)
+	{
+		file.write((const char*)&value, sizeof(T));
+	}
+}
+
+MotionRecorder::MotionRecorder(const std::string& filename, unsigned int chunkFrames)
+	: file_(filename.c_str(), std::ios::out | std::ios::binary)
+	, chunkFrames_(chunkFrames < 1 ? 1 : chunkFrames)
+	, robotType_(0)
+	, chunkFrame_(0)
+	, nbFrames_(0)
+	, size_(0)
+{
+	// NOTHING
+}
+
+MotionRecorder::~MotionRecorder()
+{
+	Flush();
+}
+
+bool MotionRecorder::IsOpen() const
+{
+	return file_.is_open();
+}
+
+void MotionRecorder::WriteHeader(const RobotI& robot)
+{
+	robotType_ = robot.GetType();
+	for(unsigned int i = 0; i < robot.GetNumTrees(); ++i)
+	{
+		unsigned int nbJoints = 0;
+		for(const JointI* joint = robot.GetTreeI(i)->GetRootJointI(); joint; joint = joint->GetSon())
+		{
+			++nbJoints;
+		}
+		nbJoints_.push_back(nbJoints);
+	}
+	file_.write(magic, sizeof(magic));
+	Write(file_, version);
+	Write(file_, (unsigned int)robotType_);
+	Write(file_, (unsigned int)nbJoints_.size());
+	for(std::vector<unsigned int>::const_iterator it = nbJoints_.begin(); it != nbJoints_.end(); ++it)
+	{
+		Write(file_, *it);
+	}
+	Write(file_, angleStep);
+	Write(file_, positionStep);
+	Write(file_, rotationStep);
+	size_ = sizeof(magic) + (3 + nbJoints_.size()) * sizeof(unsigned int) + 3 * sizeof(double);
+}
+
+bool MotionRecorder::RecordFrame(const Timer::t_time time, const RobotI& robot)
+{
+	if(nbJoints_.empty())
+	{
+		if(robot.GetNumTrees() == 0 || robot.GetNumTrees() > maxTrees)
+		{
+			return false;
+		}
+		WriteHeader(robot);
+	}
+	if(robot.GetType() != robotType_ || robot.GetNumTrees() != nbJoints_.size())
+	{
+		return false;
+	}
+	values_.clear();
+	values_.push_back(Quantize(time, 0.001));
+	double transform[16];
+	robot.ToWorldCoordinates(transform);
+	for(int i = 0; i < 9; ++i)
+	{
+		values_.push_back(Quantize(transform[rotationIndexes[i]], rotationStep));
+	}
+	for(int i = 0; i < 3; ++i)
+	{
+		values_.push_back(Quantize(transform[translationIndexes[i]], positionStep));
+	}
+	t_value anchored = 0;
+	values_.push_back(0);
+	for(unsigned int i = 0; i < nbJoints_.size(); ++i)
+	{
+		const TreeI* tree = robot.GetTreeI(i);
+		anchored |= tree->IsAnchored() ? ((t_value)1 << i) : 0;
+		unsigned int nbJoints = 0;
+		for(const JointI* joint = tree->GetRootJointI(); joint && nbJoints < nbJoints_[i]; joint = joint->GetSon(), ++nbJoints)
+		{
+			values_.push_back(Quantize(joint->GetAngle(), angleStep));
+		}
+		values_.resize(values_.size() + nbJoints_[i] - nbJoints, 0);
+		double target[3];
+		tree->GetTarget(target);
+		for(int j = 0; j < 3; ++j)
+		{
+			values_.push_back(Quantize(target[j], positionStep));
+		}
+	}
+	values_[maskValue] = anchored;
+	previous_.resize(values_.size(), 0);
+	beforePrevious_.resize(values_.size(), 0);
+	residuals_.resize(values_.size());
+	for(unsigned int i = 0; i < values_.size(); ++i)
+	{
+		residuals_[i] = values_[i] - Predict(chunkFrame_, i, previous_[i], beforePrevious_[i]);
+	}
+	PutResiduals(chunk_, &residuals_[0], (unsigned int)residuals_.size());
+	beforePrevious_.swap(previous_);
+	previous_.swap(values_);
+	++nbFrames_;
+	if(++chunkFrame_ >= chunkFrames_)
+	{
+		Flush();
+	}
+	return true;
+}
+
+void MotionRecorder::Flush()
+{
+	if(chunkFrame_ == 0)
+	{
+		return;
+	}
+	Write(file_, chunkFrame_);
+	Write(file_, (unsigned int)chunk_.size());
+	file_.write(chunk_.data(), chunk_.size());
+	file_.flush();
+	size_ += 2 * sizeof(unsigned int) + chunk_.size();
+	chunk_.clear();
+	chunkFrame_ = 0;
+}
+
+void MotionRecorder::OnPostureCreated(double time, const RobotI* pRobot)
+{
+	RecordFrame(time, *pRobot);
+}
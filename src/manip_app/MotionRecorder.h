@@ -0,0 +1,59 @@
+
+#ifndef _CLASS_MOTIONRECORDER
+#define _CLASS_MOTIONRECORDER
+
+#include "API/PostureManagerI.h"
+#include "MotionFormat.h"
+#include "Timer.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace manip_core
+{
+	struct RobotI;
+}
+
+/* Writes the states of a robot in the compact format of MotionFormat.h, to be replayed with MotionReader.
+Frames are encoded as they come and written a chunk at a time, so the memory used does not grow with the recording.
+The robot type and structure are taken from the first frame, later frames must come from the same robot model.
+Registered as a PostureCreatedListenerI, it records the created postures instead of keeping them.*/
+class MotionRecorder : public manip_core::PostureCreatedListenerI
+{
+public:
+	explicit MotionRecorder(const std::string& /*filename*/, unsigned int chunkFrames = 64);
+	~MotionRecorder(); // writes the last chunk
+
+private:
+	MotionRecorder(const MotionRecorder&);
+	MotionRecorder& operator=(const MotionRecorder&);
+
+public:
+	bool IsOpen() const;
+	bool RecordFrame(const Timer::t_time /*time*/, const manip_core::RobotI& /*robot*/); // false if the robot does not match the first one
+	void Flush(); // ends the current chunk
+
+	virtual void OnPostureCreated(double /*time*/, const manip_core::RobotI* /*pRobot*/);
+
+	unsigned int GetNumFrames() const { return nbFrames_; }
+	unsigned long GetSize() const { return size_; } // bytes written so far
+
+private:
+	void WriteHeader(const manip_core::RobotI& /*robot*/);
+
+private:
+	typedef std::vector<motion_format::t_value> T_Values;
+
+	std::ofstream file_;
+	const unsigned int chunkFrames_;
+	std::vector<unsigned int> nbJoints_; // per tree, empty until the header is written
+	int robotType_;
+	T_Values values_, previous_, beforePrevious_, residuals_;
+	std::string chunk_;
+	unsigned int chunkFrame_; // frames in the current chunk
+	unsigned int nbFrames_;
+	unsigned long size_;
+};
+
+#endif //_CLASS_MOTIONRECORDER
@@ -0,0 +1,448 @@
+
+#include "PlannerThread.h"
+
+#include "API/RobotI.h"
+#include "API/TreeI.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+using namespace manip_core;
+
+namespace
+{
+	void Publish()
+	{
+	#ifdef WIN32
+		MemoryBarrier();
+	#else
+		__sync_synchronize();
+	#endif
+	}
+
+	// lets the other thread run for a millisecond
+	void Pause()
+	{
+	#ifdef WIN32
+		Sleep(1);
+	#else
+		usleep(1000);
+	#endif
+	}
+
+	enum eCommand
+	{
+		planCommand = 0,
+		updateCommand,
+		releaseCommand
+	};
+
+	struct Command
+	{
+		eCommand type_;
+		double transform_[16];
+		double direction_[3];
+		unsigned long time_;
+		const spline::curve_abc<>* trajectory_;
+	};
+}
+
+struct PlannerSnapshot
+{
+	PlannerSnapshot()
+		: robot_(0)
+		, planned_(false)
+		, ready_(false)
+	{
+		// NOTHING
+	}
+
+	double requested_[16]; // robot transform the plan was asked for
+	double transform_[16]; // planner robot transform once planned
+	RobotI* robot_; // holds the contacts
+	T_CubicTrajectory cubics_;
+	PostureManager::T_Postures postures_;
+	bool planned_; // false when it only carries the postures created by update commands
+	volatile bool ready_; // set by the worker, cleared once collected
+};
+
+struct PlannerThreadPImpl
+{
+	explicit PlannerThreadPImpl(PostureManager& postureManager)
+		: postureManager_(postureManager)
+		, robot_(0)
+		, head_(0)
+		, tail_(0)
+		, written_(0)
+		, read_(0)
+		, stop_(false)
+		, running_(false)
+	{
+		// NOTHING
+	}
+
+	void Run();
+	void RunPlan(const Command& /*command*/);
+	bool SendPostures();
+	bool Push(const Command& /*command*/);
+	void Flush();
+	void Clear();
+
+	PostureManager& postureManager_;
+	RobotI* robot_; // planner side
+	Command commands_[PlannerThread::queueSize];
+	volatile unsigned long head_; // written by the main thread
+	volatile unsigned long tail_; // written by the worker
+	PlannerSnapshot snapshots_[2];
+	unsigned long written_; // worker
+	unsigned long read_; // main thread
+	std::vector<const spline::curve_abc<>*> releases_; // waiting for room in the queue
+	volatile bool stop_;
+	bool running_;
+#ifdef WIN32
+	HANDLE thread_;
+#else
+	pthread_t thread_;
+#endif
+};
+
+namespace
+{
+#ifdef WIN32
+	DWORD WINAPI RunPlanner(LPVOID data)
+	{
+		static_cast<PlannerThreadPImpl*>(data)->Run();
+		return 0;
+	}
+#else
+	void* RunPlanner(void* data)
+	{
+		static_cast<PlannerThreadPImpl*>(data)->Run();
+		return 0;
+	}
+#endif
+}
+
+void PlannerThreadPImpl::Run()
+{
+	Command plan;
+	bool updated = false; // postures may be waiting since the last snapshot
+	while(!stop_)
+	{
+		bool planning = false;
+		while(tail_ != head_)
+		{
+			Publish();
+			const Command& command = commands_[tail_ % PlannerThread::queueSize];
+			switch(command.type_)
+			{
+				case planCommand:
+					plan = command;
+					planning = true;
+				break;
+				case updateCommand:
+					postureManager_.Update(command.time_);
+					updated = true;
+				break;
+				case releaseCommand:
+					postureManager_.ReleaseTrajectory(command.trajectory_);
+				break;
+			}
+			Publish();
+			++tail_;
+		}
+		if(planning)
+		{
+			RunPlan(plan);
+			updated = false;
+		}
+		else
+		{
+			if(updated)
+			{
+				updated = !SendPostures();
+			}
+			Pause();
+		}
+	}
+}
+
+void PlannerThreadPImpl::RunPlan(const Command& command)
+{
+	PlannerSnapshot& snapshot = snapshots_[written_ % 2];
+	// both slots are waiting for the main thread
+	while(snapshot.ready_ && !stop_)
+	{
+		Pause();
+	}
+	if(stop_)
+	{
+		return;
+	}
+	Publish();
+	robot_->SetTransform(command.transform_);
+	matrices::Vector3 direction;
+	matrices::arrayToVect3(command.direction_, direction);
+	snapshot.cubics_ = postureManager_.NextPosture(robot_, direction);
+	memcpy(snapshot.requested_, command.transform_, sizeof(snapshot.requested_));
+	robot_->ToWorldCoordinates(snapshot.transform_);
+	for(unsigned int i = 0; i < robot_->GetNumTrees(); ++i)
+	{
+		snapshot.robot_->GetTreeI(i)->CopyContact(robot_->GetTreeI(i));
+	}
+	postureManager_.TakeDeferred(snapshot.postures_);
+	snapshot.planned_ = true;
+	Publish();
+	snapshot.ready_ = true;
+	++written_;
+}
+
+// hands the postures created by update commands over without waiting, returns false if no slot is free
+bool PlannerThreadPImpl::SendPostures()
+{
+	PlannerSnapshot& snapshot = snapshots_[written_ % 2];
+	if(snapshot.ready_)
+	{
+		return false;
+	}
+	Publish();
+	postureManager_.TakeDeferred(snapshot.postures_);
+	if(!snapshot.postures_.empty())
+	{
+		snapshot.planned_ = false;
+		Publish();
+		snapshot.ready_ = true;
+		++written_;
+	}
+	return true;
+}
+
+bool PlannerThreadPImpl::Push(const Command& command)
+{
+	if(head_ - tail_ >= PlannerThread::queueSize)
+	{
+		return false;
+	}
+	commands_[head_ % PlannerThread::queueSize] = command;
+	Publish();
+	++head_;
+	return true;
+}
+
+void PlannerThreadPImpl::Flush()
+{
+	Command command;
+	command.type_ = releaseCommand;
+	std::vector<const spline::curve_abc<>*>::iterator it = releases_.begin();
+	for(; it != releases_.end(); ++it)
+	{
+		command.trajectory_ = *it;
+		if(!Push(command))
+		{
+			break;
+		}
+	}
+	releases_.erase(releases_.begin(), it);
+}
+
+// worker stopped, what is left is given back to the planner
+void PlannerThreadPImpl::Clear()
+{
+	for(; tail_ != head_; ++tail_)
+	{
+		const Command& command = commands_[tail_ % PlannerThread::queueSize];
+		if(command.type_ == releaseCommand)
+		{
+			postureManager_.ReleaseTrajectory(command.trajectory_);
+		}
+	}
+	for(std::vector<const spline::curve_abc<>*>::const_iterator it = releases_.begin(); it != releases_.end(); ++it)
+	{
+		postureManager_.ReleaseTrajectory(*it);
+	}
+	releases_.clear();
+	PostureManager::T_Postures postures;
+	postureManager_.TakeDeferred(postures);
+	postureManager_.SetDeferListeners(false);
+	for(int i = 0; i < 2; ++i)
+	{
+		PlannerSnapshot& snapshot = snapshots_[i];
+		if(snapshot.ready_)
+		{
+			for(IT_CubicTrajectory it = snapshot.cubics_.begin(); it != snapshot.cubics_.end(); ++it)
+			{
+				postureManager_.ReleaseTrajectory(it->second);
+			}
+		}
+		snapshot.cubics_.clear();
+		postures.insert(postures.end(), snapshot.postures_.begin(), snapshot.postures_.end());
+		snapshot.postures_.clear();
+		snapshot.ready_ = false;
+		if(snapshot.robot_)
+		{
+			snapshot.robot_->Release();
+			snapshot.robot_ = 0;
+		}
+	}
+	for(PostureManager::T_Postures::iterator it = postures.begin(); it != postures.end(); ++it)
+	{
+		it->second->Release();
+	}
+	if(robot_)
+	{
+		robot_->Release();
+		robot_ = 0;
+	}
+}
+
+PlannerThread::PlannerThread(PostureManager& postureManager)
+	: pImpl_(new PlannerThreadPImpl(postureManager))
+{
+	// NOTHING
+}
+
+PlannerThread::~PlannerThread()
+{
+	Stop();
+}
+
+bool PlannerThread::Start(const RobotI* robot)
+{
+	if(pImpl_->running_)
+	{
+		return false;
+	}
+	pImpl_->robot_ = robot->Copy();
+	for(int i = 0; i < 2; ++i)
+	{
+		pImpl_->snapshots_[i].robot_ = robot->Copy();
+	}
+	pImpl_->head_ = pImpl_->tail_ = 0;
+	pImpl_->written_ = pImpl_->read_ = 0;
+	pImpl_->stop_ = false;
+	pImpl_->postureManager_.SetDeferListeners(true);
+	Publish();
+#ifdef WIN32
+	pImpl_->thread_ = CreateThread(0, 0, &RunPlanner, pImpl_.get(), 0, 0);
+	pImpl_->running_ = pImpl_->thread_ != 0;
+#else
+	pImpl_->running_ = pthread_create(&pImpl_->thread_, 0, &RunPlanner, pImpl_.get()) == 0;
+#endif
+	if(!pImpl_->running_)
+	{
+		pImpl_->Clear();
+	}
+	return pImpl_->running_;
+}
+
+void PlannerThread::Stop()
+{
+	if(!pImpl_->running_)
+	{
+		return;
+	}
+	pImpl_->stop_ = true;
+#ifdef WIN32
+	WaitForSingleObject(pImpl_->thread_, INFINITE);
+	CloseHandle(pImpl_->thread_);
+#else
+	pthread_join(pImpl_->thread_, 0);
+#endif
+	pImpl_->running_ = false;
+	pImpl_->Clear();
+}
+
+bool PlannerThread::IsRunning() const
+{
+	return pImpl_->running_;
+}
+
+bool PlannerThread::Plan(const RobotI& robot, const matrices::Vector3& direction)
+{
+	Command command;
+	command.type_ = planCommand;
+	robot.ToWorldCoordinates(command.transform_);
+	matrices::vect3ToArray(command.direction_, direction);
+	pImpl_->Flush();
+	return pImpl_->running_ && pImpl_->Push(command);
+}
+
+bool PlannerThread::Update(const unsigned long time)
+{
+	Command command;
+	command.type_ = updateCommand;
+	command.time_ = time;
+	pImpl_->Flush();
+	return pImpl_->running_ && pImpl_->Push(command);
+}
+
+void PlannerThread::ReleaseTrajectory(const spline::curve_abc<>* trajectory)
+{
+	if(pImpl_->running_)
+	{
+		pImpl_->releases_.push_back(trajectory);
+		pImpl_->Flush();
+	}
+	else
+	{
+		pImpl_->postureManager_.ReleaseTrajectory(trajectory);
+	}
+}
+
+bool PlannerThread::Collect(RobotI& robot, T_CubicTrajectory& cubics)
+{
+	if(!pImpl_->running_)
+	{
+		return false;
+	}
+	// snapshots holding only the postures of update commands are dispatched on the way, in order
+	for(;;)
+	{
+		PlannerSnapshot& snapshot = pImpl_->snapshots_[pImpl_->read_ % 2];
+		if(!snapshot.ready_)
+		{
+			return false;
+		}
+		Publish();
+		if(snapshot.planned_)
+		{
+			break;
+		}
+		pImpl_->postureManager_.Dispatch(snapshot.postures_);
+		Publish();
+		snapshot.ready_ = false;
+		++pImpl_->read_;
+	}
+	PlannerSnapshot& snapshot = pImpl_->snapshots_[pImpl_->read_ % 2];
+	// the planner may have moved the root, the same correction is applied to the current transform
+	if(memcmp(snapshot.requested_, snapshot.transform_, sizeof(snapshot.requested_)) != 0)
+	{
+		matrices::Matrix4 requested, planned, current;
+		double transform[16];
+		robot.ToWorldCoordinates(transform);
+		matrices::array16ToMatrix4(transform, current);
+		matrices::array16ToMatrix4(snapshot.requested_, requested);
+		matrices::array16ToMatrix4(snapshot.transform_, planned);
+		current = planned * requested.inverse() * current;
+		matrices::matrixTo16Array(transform, current);
+		robot.SetTransform(transform);
+	}
+	for(unsigned int i = 0; i < robot.GetNumTrees(); ++i)
+	{
+		robot.GetTreeI(i)->CopyContact(snapshot.robot_->GetTreeI(i));
+	}
+	cubics = snapshot.cubics_;
+	snapshot.cubics_.clear();
+	pImpl_->postureManager_.Dispatch(snapshot.postures_);
+	Publish();
+	snapshot.ready_ = false;
+	++pImpl_->read_;
+	return true;
+}
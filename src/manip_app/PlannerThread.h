@@ -0,0 +1,56 @@
+
+#ifndef _CLASS_PLANNERTHREAD
+#define _CLASS_PLANNERTHREAD
+
+#include "MatrixDefs.h"
+#include "PostureManager.h"
+
+#include "API/PostureManagerI.h"
+
+#include <memory>
+
+namespace manip_core
+{
+	struct RobotI;
+}
+
+struct PlannerThreadPImpl;
+
+/* Runs NextPosture on a worker thread so that re-planning never stalls the frame.
+Commands are sent through a lock free queue with a single producer, the main thread,
+and results come back as snapshots held in two slots, which it collects without waiting.
+The planner works on its own copy of the robot, whose contacts are handed to the drawn robot.*/
+class PlannerThread
+{
+public:
+	enum
+	{
+		queueSize = 256 // commands in flight, further ones are refused
+	};
+
+public:
+	explicit PlannerThread(manip_core::PostureManager& /*postureManager*/);
+	~PlannerThread();
+
+private:
+	PlannerThread(const PlannerThread&);
+	PlannerThread& operator=(const PlannerThread&);
+
+public:
+	bool Start(const manip_core::RobotI* /*robot*/); // the robot is copied
+	void Stop(); // waits for the current plan, the snapshots not collected are dropped
+	bool IsRunning() const;
+
+	// main thread only
+	bool Plan(const manip_core::RobotI& /*robot*/, const matrices::Vector3& /*direction*/); // coalesced, only the last plan queued is run
+	bool Update(const unsigned long /*time*/);
+	void ReleaseTrajectory(const spline::curve_abc<>* /*trajectory*/); // kept until the queue has room
+	// takes the oldest plan, the robot gets its contacts and transform correction, returns false if none is ready
+	// the postures created since are dispatched to the listeners, including those of update commands
+	bool Collect(manip_core::RobotI& /*robot*/, manip_core::T_CubicTrajectory& /*cubics*/);
+
+private:
+	std::auto_ptr<PlannerThreadPImpl> pImpl_;
+};
+
+#endif //_CLASS_PLANNERTHREAD
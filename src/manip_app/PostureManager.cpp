@@ -4,18 +4,25 @@
 #include "MatrixDefs.h"
 
 #include "API/PostureManagerI.h"
+#include "API/RobotI.h"
+
+#include <algorithm>
 
 using namespace manip_core;
 using namespace matrices;
 
 PostureManager::PostureManager(PostureManagerI* pPostureManager)
 	: pPostureManager_(pPostureManager)
+	, defer_(false)
 { 
-	
+	pPostureManager_->RegisterPostureCreatedListenerI(this);
 }
 
 PostureManager::~PostureManager()
 {
+	pPostureManager_->UnRegisterPostureCreatedListenerI(this);
+	listeners_.clear();
+	Dispatch(deferred_); // only releases the copies
 	pPostureManager_->Release();
 }
 
@@ -24,6 +31,16 @@ void PostureManager::SetJumpToTarget(const bool jump)
 	pPostureManager_->SetJumpToTarget(jump);
 }
 
+void PostureManager::SetRootOptimization(const unsigned int maxIterations)
+{
+	pPostureManager_->SetRootOptimization(maxIterations);
+}
+
+void PostureManager::SetFootstepPlanning(const unsigned int horizon, const unsigned int beamWidth, const float timeBudget)
+{
+	pPostureManager_->SetFootstepPlanning(horizon, beamWidth, timeBudget);
+}
+
 
 void PostureManager::AddCheckPoint(const float time, const matrices::Vector3& transform)
 {
@@ -32,6 +49,16 @@ void PostureManager::AddCheckPoint(const float time, const matrices::Vector3& tr
 	pPostureManager_->AddTrajectoryPoint(time, transf);
 }
 
+void PostureManager::AddCheckPoints(const float* times, const matrices::Vector3* positions, const unsigned int nbPoints)
+{
+	std::vector<double> transf(3 * nbPoints);
+	for(unsigned int i = 0; i < nbPoints; ++i)
+	{
+		matrices::vect3ToArray(&transf[3*i], positions[i]);
+	}
+	pPostureManager_->AddTrajectoryPoints(times, transf.empty() ? 0 : &transf[0], nbPoints);
+}
+
 void PostureManager::ResetTrajectory()
 {
 	pPostureManager_->ResetTrajectory();
@@ -44,12 +71,55 @@ void PostureManager::AddPostureCriteria(const enums::postureCriteria::ePostureCr
 
 void PostureManager::RegisterPostureCreatedListenerI(PostureCreatedListenerI* listener) 	
 {
-	pPostureManager_->RegisterPostureCreatedListenerI(listener);
+	listeners_.push_back(listener);
 }
 
 void PostureManager::UnRegisterPostureCreatedListenerI(PostureCreatedListenerI* listener) 
 {
-	pPostureManager_->UnRegisterPostureCreatedListenerI(listener);
+	std::vector<PostureCreatedListenerI*>::iterator it = std::find(listeners_.begin(), listeners_.end(), listener);
+	if(it != listeners_.end())
+	{
+		listeners_.erase(it);
+	}
+}
+
+void PostureManager::SetDeferListeners(const bool defer)
+{
+	defer_ = defer;
+}
+
+void PostureManager::TakeDeferred(T_Postures& postures)
+{
+	postures.insert(postures.end(), deferred_.begin(), deferred_.end());
+	deferred_.clear();
+}
+
+void PostureManager::Dispatch(T_Postures& postures)
+{
+	for(T_Postures::iterator it = postures.begin(); it != postures.end(); ++it)
+	{
+		for(std::vector<PostureCreatedListenerI*>::const_iterator itl = listeners_.begin(); itl != listeners_.end(); ++itl)
+		{
+			(*itl)->OnPostureCreated(it->first, it->second);
+		}
+		it->second->Release();
+	}
+	postures.clear();
+}
+
+void PostureManager::OnPostureCreated(double time, const RobotI* pRobot)
+{
+	if(defer_)
+	{
+		deferred_.push_back(std::make_pair(time, pRobot->Copy()));
+	}
+	else
+	{
+		for(std::vector<PostureCreatedListenerI*>::const_iterator it = listeners_.begin(); it != listeners_.end(); ++it)
+		{
+			(*it)->OnPostureCreated(time, pRobot);
+		}
+	}
 }
 
 void PostureManager::ComputeOnline(const RobotI* robot, int nbSamples) 
@@ -76,6 +146,11 @@ T_CubicTrajectory PostureManager::NextPosture(RobotI* robot, const matrices::Vec
 	return pPostureManager_->NextPosture(robot, dir, Simulation::GetInstance()->simpParams_.closestDistance_);
 }
 
+void PostureManager::ReleaseTrajectory(const spline::curve_abc<>* trajectory)
+{
+	pPostureManager_->ReleaseTrajectory(trajectory);
+}
+
 void PostureManager::Update(const unsigned long time)
 {
 	pPostureManager_->Update(time);
@@ -15,8 +15,14 @@ namespace manip_core
 struct RobotI;
 struct TreeI;
 
-class PostureManager
+/* Listeners are kept here rather than in the core, so that the postures created on a planner thread
+can be deferred and handed to them later from the main thread.*/
+class PostureManager : public PostureCreatedListenerI
 {
+public:
+	typedef std::pair<double, RobotI*>	T_Posture; // the robot is a copy owned by the list
+	typedef std::vector<T_Posture>		T_Postures;
+
 public:
 	 explicit PostureManager(PostureManagerI* /*pPostureManager*/);
 	~PostureManager();
@@ -26,9 +32,14 @@ public:
 
 	void SetJumpToTarget(const bool /*jump*/);
 
+	void SetRootOptimization(const unsigned int /*maxIterations*/);
+
+	void SetFootstepPlanning(const unsigned int /*horizon*/, const unsigned int /*beamWidth*/ = 4, const float /*timeBudget*/ = 0.005f); // seconds
+
 	void Update(const unsigned long /*time*/);
 
 	void AddCheckPoint(const float /*time*/, const matrices::Vector3& /*transform*/);
+	void AddCheckPoints(const float* /*times*/, const matrices::Vector3* /*positions*/, const unsigned int /*nbPoints*/);
 	/**
 	Add a criteria either for raising or lowering foot.
 	*/
@@ -42,6 +53,12 @@ public:
 	*/
 	void UnRegisterPostureCreatedListenerI(PostureCreatedListenerI* /*listener*/) ;
 	/**
+	While deferred, created postures are copied and kept until TakeDeferred instead of being dispatched
+	*/
+	void SetDeferListeners(const bool /*defer*/);
+	void TakeDeferred(T_Postures& /*postures*/); // appends the postures kept so far
+	void Dispatch(T_Postures& /*postures*/); // calls the listeners, then releases and clears the postures
+	/**
 	Compute solution posture for given trajectory and constraints
 	*/
 	/**
@@ -55,13 +72,22 @@ public:
 
 	T_CubicTrajectory NextPosture(RobotI* /*robot*/, const matrices::Vector3& /*direction*/);
 
+	void ReleaseTrajectory(const spline::curve_abc<>* /*trajectory*/);
+
 	T_CubicTrajectory ComputeTrajectoryPostures(RobotI* /*robot*/);
 
 	#ifdef PROFILE
 	void Log() const;
 	#endif
+
+public:
+	virtual void OnPostureCreated(double /*time*/, const RobotI* /*pRobot*/);
+
 private:
 	PostureManagerI* pPostureManager_;
+	std::vector<PostureCreatedListenerI*> listeners_;
+	T_Postures deferred_;
+	bool defer_;
 };
 
 } // namespace manip_core
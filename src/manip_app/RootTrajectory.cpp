@@ -1,6 +1,8 @@
 #include "RootTrajectory.h"
 #include "Simulation.h"
+#ifndef MANIP_HEADLESS
 #include "Draw/DrawSpline.h"
+#endif
 
 using namespace matrices;
 
@@ -90,10 +92,12 @@ void RootTrajectory::Update(const Timer::t_time t, const Timer::t_time dt)
 			}
 		}
 
+#ifndef MANIP_HEADLESS
 		if(sg->simpParams_.drawSplines_)
 		{
 			DrawSpline ds(*spline_);
 			ds.Draw();
 		}
+#endif
 	}
 }
@@ -3,13 +3,21 @@
 #include "RootTrajectory.h"
 //#include "XboxMotion.h"
 #include "WorldParser/WorldParser.h"
+#include "HeadlessRecorder.h"
+#include "MotionRecorder.h"
 
+#include <memory>
 #include <time.h>
 
 using namespace manip_core;
 
 Simulation* Simulation::instance = 0;
 
+namespace
+{
+	const Timer::t_time autoRotatePeriod = 1000. / 30; // ms, the rotation is scaled by the elapsed time
+}
+
 Simulation::Simulation()
 	: manager_()
 	, simpParams_()
@@ -17,7 +25,10 @@ Simulation::Simulation()
 	, timerHandler_()
 	, postureManager_(manager_.GetPostureManager())
 	, motionHandler_(manager_)
+#ifndef MANIP_HEADLESS
 	, drawManager_(manager_)
+#endif
+	, planner_(*manager_.GetPostureManager())
 {
 	srand((unsigned int)(time(0))); //Init Random generation
 	// TODO
@@ -34,6 +45,7 @@ Simulation::~Simulation()
 	//delete postureManager_;
 }
 
+#ifndef MANIP_HEADLESS
 namespace simspace
 {
 	void start()
@@ -58,6 +70,11 @@ namespace simspace
 		{
 			sim->pRobot->Rest();
 		}
+		if(sim->simpParams_.plannerThread_)
+		{
+			sim->motionHandler_.SetPlanner(&sim->planner_);
+			sim->planner_.Start(sim->pRobot);
+		}
 	}
 
 	void simLoop(int pause)
@@ -67,11 +84,15 @@ namespace simspace
 		sim->Draw();
 	}
 }
+#endif
 
 #include<fstream>
+#include<iostream>
+#ifdef WIN32
 #include <Windows.h>
+#endif
 using namespace std;
-void Simulation::Start(int argc, char *argv[])
+bool Simulation::Init(int argc, char *argv[])
 {
 	srand((unsigned int)(time(0))); //Init Random generation
 	//init robot
@@ -82,18 +103,28 @@ void Simulation::Start(int argc, char *argv[])
 	if(argc > 1)
 	{
 		filename = std::string(argv[1]);
-		parser.CreateWorld(filename);
+		if(!parser.CreateWorld(filename))
+		{
+			return false;
+		}
 	}
 	else
 	{
 		std::string startupFile = std::string("../world/startup.xml");
 		// Open startup xml
 		if (!std::ifstream("../world/startup.xml")){
+#ifdef WIN32
 			MessageBox(NULL, "Unable to open startup file\n", "Error", MB_OK);
-			exit(0);
+#else
+			std::cerr << "Unable to open startup file" << std::endl;
+#endif
+			return false;
 		} 
 
-		parser.InitWorld(startupFile);
+		if(!parser.InitWorld(startupFile))
+		{
+			return false;
+		}
 	}
 	
 	
@@ -127,8 +158,9 @@ void Simulation::Start(int argc, char *argv[])
 		}
 	}
 	postureManager_->SetJumpToTarget(simpParams_.jumpToTarget_);
+	postureManager_->SetFootstepPlanning(simpParams_.footstepHorizon_);
+	postureManager_->SetRootOptimization(simpParams_.rootIterations_);
 	postureManager_->InitSamples(pRobot,simpParams_.nbSamples_);
-	dRobot = new DrawRobot(pRobot);
 	if(simpParams_.gait_)
 	{
 		postureManager_->AddPostureCriteria(enums::postureCriteria::toeOnSpiderGait);
@@ -138,6 +170,18 @@ void Simulation::Start(int argc, char *argv[])
 	{
 		postureManager_->AddPostureCriteria(enums::postureCriteria::toeOffJointLimit);
 	}
+	RegisterHandlers();
+	return true;
+}
+
+#ifndef MANIP_HEADLESS
+void Simulation::Start(int argc, char *argv[])
+{
+	if(!Init(argc, argv))
+	{
+		exit(0);
+	}
+	dRobot = new DrawRobot(pRobot);
 
     simpParams_.fn_.version = DS_VERSION;
     simpParams_.fn_.start   = &simspace::start;
@@ -145,9 +189,85 @@ void Simulation::Start(int argc, char *argv[])
 	simpParams_.fn_.command = simpParams_.command;
     simpParams_.fn_.stop    = 0;
 
-	RegisterHandlers();
     dsSimulationLoop (argc,argv,1600,900, &simpParams_.fn_);
 }
+#endif
+
+bool Simulation::RunHeadless(Timer::t_time step, Timer::t_time duration, const std::string& output, const matrices::Vector3& move,
+							 const std::string& record, const std::string& postures)
+{
+	if(step <= 0)
+	{
+		return false;
+	}
+	HeadlessRecorder recorder(output);
+	if(!recorder.IsOpen())
+	{
+		std::cerr << "Unable to open " << output << std::endl;
+		return false;
+	}
+	std::auto_ptr<MotionRecorder> motion(record.empty() ? 0 : new MotionRecorder(record));
+	if(motion.get() && !motion->IsOpen())
+	{
+		std::cerr << "Unable to open " << record << std::endl;
+		return false;
+	}
+	std::auto_ptr<MotionRecorder> posturesRecorder(postures.empty() ? 0 : new MotionRecorder(postures));
+	if(posturesRecorder.get() && !posturesRecorder->IsOpen())
+	{
+		std::cerr << "Unable to open " << postures << std::endl;
+		return false;
+	}
+	simpParams_.drawSplines_ = false;
+	postureManager_->RegisterPostureCreatedListenerI(&recorder);
+	if(posturesRecorder.get())
+	{
+		// postures are encoded as they come instead of being kept
+		postureManager_->RegisterPostureCreatedListenerI(posturesRecorder.get());
+	}
+	motionHandler_.SetSplineListener(&recorder);
+	if(simpParams_.planif_)
+	{
+		postureManager_->ComputeOnline(pRobot, simpParams_.nbSamples_);
+	}
+	// the clock is not used, time only moves by steps
+	timerHandler_.GetTimer().Stop();
+	bool moving = move != matrices::Vector3(0, 0, 0);
+	Timer::t_time time = timerHandler_.GetTimer().GetTime();
+	unsigned int nbFrames = 0;
+	while(time < duration)
+	{
+		if(moving)
+		{
+			motionHandler_.Translate(move);
+		}
+		timerHandler_.Step(step);
+		time = timerHandler_.GetTimer().GetTime();
+		postureManager_->Update((unsigned long)time);
+		recorder.RecordFrame(time, *pRobot);
+		if(motion.get())
+		{
+			motion->RecordFrame(time, *pRobot);
+		}
+		++nbFrames;
+	}
+	motionHandler_.SetSplineListener(0);
+	postureManager_->UnRegisterPostureCreatedListenerI(&recorder);
+	if(posturesRecorder.get())
+	{
+		postureManager_->UnRegisterPostureCreatedListenerI(posturesRecorder.get());
+		posturesRecorder->Flush();
+		std::cout << posturesRecorder->GetNumFrames() << " postures, " << posturesRecorder->GetSize() << " bytes written to " << postures << std::endl;
+	}
+	std::cout << nbFrames << " frames, " << recorder.GetNumPostures() << " postures, "
+		<< recorder.GetNumSplines() << " splines written to " << output << std::endl;
+	if(motion.get())
+	{
+		motion->Flush();
+		std::cout << motion->GetNumFrames() << " frames, " << motion->GetSize() << " bytes written to " << record << std::endl;
+	}
+	return true;
+}
 
 void Simulation::Update()
 {
@@ -163,17 +283,26 @@ void Simulation::Update()
 		{
 			simpParams_.inputHandler_->Update();
 		}
-		postureManager_->Update(timerHandler_.GetTimer().GetTime());
+		if(planner_.IsRunning())
+		{
+			planner_.Update(timerHandler_.GetTimer().GetTime());
+		}
+		else
+		{
+			postureManager_->Update(timerHandler_.GetTimer().GetTime());
+		}
 		timerHandler_.GetTimer().Start();
 	}
 }
 
+#ifndef MANIP_HEADLESS
 void Simulation::Draw()
 {
 	drawManager_.Draw();
 	dRobot->Draw();
 	simpParams_.GetCamera()->DrawArrow();
 }
+#endif
 
 void Simulation::RegisterHandlers()
 {
@@ -181,13 +310,13 @@ void Simulation::RegisterHandlers()
 	{
 		TimerHandled_ABC* listener = new AutoRotate(matrices::Vector3(0,0,1));
 		managedTimeListeners_.push_back(listener);
-		timerHandler_.Register(listener);
+		timerHandler_.Register(listener, autoRotatePeriod);
 	}
 	else if(simpParams_.autorotateleg_) // before motion handler !
 	{
 		TimerHandled_ABC* listener = new AutoRotateLeg(matrices::Vector3(0,0,1));
 		managedTimeListeners_.push_back(listener);
-		timerHandler_.Register(listener);
+		timerHandler_.Register(listener, autoRotatePeriod);
 	}
 	if(simpParams_.rootTrajectory_) // before motion handler !
 	{
@@ -202,17 +331,27 @@ void Simulation::RegisterHandlers()
 
 void Simulation::Reset()
 {
+	bool planning = planner_.IsRunning();
+	planner_.Stop();
+#ifndef MANIP_HEADLESS
 	delete dRobot;
+#endif
 	delete pRobot;
 	pRobot = manager_.CreateRobot(simpParams_.robotType_, simpParams_.robotBasis_, simpParams_.angleValues_);
 	for(std::vector<int>::const_iterator it = simpParams_.locked_.begin(); it !=simpParams_.locked_.end(); ++it)
 	{
 		pRobot->LockOnCurrent(*it);
 	}
+#ifndef MANIP_HEADLESS
 	dRobot = new DrawRobot(pRobot);
+#endif
 	simpParams_.GetCamera()->Reset();
 	//simpParams_.rootTrajectory_ = false;
 	timerHandler_.Reset(simpParams_.initTimer_);
+	if(planning)
+	{
+		planner_.Start(pRobot);
+	}
 	#ifdef PROFILE
 	postureManager_->Log();
 	#endif
@@ -6,7 +6,6 @@
 #include "Pi.h"
 
 #include "spline/exact_cubic.h"
-#include "Draw/DrawSpline.h"
 
 #include "TimerHandler.h"
 #include "Camera.h"
@@ -15,11 +14,14 @@
 #include "ManipManager.h"
 #include "PostureManager.h"
 #include "MotionHandler.h"
+#include "PlannerThread.h"
 
+#ifndef MANIP_HEADLESS
 #include "drawstuff/drawstuff.h"
 #include "Draw/DrawRobot.h"
 #include "Draw/DrawManager.h"
 #include "Draw/DrawTrajectory.h"
+#endif
 
 #include "API/TreeI.h"
 #include "API/RobotI.h"
@@ -66,8 +68,13 @@ struct SimParams
 		, drawArms_(true)
 		, currentSample_(0)
 		, drawManip_(false)
+		, plannerThread_(false)
+		, footstepHorizon_(0)
+		, rootIterations_(0)
 	{
+#ifndef MANIP_HEADLESS
 		fn_.path_to_textures = "../textures";
+#endif
 		command = 0;
 		camera_ = new Camera_ABC(matrices::Vector3(-13,0,5), matrices::Vector3(0,0,0));
 	}
@@ -122,11 +129,16 @@ struct SimParams
 	bool reachComRotate_;
 	bool drawArms_;
 	bool drawManip_;
+	bool plannerThread_; // postures computed off the render loop
+	unsigned int footstepHorizon_; // steps planned ahead when locking a tree, 0 keeps the greedy choice
+	unsigned int rootIterations_;  // of the root optimization, 0 keeps the root on the trajectory
 	matrices::Matrix4 robotBasis_;
 	matrices::Vector3 initDir_;
     matrices::Vector3 background_;
 	void (*command)(int cmd);
+#ifndef MANIP_HEADLESS
 	dsFunctions fn_;
+#endif
 	manip_core::enums::robot::eRobots robotType_;
 	InputHandlerABC* inputHandler_;
 
@@ -153,25 +165,40 @@ private:
 	 ~Simulation();
 
 public:
+	bool Init(int argc, char *argv[]); // world and robot, without display
+#ifndef MANIP_HEADLESS
 	void Start(int argc, char *argv[]);
+#endif
+	// runs the planner for duration ms by steps of step ms, the robot moving along move, and writes the motion to output
+	// and, if record is given, each frame to record in the compact format of MotionRecorder.
+	// If postures is given, the created postures are written there in the same format as they come
+	bool RunHeadless(Timer::t_time step, Timer::t_time duration, const std::string& output, const matrices::Vector3& move,
+					 const std::string& record = std::string(), const std::string& postures = std::string());
 	void Update();
+#ifndef MANIP_HEADLESS
 	void Draw();
+#endif
 	void Reset();
 	void RegisterHandlers();
 	
 public:
 	TimerHandler timerHandler_;
 	manip_core::ManipManager manager_;
-	DrawManager drawManager_;
+#ifndef MANIP_HEADLESS
+	DrawManager drawManager_; // registers the drawn postures, never built by the batch runner
+#endif
 	manip_core::PostureManager* postureManager_;
 
 public:
 	manip_core::RobotI* pRobot;
+#ifndef MANIP_HEADLESS
 	DrawRobot* dRobot;
+#endif
 
 public:
 	SimParams simpParams_;
 	MotionHandler motionHandler_;
+	PlannerThread planner_;
 	
 private:
 	static Simulation* instance;
@@ -17,7 +17,7 @@ SplineTimeManager::SplineTimeManager(const Timer::t_time zeroTime, spline::curve
 
 SplineTimeManager::~SplineTimeManager()
 {
-	delete cubic_;
+	// NOTHING, cubic_ is released to the posture manager by its owner
 }
 
 void SplineTimeManager::Update(const Timer::t_time t, const Timer::t_time dt)
@@ -32,6 +32,11 @@ matrices::Vector3 SplineTimeManager::GetTarget() const
 	return res;
 }
 
+Timer::t_time SplineTimeManager::GetEndTime() const
+{
+	return zeroTime_ + cubic_->max() / speed_;
+}
+
 bool SplineTimeManager::IsObsolete()
 {
 	return distance_ > cubic_->max();
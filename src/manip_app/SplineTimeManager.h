@@ -22,6 +22,7 @@ private:
 public:
 	void Update(const Timer::t_time /*t*/, const Timer::t_time /*dt*/);
 	matrices::Vector3 GetTarget() const;
+	Timer::t_time GetEndTime() const; // time at which the end of the cubic is reached
 
 public:
 	bool IsObsolete();
@@ -31,7 +32,7 @@ private:
 	const Timer::t_time zeroTime_;
 	Timer::t_time currentTime_;
 	const float speed_;
-	curve_abc<>* cubic_;
+	curve_abc<>* cubic_; // shared, not owned
 	NUMBER distance_;
 };
 
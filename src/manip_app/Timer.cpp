@@ -65,3 +65,9 @@ Timer::t_time Timer::GetTime() {
 bool Timer::IsOver(Timer::t_time milliseconds) {
 	return milliseconds >= GetTime();
 }
+
+
+void Timer::Advance(Timer::t_time milliseconds) {
+	beg_ -= milliseconds;
+	resetted_ = false;
+}
@@ -19,6 +19,7 @@ public:
 	bool    IsRunning();
 	t_time	GetTime();
 	bool    IsOver(t_time milliseconds);
+	void    Advance(t_time milliseconds); // moves the time forward without waiting, for simulations that run faster than the clock
 
 private:
 	bool    resetted_;
@@ -1,5 +1,26 @@
 #include "TimerHandler.h"
 
+// calls Update on a registered listener each time its period is over
+struct PeriodicListener : public TimerEvent_ABC
+{
+	PeriodicListener(TimerHandled_ABC* listener, const Timer::t_time period)
+		: listener_(listener)
+		, period_(period)
+		, lastUpdateTime_(0)
+	{
+		// NOTHING
+	}
+
+	virtual void OnTimer(const Timer::t_time time, const unsigned long /*id*/)
+	{
+		listener_->Update(time / 1000., (time - lastUpdateTime_) / 1000.);
+		lastUpdateTime_ = time;
+	}
+
+	TimerHandled_ABC* listener_;
+	const Timer::t_time period_;
+	Timer::t_time lastUpdateTime_;
+};
 
 TimerHandler::TimerHandler()
 	: lastUpdateTime_(0)
@@ -9,20 +30,34 @@ TimerHandler::TimerHandler()
 
 TimerHandler::~TimerHandler()
 {
-	// NOTHING
+	for(std::vector<PeriodicListener*>::iterator it = periodicListeners_.begin(); it != periodicListeners_.end(); ++it)
+	{
+		delete *it;
+	}
 }
 
 void TimerHandler::Start(Timer::t_time initTime) {
 	timer_.Start(initTime);
 	lastUpdateTime_ = timer_.GetTime();
+	wheel_.Clear(lastUpdateTime_);
+	for(std::vector<PeriodicListener*>::iterator it = periodicListeners_.begin(); it != periodicListeners_.end(); ++it)
+	{
+		SchedulePeriodic(*it);
+	}
 }
 
 void TimerHandler::Reset(Timer::t_time initTime) {
 	timer_.Reset(initTime);
+	wheel_.Clear(timer_.GetTime());
 	for(TimerHandled_ABC::IT_TimerHandled_ABC it = listeners_.begin(); it != listeners_.end(); ++it)
 	{
 		(*it)->Reset();
 	}
+	for(std::vector<PeriodicListener*>::iterator it = periodicListeners_.begin(); it != periodicListeners_.end(); ++it)
+	{
+		(*it)->listener_->Reset();
+		SchedulePeriodic(*it);
+	}
 	lastUpdateTime_ = 0;
 }
 
@@ -30,17 +65,47 @@ void TimerHandler::Update() {
 	Timer::t_time currentTime = timer_.GetTime();
 	Timer::t_time dt = (currentTime - lastUpdateTime_);
 	lastUpdateTime_ = currentTime;
+	wheel_.Advance(currentTime);
 	for(TimerHandled_ABC::IT_TimerHandled_ABC it = listeners_.begin(); it != listeners_.end(); ++it)
 	{
 		(*it)->Update(currentTime / 1000., dt / 1000.);
 	}
 }
 
+void TimerHandler::Step(Timer::t_time dt) {
+	timer_.Stop();
+	timer_.Advance(dt);
+	Update();
+}
+
 void TimerHandler::Register(TimerHandled_ABC* listener)
 {
 	listeners_.push_back(listener);
 }
 
+void TimerHandler::Register(TimerHandled_ABC* listener, const Timer::t_time period)
+{
+	periodicListeners_.push_back(new PeriodicListener(listener, period));
+	SchedulePeriodic(periodicListeners_.back());
+}
+
+void TimerHandler::SchedulePeriodic(PeriodicListener* listener)
+{
+	Timer::t_time time = timer_.GetTime();
+	listener->lastUpdateTime_ = time;
+	wheel_.Schedule(listener, time + listener->period_, listener->period_);
+}
+
+TimerWheel::t_id TimerHandler::Schedule(TimerEvent_ABC* listener, const Timer::t_time deadline, const Timer::t_time period)
+{
+	return wheel_.Schedule(listener, deadline, period);
+}
+
+bool TimerHandler::Cancel(const TimerWheel::t_id id)
+{
+	return wheel_.Cancel(id);
+}
+
 Timer& TimerHandler::GetTimer()
 {
 	return timer_;
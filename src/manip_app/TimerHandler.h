@@ -3,6 +3,7 @@
 #define _CLASS_TIMERHANDLER
 
 #include "Timer.h"
+#include "TimerWheel.h"
 
 #include <vector>
 
@@ -18,6 +19,10 @@ struct TimerHandled_ABC
 	virtual void Reset(){};
 };
 
+struct PeriodicListener;
+
+/* Listeners are either updated at each tick, or every period through the timer wheel.
+Events scheduled on the wheel are fired before the listeners are updated.*/
 class TimerHandler {
 
 public:
@@ -27,7 +32,11 @@ public:
 public:
 	void	Start(Timer::t_time initTime = 0);
 	void	Register(TimerHandled_ABC* timer);
+	void	Register(TimerHandled_ABC* timer, const Timer::t_time period); // updated every period ms instead of every tick
+	TimerWheel::t_id Schedule(TimerEvent_ABC* /*listener*/, const Timer::t_time /*deadline*/, const Timer::t_time period = 0); // ms
+	bool    Cancel(const TimerWheel::t_id /*id*/);
 	void    Update();
+	void    Step(Timer::t_time dt); // stopped timer advanced by dt ms, then Update
 	void    Reset(Timer::t_time initTime = 0);
 
 public:
@@ -37,6 +46,11 @@ private:
 	Timer timer_;
 	Timer::t_time lastUpdateTime_;
 	TimerHandled_ABC::T_TimerHandled_ABC listeners_;
+	std::vector<PeriodicListener*> periodicListeners_;
+	TimerWheel wheel_;
+
+private:
+	void SchedulePeriodic(PeriodicListener* /*listener*/);
 }; // Timer
 
 #endif //_CLASS_TIMERHANDLER
\ No newline at end of file
@@ -0,0 +1,283 @@
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	typedef unsigned long long t_tick;
+
+	const unsigned int rootBits  = 8;
+	const unsigned int levelBits = 6;
+	const unsigned int nbLevels  = 3;
+	const unsigned int rootSize  = 1 << rootBits;
+	const unsigned int levelSize = 1 << levelBits;
+	const unsigned int firing    = rootSize + nbLevels * levelSize; // list of the events being fired
+	const unsigned int nbLists   = firing + 1;
+	const t_tick maxDelta = ((t_tick)1 << (rootBits + nbLevels * levelBits)) - 1;
+	const unsigned long indexMask = 0xffffff; // entry index + 1 in the low bits of an id, a generation above
+
+	const int none = -1;
+
+	struct Entry
+	{
+		TimerEvent_ABC* listener_;
+		Timer::t_time deadline_;
+		Timer::t_time period_;
+		t_tick expires_;
+		TimerWheel::t_id id_;
+		int prev_;
+		int next_;
+		int list_; // none when the entry is free
+	};
+
+	// rounded up, an event never fires early
+	t_tick ToTick(const Timer::t_time time)
+	{
+		return time > 0 ? (t_tick)ceil(time) : 0;
+	}
+}
+
+struct TimerWheelPImpl
+{
+	TimerWheelPImpl()
+	{
+		Clear(0);
+	}
+
+	void Clear(const Timer::t_time time)
+	{
+		entries_.clear();
+		free_ = none;
+		for(unsigned int i = 0; i < nbLists; ++i)
+		{
+			heads_[i] = tails_[i] = none;
+		}
+		next_ = (time > 0 ? (t_tick)floor(time) : 0) + 1;
+		nbEvents_ = 0;
+		nbRootEvents_ = 0;
+	}
+
+	void Link(const int index, const unsigned int list)
+	{
+		Entry& entry = entries_[index];
+		entry.list_ = (int)list;
+		entry.prev_ = tails_[list];
+		entry.next_ = none;
+		if(tails_[list] != none)
+		{
+			entries_[tails_[list]].next_ = index;
+		}
+		else
+		{
+			heads_[list] = index;
+		}
+		tails_[list] = index;
+		if(list < rootSize)
+		{
+			++nbRootEvents_;
+		}
+	}
+
+	void Unlink(const int index)
+	{
+		Entry& entry = entries_[index];
+		if(entry.prev_ != none)
+		{
+			entries_[entry.prev_].next_ = entry.next_;
+		}
+		else
+		{
+			heads_[entry.list_] = entry.next_;
+		}
+		if(entry.next_ != none)
+		{
+			entries_[entry.next_].prev_ = entry.prev_;
+		}
+		else
+		{
+			tails_[entry.list_] = entry.prev_;
+		}
+		if(entry.list_ < (int)rootSize)
+		{
+			--nbRootEvents_;
+		}
+		entry.list_ = none;
+	}
+
+	// slot of the entry relative to the tick being processed, the past going to the current slot
+	void Insert(const int index)
+	{
+		Entry& entry = entries_[index];
+		t_tick expires = entry.expires_ < next_ ? next_ : entry.expires_;
+		t_tick delta = expires - next_;
+		if(delta < rootSize)
+		{
+			Link(index, (unsigned int)(expires & (rootSize - 1)));
+			return;
+		}
+		if(delta > maxDelta)
+		{
+			expires = next_ + maxDelta;
+		}
+		unsigned int level = 0;
+		while(level + 1 < nbLevels && delta >= ((t_tick)1 << (rootBits + (level + 1) * levelBits)))
+		{
+			++level;
+		}
+		unsigned int slot = (unsigned int)((expires >> (rootBits + level * levelBits)) & (levelSize - 1));
+		Link(index, rootSize + level * levelSize + slot);
+	}
+
+	// moves the events of a slot of a level to lower ones, returns the slot
+	unsigned int Cascade(const unsigned int level)
+	{
+		unsigned int slot = (unsigned int)((next_ >> (rootBits + level * levelBits)) & (levelSize - 1));
+		unsigned int list = rootSize + level * levelSize + slot;
+		while(heads_[list] != none)
+		{
+			int index = heads_[list];
+			Unlink(index);
+			Insert(index);
+		}
+		return slot;
+	}
+
+	void Release(const int index)
+	{
+		entries_[index].listener_ = 0;
+		entries_[index].next_ = free_;
+		free_ = index;
+		--nbEvents_;
+	}
+
+	std::vector<Entry> entries_;
+	int free_; // free entries, chained by next_
+	int heads_[nbLists];
+	int tails_[nbLists];
+	t_tick next_; // tick to process
+	unsigned int nbEvents_;
+	unsigned int nbRootEvents_; // in the first 256 slots
+	unsigned long generation_;
+};
+
+TimerWheel::TimerWheel()
+	: pImpl_(new TimerWheelPImpl())
+{
+	pImpl_->generation_ = 0;
+}
+
+TimerWheel::~TimerWheel()
+{
+	// NOTHING
+}
+
+TimerWheel::t_id TimerWheel::Schedule(TimerEvent_ABC* listener, const Timer::t_time deadline, const Timer::t_time period)
+{
+	int index = pImpl_->free_;
+	if(index != none)
+	{
+		pImpl_->free_ = pImpl_->entries_[index].next_;
+	}
+	else
+	{
+		index = (int)pImpl_->entries_.size();
+		pImpl_->entries_.push_back(Entry());
+	}
+	pImpl_->generation_ = (pImpl_->generation_ + 1) & (~0UL >> 24);
+	Entry& entry = pImpl_->entries_[index];
+	entry.listener_ = listener;
+	entry.deadline_ = deadline;
+	entry.period_ = period > 0 ? period : 0;
+	entry.expires_ = ToTick(deadline);
+	entry.id_ = (pImpl_->generation_ << 24) | (unsigned long)(index + 1);
+	pImpl_->Insert(index);
+	++pImpl_->nbEvents_;
+	return entry.id_;
+}
+
+bool TimerWheel::Cancel(const t_id id)
+{
+	int index = (int)(id & indexMask) - 1;
+	if(index < 0 || index >= (int)pImpl_->entries_.size())
+	{
+		return false;
+	}
+	Entry& entry = pImpl_->entries_[index];
+	if(entry.list_ == none || entry.id_ != id)
+	{
+		return false;
+	}
+	pImpl_->Unlink(index);
+	pImpl_->Release(index);
+	return true;
+}
+
+void TimerWheel::Advance(const Timer::t_time time)
+{
+	if(time < 0)
+	{
+		return;
+	}
+	const t_tick target = (t_tick)floor(time);
+	TimerWheelPImpl& wheel = *pImpl_;
+	while(wheel.next_ <= target)
+	{
+		if(wheel.nbEvents_ == 0)
+		{
+			wheel.next_ = target + 1;
+			break;
+		}
+		unsigned int slot = (unsigned int)(wheel.next_ & (rootSize - 1));
+		for(unsigned int level = 0; slot == 0 && level < nbLevels; ++level)
+		{
+			slot = wheel.Cascade(level);
+		}
+		// nothing before the next turn of the first slots
+		if(wheel.nbRootEvents_ == 0)
+		{
+			wheel.next_ = std::min((wheel.next_ | (rootSize - 1)) + 1, target + 1);
+			continue;
+		}
+		slot = (unsigned int)(wheel.next_ & (rootSize - 1));
+		++wheel.next_;
+		while(wheel.heads_[slot] != none)
+		{
+			int index = wheel.heads_[slot];
+			wheel.Unlink(index);
+			wheel.Link(index, firing);
+		}
+		while(wheel.heads_[firing] != none)
+		{
+			int index = wheel.heads_[firing];
+			wheel.Unlink(index);
+			Entry& entry = wheel.entries_[index];
+			TimerEvent_ABC* listener = entry.listener_;
+			const Timer::t_time deadline = entry.deadline_;
+			const t_id id = entry.id_;
+			if(entry.period_ > 0)
+			{
+				entry.deadline_ += entry.period_;
+				entry.expires_ = ToTick(entry.deadline_);
+				wheel.Insert(index);
+			}
+			else
+			{
+				wheel.Release(index);
+			}
+			listener->OnTimer(deadline, id);
+		}
+	}
+}
+
+void TimerWheel::Clear(const Timer::t_time time)
+{
+	pImpl_->Clear(time);
+}
+
+unsigned int TimerWheel::GetNumEvents() const
+{
+	return pImpl_->nbEvents_;
+}
@@ -0,0 +1,47 @@
+
+#ifndef _CLASS_TIMERWHEEL
+#define _CLASS_TIMERWHEEL
+
+#include "Timer.h"
+
+#include <memory>
+
+struct TimerWheelPImpl;
+
+struct TimerEvent_ABC
+{
+	 TimerEvent_ABC(){};
+	~TimerEvent_ABC(){};
+	virtual void OnTimer(const Timer::t_time /*time*/, const unsigned long /*id*/) = 0; // time is the deadline of the event, in ms
+};
+
+/* Hierarchical timer wheel with a resolution of one millisecond : 256 slots for the next ticks,
+then three levels of 64 slots, each covering 64 times the span of the previous one.
+Scheduling and cancelling cost the same whatever the number of events, and advancing the time
+only touches the slots passed. Events further than 18 hours are parked in the last level until they come closer.*/
+class TimerWheel
+{
+public:
+	typedef unsigned long t_id; // 0 is never returned
+
+public:
+	 TimerWheel();
+	~TimerWheel();
+
+private:
+	TimerWheel(const TimerWheel&);
+	TimerWheel& operator=(const TimerWheel&);
+
+public:
+	// deadline and period in ms, a period of 0 fires once. A deadline already passed fires at the next tick
+	t_id Schedule(TimerEvent_ABC* /*listener*/, const Timer::t_time /*deadline*/, const Timer::t_time period = 0);
+	bool Cancel(const t_id /*id*/); // false if the event already fired or was cancelled
+	void Advance(const Timer::t_time /*time*/); // fires the events due up to time, millisecond by millisecond, listeners may schedule and cancel
+	void Clear(const Timer::t_time time = 0); // drops every event and restarts at time
+	unsigned int GetNumEvents() const;
+
+private:
+	std::auto_ptr<TimerWheelPImpl> pImpl_;
+};
+
+#endif //_CLASS_TIMERWHEEL
@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef WIN32
+MappedFile::MappedFile(const std::string& filename)
+	: open_(false)
+	, data_(0)
+	, size_(0)
+	, file_(INVALID_HANDLE_VALUE)
+	, mapping_(0)
+{
+	file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	LARGE_INTEGER size;
+	if(file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size))
+	{
+		return;
+	}
+	size_ = (std::size_t)size.QuadPart;
+	open_ = true;
+	// an empty file cannot be mapped
+	if(size_ > 0)
+	{
+		mapping_ = CreateFileMappingA(file_, 0, PAGE_READONLY, 0, 0, 0);
+		data_ = mapping_ ? (const char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0) : 0;
+		open_ = data_ != 0;
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if(data_)
+	{
+		UnmapViewOfFile(data_);
+	}
+	if(mapping_)
+	{
+		CloseHandle(mapping_);
+	}
+	if(file_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file_);
+	}
+}
+#else
+MappedFile::MappedFile(const std::string& filename)
+	: open_(false)
+	, data_(0)
+	, size_(0)
+{
+	int file = open(filename.c_str(), O_RDONLY);
+	struct stat status;
+	if(file < 0)
+	{
+		return;
+	}
+	if(fstat(file, &status) == 0)
+	{
+		size_ = (std::size_t)status.st_size;
+		open_ = true;
+		// an empty file cannot be mapped
+		if(size_ > 0)
+		{
+			void* data = mmap(0, size_, PROT_READ, MAP_PRIVATE, file, 0);
+			open_ = data != MAP_FAILED;
+			if(open_)
+			{
+				madvise(data, size_, MADV_SEQUENTIAL);
+				data_ = (const char*)data;
+			}
+		}
+	}
+	// the mapping stays valid once the descriptor is closed
+	close(file);
+}
+
+MappedFile::~MappedFile()
+{
+	if(data_)
+	{
+		munmap((void*)data_, size_);
+	}
+}
+#endif
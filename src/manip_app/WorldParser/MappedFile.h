@@ -0,0 +1,34 @@
+
+#ifndef _CLASS_MAPPEDFILE
+#define _CLASS_MAPPEDFILE
+
+#include <string>
+
+/* Read only view of a whole file, mapped in memory as long as the object lives.
+The content is not null terminated.*/
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& /*filename*/);
+	~MappedFile();
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	bool IsOpen() const { return open_; }
+	const char* GetData() const { return data_; }
+	std::size_t GetSize() const { return size_; }
+
+private:
+	bool open_;
+	const char* data_;
+	std::size_t size_;
+#ifdef WIN32
+	void* file_;
+	void* mapping_;
+#endif
+};
+
+#endif //_CLASS_MAPPEDFILE
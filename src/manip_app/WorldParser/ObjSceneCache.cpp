@@ -0,0 +1,106 @@
+#include "ObjSceneCache.h"
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace
+{
+	const char magic[4] = {'M', 'O', 'B', 'J'};
+	const unsigned int version = 1;
+
+	struct ObjSceneHeader
+	{
+		char magic_[4];
+		unsigned int version_;
+		unsigned long long sourceSize_;
+		long long sourceTime_;
+		unsigned long long nbRecords_;
+	};
+
+	bool ReadSource(const std::string& filename, ObjSceneHeader& header)
+	{
+		struct stat status;
+		if(stat(filename.c_str(), &status) != 0)
+		{
+			return false;
+		}
+		memcpy(header.magic_, magic, sizeof(magic));
+		header.version_ = version;
+		header.sourceSize_ = (unsigned long long)status.st_size;
+		header.sourceTime_ = (long long)status.st_mtime;
+		header.nbRecords_ = 0;
+		return true;
+	}
+}
+
+ObjSceneCache::ObjSceneCache(const std::string& objFile)
+	: objFile_(objFile)
+	, cacheFile_(objFile + ".cache")
+	, records_(0)
+	, nbRecords_(0)
+{
+	// NOTHING
+}
+
+ObjSceneCache::~ObjSceneCache()
+{
+	// NOTHING
+}
+
+bool ObjSceneCache::Load()
+{
+	ObjSceneHeader expected;
+	if(!ReadSource(objFile_, expected))
+	{
+		return false;
+	}
+	mapped_.reset(new MappedFile(cacheFile_));
+	if(!mapped_->IsOpen() || mapped_->GetSize() < sizeof(ObjSceneHeader))
+	{
+		mapped_.reset();
+		return false;
+	}
+	const ObjSceneHeader* header = (const ObjSceneHeader*)mapped_->GetData();
+	// a cache interrupted while written has less records than announced
+	if(memcmp(header->magic_, expected.magic_, sizeof(magic)) != 0 || header->version_ != expected.version_
+		|| header->sourceSize_ != expected.sourceSize_ || header->sourceTime_ != expected.sourceTime_
+		|| mapped_->GetSize() != sizeof(ObjSceneHeader) + header->nbRecords_ * sizeof(ObjSceneRecord))
+	{
+		mapped_.reset();
+		return false;
+	}
+	records_ = (const ObjSceneRecord*)(mapped_->GetData() + sizeof(ObjSceneHeader));
+	nbRecords_ = (std::size_t)header->nbRecords_;
+	return true;
+}
+
+bool ObjSceneCache::Write(const T_ObjSceneRecords& records) const
+{
+	ObjSceneHeader header;
+	if(!ReadSource(objFile_, header))
+	{
+		return false;
+	}
+	header.nbRecords_ = records.size();
+	std::ofstream file(cacheFile_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+	{
+		return false;
+	}
+	file.write((const char*)&header, sizeof(header));
+	if(!records.empty())
+	{
+		file.write((const char*)&records[0], records.size() * sizeof(ObjSceneRecord));
+	}
+	file.close();
+	if(file.fail())
+	{
+		remove(cacheFile_.c_str());
+		return false;
+	}
+	return true;
+}
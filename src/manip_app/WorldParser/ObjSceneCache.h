@@ -0,0 +1,54 @@
+
+#ifndef _CLASS_OBJSCENECACHE
+#define _CLASS_OBJSCENECACHE
+
+#include "MappedFile.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/* What an obj file creates, in order: the obstacles and the draw attributes set before them.
+Plain values only so that records can be read from a mapped file.*/
+struct ObjSceneRecord
+{
+	enum eType
+	{
+		texture = 0,
+		color,   // and transparency
+		obstacle
+	};
+
+	int type_;
+	int texture_;
+	float color_[4];    // r, g, b, transparency
+	double points_[12]; // upLeft, upRight, downRight, downLeft
+};
+
+typedef std::vector<ObjSceneRecord> T_ObjSceneRecords;
+
+/* Binary copy of the records of an obj file, written next to it (<file>.cache).
+It is only used while the obj file keeps the size and modification time it had when the copy was written.
+Values are stored in the byte order of the machine.*/
+class ObjSceneCache
+{
+public:
+	explicit ObjSceneCache(const std::string& /*objFile*/);
+	~ObjSceneCache();
+
+public:
+	bool Load(); // maps the cache, false if missing or out of date
+	const ObjSceneRecord* GetRecords() const { return records_; }
+	std::size_t GetNumRecords() const { return nbRecords_; }
+
+	bool Write(const T_ObjSceneRecords& /*records*/) const;
+
+private:
+	const std::string objFile_;
+	const std::string cacheFile_;
+	std::auto_ptr<MappedFile> mapped_;
+	const ObjSceneRecord* records_;
+	std::size_t nbRecords_;
+};
+
+#endif //_CLASS_OBJSCENECACHE
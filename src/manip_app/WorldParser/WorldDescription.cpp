@@ -0,0 +1,49 @@
+#include "WorldDescription.h"
+
+WorldDescription::WorldDescription()
+	: startPaused_(false)
+	, type_(0)
+	, nbSamples_(10000)
+	, speed_(0)
+	, gait_(false)
+	, jointLimit_(false)
+	, autoRotate_(false)
+	, autoRotateLeg_(false)
+	, jumpToTarget_(false)
+	, drawSplines_(false)
+	, drawEllipseAxes_(false)
+	, drawEllipsoid_(false)
+	, drawNormals_(false)
+	, rotateWithSpline_(false)
+	, rotateWithSplineDir_(false)
+	, reachCom_(false)
+	, reachComY_(false)
+	, reachComRotate_(false)
+	, humanRotate_(false)
+	, planif_(false)
+	, footstepHorizon_(0)
+	, rootIterations_(0)
+	, initTimer_(0)
+	, objGround_(false)
+	, drawShadows_(false)
+	, drawSky_(false)
+	, drawGround_(false)
+	, obstacleOffset_(false)
+{
+	for(int i = 0; i < 3; ++i)
+	{
+		position_[i] = 0;
+		rotation_[i] = 0;
+		initDir_[i] = 0;
+		cameraRotation_[i] = 0;
+		background_[i] = 1;
+	}
+	initDir_[0] = 1;
+	camera_[0] = -13; camera_[1] = 0; camera_[2] = 5;
+	light_[0] = -1; light_[1] = 0.4f;
+}
+
+WorldDescription::~WorldDescription()
+{
+	// NOTHING
+}
@@ -0,0 +1,94 @@
+
+#ifndef _CLASS_WORLDDESCRIPTION
+#define _CLASS_WORLDDESCRIPTION
+
+#include "MatrixDefs.h"
+
+#include <string>
+#include <vector>
+
+/* Child of <obstacles>, kept in the file order since colors and textures apply to the next obstacles.*/
+struct WorldElement
+{
+	enum eType
+	{
+		obstacle = 0,
+		ground,
+		verticalChess,
+		prise,
+		color,
+		texture
+	};
+
+	int type_;
+	int index_;        // depth of a vertical chess, index of a texture
+	float values_[12]; // p0 to p3, or r, g, b and transparency of a color
+};
+
+/* Content of a world file, whether xml or binary, before the simulation is configured with it.
+Defaults are the ones of SimParams and of the optional attributes.*/
+struct WorldDescription
+{
+	typedef std::vector<double> T_JointValues;
+	typedef std::vector<T_JointValues> T_TreeValues;
+	typedef std::vector<matrices::Vector3, Eigen::aligned_allocator<matrices::Vector3> > T_Waypoints;
+	typedef std::vector<WorldElement> T_Elements;
+
+	 WorldDescription();
+	~WorldDescription();
+
+	bool startPaused_;
+
+	// robot
+	int type_;
+	std::string robotFile_;
+	int nbSamples_;
+	float position_[3];
+	float rotation_[3]; // degrees
+	float initDir_[3];
+	float speed_;
+	bool gait_;
+	bool jointLimit_;
+	bool autoRotate_;
+	bool autoRotateLeg_;
+	bool jumpToTarget_;
+	bool drawSplines_;
+	bool drawEllipseAxes_;
+	bool drawEllipsoid_;
+	bool drawNormals_;
+	bool rotateWithSpline_;
+	bool rotateWithSplineDir_;
+	bool reachCom_;
+	bool reachComY_;
+	bool reachComRotate_;
+	bool humanRotate_;
+	bool planif_;
+	unsigned int footstepHorizon_;
+	unsigned int rootIterations_;
+	T_TreeValues treeValues_; // radians
+	std::vector<int> locked_;
+
+	// root trajectory
+	double initTimer_;
+	T_Waypoints waypoints_;
+
+	// obj
+	std::string obj_;
+	bool objGround_;
+
+	// display
+	std::string cameraType_;
+	float camera_[3];
+	float cameraRotation_[3];
+	float light_[2];
+	bool drawShadows_;
+	float background_[3];
+	bool drawSky_;
+	bool drawGround_;
+
+	// obstacles
+	bool obstacleOffset_;
+	T_Elements elements_;
+};
+
+#endif //_CLASS_WORLDDESCRIPTION
@@ -1,5 +1,7 @@
 #include "WorldParser.h"
 #include "WorldParserObj.h"
+#include "WorldParserXml.h"
+#include "WorldParserBinary.h"
 #include "spline/exact_cubic.h"
 
 
@@ -9,6 +11,10 @@
 
 #include "Pi.h"
 
+#include <xeumeuleu/xml.hpp>
+
+#include <iostream>
+
 using namespace matrices;
 
 WorldParser::WorldParser()
@@ -62,7 +68,7 @@ WorldParser::~WorldParser()
   </obstacles>
 </world>*/
 
-void WorldParser::InitWorld(const std::string& filename){
+bool WorldParser::InitWorld(const std::string& filename){
 	std::string file;
 	xml::xifstream xis(filename);
 	xis >> xml::start("program")
@@ -70,203 +76,130 @@ void WorldParser::InitWorld(const std::string& filename){
 		>> xml::attribute("file", file)
 		>> xml::end
 		>> xml::end;
-	CreateWorld(file);
+	return CreateWorld(file);
 }
 
-void WorldParser::CreateWorld(const std::string& filename)
+bool WorldParser::CreateWorld(const std::string& filename)
 {
-	bool modePlanif = false;
-	int type; int nbSamples = 10000;
-	float iDirx = 1;
-	float iDiry = 0;
-	float iDirz = 0;
-	float backr = 1;
-	float backg = 1;
-	float backb = 1;
-	float x, y, z, rx, ry, rz;
-	float cx, cy, cz, crx, cry, crz;
-	float speed = 1/4;
-	std::string camType = "";
-	std::string robotFile = "";
-	bool ground(false);
-	bool gait(false);
-	bool autoRotate(false);
-	bool autoRotateLeg(false);
-	bool jumpToTarget(false);
-	bool drawSplines(false);
-	bool drawNormals(false);
-	bool rotatewithspline(false);
-	bool reachCom(false);
-	bool humanrotate(false);
-	bool rotatewithsplinedir(false);
-	std::vector<std::pair<double, Vector3> > splinePoints;
-	std::string obj = "";
+	WorldDescription description;
+	if(WorldParserBinary::IsBinary(filename))
+	{
+		if(!WorldParserBinary().Read(filename, description))
+		{
+			std::cerr << "corrupted world file " << filename << std::endl;
+			return false;
+		}
+	}
+	else
+	{
+		WorldParserXml().Read(filename, description);
+	}
+	CreateWorld(description);
+	return true;
+}
 
-	xml::xifstream xis( filename );
+void WorldParser::CreateWorld(const WorldDescription& d)
+{
+	SimParams& params = Simulation::GetInstance()->simpParams_;
+	params.pause_ = d.startPaused_;
+	params.joint_ = d.jointLimit_;
+	params.drawEllipseAxes_ = d.drawEllipseAxes_;
+	params.drawEllipsoid_ = d.drawEllipsoid_;
+	params.reachComY_ = d.reachComY_;
+	params.reachComRotate_ = d.reachComRotate_;
+	params.planif_ = d.planif_;
+	params.initTimer_ = d.initTimer_;
+	params.lightX = d.light_[0];
+	params.lightY = d.light_[1];
+	params.drawShadows_ = d.drawShadows_;
+	params.drawSky_ = d.drawSky_;
+	params.drawGround_ = d.drawGround_;
+	params.locked_.insert(params.locked_.end(), d.locked_.begin(), d.locked_.end());
+	values_ = d.treeValues_;
 
-	xis >> xml::start( "world" )
-			>> xml::optional 
-				>> xml::start( "startpaused" )
-				>> xml::attribute( "val", Simulation::GetInstance()->simpParams_.pause_ )
-				>> xml::end
-			>> xml::start( "robot" )
-				>> xml::optional 
-				>> xml::attribute( "type", type )
-				>> xml::optional 
-				>> xml::attribute( "robotFile", robotFile )
-				>> xml::optional 
-				>> xml::attribute( "samples", nbSamples )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-				>> xml::attribute( "rotx", rx )
-				>> xml::attribute( "roty", ry )
-				>> xml::attribute( "rotz", rz )
-				>> xml::optional 
-				>> xml::attribute( "iDirx", iDirx )
-				>> xml::optional 
-				>> xml::attribute( "iDiry", iDiry )
-				>> xml::optional 
-				>> xml::attribute( "iDirz", iDirz )
-				>> xml::optional 
-				>> xml::attribute( "gait", gait )
-				>> xml::optional 
-				>> xml::attribute( "jointlimit", Simulation::GetInstance()->simpParams_.joint_ )
-				>> xml::optional 
-				>> xml::attribute( "autorotate", autoRotate )
-				>> xml::optional 
-				>> xml::attribute( "autorotateleg", autoRotateLeg )
-				>> xml::optional 
-				>> xml::attribute( "jumptotarget", jumpToTarget )
-				>> xml::optional 
-				>> xml::attribute( "drawsplines", drawSplines )
-				>> xml::optional 
-				>> xml::attribute( "drawEllipseAxes", Simulation::GetInstance()->simpParams_.drawEllipseAxes_ )
-				>> xml::optional 
-				>> xml::attribute( "drawEllipsoid", Simulation::GetInstance()->simpParams_.drawEllipsoid_ )
-				>> xml::optional 
-				>> xml::attribute( "drawnormals", drawNormals )
-				>> xml::optional 
-				>> xml::attribute( "rotatewithspline", rotatewithspline )
-				>> xml::optional 
-				>> xml::attribute( "rotatewithsplinedir", rotatewithsplinedir )
-				>> xml::optional 
-				>> xml::attribute( "reachcom", reachCom )
-				>> xml::optional 
-				>> xml::attribute( "reachcomy", Simulation::GetInstance()->simpParams_.reachComY_ )
-				>> xml::optional 
-				>> xml::attribute( "reachcomrotate", Simulation::GetInstance()->simpParams_.reachComRotate_ )
-				>> xml::optional 
-				>> xml::attribute( "humanrotate", humanrotate )
-					>> xml::optional 
-					>> xml::list(*this, &WorldParser::ConfigureTree)
-				>> xml::optional 
-				>> xml::attribute( "speed", speed )
-				>> xml::optional 
-				>> xml::attribute( "planif", Simulation::GetInstance()->simpParams_.planif_ )
-			>> xml::end
-			>> xml::optional
-				>> xml::start( "rootTrajectory" )
-						>> xml::optional 
-						>> xml::attribute( "inittimer", Simulation::GetInstance()->simpParams_.initTimer_ )
-						>> xml::list(*this, &WorldParser::AddRootTrajectoryPoint, splinePoints)
-				>> xml::end
-			>> xml::optional 
-				>> xml::start( "obj" )
-					>> xml::attribute( "name", obj )
-					>> xml::optional 
-					>> xml::attribute( "ground", ground )
-				>> xml::end
-			>> xml::optional
-				>> xml::start( "camera" )					
-					>> xml::attribute( "x", cx )
-					>> xml::attribute( "y", cy )
-					>> xml::attribute( "z", cz )
-					>> xml::attribute( "rotx", crx )
-					>> xml::attribute( "roty", cry )
-					>> xml::attribute( "rotz", crz )
-					>> xml::optional 
-					>> xml::attribute( "type", camType )
-				>> xml::end
-			>> xml::optional 
-				>> xml::start( "light" )					
-					>> xml::attribute( "x", Simulation::GetInstance()->simpParams_.lightX )
-					>> xml::attribute( "y", Simulation::GetInstance()->simpParams_.lightY )
-					>> xml::attribute( "shadows", Simulation::GetInstance()->simpParams_.drawShadows_ )
-				>> xml::end
-			>> xml::optional 
-				>> xml::start( "background" )
-					>> xml::attribute( "r", backr )
-					>> xml::attribute( "g", backg )
-					>> xml::attribute( "b", backb )
-					>> xml::attribute( "sky", Simulation::GetInstance()->simpParams_.drawSky_ )
-					>> xml::attribute( "ground", Simulation::GetInstance()->simpParams_.drawGround_ )
-				>> xml::end
-			>> xml::start( "obstacles" )
-				>> xml::optional 
-				>> xml::attribute( "offSet", Simulation::GetInstance()->simpParams_.obstacleOffset_ )
-				>> xml::list(*this, &WorldParser::CreateObstacle)
-			>> xml::end;
-				
-	Simulation::GetInstance()->simpParams_.obstacleOffset_ = false;
-	if(obj != "")
+	params.obstacleOffset_ = d.obstacleOffset_;
+	for(WorldDescription::T_Elements::const_iterator it = d.elements_.begin(); it != d.elements_.end(); ++it)
+	{
+		CreateObstacle(*it);
+	}
+	params.obstacleOffset_ = false;
+	if(d.obj_ != "")
 	{
 		WorldParserObj objParse;
-		objParse.CreateWorld(obj, ground);
+		objParse.CreateWorld(d.obj_, d.objGround_);
 	}
 	Camera_ABC * camera;
-	if(camType == "follow")
+	Vector3 cameraPosition(d.camera_[0], d.camera_[1], d.camera_[2]);
+	Vector3 cameraRotation(d.cameraRotation_[0], d.cameraRotation_[1], d.cameraRotation_[2]);
+	if(d.cameraType_ == "follow")
 	{
-		camera = new CameraFollow(matrices::Vector3(cx, cy, cz), matrices::Vector3(crx, cry, crz));
+		camera = new CameraFollow(cameraPosition, cameraRotation);
 	}
 	else
 	{
-		camera = new Camera_ABC(matrices::Vector3(cx, cy, cz), matrices::Vector3(crx, cry, crz));
+		camera = new Camera_ABC(cameraPosition, cameraRotation);
+	}
+	params.SetCamera(camera);
+	params.initDir_ = Vector3(d.initDir_[0], d.initDir_[1], d.initDir_[2]);
+	params.autorotate_ = d.autoRotate_;
+	params.autorotateleg_ = !d.autoRotate_ && d.autoRotateLeg_;
+	params.jumpToTarget_ = d.jumpToTarget_;
+	params.footstepHorizon_ = d.footstepHorizon_;
+	params.rootIterations_ = d.rootIterations_;
+	params.drawSplines_ = d.drawSplines_;
+	params.drawNormals_ = d.drawNormals_;
+	params.reachCom_ = d.reachCom_;
+	params.nbSamples_ = d.nbSamples_;
+	params.speed_ = d.speed_;
+	params.gait_ = d.gait_;
+	params.rotatewithspline_ = d.rotateWithSpline_;
+	params.rotatewithsplinedir_ = d.rotateWithSplineDir_;
+	params.humanrotate_ = d.humanRotate_;
+	params.background_ = Vector3(d.background_[0], d.background_[1], d.background_[2]);
+	// waypoints are timed by their index
+	std::vector<std::pair<double, Vector3> > splinePoints;
+	for(WorldDescription::T_Waypoints::const_iterator it = d.waypoints_.begin(); it != d.waypoints_.end(); ++it)
+	{
+		splinePoints.push_back(std::make_pair((double)splinePoints.size(), *it));
 	}
-	Simulation::GetInstance()->simpParams_.SetCamera(camera);
-	Simulation::GetInstance()->simpParams_.initDir_ = Vector3(iDirx, iDiry, iDirz);
-	Simulation::GetInstance()->simpParams_.autorotate_ = autoRotate;
-	Simulation::GetInstance()->simpParams_.autorotateleg_ = !autoRotate && autoRotateLeg;
-	Simulation::GetInstance()->simpParams_.jumpToTarget_ = jumpToTarget;
-	Simulation::GetInstance()->simpParams_.drawSplines_ = drawSplines;
-	Simulation::GetInstance()->simpParams_.drawNormals_ = drawNormals;
-	Simulation::GetInstance()->simpParams_.reachCom_ = reachCom;
-	Simulation::GetInstance()->simpParams_.nbSamples_ = nbSamples;
-	Simulation::GetInstance()->simpParams_.speed_ = speed;
-	Simulation::GetInstance()->simpParams_.gait_ = gait;
-	Simulation::GetInstance()->simpParams_.rotatewithspline_ = rotatewithspline;
-	Simulation::GetInstance()->simpParams_.rotatewithsplinedir_ = rotatewithsplinedir;
-	Simulation::GetInstance()->simpParams_.humanrotate_ = humanrotate;
-	Simulation::GetInstance()->simpParams_.background_ = Vector3(backr, backg, backb);
 	if(splinePoints.size() > 1)
 	{
-		if(Simulation::GetInstance()->simpParams_.planif_)
+		if(params.planif_)
 		{
-			Simulation::GetInstance()->simpParams_.rootTrajectory_ = false;
+			params.rootTrajectory_ = false;
 			spline::exact_cubic<> tg (splinePoints.begin(), splinePoints.end());
 			float delta = (tg.max() - tg.min()) / 50;
+			std::vector<float> times;
+			std::vector<double> splineTimes;
 			for(float it = tg.min(); it < tg.max(); it = it + delta)
 			{
-				manager_.GetPostureManager()->AddCheckPoint(it, tg(it));
+				times.push_back(it);
+				splineTimes.push_back(it);
+			}
+			std::vector<Vector3, Eigen::aligned_allocator<Vector3> > positions(times.size());
+			if(!times.empty())
+			{
+				tg.evaluate(&splineTimes[0], splineTimes.size(), &positions[0]);
+				manager_.GetPostureManager()->AddCheckPoints(&times[0], &positions[0], (unsigned int)times.size());
 			}
 		}
 		else
 		{
-			Simulation::GetInstance()->simpParams_.rootTrajectory_ = true;
-			Simulation::GetInstance()->simpParams_.rootSpline = new spline::exact_cubic<>(splinePoints.begin(), splinePoints.end());
+			params.rootTrajectory_ = true;
+			params.rootSpline = new spline::exact_cubic<>(splinePoints.begin(), splinePoints.end());
 		}
 	}
 	else
 	{
-		Simulation::GetInstance()->simpParams_.rootTrajectory_ = false;
+		params.rootTrajectory_ = false;
 	}
-	if(robotFile.length() > 0)
+	if(d.robotFile_.length() > 0)
 	{
-		CreateRobot(robotFile, x, y, z, rx, ry, rz);
+		CreateRobot(d.robotFile_, d.position_[0], d.position_[1], d.position_[2], d.rotation_[0], d.rotation_[1], d.rotation_[2]);
 	}
 	else
 	{
-		CreateRobot(type, x, y, z, rx, ry, rz);
+		CreateRobot(d.type_, d.position_[0], d.position_[1], d.position_[2], d.rotation_[0], d.rotation_[1], d.rotation_[2]);
 	}
 	manager_.Initialize(true);
 }
@@ -322,169 +255,46 @@ void WorldParser::CreateRobot(const std::string& robotFile, const float x   , co
     Simulation::GetInstance()->simpParams_.angleValues_ = values_;*/
 }
 
-void WorldParser::ConfigureTree(const std::string& name, xml::xistream& xis)
+void WorldParser::CreateObstacle(const WorldElement& element) const
 {
-	int id;bool lock = false;
-	if(name == "tree")
+	const float* v = element.values_;
+	matrices::Vector3 p0(v[0], v[1], v[2]), p1(v[3], v[4], v[5]), p2(v[6], v[7], v[8]), p3(v[9], v[10], v[11]);
+	switch(element.type_)
 	{
-		xis >> xml::attribute( "id", id )
-			>> xml::optional 
-			>> xml::attribute( "lock", lock )
-			>> xml::list(*this, &WorldParser::ConfigureTreeJoint, id);
-		if(lock)
-			Simulation::GetInstance()->simpParams_.locked_.push_back(id);
-	}
-}
-
-void WorldParser::ConfigureTreeJoint(const std::string& name, xml::xistream& xis, int tree)
-{
-	int id; double val;
-	if(name == "joint")
-	{
-		xis >> xml::attribute( "id", id )
-			>> xml::attribute( "angle", val );
-		
-		if(tree<values_.size())
+		case WorldElement::obstacle:
 		{
-			values_[tree].push_back( val * DegreesToRadians);
+			manager_.AddObstacle(p0, p1, p2, p3);
+			break;
 		}
-		else
+		case WorldElement::ground:
 		{
-			T_JointValues vals;
-			vals.push_back(val * DegreesToRadians);
-			values_.push_back(vals);
+			manager_.AddGround(p0, p1, p2, p3);
+			break;
 		}
-	}
-
-}
-
-void WorldParser::AddRootTrajectoryPoint(const std::string& name, xml::xistream& xis, T_Waypoints& splinePoints) const
-{
-	double x, y, z, t;
-	if(name == "waypoint")
-	{
-		xis >> xml::attribute( "x", x )
-			>> xml::attribute( "y", y )
-			>> xml::attribute( "z", z )
-			>> xml::attribute( "t", t );
-	}
-	t = splinePoints.size() ;
-	splinePoints.push_back(std::make_pair(t, Vector3(x, y, z)));
-}
-
-void WorldParser::CreateObstacle(const std::string& name, xml::xistream& xis) const
-{
-	matrices::Vector3 p0, p1, p2, p3;
-	float x, y, z;
-	if(name == "obstacle")
-	{
-		xis >> xml::start( "p0" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p0 = Vector3(x, y, z);
-		xis >> xml::start( "p1" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p1 = Vector3(x, y, z);
-		xis >> xml::start( "p2" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p2 = Vector3(x, y, z);
-		xis >> xml::start( "p3" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p3 = Vector3(x, y, z);
-
-		manager_.AddObstacle(p0, p1, p2, p3);
-	}
-	if(name == "ground")
-	{
-		xis >> xml::start( "p0" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p0 = Vector3(x, y, z);
-		xis >> xml::start( "p1" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p1 = Vector3(x, y, z);
-		xis >> xml::start( "p2" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p2 = Vector3(x, y, z);
-		xis >> xml::start( "p3" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p3 = Vector3(x, y, z);
-
-		
-		manager_.AddGround(p0, p1, p2, p3);
-	}
-	if(name == "verticalchess")
-	{
-		unsigned int depth;
-		xis >> xml::attribute( "depth", depth )
-		>>xml::start( "p0" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p0 = Vector3(x, y, z);
-		xis >> xml::start( "p1" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p1 = Vector3(x, y, z);
-		manager_.GenerateVerticalChess(p0, p1, depth);
-	}
-	if(name == "prise")
-	{
-		xis >>xml::start( "p0" )
-				>> xml::attribute( "x", x )
-				>> xml::attribute( "y", y )
-				>> xml::attribute( "z", z )
-		>> xml::end;
-		p0 = Vector3(x, y, z);
-		Vector3 pu(p0(0), p0(1)+0.1, p0(2)+0.1);
-		Vector3 pb(p0(0), p0(1)-0.1, p0(2)-0.1);
-		manager_.GenerateVerticalChess(pu, pb, 0);
-	}
-	if(name == "color")
-	{
-		float r, g, b, t;
-		xis >>xml::start( "p0" )
-				>> xml::attribute( "r", r )
-				>> xml::attribute( "g", g )
-				>> xml::attribute( "b", b )
-				>> xml::attribute( "t", t )
-		>> xml::end;
-		manager_.SetNextColor(r, g, b);
-		manager_.SetNextTransparency(t);
-
-	}
-	if(name == "texture")
-	{
-		int tex = 0;
-		xis >>xml::start( "p0" )
-				>> xml::attribute( "index", tex )
-		>> xml::end;
-		manager_.SetNextTexture(tex);
-
+		case WorldElement::verticalChess:
+		{
+			manager_.GenerateVerticalChess(p0, p1, (unsigned int)element.index_);
+			break;
+		}
+		case WorldElement::prise:
+		{
+			Vector3 pu(p0(0), p0(1)+0.1, p0(2)+0.1);
+			Vector3 pb(p0(0), p0(1)-0.1, p0(2)-0.1);
+			manager_.GenerateVerticalChess(pu, pb, 0);
+			break;
+		}
+		case WorldElement::color:
+		{
+			manager_.SetNextColor(v[0], v[1], v[2]);
+			manager_.SetNextTransparency(v[3]);
+			break;
+		}
+		case WorldElement::texture:
+		{
+			manager_.SetNextTexture(element.index_);
+			break;
+		}
+		default:
+			break;
 	}
 }
@@ -4,8 +4,7 @@
 
 #include "ManipManager.h"
 #include "MatrixDefs.h"
-
-#include <xeumeuleu/xml.hpp>
+#include "WorldDescription.h"
 
 #include <string>
 
@@ -52,20 +51,18 @@ public:
 	 WorldParser();
 	~WorldParser();
 
-	void InitWorld(const std::string& filename);
-	void CreateWorld(const std::string& filename);
+	bool InitWorld(const std::string& filename);
+	/* Either the xml above or its binary copy written by manip_worldc, which is loaded without xerces.
+	False if a binary file is corrupted.*/
+	bool CreateWorld(const std::string& filename);
 
 private:
-	typedef std::vector<std::pair<double, matrices::Vector3> > T_Waypoints;
-private:
+	void CreateWorld       (const WorldDescription& /*description*/);
 	void CreateRobot       (const int /*type*/, const float /*x*/, const float /*y*/, const float /*z*/
 											  , const float /*rx*/, const float /*ry*/, const float /*rz*/) const;
 	void CreateRobot       (const std::string& /*type*/, const float /*x*/, const float /*y*/, const float /*z*/
 											  , const float /*rx*/, const float /*ry*/, const float /*rz*/) const;
-	void CreateObstacle    (const std::string& /*name*/, xml::xistream& /*xis*/) const;
-	void ConfigureTree     (const std::string& /*name*/, xml::xistream& /*xis*/);
-	void ConfigureTreeJoint(const std::string& /*name*/, xml::xistream& /*xis*/, int tree);
-	void AddRootTrajectoryPoint(const std::string& /*name*/, xml::xistream& /*xis*/, T_Waypoints& /*splinePoints*/) const;
+	void CreateObstacle    (const WorldElement& /*element*/) const;
 
 private:
 	manip_core::ManipManager& manager_;
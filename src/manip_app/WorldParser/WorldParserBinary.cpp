@@ -0,0 +1,263 @@
+#include "WorldParserBinary.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+
+using namespace matrices;
+
+namespace
+{
+	const char magic[4] = {'M', 'W', 'L', 'D'};
+	const unsigned int version = 3;
+
+	struct Writer
+	{
+		template<typename T>
+		void Put(const T& value)
+		{
+			buffer_.append((const char*)&value, sizeof(T));
+		}
+
+		void Put(const bool value)
+		{
+			Put((unsigned char)(value ? 1 : 0));
+		}
+
+		void Put(const std::string& value)
+		{
+			Put((unsigned int)value.size());
+			buffer_.append(value);
+		}
+
+		template<typename T>
+		void Put(const T* values, const unsigned int size)
+		{
+			buffer_.append((const char*)values, size * sizeof(T));
+		}
+
+		std::string buffer_;
+	};
+
+	// every read fails once the end is passed
+	struct Reader
+	{
+		Reader(const char* data, const std::size_t size)
+			: cursor_(data)
+			, end_(data + size)
+			, failed_(false)
+		{
+			// NOTHING
+		}
+
+		bool GetBytes(void* value, const std::size_t size)
+		{
+			if(failed_ || (std::size_t)(end_ - cursor_) < size)
+			{
+				failed_ = true;
+				return false;
+			}
+			memcpy(value, cursor_, size);
+			cursor_ += size;
+			return true;
+		}
+
+		template<typename T>
+		void Get(T& value)
+		{
+			GetBytes(&value, sizeof(T));
+		}
+
+		void Get(bool& value)
+		{
+			unsigned char res = 0;
+			Get(res);
+			value = res != 0;
+		}
+
+		void Get(std::string& value)
+		{
+			unsigned int size = 0;
+			Get(size);
+			if(!failed_ && (std::size_t)(end_ - cursor_) >= size)
+			{
+				value.assign(cursor_, size);
+				cursor_ += size;
+			}
+			else
+			{
+				failed_ = true;
+			}
+		}
+
+		template<typename T>
+		void Get(T* values, const unsigned int size)
+		{
+			GetBytes(values, size * sizeof(T));
+		}
+
+		// count of a vector, bounded by the bytes left so that a corrupted count cannot exhaust the memory
+		unsigned int GetCount(const std::size_t itemSize)
+		{
+			unsigned int count = 0;
+			Get(count);
+			if(failed_ || count > (std::size_t)(end_ - cursor_) / itemSize)
+			{
+				failed_ = true;
+				return 0;
+			}
+			return count;
+		}
+
+		bool Valid() const
+		{
+			return !failed_;
+		}
+
+		const char* cursor_;
+		const char* end_;
+		bool failed_;
+	};
+}
+
+WorldParserBinary::WorldParserBinary()
+{
+	// NOTHING
+}
+
+WorldParserBinary::~WorldParserBinary()
+{
+	// NOTHING
+}
+
+bool WorldParserBinary::IsBinary(const std::string& filename)
+{
+	char header[sizeof(magic)];
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	return file.read(header, sizeof(header)) && memcmp(header, magic, sizeof(magic)) == 0;
+}
+
+bool WorldParserBinary::Write(const std::string& filename, const WorldDescription& d) const
+{
+	Writer w;
+	w.Put(magic, sizeof(magic));
+	w.Put(version);
+	w.Put(d.startPaused_);
+
+	w.Put(d.type_); w.Put(d.robotFile_); w.Put(d.nbSamples_);
+	w.Put(d.position_, 3); w.Put(d.rotation_, 3); w.Put(d.initDir_, 3);
+	w.Put(d.speed_);
+	w.Put(d.gait_); w.Put(d.jointLimit_); w.Put(d.autoRotate_); w.Put(d.autoRotateLeg_);
+	w.Put(d.jumpToTarget_); w.Put(d.drawSplines_); w.Put(d.drawEllipseAxes_); w.Put(d.drawEllipsoid_);
+	w.Put(d.drawNormals_); w.Put(d.rotateWithSpline_); w.Put(d.rotateWithSplineDir_); w.Put(d.reachCom_);
+	w.Put(d.reachComY_); w.Put(d.reachComRotate_); w.Put(d.humanRotate_); w.Put(d.planif_);
+	w.Put(d.footstepHorizon_); w.Put(d.rootIterations_);
+	w.Put((unsigned int)d.treeValues_.size());
+	for(WorldDescription::T_TreeValues::const_iterator it = d.treeValues_.begin(); it != d.treeValues_.end(); ++it)
+	{
+		w.Put((unsigned int)it->size());
+		if(!it->empty())
+		{
+			w.Put(&(*it)[0], (unsigned int)it->size());
+		}
+	}
+	w.Put((unsigned int)d.locked_.size());
+	if(!d.locked_.empty())
+	{
+		w.Put(&d.locked_[0], (unsigned int)d.locked_.size());
+	}
+
+	w.Put(d.initTimer_);
+	w.Put((unsigned int)d.waypoints_.size());
+	for(WorldDescription::T_Waypoints::const_iterator it = d.waypoints_.begin(); it != d.waypoints_.end(); ++it)
+	{
+		w.Put((double)it->x()); w.Put((double)it->y()); w.Put((double)it->z());
+	}
+
+	w.Put(d.obj_); w.Put(d.objGround_);
+
+	w.Put(d.cameraType_); w.Put(d.camera_, 3); w.Put(d.cameraRotation_, 3);
+	w.Put(d.light_, 2); w.Put(d.drawShadows_);
+	w.Put(d.background_, 3); w.Put(d.drawSky_); w.Put(d.drawGround_);
+
+	w.Put(d.obstacleOffset_);
+	w.Put((unsigned int)d.elements_.size());
+	for(WorldDescription::T_Elements::const_iterator it = d.elements_.begin(); it != d.elements_.end(); ++it)
+	{
+		w.Put(it->type_); w.Put(it->index_); w.Put(it->values_, 12);
+	}
+
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+	{
+		return false;
+	}
+	file.write(w.buffer_.data(), w.buffer_.size());
+	file.close();
+	return !file.fail();
+}
+
+bool WorldParserBinary::Read(const std::string& filename, WorldDescription& d) const
+{
+	MappedFile file(filename);
+	if(!file.IsOpen())
+	{
+		return false;
+	}
+	Reader r(file.GetData(), file.GetSize());
+	char header[sizeof(magic)];
+	unsigned int fileVersion = 0;
+	r.GetBytes(header, sizeof(header));
+	r.Get(fileVersion);
+	if(!r.Valid() || memcmp(header, magic, sizeof(magic)) != 0 || fileVersion != version)
+	{
+		return false;
+	}
+	r.Get(d.startPaused_);
+
+	r.Get(d.type_); r.Get(d.robotFile_); r.Get(d.nbSamples_);
+	r.Get(d.position_, 3); r.Get(d.rotation_, 3); r.Get(d.initDir_, 3);
+	r.Get(d.speed_);
+	r.Get(d.gait_); r.Get(d.jointLimit_); r.Get(d.autoRotate_); r.Get(d.autoRotateLeg_);
+	r.Get(d.jumpToTarget_); r.Get(d.drawSplines_); r.Get(d.drawEllipseAxes_); r.Get(d.drawEllipsoid_);
+	r.Get(d.drawNormals_); r.Get(d.rotateWithSpline_); r.Get(d.rotateWithSplineDir_); r.Get(d.reachCom_);
+	r.Get(d.reachComY_); r.Get(d.reachComRotate_); r.Get(d.humanRotate_); r.Get(d.planif_);
+	r.Get(d.footstepHorizon_); r.Get(d.rootIterations_);
+	d.treeValues_.resize(r.GetCount(sizeof(unsigned int)));
+	for(WorldDescription::T_TreeValues::iterator it = d.treeValues_.begin(); it != d.treeValues_.end(); ++it)
+	{
+		it->resize(r.GetCount(sizeof(double)));
+		if(!it->empty())
+		{
+			r.Get(&(*it)[0], (unsigned int)it->size());
+		}
+	}
+	d.locked_.resize(r.GetCount(sizeof(int)));
+	if(!d.locked_.empty())
+	{
+		r.Get(&d.locked_[0], (unsigned int)d.locked_.size());
+	}
+
+	r.Get(d.initTimer_);
+	d.waypoints_.resize(r.GetCount(3 * sizeof(double)));
+	for(WorldDescription::T_Waypoints::iterator it = d.waypoints_.begin(); it != d.waypoints_.end(); ++it)
+	{
+		double x = 0, y = 0, z = 0;
+		r.Get(x); r.Get(y); r.Get(z);
+		*it = Vector3(x, y, z);
+	}
+
+	r.Get(d.obj_); r.Get(d.objGround_);
+
+	r.Get(d.cameraType_); r.Get(d.camera_, 3); r.Get(d.cameraRotation_, 3);
+	r.Get(d.light_, 2); r.Get(d.drawShadows_);
+	r.Get(d.background_, 3); r.Get(d.drawSky_); r.Get(d.drawGround_);
+
+	r.Get(d.obstacleOffset_);
+	d.elements_.resize(r.GetCount(2 * sizeof(int) + 12 * sizeof(float)));
+	for(WorldDescription::T_Elements::iterator it = d.elements_.begin(); it != d.elements_.end(); ++it)
+	{
+		r.Get(it->type_); r.Get(it->index_); r.Get(it->values_, 12);
+	}
+	return r.Valid();
+}
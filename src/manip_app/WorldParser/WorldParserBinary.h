@@ -0,0 +1,23 @@
+
+#ifndef _CLASS_WORLDPARSERBINARY
+#define _CLASS_WORLDPARSERBINARY
+
+#include "WorldDescription.h"
+
+#include <string>
+
+/* Compact copy of an xml world, loaded without xerces. manip_worldc writes it from the xml.
+Values are stored in the byte order of the machine.*/
+struct WorldParserBinary
+{
+public:
+	 WorldParserBinary();
+	~WorldParserBinary();
+
+	static bool IsBinary(const std::string& /*filename*/);
+
+	bool Read (const std::string& /*filename*/, WorldDescription& /*description*/) const; // false if the file is truncated or of another version
+	bool Write(const std::string& /*filename*/, const WorldDescription& /*description*/) const;
+};
+
+#endif //_CLASS_WORLDPARSERBINARY
@@ -3,9 +3,9 @@
 #include "Simulation.h"
 
 #include <iostream>
-#include <fstream>
-#include <string>
-#include <stdlib.h>
+#include <algorithm>
+#include <cstring>
+#include <math.h>
 
 using namespace matrices;
 using namespace std;
@@ -23,104 +23,268 @@ WorldParserObj::~WorldParserObj()
 
 namespace
 {
-string doubleSlash(const string& s)
-{
-    //Remplace "//" par "/1/".
-    string s1="";
-    for(unsigned int i=0;i<s.size();i++)
-    {
-        if(i<s.size()-1&&s[i]=='/'&&s[i+1]=='/')
-        {
-            s1+="/1/";
-            i++;
-        }
-        else
-            s1+=s[i];
-    }
-    return s1;
-}
+	const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
 
-string remplacerSlash(const string& s)
-{
-    //Remplace les '/' par des espaces.
-    string ret="";
-    for(unsigned int i=0;i<s.size();i++)
-    {
-        if(s[i]=='/')
-            ret+=' ';
-        else
-            ret+=s[i];
-    }
-    return ret;
+	// digits beyond are not significant for a double
+	const unsigned long long maxMantissa = 100000000000000000ULL;
+
+	bool IsDigit(const char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	bool IsBlank(const char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	void SkipBlanks(const char*& cursor, const char* end)
+	{
+		while(cursor != end && IsBlank(*cursor))
+		{
+			++cursor;
+		}
+	}
+
+	double Power10(const int exponent)
+	{
+		return exponent < 23 ? powers[exponent] : pow(10., exponent);
+	}
+
+	// strtod without locale, the mapped file is not null terminated
+	double ReadNumber(const char*& cursor, const char* end)
+	{
+		SkipBlanks(cursor, end);
+		bool negative = false;
+		if(cursor != end && (*cursor == '-' || *cursor == '+'))
+		{
+			negative = *cursor == '-';
+			++cursor;
+		}
+		unsigned long long mantissa = 0;
+		int exponent = 0;
+		for(; cursor != end && IsDigit(*cursor); ++cursor)
+		{
+			if(mantissa < maxMantissa)
+			{
+				mantissa = mantissa * 10 + (*cursor - '0');
+			}
+			else
+			{
+				++exponent;
+			}
+		}
+		if(cursor != end && *cursor == '.')
+		{
+			for(++cursor; cursor != end && IsDigit(*cursor); ++cursor)
+			{
+				if(mantissa < maxMantissa)
+				{
+					mantissa = mantissa * 10 + (*cursor - '0');
+					--exponent;
+				}
+			}
+		}
+		if(cursor != end && (*cursor == 'e' || *cursor == 'E'))
+		{
+			++cursor;
+			bool negativeExponent = false;
+			if(cursor != end && (*cursor == '-' || *cursor == '+'))
+			{
+				negativeExponent = *cursor == '-';
+				++cursor;
+			}
+			int value = 0;
+			for(; cursor != end && IsDigit(*cursor); ++cursor)
+			{
+				if(value < 10000)
+				{
+					value = value * 10 + (*cursor - '0');
+				}
+			}
+			exponent += negativeExponent ? -value : value;
+		}
+		double res = (double)mantissa;
+		if(mantissa != 0 && exponent != 0)
+		{
+			// dividing by an exact power of 10 rounds better than multiplying by its inverse
+			res = exponent < 0 ? res / Power10(-exponent) : res * Power10(exponent);
+		}
+		return negative ? -res : res;
+	}
+
+	// first index of a vertex, "v", "v/vt", "v//vn" or "v/vt/vn", 0 based
+	long ReadIndex(const char*& cursor, const char* end, const std::size_t nbPoints)
+	{
+		SkipBlanks(cursor, end);
+		bool negative = cursor != end && *cursor == '-';
+		if(negative)
+		{
+			++cursor;
+		}
+		long value = 0;
+		bool read = false;
+		for(; cursor != end && IsDigit(*cursor); ++cursor)
+		{
+			value = value * 10 + (*cursor - '0');
+			read = true;
+		}
+		while(cursor != end && !IsBlank(*cursor))
+		{
+			++cursor;
+		}
+		if(!read)
+		{
+			return -1;
+		}
+		// negative indices are relative to the last vertex read
+		return negative ? (long)nbPoints - value : value - 1;
+	}
+
+	// moves the cursor after the prefix when the line starts with it
+	bool ReadPrefix(const char*& cursor, const char* end, const char* prefix)
+	{
+		const char* current = cursor;
+		for(; *prefix; ++prefix, ++current)
+		{
+			if(current == end || *current != *prefix)
+			{
+				return false;
+			}
+		}
+		cursor = current;
+		return true;
+	}
 }
 
-vector<string> splitSpace(const string& s)
+void WorldParserObj::CreateWorld(const std::string& filename, const bool isGround)
 {
-    //Eclate une chane au niveau de ses espaces.
-    vector<string> ret;
-    string s1="";
-    for(unsigned int i=0;i<s.size();i++)
-    {
-        if(s[i]==' '||i==s.size()-1)
-        {
-            if(i==s.size()-1)
-                s1+=s[i];
-            ret.push_back(s1);
-            s1="";
-        }
-        else
-            s1+=s[i];
-    }
-    return ret;
-}
+	ObjSceneCache cache(filename);
+	if(cache.Load())
+	{
+		Replay(cache.GetRecords(), cache.GetNumRecords(), isGround);
+		return;
+	}
+	MappedFile file(filename);
+	if(file.IsOpen())
+	{
+		ParseObj(file.GetData(), file.GetData() + file.GetSize());
+		cache.Write(records_);
+		if(!records_.empty())
+		{
+			Replay(&records_[0], records_.size(), isGround);
+		}
+	}
 }
 
-void WorldParserObj::CreateWorld(const std::string& filename, const bool isGround)
+void WorldParserObj::ParseObj(const char* begin, const char* end)
 {
-	string line;
-    ifstream myfile (filename.c_str());
-	std::vector<std::string> lines;
-	if (myfile.is_open())
+	long indices[4];
+	int nbIndices = 0, nbFaces = 0;
+	const char* line = begin;
+	while(line != end)
 	{
-		while ( myfile.good() )
+		const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+		if(!lineEnd)
+		{
+			lineEnd = end;
+		}
+		const char* cursor = line;
+		if(ReadPrefix(cursor, lineEnd, "v "))
+		{
+			NUMBER x = ReadNumber(cursor, lineEnd);
+			NUMBER z = ReadNumber(cursor, lineEnd);
+			NUMBER y = ReadNumber(cursor, lineEnd);
+			points_.push_back(Vector3(-x, y, z));
+		}
+		else if(ReadPrefix(cursor, lineEnd, "vn "))
 		{
-			getline (myfile, line);
-			if(line.find("t ") == 0)
+			NUMBER x = ReadNumber(cursor, lineEnd);
+			NUMBER z = ReadNumber(cursor, lineEnd);
+			NUMBER y = ReadNumber(cursor, lineEnd);
+			normals_.push_back(Vector3(-x, y, z));
+		}
+		else if(ReadPrefix(cursor, lineEnd, "f "))
+		{
+			// the two triangles of a quad, their distinct vertices make the obstacle
+			SkipBlanks(cursor, lineEnd);
+			while(cursor != lineEnd)
+			{
+				long idx = ReadIndex(cursor, lineEnd, points_.size());
+				if(idx >= 0 && idx < (long)points_.size() && nbIndices < 4 && std::find(indices, indices + nbIndices, idx) == indices + nbIndices)
+				{
+					indices[nbIndices++] = idx;
+				}
+				SkipBlanks(cursor, lineEnd);
+			}
+			if(++nbFaces == 2)
 			{
-				char t[255];
-				sscanf(line.c_str(),"t %s",t);
-				manager_.SetNextTexture(strtod (t, NULL));
+				if(nbIndices == 4)
+				{
+					CreateObstacle(indices);
+				}
+				nbFaces = 0;
+				nbIndices = 0;
 			}
-			if(line.find("c ") == 0)
+		}
+		else if(ReadPrefix(cursor, lineEnd, "t "))
+		{
+			ObjSceneRecord record;
+			memset(&record, 0, sizeof(record));
+			record.type_ = ObjSceneRecord::texture;
+			record.texture_ = (int)ReadNumber(cursor, lineEnd);
+			records_.push_back(record);
+		}
+		else if(ReadPrefix(cursor, lineEnd, "c "))
+		{
+			ObjSceneRecord record;
+			memset(&record, 0, sizeof(record));
+			record.type_ = ObjSceneRecord::color;
+			for(int i = 0; i < 4; ++i)
 			{
-				char r[255],g[255],b[255],t[255];
-				sscanf(line.c_str(),"c %s %s %s %s",r,g,b,t);
-				manager_.SetNextColor(strtod (r, NULL), strtod(g, NULL), strtod(b, NULL));
-				manager_.SetNextTransparency(strtod (t, NULL));
+				record.color_[i] = (float)ReadNumber(cursor, lineEnd);
 			}
-			if(line.find("v ") == 0)
+			records_.push_back(record);
+		}
+		line = lineEnd == end ? end : lineEnd + 1;
+	}
+}
+
+void WorldParserObj::Replay(const ObjSceneRecord* records, const std::size_t nbRecords, const bool isGround)
+{
+	for(const ObjSceneRecord* record = records; record != records + nbRecords; ++record)
+	{
+		switch(record->type_)
+		{
+			case ObjSceneRecord::texture:
 			{
-				char x[255],y[255],z[255];
-				sscanf(line.c_str(),"v %s %s %s",x,z,y);
-				points_.push_back(Vector3(-strtod (x, NULL), strtod(y, NULL), strtod(z, NULL)));
+				manager_.SetNextTexture(record->texture_);
+				break;
 			}
-			if(line.find("vn ") == 0)
+			case ObjSceneRecord::color:
 			{
-				char x[255],y[255],z[255];
-				sscanf(line.c_str(),"vn %s %s %s",x,z,y);
-				normals_.push_back(Vector3(-strtod (x, NULL), strtod(y, NULL), strtod(z, NULL)));
+				manager_.SetNextColor(record->color_[0], record->color_[1], record->color_[2]);
+				manager_.SetNextTransparency(record->color_[3]);
+				break;
 			}
-			if(line.find("f ") == 0)
+			case ObjSceneRecord::obstacle:
 			{
-				lines.push_back(line);
-				if(lines.size() == 2)
+				const double* p = record->points_;
+				Vector3 upLeft(p[0], p[1], p[2]), upRight(p[3], p[4], p[5]), downRight(p[6], p[7], p[8]), downLeft(p[9], p[10], p[11]);
+				if(isGround)
 				{
-					CreateObstacle(lines, isGround);
-					lines.clear();
+					manager_.AddGround(upLeft, upRight, downRight, downLeft);
 				}
+				else
+				{
+					manager_.AddObstacle(upLeft, upRight, downRight, downLeft);
+				}
+				break;
 			}
+			default:
+				break;
 		}
-		myfile.close();
 	}
 }
 
@@ -182,27 +346,12 @@ namespace
 
 using namespace matrices;
 
-void WorldParserObj::CreateObstacle(const std::vector<std::string>& lines, bool isGround)
+void WorldParserObj::CreateObstacle(const long* indices)
 {
-	vector<long int> indices;
     T_Point points;
-	for(int i =0; i<2; ++i)
+	for(int i = 0; i < 4; ++i)
 	{
-		string ligne = doubleSlash(lines[i]);
-		ligne=remplacerSlash(ligne); //On remplace les '/' par des espaces, ex : pour "f 1/2/3 4/5/6 7/8/9" on obtiendra "f 1 2 3 4 5 6 7 8 9"
-		vector<string> termes=splitSpace(ligne.substr(2)); //On clate la chane en ses espaces (le substr permet d'enlever "f ")
-		int ndonnees=(int)termes.size()/3;
-		for(int i=0; i <ndonnees;i++) //On aurait trs bien pu mettre i<ndonnees mais je veux vraiment limiter  3 ou 4
-		{
-			long int idx = (strtol(termes[i*3].c_str(),NULL, 10)) - 1;
-			std::vector<long int>::iterator it = indices.begin();
-			it = find (indices.begin(), indices.end(), idx);
-			if(it == indices.end())
-			{
-				indices.push_back(idx);
-				points.push_back(points_[(int)idx]);
-			}
-		}
+		points.push_back(points_[(int)indices[i]]);
 	}
      
     //T_Point points;
@@ -260,27 +409,19 @@ void WorldParserObj::CreateObstacle(const std::vector<std::string>& lines, bool
 	v_ = transformedPoints[0] - transformedPoints[3];
 
 	normal = u_.cross(v_);
-	normals_[(int)indices[0]];
-	if(isGround)
+	// up when the file has less normals than vertices
+	Vector3 reference = indices[0] < (long)normals_.size() ? normals_[(int)indices[0]] : Vector3(0, 0, 1);
+	int order[4] = {0, 1, 2, 3};
+	if(normal.dot(reference) <= 0)
 	{
-		if(normal.dot(normals_[(int)indices[0]]) > 0 )
-		{
-			manager_.AddGround(transformedPoints[0], transformedPoints[1], transformedPoints[2], transformedPoints[3]);
-		}
-		else
-		{
-			manager_.AddGround(transformedPoints[2], transformedPoints[1], transformedPoints[0], transformedPoints[3]);
-		}
+		order[0] = 2; order[2] = 0;
 	}
-	else
+	ObjSceneRecord record;
+	memset(&record, 0, sizeof(record));
+	record.type_ = ObjSceneRecord::obstacle;
+	for(int i = 0; i < 4; ++i)
 	{
-		if(normal.dot(normals_[(int)indices[0]]) > 0 )
-		{
-			manager_.AddObstacle(transformedPoints[0], transformedPoints[1], transformedPoints[2], transformedPoints[3]);
-		}
-		else
-		{
-			manager_.AddObstacle(transformedPoints[2], transformedPoints[1], transformedPoints[0], transformedPoints[3]);
-		}
+		matrices::vect3ToArray(record.points_ + 3 * i, transformedPoints[order[i]]);
 	}
+	records_.push_back(record);
 }
@@ -4,6 +4,7 @@
 
 #include "MatrixDefs.h"
 #include "ManipManager.h"
+#include "ObjSceneCache.h"
 
 #include <string>
 #include <vector>
@@ -14,10 +15,14 @@ public:
 	 WorldParserObj();
 	~WorldParserObj();
 
+	/* Faces are read by pairs, the two triangles of an obstacle. The file is mapped rather than read,
+	and the obstacles are cached next to it so that the next loads skip the parsing.*/
 	void CreateWorld(const std::string& /*filename*/, const bool isGround=false);
 
 private:
-	void CreateObstacle (const std::vector<std::string>& /*lines*/, const bool /*isGround*/);
+	void ParseObj(const char* /*begin*/, const char* /*end*/);
+	void CreateObstacle(const long* /*indices*/);
+	void Replay(const ObjSceneRecord* /*records*/, const std::size_t /*nbRecords*/, const bool /*isGround*/);
 	
 private:
     typedef std::vector<matrices::Vector3,Eigen::aligned_allocator<matrices::Vector3> > T_Vector3;
@@ -26,6 +31,7 @@ private:
 	manip_core::ManipManager& manager_;
 	T_Vector3 points_;
 	T_Vector3 normals_;
+	T_ObjSceneRecords records_;
 };
 
 #endif //_CLASS_WORLDPARSEROBJ
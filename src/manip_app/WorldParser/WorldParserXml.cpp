@@ -0,0 +1,245 @@
+#include "WorldParserXml.h"
+
+#include "Pi.h"
+
+using namespace matrices;
+
+WorldParserXml::WorldParserXml()
+	: description_(0)
+{
+	// NOTHING
+}
+
+WorldParserXml::~WorldParserXml()
+{
+	// NOTHING
+}
+
+void WorldParserXml::Read(const std::string& filename, WorldDescription& description)
+{
+	description_ = &description;
+	WorldDescription& d = description;
+
+	xml::xifstream xis( filename );
+
+	xis >> xml::start( "world" )
+			>> xml::optional 
+				>> xml::start( "startpaused" )
+				>> xml::attribute( "val", d.startPaused_ )
+				>> xml::end
+			>> xml::start( "robot" )
+				>> xml::optional 
+				>> xml::attribute( "type", d.type_ )
+				>> xml::optional 
+				>> xml::attribute( "robotFile", d.robotFile_ )
+				>> xml::optional 
+				>> xml::attribute( "samples", d.nbSamples_ )
+				>> xml::attribute( "x", d.position_[0] )
+				>> xml::attribute( "y", d.position_[1] )
+				>> xml::attribute( "z", d.position_[2] )
+				>> xml::attribute( "rotx", d.rotation_[0] )
+				>> xml::attribute( "roty", d.rotation_[1] )
+				>> xml::attribute( "rotz", d.rotation_[2] )
+				>> xml::optional 
+				>> xml::attribute( "iDirx", d.initDir_[0] )
+				>> xml::optional 
+				>> xml::attribute( "iDiry", d.initDir_[1] )
+				>> xml::optional 
+				>> xml::attribute( "iDirz", d.initDir_[2] )
+				>> xml::optional 
+				>> xml::attribute( "gait", d.gait_ )
+				>> xml::optional 
+				>> xml::attribute( "jointlimit", d.jointLimit_ )
+				>> xml::optional 
+				>> xml::attribute( "autorotate", d.autoRotate_ )
+				>> xml::optional 
+				>> xml::attribute( "autorotateleg", d.autoRotateLeg_ )
+				>> xml::optional 
+				>> xml::attribute( "jumptotarget", d.jumpToTarget_ )
+				>> xml::optional 
+				>> xml::attribute( "drawsplines", d.drawSplines_ )
+				>> xml::optional 
+				>> xml::attribute( "drawEllipseAxes", d.drawEllipseAxes_ )
+				>> xml::optional 
+				>> xml::attribute( "drawEllipsoid", d.drawEllipsoid_ )
+				>> xml::optional 
+				>> xml::attribute( "drawnormals", d.drawNormals_ )
+				>> xml::optional 
+				>> xml::attribute( "rotatewithspline", d.rotateWithSpline_ )
+				>> xml::optional 
+				>> xml::attribute( "rotatewithsplinedir", d.rotateWithSplineDir_ )
+				>> xml::optional 
+				>> xml::attribute( "reachcom", d.reachCom_ )
+				>> xml::optional 
+				>> xml::attribute( "reachcomy", d.reachComY_ )
+				>> xml::optional 
+				>> xml::attribute( "reachcomrotate", d.reachComRotate_ )
+				>> xml::optional 
+				>> xml::attribute( "humanrotate", d.humanRotate_ )
+					>> xml::optional 
+					>> xml::list(*this, &WorldParserXml::ReadTree)
+				>> xml::optional 
+				>> xml::attribute( "speed", d.speed_ )
+				>> xml::optional 
+				>> xml::attribute( "planif", d.planif_ )
+				>> xml::optional 
+				>> xml::attribute( "footsteps", d.footstepHorizon_ )
+				>> xml::optional 
+				>> xml::attribute( "rootiterations", d.rootIterations_ )
+			>> xml::end
+			>> xml::optional
+				>> xml::start( "rootTrajectory" )
+						>> xml::optional 
+						>> xml::attribute( "inittimer", d.initTimer_ )
+						>> xml::list(*this, &WorldParserXml::ReadWaypoint)
+				>> xml::end
+			>> xml::optional 
+				>> xml::start( "obj" )
+					>> xml::attribute( "name", d.obj_ )
+					>> xml::optional 
+					>> xml::attribute( "ground", d.objGround_ )
+				>> xml::end
+			>> xml::optional
+				>> xml::start( "camera" )					
+					>> xml::attribute( "x", d.camera_[0] )
+					>> xml::attribute( "y", d.camera_[1] )
+					>> xml::attribute( "z", d.camera_[2] )
+					>> xml::attribute( "rotx", d.cameraRotation_[0] )
+					>> xml::attribute( "roty", d.cameraRotation_[1] )
+					>> xml::attribute( "rotz", d.cameraRotation_[2] )
+					>> xml::optional 
+					>> xml::attribute( "type", d.cameraType_ )
+				>> xml::end
+			>> xml::optional 
+				>> xml::start( "light" )					
+					>> xml::attribute( "x", d.light_[0] )
+					>> xml::attribute( "y", d.light_[1] )
+					>> xml::attribute( "shadows", d.drawShadows_ )
+				>> xml::end
+			>> xml::optional 
+				>> xml::start( "background" )
+					>> xml::attribute( "r", d.background_[0] )
+					>> xml::attribute( "g", d.background_[1] )
+					>> xml::attribute( "b", d.background_[2] )
+					>> xml::attribute( "sky", d.drawSky_ )
+					>> xml::attribute( "ground", d.drawGround_ )
+				>> xml::end
+			>> xml::start( "obstacles" )
+				>> xml::optional 
+				>> xml::attribute( "offSet", d.obstacleOffset_ )
+				>> xml::list(*this, &WorldParserXml::ReadElement)
+			>> xml::end;
+	description_ = 0;
+}
+
+void WorldParserXml::ReadTree(const std::string& name, xml::xistream& xis)
+{
+	int id;bool lock = false;
+	if(name == "tree")
+	{
+		xis >> xml::attribute( "id", id )
+			>> xml::optional 
+			>> xml::attribute( "lock", lock )
+			>> xml::list(*this, &WorldParserXml::ReadTreeJoint, id);
+		if(lock)
+			description_->locked_.push_back(id);
+	}
+}
+
+void WorldParserXml::ReadTreeJoint(const std::string& name, xml::xistream& xis, int tree)
+{
+	int id; double val;
+	if(name == "joint")
+	{
+		xis >> xml::attribute( "id", id )
+			>> xml::attribute( "angle", val );
+		
+		WorldDescription::T_TreeValues& values = description_->treeValues_;
+		if(tree < (int)values.size())
+		{
+			values[tree].push_back( val * DegreesToRadians);
+		}
+		else
+		{
+			WorldDescription::T_JointValues vals;
+			vals.push_back(val * DegreesToRadians);
+			values.push_back(vals);
+		}
+	}
+}
+
+void WorldParserXml::ReadWaypoint(const std::string& name, xml::xistream& xis)
+{
+	double x, y, z, t;
+	if(name == "waypoint")
+	{
+		xis >> xml::attribute( "x", x )
+			>> xml::attribute( "y", y )
+			>> xml::attribute( "z", z )
+			>> xml::attribute( "t", t );
+		description_->waypoints_.push_back(Vector3(x, y, z));
+	}
+}
+
+void WorldParserXml::ReadPoint(xml::xistream& xis, const std::string& name, float* values) const
+{
+	xis >> xml::start( name )
+			>> xml::attribute( "x", values[0] )
+			>> xml::attribute( "y", values[1] )
+			>> xml::attribute( "z", values[2] )
+	>> xml::end;
+}
+
+void WorldParserXml::ReadElement(const std::string& name, xml::xistream& xis)
+{
+	WorldElement element;
+	element.index_ = 0;
+	for(int i = 0; i < 12; ++i)
+	{
+		element.values_[i] = 0;
+	}
+	if(name == "obstacle" || name == "ground")
+	{
+		element.type_ = name == "obstacle" ? WorldElement::obstacle : WorldElement::ground;
+		ReadPoint(xis, "p0", element.values_);
+		ReadPoint(xis, "p1", element.values_ + 3);
+		ReadPoint(xis, "p2", element.values_ + 6);
+		ReadPoint(xis, "p3", element.values_ + 9);
+	}
+	else if(name == "verticalchess")
+	{
+		unsigned int depth;
+		xis >> xml::attribute( "depth", depth );
+		element.type_ = WorldElement::verticalChess;
+		element.index_ = (int)depth;
+		ReadPoint(xis, "p0", element.values_);
+		ReadPoint(xis, "p1", element.values_ + 3);
+	}
+	else if(name == "prise")
+	{
+		element.type_ = WorldElement::prise;
+		ReadPoint(xis, "p0", element.values_);
+	}
+	else if(name == "color")
+	{
+		element.type_ = WorldElement::color;
+		xis >>xml::start( "p0" )
+				>> xml::attribute( "r", element.values_[0] )
+				>> xml::attribute( "g", element.values_[1] )
+				>> xml::attribute( "b", element.values_[2] )
+				>> xml::attribute( "t", element.values_[3] )
+		>> xml::end;
+	}
+	else if(name == "texture")
+	{
+		element.type_ = WorldElement::texture;
+		xis >>xml::start( "p0" )
+				>> xml::attribute( "index", element.index_ )
+		>> xml::end;
+	}
+	else
+	{
+		return;
+	}
+	description_->elements_.push_back(element);
+}
@@ -0,0 +1,32 @@
+
+#ifndef _CLASS_WORLDPARSERXML
+#define _CLASS_WORLDPARSERXML
+
+#include "WorldDescription.h"
+
+#include <xeumeuleu/xml.hpp>
+
+#include <string>
+
+/* Reads an xml world, the format is described in WorldParser.h.
+Does not need the simulation so that worlds can be converted offline.*/
+struct WorldParserXml
+{
+public:
+	 WorldParserXml();
+	~WorldParserXml();
+
+	void Read(const std::string& /*filename*/, WorldDescription& /*description*/);
+
+private:
+	void ReadElement   (const std::string& /*name*/, xml::xistream& /*xis*/);
+	void ReadTree      (const std::string& /*name*/, xml::xistream& /*xis*/);
+	void ReadTreeJoint (const std::string& /*name*/, xml::xistream& /*xis*/, int tree);
+	void ReadWaypoint  (const std::string& /*name*/, xml::xistream& /*xis*/);
+	void ReadPoint     (xml::xistream& /*xis*/, const std::string& /*name*/, float* /*values*/) const;
+
+private:
+	WorldDescription* description_;
+};
+
+#endif //_CLASS_WORLDPARSERXML
@@ -0,0 +1,208 @@
+#include "TimerWheel.h"
+
+#include <cstdio>
+#include <vector>
+
+/* Checks of TimerWheel, returns the number of failed checks.
+Deadlines are chosen around the spans of the levels : 256, 256 * 64, 256 * 64^2 and 256 * 64^3 ms.*/
+
+namespace
+{
+	int failures = 0;
+
+	void Check(const bool condition, const char* what, const double value = 0)
+	{
+		if(!condition)
+		{
+			++failures;
+			printf("FAILED %s (%g)\n", what, value);
+		}
+	}
+
+	struct Fired
+	{
+		Fired(const Timer::t_time deadline, const unsigned long id, const Timer::t_time now)
+			: deadline_(deadline), id_(id), now_(now) {}
+
+		Timer::t_time deadline_;
+		unsigned long id_;
+		Timer::t_time now_; // time given to Advance when the event fired
+	};
+	typedef std::vector<Fired> T_Fired;
+
+	struct Recorder : public TimerEvent_ABC
+	{
+		Recorder() : wheel_(0), now_(0), cancel_(0), cancelled_(false) {}
+
+		virtual void OnTimer(const Timer::t_time time, const unsigned long id)
+		{
+			fired_.push_back(Fired(time, id, now_));
+			if(cancel_)
+			{
+				cancelled_ = wheel_->Cancel(cancel_);
+				cancel_ = 0;
+			}
+		}
+
+		void Advance(const Timer::t_time time)
+		{
+			now_ = time;
+			wheel_->Advance(time);
+		}
+
+		TimerWheel* wheel_;
+		Timer::t_time now_;
+		T_Fired fired_;
+		TimerWheel::t_id cancel_; // cancelled by the next event that fires
+		bool cancelled_;
+	};
+
+	// each event fires in the millisecond of its deadline, in order, whatever level it was parked in
+	void CheckLevels(const Timer::t_time start)
+	{
+		const Timer::t_time offsets[] =
+		{
+			1, 2, 255, 256, 257, 511, 512,
+			16383, 16384, 16385, 32768,
+			1048575, 1048576, 1048577,
+			67108863, 67108864, 67108865
+		};
+		const int nbOffsets = sizeof(offsets) / sizeof(offsets[0]);
+		TimerWheel wheel;
+		wheel.Clear(start);
+		Recorder recorder;
+		recorder.wheel_ = &wheel;
+		// scheduled backwards, so that the insertion order differs from the firing order
+		std::vector<TimerWheel::t_id> ids(nbOffsets);
+		for(int i = nbOffsets - 1; i >= 0; --i)
+		{
+			ids[i] = wheel.Schedule(&recorder, start + offsets[i]);
+		}
+		Check(wheel.GetNumEvents() == (unsigned int)nbOffsets, "levels : all scheduled", wheel.GetNumEvents());
+		for(int i = 0; i < nbOffsets; ++i)
+		{
+			const Timer::t_time deadline = start + offsets[i];
+			recorder.Advance(deadline - 1);
+			Check(recorder.fired_.size() == (std::size_t)i, "levels : nothing fires before its deadline", deadline);
+			recorder.Advance(deadline);
+			Check(recorder.fired_.size() == (std::size_t)i + 1, "levels : fires at its deadline", deadline);
+			if(recorder.fired_.size() == (std::size_t)i + 1)
+			{
+				Check(recorder.fired_[i].id_ == ids[i], "levels : order", deadline);
+				Check(recorder.fired_[i].deadline_ == deadline, "levels : deadline given", recorder.fired_[i].deadline_);
+			}
+		}
+		Check(wheel.GetNumEvents() == 0, "levels : all fired", wheel.GetNumEvents());
+	}
+
+	// a fractional deadline fires in the following millisecond, and one advance fires everything in order
+	void CheckSingleAdvance()
+	{
+		TimerWheel wheel;
+		Recorder recorder;
+		recorder.wheel_ = &wheel;
+		wheel.Schedule(&recorder, 16384.5);
+		wheel.Schedule(&recorder, 300);
+		wheel.Schedule(&recorder, 16384);
+		wheel.Schedule(&recorder, 70000000);
+		recorder.Advance(16384);
+		Check(recorder.fired_.size() == 2, "single advance : fired", (double)recorder.fired_.size());
+		recorder.Advance(70000000);
+		Check(recorder.fired_.size() == 4, "single advance : fired", (double)recorder.fired_.size());
+		const Timer::t_time expected[] = {300, 16384, 16384.5, 70000000};
+		for(std::size_t i = 0; i < recorder.fired_.size() && i < 4; ++i)
+		{
+			Check(recorder.fired_[i].deadline_ == expected[i], "single advance : order", recorder.fired_[i].deadline_);
+		}
+	}
+
+	// an event cancelled by another one firing in the same millisecond or later never fires
+	void CheckCancelWhileFiring()
+	{
+		TimerWheel wheel;
+		Recorder recorder;
+		recorder.wheel_ = &wheel;
+		TimerWheel::t_id first  = wheel.Schedule(&recorder, 100);
+		TimerWheel::t_id second = wheel.Schedule(&recorder, 100);
+		recorder.cancel_ = second;
+		recorder.Advance(100);
+		Check(recorder.cancelled_, "cancel while firing : same millisecond cancelled");
+		Check(recorder.fired_.size() == 1 && recorder.fired_[0].id_ == first, "cancel while firing : same millisecond not fired", (double)recorder.fired_.size());
+		Check(!wheel.Cancel(second), "cancel while firing : cancelled twice");
+
+		// a periodic event cancelling itself
+		recorder.fired_.clear();
+		TimerWheel::t_id periodic = wheel.Schedule(&recorder, 200, 50);
+		TimerWheel::t_id later = wheel.Schedule(&recorder, 100000);
+		recorder.Advance(300);
+		Check(recorder.fired_.size() == 3, "cancel while firing : periodic fired", (double)recorder.fired_.size());
+		recorder.cancel_ = periodic;
+		recorder.Advance(350);
+		Check(recorder.cancelled_, "cancel while firing : periodic cancelled by itself");
+		recorder.cancel_ = later;
+		recorder.Advance(1000);
+		Check(recorder.fired_.size() == 4, "cancel while firing : periodic stopped", (double)recorder.fired_.size());
+		wheel.Schedule(&recorder, 2000);
+		recorder.Advance(2000);
+		Check(recorder.cancelled_, "cancel while firing : far event cancelled");
+		recorder.Advance(200000);
+		Check(recorder.fired_.size() == 5, "cancel while firing : far event not fired", (double)recorder.fired_.size());
+		Check(wheel.GetNumEvents() == 0, "cancel while firing : empty", wheel.GetNumEvents());
+	}
+
+	// after a jump, a periodic event fires once per missed period, with each of its deadlines
+	void CheckCatchUp()
+	{
+		TimerWheel wheel;
+		Recorder recorder;
+		recorder.wheel_ = &wheel;
+		TimerWheel::t_id id = wheel.Schedule(&recorder, 10, 10);
+		recorder.Advance(1000);
+		Check(recorder.fired_.size() == 100, "catch up : one fire per period", (double)recorder.fired_.size());
+		for(std::size_t i = 0; i < recorder.fired_.size(); ++i)
+		{
+			Check(recorder.fired_[i].deadline_ == 10. * (i + 1), "catch up : deadlines", recorder.fired_[i].deadline_);
+		}
+		// across the first level
+		recorder.fired_.clear();
+		recorder.Advance(21000);
+		Check(recorder.fired_.size() == 2000, "catch up : across levels", (double)recorder.fired_.size());
+		Check(!recorder.fired_.empty() && recorder.fired_.back().deadline_ == 21000, "catch up : last deadline", recorder.fired_.empty() ? 0 : recorder.fired_.back().deadline_);
+		Check(wheel.Cancel(id), "catch up : still scheduled");
+		recorder.Advance(30000);
+		Check(recorder.fired_.size() == 2000, "catch up : cancelled", (double)recorder.fired_.size());
+
+		// started in the past, the missed deadlines fire one per millisecond until the event is back on time
+		recorder.fired_.clear();
+		id = wheel.Schedule(&recorder, 29500, 100);
+		for(Timer::t_time time = 30001; time <= 30006; ++time)
+		{
+			recorder.Advance(time);
+			Check(recorder.fired_.size() == (std::size_t)(time - 30000), "catch up : one missed deadline per millisecond", time);
+		}
+		recorder.Advance(30099);
+		Check(recorder.fired_.size() == 6, "catch up : back on time", (double)recorder.fired_.size());
+		recorder.Advance(30100);
+		Check(recorder.fired_.size() == 7, "catch up : next deadline", (double)recorder.fired_.size());
+		for(std::size_t i = 0; i < recorder.fired_.size(); ++i)
+		{
+			Check(recorder.fired_[i].deadline_ == 29500 + 100. * i, "catch up : missed deadlines", recorder.fired_[i].deadline_);
+		}
+		wheel.Cancel(id);
+	}
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+	CheckLevels(0);
+	CheckLevels(1000.);
+	CheckLevels(123456789.);
+	CheckSingleAdvance();
+	CheckCancelWhileFiring();
+	CheckCatchUp();
+	if(failures == 0)
+	{
+		printf("TimerWheel : all checks passed\n");
+	}
+	return failures;
+}
@@ -0,0 +1,67 @@
+
+#include "BenchStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+BenchStats::BenchStats()
+{
+	// NOTHING
+}
+
+BenchStats::~BenchStats()
+{
+	// NOTHING
+}
+
+void BenchStats::Add(const std::string& stage, double milliseconds)
+{
+	stages_[stage].push_back(milliseconds);
+}
+
+std::size_t BenchStats::GetCount(const std::string& stage) const
+{
+	T_Stages::const_iterator it = stages_.find(stage);
+	return it == stages_.end() ? 0 : it->second.size();
+}
+
+bool BenchStats::IsEmpty() const
+{
+	return stages_.empty();
+}
+
+double BenchStats::Percentile(const T_Durations& sorted, double percent)
+{
+	if(sorted.empty())
+	{
+		return 0;
+	}
+	std::size_t rank = (std::size_t)(std::ceil(percent / 100. * sorted.size()));
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+void BenchStats::WriteJson(std::ostream& stream, const std::string& indent) const
+{
+	stream << "{";
+	T_Durations sorted;
+	for(T_Stages::const_iterator it = stages_.begin(); it != stages_.end(); ++it)
+	{
+		sorted = it->second;
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0;
+		for(T_Durations::const_iterator d = sorted.begin(); d != sorted.end(); ++d)
+		{
+			sum += *d;
+		}
+		stream << (it == stages_.begin() ? "\n" : ",\n") << indent << "  \"" << it->first << "\": {"
+			<< "\"count\": " << sorted.size()
+			<< ", \"mean\": " << (sorted.empty() ? 0 : sum / sorted.size())
+			<< ", \"min\": "  << (sorted.empty() ? 0 : sorted.front())
+			<< ", \"p50\": "  << Percentile(sorted, 50)
+			<< ", \"p90\": "  << Percentile(sorted, 90)
+			<< ", \"p99\": "  << Percentile(sorted, 99)
+			<< ", \"max\": "  << (sorted.empty() ? 0 : sorted.back())
+			<< "}";
+	}
+	stream << "\n" << indent << "}";
+}
@@ -0,0 +1,35 @@
+
+#ifndef _CLASS_BENCHSTATS
+#define _CLASS_BENCHSTATS
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Durations measured for each stage of a benchmark case, in milliseconds
+class BenchStats
+{
+public:
+	typedef std::vector<double> T_Durations;
+	typedef std::map<std::string, T_Durations> T_Stages;
+
+public:
+	 BenchStats();
+	~BenchStats();
+
+public:
+	void Add(const std::string& /*stage*/, double /*milliseconds*/);
+	std::size_t GetCount(const std::string& /*stage*/) const;
+	bool IsEmpty() const;
+
+	// {"stage": {"count", "mean", "min", "p50", "p90", "p99", "max"}, ...}
+	void WriteJson(std::ostream& /*stream*/, const std::string& /*indent*/) const;
+
+	static double Percentile(const T_Durations& /*sorted*/, double /*percent*/); // nearest rank
+
+private:
+	T_Stages stages_;
+};
+
+#endif //_CLASS_BENCHSTATS
@@ -0,0 +1,383 @@
+
+#include "MatrixDefs.h"
+#include "Profiler.h"
+
+#include "BenchStats.h"
+#include "SceneBuilder.h"
+
+#include "kinematic/Robot.h"
+#include "kinematic/Tree.h"
+#include "kinematic/RobotFactory.h"
+#include "posture/PostureSolver.h"
+#include "posture/PostureCriteriaToeOffBoundary.h"
+#include "sampling/SampleGenerator.h"
+#include "IK/IKSolver.h"
+#include "IK/IkConstraintHandler.h"
+#include "world/World.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace matrices
+{
+	const Vector3 unitx = Vector3(1, 0, 0);
+	const Vector3 unity = Vector3(0, 1, 0);
+	const Vector3 unitz = Vector3(0, 0, 1);
+	const Vector3 zero  = Vector3(0, 0, 0);
+}
+
+using namespace matrices;
+using namespace manip_core::enums::robot;
+
+namespace
+{
+	const char* robotNames[UnknownRobot] =
+	{
+		"Human", "HumanWalk", "HumanEllipse", "Quadruped", "QuadrupedDown", "Spider",
+		"SpiderRace", "HumanCrouch", "HumanEscalade", "HumanCanap", "SpiderSix", "HumanCrouch180"
+	};
+
+	struct BenchOptions
+	{
+		BenchOptions()
+			: seed_(1)
+			, repeat_(100)
+			, nbSamples_(10000)
+			, robot_(Human)
+			, output_("bench.json")
+			, origin_(0, 0, 0)
+			, step_(0.05)
+			, footsteps_(0)
+		{}
+
+		unsigned int seed_;
+		unsigned int repeat_;
+		int nbSamples_;
+		eRobots robot_;
+		std::string output_;
+		std::vector<std::string> scenes_; // all the generated ones if empty
+		std::vector<std::string> objs_;
+		Vector3 origin_; // of the robot in the obj worlds
+		NUMBER step_;    // distance walked between two postures
+		unsigned int footsteps_; // horizon of the footstep planning, 0 keeps the greedy choice
+	};
+
+	struct Scene
+	{
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+		std::string name_;
+		SceneBuilder builder_;
+		Matrix4 basis_;
+	};
+	typedef std::vector<Scene*> T_Scenes;
+
+	bool ParseRobot(const char* name, eRobots& robot)
+	{
+		for(int i = 0; i < UnknownRobot; ++i)
+		{
+			if(!strcmp(name, robotNames[i]))
+			{
+				robot = (eRobots)i;
+				return true;
+			}
+		}
+		char* end;
+		long id = strtol(name, &end, 10);
+		if(*end != 0 || id < 0 || id >= UnknownRobot)
+		{
+			return false;
+		}
+		robot = (eRobots)id;
+		return true;
+	}
+
+	bool Selected(const BenchOptions& options, const std::string& scene)
+	{
+		if(options.scenes_.empty())
+		{
+			return true;
+		}
+		for(std::vector<std::string>::const_iterator it = options.scenes_.begin(); it != options.scenes_.end(); ++it)
+		{
+			if(*it == scene)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// slightly below the lowest effector of the robot at rest
+	NUMBER GroundHeight(const Robot& robot)
+	{
+		NUMBER height = robot.ToWorldCoordinates()(2,3);
+		for(Robot::T_TreeCIT it = robot.GetTrees().begin(); it != robot.GetTrees().end(); ++it)
+		{
+			const Tree* tree = *it;
+			Vector3 effector = matrix4TimesVect3(robot.ToWorldCoordinates(), tree->GetEffectorPosition(tree->GetNumEffector() - 1));
+			height = std::min(height, effector.z());
+		}
+		return height - 0.05;
+	}
+
+	// the scenes of ManipManager, in front of a robot walking along x
+	void CreateScenes(const BenchOptions& options, NUMBER ground, T_Scenes& scenes)
+	{
+		const Vector3 upLeft(-1, 1.5, 0);
+		const Vector3 bottomRight(7, -1.5, 0);
+		if(Selected(options, "chess"))
+		{
+			Scene* scene = new Scene();
+			scene->name_ = "chess";
+			scene->builder_.GenerateChess(upLeft, bottomRight, ground, 3);
+			scenes.push_back(scene);
+		}
+		if(Selected(options, "stair"))
+		{
+			Scene* scene = new Scene();
+			scene->name_ = "stair";
+			scene->builder_.GenerateStair(upLeft, bottomRight, ground, ground + 0.8, 16);
+			scenes.push_back(scene);
+		}
+		if(Selected(options, "verticalchess"))
+		{
+			Scene* scene = new Scene();
+			scene->name_ = "verticalchess";
+			scene->builder_.AddObstacle(Vector3(-1, 1.5, ground), Vector3(0.6, 1.5, ground), Vector3(0.6, -1.5, ground), Vector3(-1, -1.5, ground));
+			scene->builder_.GenerateVerticalChess(Vector3(0.6, 1.5, ground + 2.5), Vector3(0.6, -1.5, ground), 3);
+			scenes.push_back(scene);
+		}
+		for(T_Scenes::iterator it = scenes.begin(); it != scenes.end(); ++it)
+		{
+			(*it)->basis_ = Matrix4::Identity();
+		}
+		for(std::vector<std::string>::const_iterator it = options.objs_.begin(); it != options.objs_.end(); ++it)
+		{
+			Scene* scene = new Scene();
+			scene->name_ = *it;
+			if(!scene->builder_.LoadObj(*it))
+			{
+				std::cerr << "unable to open " << *it << std::endl;
+				delete scene;
+				continue;
+			}
+			scene->basis_ = Matrix4::Identity();
+			scene->basis_.block<3,1>(0,3) = options.origin_;
+			scenes.push_back(scene);
+		}
+	}
+
+	// milliseconds elapsed since begin, on the monotonic profiler clock
+	double ElapsedMs(const Profiler::t_tick begin)
+	{
+		return (Profiler::Now() - begin) / 1e6;
+	}
+
+	void RunScene(const BenchOptions& options, const factories::RobotFactory& factory, const Scene& scene, BenchStats& stats)
+	{
+		Profiler::t_tick begin;
+		for(unsigned int i = 0; i < options.repeat_; ++i)
+		{
+			std::auto_ptr<World> world(new World());
+			begin = Profiler::Now();
+			scene.builder_.Build(*world);
+			world->Instantiate(true);
+			stats.Add("world_build", ElapsedMs(begin));
+		}
+
+		World world;
+		scene.builder_.Build(world);
+		world.Instantiate(true);
+		PostureSolver solver(world);
+		solver.AddToeOffCriteria(new PostureCriteriaToeOffBoundary());
+		FootstepCriteria footsteps;
+		footsteps.horizon_ = options.footsteps_;
+		solver.SetFootstepCriteria(footsteps);
+		IKSolver ik;
+		IkConstraintHandler constraints(world);
+		const Vector3 direction(1, 0, 0);
+		srand(options.seed_);
+
+		// every tree is free, each call locks all of them
+		std::auto_ptr<Robot> model(factory.CreateRobot(options.robot_, scene.basis_));
+		for(unsigned int i = 0; i < options.repeat_; ++i)
+		{
+			std::auto_ptr<Robot> robot(model->Clone());
+			begin = Profiler::Now();
+			int locked = solver.NextPosture(*robot, direction);
+			double time = ElapsedMs(begin);
+			if(locked > 0)
+			{
+				stats.Add("lock_tree", time / locked);
+			}
+		}
+
+		// walking, one posture per step followed by an ik step per locked tree
+		std::auto_ptr<Robot> robot(model->Clone());
+		solver.NextPosture(*robot, direction);
+		for(unsigned int i = 0; i < options.repeat_; ++i)
+		{
+			robot->Translate(direction * options.step_);
+			begin = Profiler::Now();
+			solver.NextPosture(*robot, direction, true);
+			stats.Add("next_posture", ElapsedMs(begin));
+			for(Robot::T_TreeIT it = robot->GetTrees().begin(); it != robot->GetTrees().end(); ++it)
+			{
+				Tree& tree = **it;
+				if(tree.IsLocked())
+				{
+					Vector3 target = matrix4TimesVect3(robot->ToRobotCoordinates(), tree.GetTarget());
+					begin = Profiler::Now();
+					ik.StepClamping(*robot, tree, target, direction, &constraints);
+					stats.Add("ik_step", ElapsedMs(begin));
+				}
+				begin = Profiler::Now();
+				world.IsColliding(*robot, tree);
+				stats.Add("collision", ElapsedMs(begin));
+			}
+		}
+	}
+
+	std::string JsonString(const std::string& value)
+	{
+		std::string res("\"");
+		for(std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+		{
+			if(*it == '"' || *it == '\\')
+			{
+				res += '\\';
+			}
+			res += *it;
+		}
+		return res + "\"";
+	}
+
+	void Usage(const char* program)
+	{
+		std::cerr << "usage : " << program << " [--robot name|id] [--scene chess|stair|verticalchess]... [--obj file]..." << std::endl
+				  << "        [--origin x y z] [--seed n] [--repeat n] [--samples n] [--footsteps n] [--out file]" << std::endl
+				  << "samples are shared between the trees of the same id, run one process per robot type" << std::endl;
+	}
+}
+
+/* Benchmark of the posture pipeline : sample generation, world build, LockTree, NextPosture, IK steps and
+collision checks are timed separately for one robot type on the generated scenes and the given obj worlds.
+Durations are written in milliseconds as a json file, with their percentiles.*/
+int main(int argc, char *argv[])
+{
+	BenchOptions options;
+	for(int i = 1; i < argc; ++i)
+	{
+		bool hasValue = i + 1 < argc;
+		if(!strcmp(argv[i], "--robot") && hasValue)
+		{
+			if(!ParseRobot(argv[++i], options.robot_))
+			{
+				std::cerr << "unknown robot " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "--scene") && hasValue)
+		{
+			options.scenes_.push_back(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--obj") && hasValue)
+		{
+			options.objs_.push_back(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--origin") && i + 3 < argc)
+		{
+			options.origin_ = Vector3(atof(argv[i + 1]), atof(argv[i + 2]), atof(argv[i + 3]));
+			i += 3;
+		}
+		else if(!strcmp(argv[i], "--seed") && hasValue)
+		{
+			options.seed_ = (unsigned int)atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--repeat") && hasValue)
+		{
+			options.repeat_ = (unsigned int)atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--samples") && hasValue)
+		{
+			options.nbSamples_ = atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--footsteps") && hasValue)
+		{
+			options.footsteps_ = (unsigned int)atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "--out") && hasValue)
+		{
+			options.output_ = argv[++i];
+		}
+		else
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+	}
+	if(options.repeat_ == 0 || options.nbSamples_ <= 0)
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	factories::RobotFactory factory;
+	std::auto_ptr<Robot> model(factory.CreateRobot(options.robot_, Matrix4::Identity()));
+	if(!model.get())
+	{
+		std::cerr << "robot " << robotNames[options.robot_] << " cannot be created" << std::endl;
+		return 1;
+	}
+	// the generator seeds itself with the time when created
+	SampleGenerator* generator = SampleGenerator::GetInstance();
+	srand(options.seed_);
+	BenchStats robotStats;
+	const Profiler::t_tick begin = Profiler::Now();
+	generator->GenerateSamples(*model, options.nbSamples_);
+	robotStats.Add("sample_generation", ElapsedMs(begin));
+
+	T_Scenes scenes;
+	CreateScenes(options, GroundHeight(*model), scenes);
+	std::vector<BenchStats> sceneStats(scenes.size());
+	for(std::size_t i = 0; i < scenes.size(); ++i)
+	{
+		std::cout << robotNames[options.robot_] << " / " << scenes[i]->name_ << std::endl;
+		RunScene(options, factory, *scenes[i], sceneStats[i]);
+	}
+
+	std::ofstream file(options.output_.c_str());
+	if(!file.is_open())
+	{
+		std::cerr << "unable to open " << options.output_ << std::endl;
+		return 1;
+	}
+	file << "{\n"
+		 << "  \"robot\": \"" << robotNames[options.robot_] << "\",\n"
+		 << "  \"seed\": " << options.seed_ << ",\n"
+		 << "  \"repeat\": " << options.repeat_ << ",\n"
+		 << "  \"samples\": " << options.nbSamples_ << ",\n"
+		 << "  \"footsteps\": " << options.footsteps_ << ",\n"
+		 << "  \"unit\": \"ms\",\n"
+		 << "  \"stages\": ";
+	robotStats.WriteJson(file, "  ");
+	file << ",\n  \"scenes\": [";
+	for(std::size_t i = 0; i < scenes.size(); ++i)
+	{
+		file << (i == 0 ? "\n" : ",\n")
+			 << "    {\n"
+			 << "      \"scene\": " << JsonString(scenes[i]->name_) << ",\n"
+			 << "      \"obstacles\": " << scenes[i]->builder_.GetNumObstacles() << ",\n"
+			 << "      \"stages\": ";
+		sceneStats[i].WriteJson(file, "      ");
+		file << "\n    }";
+		delete scenes[i];
+	}
+	file << "\n  ]\n}\n";
+	return 0;
+}
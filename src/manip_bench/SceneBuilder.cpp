@@ -0,0 +1,158 @@
+
+#include "SceneBuilder.h"
+
+#include "world/World.h"
+#include "world/Obstacle.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace matrices;
+
+SceneBuilder::SceneBuilder()
+{
+	// NOTHING
+}
+
+SceneBuilder::~SceneBuilder()
+{
+	// NOTHING
+}
+
+void SceneBuilder::AddObstacle(const Vector3& upLeft, const Vector3& upRight, const Vector3& downRight, const Vector3& downLeft)
+{
+	Quad quad;
+	quad.p1_ = upLeft; quad.p2_ = upRight; quad.p3_ = downRight; quad.p4_ = downLeft;
+	quads_.push_back(quad);
+}
+
+void SceneBuilder::GenerateChess(const Vector3& upLeft, const Vector3& bottomRight, NUMBER height, const unsigned int depth)
+{
+	ObstacleGenerator(*this).GenerateChess(upLeft, bottomRight, height, depth);
+}
+
+void SceneBuilder::GenerateVerticalChess(const Vector3& upLeft, const Vector3& bottomRight, const unsigned int depth)
+{
+	ObstacleGenerator(*this).GenerateVerticalChess(upLeft, bottomRight, depth);
+}
+
+void SceneBuilder::GenerateXInclinedPlank(const Vector3& upLeft, const Vector3& bottomRight)
+{
+	ObstacleGenerator(*this).GenerateXInclinedPlank(upLeft, bottomRight);
+}
+
+void SceneBuilder::GenerateStair(const Vector3& upLeft, const Vector3& bottomRight, NUMBER heightInit, NUMBER heightFinal, const unsigned int depth)
+{
+	ObstacleGenerator(*this).GenerateStair(upLeft, bottomRight, heightInit, heightFinal, depth);
+}
+
+namespace
+{
+	typedef std::vector<Vector3, Eigen::aligned_allocator<Vector3> > T_Points;
+
+	struct AngleSort
+	{
+		AngleSort(const Vector3& center, const Vector3& normal, const Vector3& axis)
+			: center_(center), u_(axis), v_(normal.cross(axis)) {}
+
+		NUMBER Angle(const Vector3& p) const
+		{
+			Vector3 d = p - center_;
+			return atan2(d.dot(v_), d.dot(u_));
+		}
+
+		bool operator()(const Vector3& a, const Vector3& b) const
+		{
+			return Angle(a) < Angle(b);
+		}
+
+		Vector3 center_, u_, v_;
+	};
+
+	long ReadIndex(const std::string& token, std::size_t nbPoints)
+	{
+		long idx = strtol(token.c_str(), 0, 10);
+		return idx < 0 ? (long)nbPoints + idx : idx - 1;
+	}
+}
+
+bool SceneBuilder::LoadObj(const std::string& filename)
+{
+	std::ifstream file(filename.c_str());
+	if(!file.is_open())
+	{
+		return false;
+	}
+	T_Points points, normals, quad;
+	std::vector<long> indices;
+	int nbFaces = 0;
+	std::string line, token;
+	while(std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		token.clear();
+		stream >> token;
+		if(token == "v" || token == "vn")
+		{
+			// same axes as WorldParserObj
+			NUMBER x, y, z;
+			stream >> x >> z >> y;
+			(token == "v" ? points : normals).push_back(Vector3(-x, y, z));
+		}
+		else if(token == "f")
+		{
+			while(stream >> token)
+			{
+				long idx = ReadIndex(token, points.size());
+				if(idx >= 0 && idx < (long)points.size() && std::find(indices.begin(), indices.end(), idx) == indices.end())
+				{
+					indices.push_back(idx);
+				}
+			}
+			if(++nbFaces < 2)
+			{
+				continue;
+			}
+			// two triangles make an obstacle
+			if(indices.size() == 4)
+			{
+				quad.clear();
+				Vector3 center(0, 0, 0);
+				for(int i = 0; i < 4; ++i)
+				{
+					quad.push_back(points[indices[i]]);
+					center += quad.back() / 4;
+				}
+				Vector3 normal = (quad[1] - quad[0]).cross(quad[2] - quad[0]);
+				// oriented as the normal of the first vertex when there is one, up otherwise
+				Vector3 reference = (std::size_t)indices[0] < normals.size() ? normals[indices[0]] : Vector3(0, 0, 1);
+				if(normal.dot(reference) < 0)
+				{
+					normal = -normal;
+				}
+				Vector3 axis = quad[0] - center;
+				if(normal.norm() > 0 && axis.norm() > 0)
+				{
+					normal.normalize(); axis.normalize();
+					std::sort(quad.begin(), quad.end(), AngleSort(center, normal, axis));
+					// counterclockwise around the normal, so that the normal of the obstacle is kept
+					AddObstacle(quad[3], quad[2], quad[1], quad[0]);
+				}
+			}
+			indices.clear();
+			nbFaces = 0;
+		}
+	}
+	return true;
+}
+
+void SceneBuilder::Build(World& world) const
+{
+	for(T_Quads::const_iterator it = quads_.begin(); it != quads_.end(); ++it)
+	{
+		world.AddObstacle(new Obstacle(it->p1_, it->p2_, it->p3_, it->p4_));
+	}
+}
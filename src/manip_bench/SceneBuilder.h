@@ -0,0 +1,44 @@
+
+#ifndef _CLASS_SCENEBUILDER
+#define _CLASS_SCENEBUILDER
+
+#include "MatrixDefs.h"
+#include "world/ObstacleGenerator.h"
+
+#include <string>
+#include <vector>
+
+class World;
+
+/* Obstacles of a benchmark scene. The generators are shared with ManipManager in manip_app,
+and the quads are kept so that the world can be rebuilt.*/
+class SceneBuilder : private ObstacleGenerator::Receiver_ABC
+{
+public:
+	struct Quad
+	{
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+		matrices::Vector3 p1_, p2_, p3_, p4_;
+	};
+	typedef std::vector<Quad, Eigen::aligned_allocator<Quad> > T_Quads;
+
+public:
+	 SceneBuilder();
+	~SceneBuilder();
+
+public:
+	virtual void AddObstacle(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*upRight*/, const matrices::Vector3& /*downRight*/, const matrices::Vector3& /*downLeft*/);
+	void GenerateChess		   (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, NUMBER /*height*/, const unsigned int /*depth*/);
+	void GenerateVerticalChess (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, const unsigned int /*depth*/);
+	void GenerateStair		   (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, NUMBER /*heightInit*/, NUMBER /*heightFinal*/, const unsigned int /*depth*/);
+	void GenerateXInclinedPlank(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/);
+	bool LoadObj(const std::string& /*filename*/); // same conventions as WorldParserObj, faces are read by pairs
+
+	void Build(World& /*world*/) const; // adds the obstacles, does not instantiate the world
+	std::size_t GetNumObstacles() const { return quads_.size(); }
+
+private:
+	T_Quads quads_;
+};
+
+#endif //_CLASS_SCENEBUILDER
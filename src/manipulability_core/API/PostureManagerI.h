@@ -24,6 +24,20 @@ namespace postureCriteria
 		unknown
 	};
 }// namespace postureCriteria
+namespace stage
+{
+	enum eStage
+	{
+		sampleQuery = 0,  // selection of the samples close to an obstacle
+		filter,           // filters applied to the selection
+		score,            // visit and ranking of the filtered samples
+		ikStep,
+		collision,
+		trajectoryBuild,  // swing trajectory of a limb, cache lookup included
+		listenerDispatch, // PostureCreatedListenerI calls
+		nbStages
+	};
+}// namespace stage
 }// namespace enums
 
 struct RobotI;
@@ -32,11 +46,25 @@ struct MANIPCORE_API PostureCreatedListenerI
 {
 public:
 	/** Called whenever a new posture has been created.
+	pRobot is recycled by the planner once it gets old, Copy it to keep it.
 	*/
 	virtual void OnPostureCreated(double /*time*/, const RobotI* /*pRobot*/) = 0; // TODO posture destroyed ?
 };
 
 
+/** Durations of a planner stage since the counters were reset, in microseconds.
+Percentiles are read from a histogram and are accurate to about 20%.
+*/
+struct StageCounters
+{
+	unsigned long count_;
+	double total_;
+	double max_;
+	double p50_;
+	double p90_;
+	double p99_;
+};
+
 typedef std::pair<int, spline::curve_abc<>*>  CubicTrajectory;
 typedef std::vector<CubicTrajectory>		T_CubicTrajectory;
 typedef T_CubicTrajectory::iterator			IT_CubicTrajectory;
@@ -49,8 +77,18 @@ struct MANIPCORE_API PostureManagerI
 	/**	Add a desired posture to the trajectory path. Parameters are time and a 4 square column-major matrix.
 	 */
 	virtual void AddTrajectoryPoint(const float time, const double* /*transform*/)= 0;
+	/**	Add nbPoints checkpoints at once. positions holds 3 coordinates per point.
+	 */
+	virtual void AddTrajectoryPoints(const float* /*times*/, const double* /*positions*/, const unsigned int /*nbPoints*/)= 0;
 
 	virtual void SetJumpToTarget(const bool /*jump*/)= 0;
+	/**	Lets the root of the created postures leave the trajectory to favour the locked limbs. 0 disables the optimization.
+	 */
+	virtual void SetRootOptimization(const unsigned int /*maxIterations*/)= 0;
+	/**	Plans horizon steps ahead when locking a tree and keeps the first step of the best plan, 0 or 1 keeps the greedy choice.
+	beamWidth plans are kept at each depth, and no new depth is started once timeBudget seconds have elapsed.
+	 */
+	virtual void SetFootstepPlanning(const unsigned int /*horizon*/, const unsigned int /*beamWidth*/, const float /*timeBudget*/)= 0;
 
 	/*in ms*/
 	virtual void Update(const unsigned long time)= 0;
@@ -78,6 +116,21 @@ struct MANIPCORE_API PostureManagerI
 
 	// direction in world coordinates
 	virtual T_CubicTrajectory NextPosture(RobotI* /*robot*/, double* /*dir*/, bool /*closestDistance*/) = 0;
+	/**
+	Give back a trajectory returned by NextPosture once it is no longer used. Trajectories are shared and must not be deleted.
+	*/
+	virtual void ReleaseTrajectory(const spline::curve_abc<>* /*trajectory*/) = 0;
+
+	/**
+	Times the planner stages from now on, or stops. Off by default, the counters are shared by all the planners of the process.
+	*/
+	virtual void EnableProfiling(const bool /*enable*/) = 0;
+	virtual void GetStageCounters(const enums::stage::eStage /*stage*/, StageCounters& /*counters*/) const = 0;
+	virtual void ResetStageCounters() = 0;
+	/**
+	Writes the last recorded stages in the chrome trace event format, false if the file cannot be written.
+	*/
+	virtual bool ExportTrace(const char* /*filename*/) const = 0;
 
 	#ifdef PROFILE
 	virtual void Log() const = 0;
@@ -14,6 +14,8 @@ struct MANIPCORE_API SampleVisitorI {
 public:
 	// user responsible of tree
 	virtual void Visit(const RobotI* /*robot*/, TreeI* /*tree*/) = 0;	
+	// jacobianProduct is the J*Jt of the sample, in rows of 4 as the rotations of the API. It spares rebuilding the jacobian of the tree
+	virtual void VisitWithJacobianProduct(const RobotI* robot, TreeI* tree, const double* /*jacobianProduct*/) { Visit(robot, tree); }
 };
 }
 
@@ -28,6 +28,15 @@ struct MANIPCORE_API TreeI
 	virtual const JointI* GetRootJointI() const = 0;
 
 	virtual bool IsAnchored() const = 0;
+	/**	Takes the lock, target and obstacle of a tree of the same model, the joint values are kept.
+	 */
+	virtual void CopyContact(const TreeI* /*tree*/) = 0;
+	/**	Loads the joint values from the root joint on, in the order of GetSon, and updates the tree.
+	 */
+	virtual void SetAngles(const double* /*angles*/) = 0;
+	/**	Locks the tree on its current target, or releases it.
+	 */
+	virtual void SetAnchored(const bool /*anchored*/) = 0;
 
 	virtual void ToRest() = 0 ;
 	virtual void SetTarget(double* /*target*/) = 0 ;
@@ -33,11 +33,23 @@ public:
 		delete this;
 	}
 
-	virtual void AddObstacle(double* upLeft, double* upRight, double* downRight, double* downLeft, bool donttouch)
+	virtual ObstacleHandle AddObstacle(double* upLeft, double* upRight, double* downRight, double* downLeft, bool donttouch)
 	{
 		Vector3 p1, p2, p3, p4;
 		arrayToVect3(upLeft, p1);arrayToVect3(upRight, p2);arrayToVect3(downRight, p3);arrayToVect3(downLeft, p4);
-		world_.AddObstacle(new Obstacle(p1, p2, p3, p4, donttouch));
+		return world_.AddObstacle(new Obstacle(p1, p2, p3, p4, donttouch));
+	}
+
+	virtual bool RemoveObstacle(const ObstacleHandle& handle)
+	{
+		return world_.RemoveObstacle(handle);
+	}
+
+	virtual bool TransformObstacle(const ObstacleHandle& handle, double* transform)
+	{
+		Matrix4 mat;
+		array16ToMatrix4(transform, mat);
+		return world_.TransformObstacle(handle, mat);
 	}
 
 	virtual RobotI* CreateRobot(enums::robot::eRobots robotType, double* transform)
@@ -94,6 +106,11 @@ public:
 		return res;
     }*/
 	
+	virtual void EnableDistanceField(double voxelSize, double bandWidth, const char* cacheFile)
+	{
+		world_.EnableDistanceField(voxelSize, bandWidth, cacheFile ? cacheFile : "");
+	}
+
 	/** Once all obstacles have been created, instantiate world.
 	*/
 	virtual void Initialize(bool activateCollisions)
@@ -48,7 +48,13 @@ struct MANIPCORE_API WorldManagerI
 	virtual void Release() = 0;
 	/**	Creates a planar obstacle. Points must be indicated clockwise from upLeft and be in a plan.
 	 */
-	virtual void AddObstacle(double* /*upLeft*/, double* /*upRight*/, double* /*downRight*/, double* /*downLeft*/, bool donttouch=false)= 0;
+	virtual ObstacleHandle AddObstacle(double* /*upLeft*/, double* /*upRight*/, double* /*downRight*/, double* /*downLeft*/, bool donttouch=false)= 0;
+	/**	Removes an obstacle. Can be called after the world has been initialized.
+	 */
+	virtual bool RemoveObstacle(const ObstacleHandle& /*handle*/)= 0;
+	/**	Moves an obstacle given a 4 square column-major matrix. Can be called after the world has been initialized.
+	 */
+	virtual bool TransformObstacle(const ObstacleHandle& /*handle*/, double* /*transform*/)= 0;
 	/**	Creates a pre-existing robot.
 	 */
 	virtual RobotI* CreateRobot(enums::robot::eRobots /*robotType*/, double* /*transform*/) = 0;
@@ -56,6 +62,10 @@ struct MANIPCORE_API WorldManagerI
     //virtual RobotI* CreateRobot(const joint_def_t& /*jointDef*/, double* /*transform*/) = 0;
     //virtual RobotI* CreateRobot(const joint_def_t& /*jointDef*/, double* /*transform*/, const T_TreeValues /*values*/ ) = 0;
 
+	/** Enables a signed distance field of the obstacles, used to speed up distance and collision queries.
+	Must be called before Initialize. If cacheFile is given, the field is loaded from it when it matches the obstacles, otherwise baked and saved there.
+	*/
+	virtual void EnableDistanceField(double /*voxelSize*/, double /*bandWidth*/, const char* cacheFile = 0) = 0;
 	/** Once all obstacles have been created, instantiate world.
 	*/
 	virtual void Initialize(bool /*activateCollisions*/) = 0;
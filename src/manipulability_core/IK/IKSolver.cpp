@@ -8,6 +8,7 @@
 #include "IkConstraintHandler.h"
 
 #include "API/TreeI.h"
+#include "Profiler.h"
 
 #include <vector>
 #include <iostream>
@@ -53,6 +54,7 @@ void IKSolver::Release()
 //REF: Boulic : An inverse kinematics architecture enforcing an arbitrary number of strict priority levels
 bool IKSolver::StepClamping(const Robot& robot, Tree& tree, const matrices::Vector3& target, const Vector3& direction, const IkConstraintHandler* constraints) const
 {
+	ProfileScope scope(enums::stage::ikStep);
 	assert(constraints);
 	/*if(!intersection_.Intersect(tree, target))
 	{
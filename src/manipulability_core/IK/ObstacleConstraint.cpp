@@ -2,20 +2,27 @@
 #include "ObstacleConstraint.h"
 #include "kinematic/Tree.h"
 #include "kinematic/Robot.h"
+#include "kinematic/Joint.h"
 #include "world/World.h"
 #include "world/Obstacle.h"
 #include "world/ObstacleVisitor_ABC.h"
+#include "world/DistanceField.h"
 
 #include "kinematic/Jacobian.h"
 
+#include <cmath>
+#include <algorithm>
+
 using namespace matrices;
 using namespace Eigen;
 
+// closest obstacle with the distance the field is baked from, outside of the band
 struct FindObstacle : public ObstacleVisitor_ABC
 {
 	FindObstacle(const matrices::Vector3& target)
 		: target_(target)
 		, bestDistance_(100000)
+		, closest_(0)
 	{
 		// NOTHING		
 	};
@@ -27,16 +34,32 @@ struct FindObstacle : public ObstacleVisitor_ABC
 
 	virtual void Visit(const Obstacle& obstacle)
 	{
-		NUMBER currentDistance_ = obstacle.Distance(target_, whoCares_);
+		NUMBER currentDistance_ = std::fabs(DistanceField::SignedDistance(obstacle, target_));
 		if(currentDistance_ < bestDistance_)
 		{
 			bestDistance_ = currentDistance_;
+			closest_ = &obstacle;
+		}
+	}
+
+	// of the unsigned distance, pointing away from the closest point of the obstacle
+	matrices::Vector3 Gradient() const
+	{
+		if(!closest_)
+		{
+			return matrices::Vector3::Zero();
 		}
+		matrices::Vector3 local = matrix4TimesVect3(closest_->BasisInv(), target_);
+		local(0) = std::min(std::max(local(0), (NUMBER)0), closest_->GetW());
+		local(1) = std::min(std::max(local(1), (NUMBER)0), closest_->GetH());
+		local(2) = 0;
+		matrices::Vector3 away = target_ - matrix4TimesVect3(closest_->Basis(), local);
+		return bestDistance_ > 0 ? matrices::Vector3(away / bestDistance_) : matrices::Vector3::Zero();
 	}
 
-	matrices::Vector3 whoCares_;
 	const matrices::Vector3& target_;
 	NUMBER bestDistance_;
+	const Obstacle* closest_;
 
 };
 
@@ -51,33 +74,46 @@ ObstacleConstraint::~ObstacleConstraint()
 	// NOTHING
 }
 
-NUMBER ObstacleConstraint::Evaluate(const Robot& robot, const Tree& tree, const int joint, Jacobian& jacobianMinus, Jacobian& jacobianPlus, float epsilon, const Vector3& direction)
+// derivative of the distance between the end of the segment driven by the joint and the obstacles,
+// with respect to the joint angle
+NUMBER ObstacleConstraint::Evaluate(const Robot& robot, const Tree& tree, const int joint, Jacobian& /*jacobianMinus*/, Jacobian& /*jacobianPlus*/, float /*epsilon*/, const Vector3& /*direction*/)
 {
-	Vector3 minusVector, maxVector;
-	Tree * myTree = tree.Clone();
-	if(myTree->GetJoint(joint)->IsEffector())
+	const Joint* current = tree.GetJoint(joint);
+	if(current->IsEffector())
+	{
+		return 0;
+	}
+	// joints sharing a position only add degrees of freedom, the segment ends at the next one that moves
+	const Joint* next = current->pChild_;
+	while(next && !next->IsEffector() && (next->GetS() - current->GetS()).norm() < 0.0001)
+	{
+		next = next->pChild_;
+	}
+	if(!next)
 	{
 		return 0;
 	}
- 	myTree->GetJoint(joint)->AddToTheta(-epsilon);
-	myTree->Compute();
-	minusVector = myTree->GetJoint(joint)->ComputeS();
-	//minusVector = myTree->GetEffectorPosition(myTree->GetNumEffector()-1);
-	myTree->GetJoint(joint)->AddToTheta(2*epsilon);
-	myTree->Compute();
-	//maxVector = myTree->GetEffectorPosition(myTree->GetNumEffector()-1);
-	maxVector = myTree->GetJoint(joint)->ComputeS();
-
-	minusVector = matrices::matrix4TimesVect3(robot.ToWorldCoordinates(), minusVector);
-	maxVector = matrices::matrix4TimesVect3(robot.ToWorldCoordinates(), maxVector);
-
-	FindObstacle fObsMin(minusVector);
-	world_.Accept(fObsMin);
-	
-	FindObstacle fObsMax(maxVector);
-	world_.Accept(fObsMax);
-
-	double res = (fObsMax.bestDistance_ - fObsMin.bestDistance_) / (epsilon * 2) * 0.2;
+	const Matrix4& toWorld = robot.ToWorldCoordinates();
+	Vector3 end = matrices::matrix4TimesVect3(toWorld, next->GetS());
+	Vector3 axis = toWorld.block<3,3>(0,0) * current->GetW();
+	Vector3 velocity = axis.cross(end - matrices::matrix4TimesVect3(toWorld, current->GetS()));
+
+	// the field is a sampling of the same distance as the obstacle visit, so the two sides of the band agree
+	NUMBER distance;
+	Vector3 gradient;
+	const DistanceField* field = world_.GetDistanceField();
+	if(!field || !field->Distance(end, distance, gradient))
+	{
+		FindObstacle fObs(end);
+		world_.Accept(fObs);
+		gradient = fObs.Gradient();
+	}
+	else if(distance < 0)
+	{
+		gradient = -gradient; // of the unsigned distance
+	}
+
+	double res = gradient.dot(velocity) * 0.2;
 	res = res > 1 ? 1 : res;
 	res = res < -1 ? -1 : res;
 	return res;
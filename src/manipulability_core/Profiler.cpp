@@ -0,0 +1,351 @@
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#include <time.h>
+#include <pthread.h>
+#define PROFILER_THREAD_LOCAL __thread
+#endif
+
+using namespace manip_core;
+using namespace manip_core::enums;
+
+namespace
+{
+	// 4 buckets per power of 2
+	const unsigned int nbBuckets = 4 * 48;
+
+	unsigned int Bucket(Profiler::t_tick duration)
+	{
+		if(duration < 4)
+		{
+			return (unsigned int)duration;
+		}
+		unsigned int exponent = 2;
+		while((duration >> (exponent + 1)) != 0)
+		{
+			++exponent;
+		}
+		unsigned int res = (exponent - 1) * 4 + (unsigned int)((duration >> (exponent - 2)) & 3);
+		return std::min(res, nbBuckets - 1);
+	}
+
+	double BucketMiddle(unsigned int bucket)
+	{
+		if(bucket < 4)
+		{
+			return bucket + 0.5;
+		}
+		unsigned int exponent = bucket / 4 + 1;
+		unsigned int sub = bucket % 4;
+		return (4 + sub + 0.5) * (double)(1ULL << (exponent - 2));
+	}
+
+	const char* stageNames[stage::nbStages] =
+	{
+		"sampleQuery", "filter", "score", "ikStep", "collision", "trajectoryBuild", "listenerDispatch"
+	};
+
+	bool ClaimSlot(volatile long* owned)
+	{
+	#ifdef _WIN32
+		return InterlockedCompareExchange(owned, 1, 0) == 0;
+	#else
+		return __sync_bool_compare_and_swap(owned, 0, 1);
+	#endif
+	}
+
+	void Publish()
+	{
+	#ifdef _WIN32
+		MemoryBarrier();
+	#else
+		__sync_synchronize();
+	#endif
+	}
+
+	// called on thread exit with the owned flag of the slot of the thread
+#ifdef _WIN32
+	VOID WINAPI ReleaseSlot(PVOID owned)
+#else
+	void ReleaseSlot(void* owned)
+#endif
+	{
+		if(owned)
+		{
+			Publish();
+			*static_cast<volatile long*>(owned) = 0;
+		}
+	}
+
+	PROFILER_THREAD_LOCAL ProfilerThread* currentThread = 0;
+	PROFILER_THREAD_LOCAL int currentSlot = -1; // -1 until the thread claims its buffers, -2 if none were free
+}
+
+struct ProfilerEvent
+{
+	Profiler::t_tick begin_;
+	Profiler::t_tick duration_;
+	int stage_;
+};
+
+// written by its thread only
+struct ProfilerThread
+{
+	explicit ProfilerThread(unsigned int id)
+		: id_(id)
+		, written_(0)
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		memset(counts_, 0, sizeof(counts_));
+		memset(totals_, 0, sizeof(totals_));
+		memset(max_, 0, sizeof(max_));
+		memset(buckets_, 0, sizeof(buckets_));
+		written_ = 0;
+	}
+
+	const unsigned int id_;
+	unsigned long counts_[stage::nbStages];
+	Profiler::t_tick totals_[stage::nbStages];
+	Profiler::t_tick max_[stage::nbStages];
+	unsigned long buckets_[stage::nbStages][nbBuckets];
+	ProfilerEvent ring_[Profiler::ringSize];
+	volatile unsigned long written_;
+};
+
+struct ProfilerPImpl
+{
+	ProfilerPImpl()
+	{
+		for(int i = 0; i < Profiler::maxThreads; ++i)
+		{
+			threads_[i] = 0;
+			owned_[i] = 0;
+		}
+	#ifdef _WIN32
+		exitKey_ = FlsAlloc(&ReleaseSlot);
+	#else
+		pthread_key_create(&exitKey_, &ReleaseSlot);
+	#endif
+	}
+
+	~ProfilerPImpl()
+	{
+		for(int i = 0; i < Profiler::maxThreads; ++i)
+		{
+			delete threads_[i];
+		}
+	}
+
+	// the slot is given back when the thread exits, its counters are kept for the next owner
+	void ReleaseOnExit(volatile long* owned)
+	{
+	#ifdef _WIN32
+		FlsSetValue(exitKey_, (PVOID)owned);
+	#else
+		pthread_setspecific(exitKey_, (const void*)owned);
+	#endif
+	}
+
+	ProfilerThread* volatile threads_[Profiler::maxThreads];
+	volatile long owned_[Profiler::maxThreads]; // 1 while a running thread writes into the slot
+#ifdef _WIN32
+	DWORD exitKey_;
+#else
+	pthread_key_t exitKey_;
+#endif
+};
+
+Profiler Profiler::instance_;
+
+Profiler::Profiler()
+	: enabled_(false)
+	, pImpl_(new ProfilerPImpl())
+{
+	// NOTHING
+}
+
+Profiler::~Profiler()
+{
+	// NOTHING
+}
+
+Profiler::t_tick Profiler::Now()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency = {0};
+	if(frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	t_tick ticks = (t_tick)counter.QuadPart;
+	t_tick freq  = (t_tick)frequency.QuadPart;
+	return (ticks / freq) * 1000000000ULL + ((ticks % freq) * 1000000000ULL) / freq;
+#else
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (t_tick)now.tv_sec * 1000000000ULL + (t_tick)now.tv_nsec;
+#endif
+}
+
+void Profiler::Enable(const bool enable)
+{
+	enabled_ = enable;
+}
+
+ProfilerThread* Profiler::CurrentThread()
+{
+	if(currentSlot == -1)
+	{
+		currentSlot = -2;
+		for(int slot = 0; slot < maxThreads; ++slot)
+		{
+			if(ClaimSlot(&pImpl_->owned_[slot]))
+			{
+				if(!pImpl_->threads_[slot])
+				{
+					ProfilerThread* thread = new ProfilerThread((unsigned int)slot);
+					Publish();
+					pImpl_->threads_[slot] = thread;
+				}
+				pImpl_->ReleaseOnExit(&pImpl_->owned_[slot]);
+				currentThread = pImpl_->threads_[slot];
+				currentSlot = slot;
+				break;
+			}
+		}
+	}
+	return currentThread;
+}
+
+void Profiler::Record(const stage::eStage stage, const t_tick begin, const t_tick end)
+{
+	ProfilerThread* thread = CurrentThread();
+	if(!thread)
+	{
+		return;
+	}
+	t_tick duration = end > begin ? end - begin : 0;
+	++thread->counts_[stage];
+	thread->totals_[stage] += duration;
+	thread->max_[stage] = std::max(thread->max_[stage], duration);
+	++thread->buckets_[stage][Bucket(duration)];
+	ProfilerEvent& event = thread->ring_[thread->written_ % ringSize];
+	event.begin_ = begin;
+	event.duration_ = duration;
+	event.stage_ = stage;
+	Publish();
+	++thread->written_;
+}
+
+void Profiler::GetCounters(const stage::eStage stage, StageCounters& counters) const
+{
+	std::vector<unsigned long> buckets(nbBuckets, 0);
+	t_tick total = 0, max = 0;
+	unsigned long count = 0;
+	for(int i = 0; i < maxThreads; ++i)
+	{
+		const ProfilerThread* thread = pImpl_->threads_[i];
+		if(thread)
+		{
+			count += thread->counts_[stage];
+			total += thread->totals_[stage];
+			max = std::max(max, thread->max_[stage]);
+			for(unsigned int b = 0; b < nbBuckets; ++b)
+			{
+				buckets[b] += thread->buckets_[stage][b];
+			}
+		}
+	}
+	counters.count_ = count;
+	counters.total_ = total / 1000.;
+	counters.max_   = max / 1000.;
+	const double percents[3] = {0.5, 0.9, 0.99};
+	double* results[3] = {&counters.p50_, &counters.p90_, &counters.p99_};
+	for(int p = 0; p < 3; ++p)
+	{
+		*results[p] = 0;
+		unsigned long rank = (unsigned long)(percents[p] * count + 0.5), cumul = 0;
+		for(unsigned int b = 0; count > 0 && b < nbBuckets; ++b)
+		{
+			cumul += buckets[b];
+			if(cumul >= std::max(rank, 1UL))
+			{
+				*results[p] = std::min(BucketMiddle(b) / 1000., counters.max_);
+				break;
+			}
+		}
+	}
+}
+
+void Profiler::Reset()
+{
+	for(int i = 0; i < maxThreads; ++i)
+	{
+		ProfilerThread* thread = pImpl_->threads_[i];
+		if(thread)
+		{
+			thread->Clear();
+		}
+	}
+}
+
+bool Profiler::ExportTrace(const std::string& filename) const
+{
+	std::ofstream file(filename.c_str());
+	if(!file.is_open())
+	{
+		return false;
+	}
+	// timestamps relative to the first event kept
+	t_tick origin = 0;
+	bool first = true;
+	for(int i = 0; i < maxThreads; ++i)
+	{
+		const ProfilerThread* thread = pImpl_->threads_[i];
+		unsigned long written = thread ? thread->written_ : 0;
+		for(unsigned long e = written > ringSize ? written - ringSize : 0; e < written; ++e)
+		{
+			t_tick begin = thread->ring_[e % ringSize].begin_;
+			origin = first ? begin : std::min(origin, begin);
+			first = false;
+		}
+	}
+	file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+	first = true;
+	for(int i = 0; i < maxThreads; ++i)
+	{
+		const ProfilerThread* thread = pImpl_->threads_[i];
+		unsigned long written = thread ? thread->written_ : 0;
+		for(unsigned long e = written > ringSize ? written - ringSize : 0; e < written; ++e)
+		{
+			const ProfilerEvent& event = thread->ring_[e % ringSize];
+			file << (first ? "\n" : ",\n")
+				 << "{\"name\": \"" << stageNames[event.stage_] << "\", \"cat\": \"planner\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << thread->id_
+				 << ", \"ts\": " << (event.begin_ - origin) / 1000. << ", \"dur\": " << event.duration_ / 1000. << "}";
+			first = false;
+		}
+	}
+	file << "\n]}\n";
+	return file.good();
+}
+
+const char* Profiler::GetName(const stage::eStage stage)
+{
+	return stage < stage::nbStages ? stageNames[stage] : "unknown";
+}
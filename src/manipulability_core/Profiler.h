@@ -0,0 +1,84 @@
+
+#ifndef _CLASS_PROFILER
+#define _CLASS_PROFILER
+
+#include "API/PostureManagerI.h"
+
+#include <memory>
+#include <string>
+
+struct ProfilerPImpl;
+struct ProfilerThread;
+
+/* Runtime switchable timing of the planner stages, off by default.
+Each thread writes into its own buffers, a histogram per stage and a ring of the last events,
+without locks. The buffers of a thread that exits go to the next thread that records. They are aggregated when queried, so counters read while stages run are approximate.*/
+class Profiler
+{
+public:
+	typedef unsigned long long t_tick; // nanoseconds of a monotonic clock
+
+	enum
+	{
+		maxThreads = 16,   // threads running at once, further ones are not recorded
+		ringSize   = 16384 // events kept per thread for the trace
+	};
+
+private:
+	 Profiler();
+	~Profiler();
+	Profiler(const Profiler&);
+	Profiler& operator=(const Profiler&);
+
+public:
+	static Profiler& GetInstance() { return instance_; }
+	static t_tick Now();
+
+	void Enable(const bool /*enable*/);
+	bool IsEnabled() const { return enabled_; }
+
+	void Record(const manip_core::enums::stage::eStage /*stage*/, const t_tick /*begin*/, const t_tick /*end*/);
+	void GetCounters(const manip_core::enums::stage::eStage /*stage*/, manip_core::StageCounters& /*counters*/) const;
+	void Reset();
+	bool ExportTrace(const std::string& /*filename*/) const; // chrome trace event format
+
+	static const char* GetName(const manip_core::enums::stage::eStage /*stage*/);
+
+private:
+	ProfilerThread* CurrentThread();
+
+private:
+	static Profiler instance_;
+	volatile bool enabled_;
+	std::auto_ptr<ProfilerPImpl> pImpl_;
+};
+
+// times the enclosing block when profiling is enabled
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const manip_core::enums::stage::eStage stage)
+		: stage_(stage)
+		, begin_(Profiler::GetInstance().IsEnabled() ? Profiler::Now() : 0)
+	{
+		// NOTHING
+	}
+
+	~ProfileScope()
+	{
+		if(begin_)
+		{
+			Profiler::GetInstance().Record(stage_, begin_, Profiler::Now());
+		}
+	}
+
+private:
+	ProfileScope(const ProfileScope&);
+	ProfileScope& operator=(const ProfileScope&);
+
+private:
+	const manip_core::enums::stage::eStage stage_;
+	const Profiler::t_tick begin_;
+};
+
+#endif //_CLASS_PROFILER
@@ -0,0 +1,221 @@
+
+#include "TrajectoryCache.h"
+
+#include <cmath>
+#include <list>
+#include <map>
+
+using namespace matrices;
+
+namespace
+{
+	struct CurveKey
+	{
+		long coordinates_[6]; // quantized from and target
+		ObstacleHandle obstacle_;
+		Tree::TREE_ID templateId_;
+
+		bool operator<(const CurveKey& other) const
+		{
+			for(int i = 0; i < 6; ++i)
+			{
+				if(coordinates_[i] != other.coordinates_[i])
+				{
+					return coordinates_[i] < other.coordinates_[i];
+				}
+			}
+			if(obstacle_ != other.obstacle_)
+			{
+				return obstacle_ < other.obstacle_;
+			}
+			return templateId_ < other.templateId_;
+		}
+	};
+
+	struct CachedCurve;
+
+	typedef std::map<CurveKey, CachedCurve*>							T_Keys;
+	typedef std::map<const TrajectoryCache::curve_t*, CachedCurve*>	T_Curves;
+	typedef std::list<CachedCurve*>										T_Lru;
+
+	struct CachedCurve
+	{
+		TrajectoryCache::curve_t* curve_;
+		unsigned int references_;
+		bool cached_; // key_ is valid
+		T_Keys::iterator key_;
+		T_Lru::iterator lru_; // valid when not referenced
+	};
+}
+
+struct TrajectoryCachePImpl
+{
+	TrajectoryCachePImpl(NUMBER quantum, unsigned int maxCurves)
+		: quantum_(quantum)
+		, maxCurves_(maxCurves)
+		, hits_(0)
+	{
+		// NOTHING
+	}
+
+	~TrajectoryCachePImpl()
+	{
+		for(T_Curves::iterator it = curves_.begin(); it != curves_.end(); ++it)
+		{
+			delete it->second->curve_;
+			delete it->second;
+		}
+	}
+
+	CurveKey MakeKey(const Vector3& from, const Vector3& target, const ObstacleHandle& obstacle, Tree::TREE_ID templateId) const
+	{
+		CurveKey key;
+		for(int i = 0; i < 3; ++i)
+		{
+			key.coordinates_[i]   = (long)std::floor(from(i)   / quantum_ + 0.5);
+			key.coordinates_[i+3] = (long)std::floor(target(i) / quantum_ + 0.5);
+		}
+		key.obstacle_ = obstacle;
+		key.templateId_ = templateId;
+		return key;
+	}
+
+	void Delete(CachedCurve* cached)
+	{
+		curves_.erase(cached->curve_);
+		delete cached->curve_;
+		delete cached;
+	}
+
+	// released curves beyond maxCurves_ are deleted, least recently used first
+	void Trim()
+	{
+		while(keys_.size() > maxCurves_ && !lru_.empty())
+		{
+			CachedCurve* oldest = lru_.front();
+			lru_.pop_front();
+			keys_.erase(oldest->key_);
+			Delete(oldest);
+		}
+	}
+
+	T_Keys keys_;
+	T_Curves curves_;
+	T_Lru lru_;
+	NUMBER quantum_;
+	unsigned int maxCurves_;
+	unsigned int hits_;
+};
+
+TrajectoryCache::TrajectoryCache(NUMBER quantum, unsigned int maxCurves)
+	: pImpl_(new TrajectoryCachePImpl(quantum, maxCurves))
+{
+	// NOTHING
+}
+
+TrajectoryCache::~TrajectoryCache()
+{
+	// NOTHING
+}
+
+TrajectoryCache::curve_t* TrajectoryCache::Find(const Vector3& from, const Vector3& target, const ObstacleHandle& obstacle, Tree::TREE_ID templateId)
+{
+	T_Keys::iterator it = pImpl_->keys_.find(pImpl_->MakeKey(from, target, obstacle, templateId));
+	if(it == pImpl_->keys_.end())
+	{
+		return 0;
+	}
+	CachedCurve* cached = it->second;
+	if(cached->references_ == 0)
+	{
+		pImpl_->lru_.erase(cached->lru_);
+	}
+	++cached->references_;
+	++pImpl_->hits_;
+	return cached->curve_;
+}
+
+void TrajectoryCache::Insert(const Vector3& from, const Vector3& target, const ObstacleHandle& obstacle, Tree::TREE_ID templateId, curve_t* curve)
+{
+	CurveKey key = pImpl_->MakeKey(from, target, obstacle, templateId);
+	T_Keys::iterator it = pImpl_->keys_.find(key);
+	if(it != pImpl_->keys_.end())
+	{
+		// replaced, the previous curve is only kept while it is used
+		CachedCurve* previous = it->second;
+		pImpl_->keys_.erase(it);
+		previous->cached_ = false;
+		if(previous->references_ == 0)
+		{
+			pImpl_->lru_.erase(previous->lru_);
+			pImpl_->Delete(previous);
+		}
+	}
+	CachedCurve* cached = new CachedCurve;
+	cached->curve_ = curve;
+	cached->references_ = 1;
+	cached->cached_ = true;
+	cached->key_ = pImpl_->keys_.insert(std::make_pair(key, cached)).first;
+	pImpl_->curves_.insert(std::make_pair(curve, cached));
+	pImpl_->Trim();
+}
+
+bool TrajectoryCache::Release(const curve_t* curve)
+{
+	T_Curves::iterator it = pImpl_->curves_.find(curve);
+	if(it == pImpl_->curves_.end())
+	{
+		return false;
+	}
+	CachedCurve* cached = it->second;
+	assert(cached->references_ > 0);
+	if(--cached->references_ == 0)
+	{
+		if(cached->cached_)
+		{
+			cached->lru_ = pImpl_->lru_.insert(pImpl_->lru_.end(), cached);
+			pImpl_->Trim();
+		}
+		else
+		{
+			pImpl_->Delete(cached);
+		}
+	}
+	return true;
+}
+
+void TrajectoryCache::Invalidate()
+{
+	for(T_Keys::iterator it = pImpl_->keys_.begin(); it != pImpl_->keys_.end(); ++it)
+	{
+		CachedCurve* cached = it->second;
+		cached->cached_ = false;
+		if(cached->references_ == 0)
+		{
+			pImpl_->Delete(cached);
+		}
+	}
+	pImpl_->keys_.clear();
+	pImpl_->lru_.clear();
+}
+
+void TrajectoryCache::SetBounds(NUMBER quantum, unsigned int maxCurves)
+{
+	if(quantum != pImpl_->quantum_)
+	{
+		Invalidate();
+		pImpl_->quantum_ = quantum;
+	}
+	pImpl_->maxCurves_ = maxCurves;
+	pImpl_->Trim();
+}
+
+unsigned int TrajectoryCache::GetNumCurves() const
+{
+	return (unsigned int)pImpl_->curves_.size();
+}
+
+unsigned int TrajectoryCache::GetNumHits() const
+{
+	return pImpl_->hits_;
+}
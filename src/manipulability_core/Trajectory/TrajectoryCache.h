@@ -0,0 +1,45 @@
+
+#ifndef _CLASS_TRAJECTORYCACHE
+#define _CLASS_TRAJECTORYCACHE
+
+#include "spline/curve_abc.h"
+#include "MatrixDefs.h"
+#include "kinematic/Tree.h"
+
+#include <memory>
+
+struct TrajectoryCachePImpl;
+
+class Obstacle;
+
+/* Swing trajectories shared by the limb transitions that are identical up to a quantum.
+Curves are reference counted, each Find or Insert must be balanced by a Release.
+Released curves remain cached in a least recently used list, bounded to maxCurves.*/
+class TrajectoryCache {
+
+public:
+	typedef spline::curve_abc<> curve_t;
+
+public:
+	 TrajectoryCache(NUMBER quantum = 0.005, unsigned int maxCurves = 256);
+	~TrajectoryCache();
+
+private:
+	TrajectoryCache(const TrajectoryCache&);
+	TrajectoryCache& operator=(const TrajectoryCache&);
+
+public:
+	curve_t* Find  (const matrices::Vector3& /*from*/, const matrices::Vector3& /*target*/, const ObstacleHandle& /*obstacle*/, Tree::TREE_ID /*templateId*/); // 0 if not cached
+	void     Insert(const matrices::Vector3& /*from*/, const matrices::Vector3& /*target*/, const ObstacleHandle& /*obstacle*/, Tree::TREE_ID /*templateId*/, curve_t* /*curve*/); // takes ownership of curve
+	bool     Release(const curve_t* /*curve*/); // false if curve does not come from the cache
+	void     Invalidate(); // forgets all curves, those still in use are deleted when released
+	void     SetBounds(NUMBER /*quantum*/, unsigned int /*maxCurves*/);
+
+	unsigned int GetNumCurves() const;
+	unsigned int GetNumHits  () const;
+
+private:
+	std::auto_ptr<TrajectoryCachePImpl> pImpl_;
+};
+
+#endif //_CLASS_TRAJECTORYCACHE
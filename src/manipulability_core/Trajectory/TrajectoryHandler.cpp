@@ -5,12 +5,15 @@
 #include "kinematic/Tree.h"
 #include "world/Obstacle.h"
 #include "world/ObstacleVisitor_ABC.h"
-#include "world/Intersection.h"
+#include "world/DistanceField.h"
 
 #include "spline/exact_cubic.h"
 #include "spline/exact_bezier.h"
-#include "spline/line_curve.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 using namespace matrices;
 
@@ -22,7 +25,7 @@ struct ReachableObstacles : public ObstacleVisitor_ABC
 		, tree_ (tree)
 		, robot_(robot)
 	{
-		world.Accept(*this);
+		world.AcceptReachable(*this, robot, tree);
 	}
 
 	~ReachableObstacles()
@@ -48,8 +51,10 @@ struct ReachableObstacles : public ObstacleVisitor_ABC
 
 TrajectoryHandler::TrajectoryHandler(const World& world)
 	: world_(world)
+	, clearance_(0.1)
+	, budget_(16)
 {
-	// TODO
+	// NOTHING
 }
 
 TrajectoryHandler::~TrajectoryHandler()
@@ -57,208 +62,180 @@ TrajectoryHandler::~TrajectoryHandler()
 	// NOTHING
 }
 
-//template<typename In>
-//bool Log(In wayPointsBegin, In wayPointsEnd, In newwayPointsBegin, In newwayPointsEnd)
-//{
-//	if(std::distance(wayPointsBegin, wayPointsEnd) > 2)
-//	{
-//		std::stringstream f;
-//		In it(wayPointsBegin);
-//		f << "original waypoints : \n";
-//		while(it != wayPointsEnd )
-//		{
-//			f << " \n waypoint: \n";
-//			f << it->second << "\n";
-//			++it;
-//		}
-//		In it2(newwayPointsBegin);
-//		f << "optimized waypoints : \n";
-//		while(it2 != newwayPointsEnd )
-//		{
-//			f << " \n waypoint: \n";
-//			f << it2->second << "\n";
-//			++it2;
-//		}
-//
-//		std::ofstream myfile;
-//		myfile.open ("log.txt", std::ofstream::out | std::ofstream::app);
-//		if (myfile.is_open())
-//		{
-//			myfile << f.rdbuf();
-//			myfile.close();
-//			return true;
-//		}
-//	}
-//	return false;
-//}
-
-
-#include <list>
-
-
 namespace
 {
+    typedef std::vector<Vector3, Eigen::aligned_allocator<Vector3> >	T_Waypoint;
+	typedef T_Waypoint::const_iterator									CIT_Waypoint;
 
-    typedef std::list<Vector3, Eigen::aligned_allocator<Vector3> >	T_Waypoint;
-	typedef T_Waypoint::const_iterator								CIT_Waypoint;
-	typedef T_Waypoint::iterator									IT_Waypoint;
-
+	const unsigned int maxDepth = 6;
+	const unsigned int maxLiftSteps = 20;
+	const unsigned int samplesPerSegment = 8; // to check the spline
+	const NUMBER minSegmentLength = 0.02; // shorter segments are only checked at their middle
+	const NUMBER endSlope = 0.25; // the required clearance grows from 0 at both extremities of the swing
 
-	// given a segment we are sure to be intersecting one of the obstacle's borders, compute the intersection point
-	bool IntersectObstacleSegment(const Intersection& intersection, const Obstacle& obstacle, const Vector3& a, const Vector3& b, const Vector3& from, const Vector3& to, Vector3& midPoint)
+	// Swing waypoints are inserted where a segment comes too close to an obstacle,
+	// then the segments on each side are checked again.
+	struct SwingRefinement
 	{
-		Vector3 res(0,0,0);
-		Vector3 aproj, bproj, fromproj, toproj;
-		Vector2 aproj2, bproj2, fromproj2, toproj2;;
-		matrices::Matrix4 obsBasis = obstacle.BasisInv();
-		aproj = matrices::matrix4TimesVect3(obsBasis, a);
-		bproj = matrices::matrix4TimesVect3(obsBasis, b);
-		fromproj = matrices::matrix4TimesVect3(obsBasis, from);
-		toproj = matrices::matrix4TimesVect3(obsBasis, to);
-		aproj2 = Vector2(aproj(0), aproj(1));
-		bproj2 = Vector2(bproj(0), bproj(1));
-		fromproj2 = Vector2(fromproj(0), fromproj(1));
-		toproj2 = Vector2(toproj(0), toproj(1));
+		SwingRefinement(const ReachableObstacles::T_Obstacles& obstacles, const DistanceField* field, const Vector3& from, const Vector3& to, NUMBER clearance, unsigned int budget)
+			: obstacles_(obstacles)
+			, field_(field)
+			, from_(from)
+			, to_(to)
+			, clearance_(clearance)
+			, budget_(budget)
+		{
+			// NOTHING
+		}
 
-		double h = obstacle.GetH();
-		double w = obstacle.GetW();
-		Vector2 A(0,h);
-		Vector2 B(w,h);
-		Vector2 C(w,0);
-		Vector2 D(0,0);
+		~SwingRefinement()
+		{
+			// NOTHING
+		}
 
-		Vector2 goodBorderA = A;
-		Vector2 goodBorderB = B;
-		if(!intersection.IntersectSegments(aproj2, bproj2, A, B, res))
+		NUMBER Distance(const Vector3& point, int& closest) const
 		{
-			goodBorderB = D;
-			if(!intersection.IntersectSegments(aproj2, bproj2, A, D, res))
+			NUMBER res = std::numeric_limits<NUMBER>::max();
+			for(std::size_t i = 0; i < obstacles_.size(); ++i)
 			{
-				goodBorderA = B;
-				goodBorderB = C;
-				if(!intersection.IntersectSegments(aproj2, bproj2, B, C, res))
+				NUMBER distance = std::fabs(DistanceField::SignedDistance(*obstacles_[i], point));
+				if(distance < res)
 				{
-					goodBorderA = C;
-					goodBorderB = D;
-					intersection.IntersectSegments(aproj2, bproj2, C, D, res);
+					res = distance;
+					closest = (int)i;
 				}
 			}
+			return res;
 		}
-		intersection.IntersectSegments(fromproj2, toproj2, goodBorderA, goodBorderB, res);
-		if(res == Vector3(0,0,0))
+
+		NUMBER Required(const Vector3& point) const
 		{
-			res = to - from / 2;
-			return false;
+			return std::min(clearance_, endSlope * std::min((point - from_).norm(), (point - to_).norm()));
 		}
-		midPoint = matrices::matrix4TimesVect3(obstacle.Basis(), res);
-		return true;
-	}
 
-	 bool ComputeNewWayPoint(const matrices::Matrix4& mat, const Intersection& intersection, const Tree& current, const Tree& estimated,
-		 const Obstacle& obstacle, const Obstacle& plane, const Vector3& treePos, const Vector3& from, const Vector3& to, const Vector3& intersectionPoint, Vector3& midPoint)
-	{
-		// If there is a collision, it necesseraly means that one of the trees intersects with the plan.
-		// Either the current or the targeted.
-		// Assuming that, we consider this point to compute the closest point in the obstacle
-		// and this will be our next waypoint ( with a small offset of course )
-		if(!intersection.IntersectPlane(current, plane, midPoint))
+		// distances are 1-lipschitz, so the middle of a segment bounds the whole segment
+		bool IsClear(const Vector3& a, const Vector3& b, Vector3& blocked, int& obstacle) const
 		{
-			if(!intersection.IntersectPlane(estimated, plane, midPoint))
+			Vector3 middle = (a + b) / 2;
+			NUMBER radius = (b - a).norm() / 2;
+			NUMBER required = Required(middle);
+			// the required clearance varies by at most endSlope * radius along the segment
+			if(field_ && field_->IsFree(a, b, required + endSlope * radius))
+			{
+				return true;
+			}
+			NUMBER distance = Distance(middle, obstacle);
+			if(distance >= required + (1 + endSlope) * radius)
 			{
-				assert (false);
+				return true;
 			}
+			if(radius * 2 < minSegmentLength)
+			{
+				blocked = middle;
+				return distance >= required;
+			}
+			return IsClear(a, middle, blocked, obstacle) && IsClear(middle, b, blocked, obstacle);
 		}
-		//TODO
-		// now intersect the segment formed by the tree intersection and the trajectory intersection, with the obstacles
-		// this gives us a point on the border. Move it "up" by a small delta along the obstacle normal.
-		if (IntersectObstacleSegment(intersection, obstacle, intersectionPoint, matrices::matrix4TimesVect3(mat, midPoint), from, to, midPoint))
+
+		bool IsClear(const Vector3& a, const Vector3& b) const
 		{
-			Vector3 norm = obstacle.n_;
-			norm.normalize();
-			midPoint = midPoint + norm * 0.6;
-			return true;
+			Vector3 blocked; int obstacle;
+			return IsClear(a, b, blocked, obstacle);
 		}
-		// temp
-		return false;
-	}
 
-	void ComputeCollisionFreePath(
-		const matrices::Matrix4& mat, const Tree& current, const Tree& estimated,
-		T_Waypoint& waypoints, IT_Waypoint it1, IT_Waypoint it2,
-		const Obstacle& obstacle, const Obstacle& plane, const Vector3& treePos)
-	{
-		Intersection intersection;
-		Vector3 intersectionPoint;
-		if(intersection.Intersect(*it1, *it2, obstacle, intersectionPoint))
+		// lifts point until it is clear, otherwise moves it away from the closest point of obstacle
+		Vector3 Push(const Vector3& point, int obstacle) const
 		{
-			Vector3 midPoint;
-			if(ComputeNewWayPoint(mat, intersection, current, estimated, obstacle, plane, treePos, *it1, *it2, intersectionPoint, midPoint))
+			int other;
+			for(unsigned int i = 1; i <= maxLiftSteps; ++i)
 			{
-				IT_Waypoint itMid = waypoints.insert(it2, midPoint);
+				Vector3 lifted = point + Vector3(0, 0, clearance_ * i);
+				if(Distance(lifted, other) >= clearance_)
+				{
+					return lifted;
+				}
 			}
-			/*ComputeCollisionFreePath(mat, current, estimated, waypoints, it1, itMid, obstacle, plane, treePos);
-			  ComputeCollisionFreePath(mat, current, estimated, waypoints, itMid, it2, obstacle, plane, treePos);*/
+			const Obstacle& obs = *obstacles_[obstacle];
+			Vector3 local = matrices::matrix4TimesVect3(obs.BasisInv(), point);
+			local(0) = std::min(std::max(local(0), (NUMBER)0), obs.GetW());
+			local(1) = std::min(std::max(local(1), (NUMBER)0), obs.GetH());
+			local(2) = 0;
+			Vector3 closest = matrices::matrix4TimesVect3(obs.Basis(), local);
+			Vector3 away = point - closest;
+			if(away.norm() < 0.001)
+			{
+				away = DistanceField::SignedDistance(obs, from_) < 0 ? -obs.n_ : obs.n_;
+			}
+			away.normalize();
+			return closest + away * clearance_;
 		}
-	}
 
-    spline::curve_abc<>* MakeSpline(T_Waypoint& waypoints)
-	{
-// CUBIC SPLINE
-		// timeline based on length(1)  
-		/*std::vector<std::pair<double, Vector3> > splinePoints;
-		Vector3& previous(*(waypoints.begin()));
-		float t = 0;
-		previous = *(waypoints.begin());
-		for(CIT_Waypoint it = waypoints.begin(); it!= waypoints.end(); ++it)
+		// refines segment [index, index + 1]
+		void Refine(T_Waypoint& waypoints, std::size_t index, unsigned int depth)
 		{
-			t += (float)(*it - previous).norm();
-			previous = *it;
-			splinePoints.push_back(std::make_pair(t,*it));
+			Vector3 blocked; int obstacle;
+			if(budget_ == 0 || depth >= maxDepth || IsClear(waypoints[index], waypoints[index + 1], blocked, obstacle))
+			{
+				return;
+			}
+			--budget_;
+			waypoints.insert(waypoints.begin() + index + 1, Push(blocked, obstacle));
+			// second half first so that index remains valid
+			Refine(waypoints, index + 1, depth + 1);
+			Refine(waypoints, index, depth + 1);
 		}
-		return new spline::exact_cubic<>(splinePoints.begin(), splinePoints.end());*/
-//
-		
-// Line curve
-		// timeline based on length(1)  
-		/*std::vector<std::pair<double, Vector3> > splinePoints;
-		Vector3& previous(*(waypoints.begin()));
-		float t = 0;
-		previous = *(waypoints.begin());
-		for(CIT_Waypoint it = waypoints.begin(); it!= waypoints.end(); ++it)
+
+		// removes the inserted waypoints that are not needed to clear the obstacles
+		void Prune(T_Waypoint& waypoints, const Vector3& lift) const
 		{
-			t += (float)(*it - previous).norm();
-			previous = *it;
-			splinePoints.push_back(std::make_pair(t,*it));
+			std::size_t i = 1;
+			while(i + 1 < waypoints.size())
+			{
+				if(waypoints[i] != lift && IsClear(waypoints[i-1], waypoints[i+1]))
+				{
+					waypoints.erase(waypoints.begin() + i);
+				}
+				else
+				{
+					++i;
+				}
+			}
 		}
-		return new spline::line_curve<>(splinePoints.begin(), splinePoints.end());*/
-//
 
-// BEZIER CURVE
-		// timeline based on length(1)  
-		std::vector<Vector3> splinePoints;
-		Vector3& previous(*(waypoints.begin()));
+		const ReachableObstacles::T_Obstacles& obstacles_;
+		const DistanceField* field_;
+		const Vector3 from_;
+		const Vector3 to_;
+		const NUMBER clearance_;
+		unsigned int budget_;
+	};
+
+	// timeline based on length
+	void ComputeTimes(const T_Waypoint& waypoints, std::vector<NUMBER>& times)
+	{
+		times.clear();
 		NUMBER t = 0;
-		for(CIT_Waypoint it = waypoints.begin(); it!= waypoints.end(); ++it)
+		for(std::size_t i = 0; i < waypoints.size(); ++i)
 		{
-			t += (*it - previous).norm();
-			previous = *it;
-			splinePoints.push_back(*it);
+			t += i == 0 ? 0 : (waypoints[i] - waypoints[i-1]).norm();
+			times.push_back(t);
 		}
-		return spline::exact_bezier<double, double, 3, false, Eigen::Matrix<double, 3, 1> >(splinePoints.begin(), splinePoints.end(), 0, t);
-//
-// OPTIMIZED STUFF
-		// timeline based on length(1)  
-		/*std::vector<std::pair<double, Vector3> > splinePoints;
-		Vector3& previous(*(waypoints.begin()));
-		float t = 0;
-		previous = *(waypoints.begin());
-		for(CIT_Waypoint it = waypoints.begin(); it!= waypoints.end(); ++it)
+	}
+
+	// C1 spline through the waypoints, a bezier curve for the usual 3 waypoints swing
+	spline::curve_abc<>* MakeSpline(const T_Waypoint& waypoints, const std::vector<NUMBER>& times)
+	{
+		if(waypoints.size() <= 3)
+		{
+			return spline::exact_bezier<double, double, 3, false, Eigen::Matrix<double, 3, 1> >(waypoints.begin(), waypoints.end(), 0, times.back());
+		}
+		std::vector<std::pair<double, Vector3> > splinePoints;
+		splinePoints.reserve(waypoints.size());
+		for(std::size_t i = 0; i < waypoints.size(); ++i)
 		{
-			t += (float)(*it - previous).norm();
-			previous = *it;
-			splinePoints.push_back(std::make_pair(t,*it));
+			splinePoints.push_back(std::make_pair(times[i], waypoints[i]));
 		}
-		return optimizer.GenerateOptimizedCurve(splinePoints.begin(), splinePoints.end());*/
+		return new spline::exact_cubic<>(splinePoints.begin(), splinePoints.end());
 	}
 }
 
@@ -266,24 +243,69 @@ spline::curve_abc<>* TrajectoryHandler::ComputeTrajectory(const Robot& robot, co
 {
 	// Real world target Position
 	Vector3 from = matrices::matrix4TimesVect3(robot.ToWorldCoordinates(), current.GetEffectorPosition(current.GetNumEffector()-1));
-	// Real world tree Position
-	Vector3 treePos = matrices::matrix4TimesVect3(robot.ToWorldCoordinates(), current.GetPosition());
 	ReachableObstacles reachableObstacles(world_, current, robot);
 	T_Waypoint waypoints;
-	IT_Waypoint it1 = waypoints.insert(waypoints.end(), from);
+	waypoints.push_back(from);
 	Vector3 midPoint = from + (target - from) / 2;
 	midPoint(2) += 0.2;
-	waypoints.insert(waypoints.end(), midPoint);
-	IT_Waypoint it2 = waypoints.insert(waypoints.end(), target);
-	//for(ReachableObstacles::T_ObstaclesCIT it = reachableObstacles.obstacles_.begin(); it != reachableObstacles.obstacles_.end(); ++it)
-	//{
-	//	matrices::Matrix4 mat = robot.ToRobotCoordinates();
-	//	// create obstacle with good coordinates
-	//	Obstacle obs(	matrices::matrix4TimesVect3(mat, (*it)->GetP1()),
-	//					matrices::matrix4TimesVect3(mat, (*it)->GetP2()),
-	//					matrices::matrix4TimesVect3(mat, (*it)->GetP3()),
-	//					matrices::matrix4TimesVect3(mat, (*it)->GetP4()));
-	//	ComputeCollisionFreePath(robot.ToWorldCoordinates(), current, estimated, waypoints, it1, it2, **it, obs, treePos);
-	//}
-    return MakeSpline(waypoints);
+	waypoints.push_back(midPoint);
+	waypoints.push_back(target);
+	std::vector<NUMBER> times;
+	if(reachableObstacles.obstacles_.empty())
+	{
+		ComputeTimes(waypoints, times);
+		return MakeSpline(waypoints, times);
+	}
+	SwingRefinement refinement(reachableObstacles.obstacles_, world_.GetDistanceField(), from, target, clearance_, budget_);
+	int obstacle;
+	if(refinement.Distance(midPoint, obstacle) < clearance_)
+	{
+		midPoint = refinement.Push(midPoint, obstacle);
+		waypoints[1] = midPoint;
+	}
+	for(std::size_t i = waypoints.size() - 1; i > 0; --i)
+	{
+		refinement.Refine(waypoints, i - 1, 0);
+	}
+	refinement.Prune(waypoints, midPoint);
+	ComputeTimes(waypoints, times);
+	spline::curve_abc<>* res = MakeSpline(waypoints, times);
+	// the spline goes away from the segments, check it and refine where it is blocked
+	T_Waypoint samples;
+	std::vector<double> sampleTimes;
+	while(refinement.budget_ > 0)
+	{
+		std::size_t nbSamples = samplesPerSegment * (waypoints.size() - 1) + 1;
+		sampleTimes.resize(nbSamples);
+		samples.resize(nbSamples);
+		for(std::size_t i = 0; i < nbSamples; ++i)
+		{
+			sampleTimes[i] = times.back() * i / (nbSamples - 1);
+		}
+		res->evaluate(&sampleTimes[0], nbSamples, &samples[0]);
+		Vector3 blocked;
+		std::size_t i = 1;
+		while(i < nbSamples && refinement.IsClear(samples[i-1], samples[i], blocked, obstacle))
+		{
+			++i;
+		}
+		if(i == nbSamples)
+		{
+			break;
+		}
+		std::size_t index = std::upper_bound(times.begin(), times.end(), sampleTimes[i]) - times.begin();
+		index = std::min(std::max(index, (std::size_t)1), waypoints.size() - 1);
+		waypoints.insert(waypoints.begin() + index, refinement.Push(blocked, obstacle));
+		--refinement.budget_;
+		ComputeTimes(waypoints, times);
+		delete res;
+		res = MakeSpline(waypoints, times);
+	}
+    return res;
+}
+
+void TrajectoryHandler::SetRefinement(NUMBER clearance, unsigned int budget)
+{
+	clearance_ = clearance;
+	budget_ = budget;
 }
@@ -26,9 +26,13 @@ private:
 
 public:
 	spline::curve_abc<>* ComputeTrajectory(const Robot& /*robot*/, const Tree& /*current*/, const Tree& /*estimated*/, const matrices::Vector3& /*target*/);
+	// clearance kept between the swing and the reachable obstacles, at most budget waypoints are inserted to reach it
+	void SetRefinement(NUMBER /*clearance*/, unsigned int /*budget*/);
 	
 private:
     const World& world_;
+	NUMBER clearance_;
+	unsigned int budget_;
 };
 
 
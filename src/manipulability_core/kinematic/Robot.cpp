@@ -5,8 +5,7 @@
 
 #include "world/World.h"
 #include "kinematic/Com.h"
-#include "kinematic/ComVisitor_ABC.h"
-#include "kinematic/SupportPolygon.h"
+#include "kinematic/Stability.h"
 
 #include "API/TreeI.h"
 
@@ -81,36 +80,7 @@ struct RobotPImpl
 	Robot::T_Tree trees_;
 	Tree* torso_;
 	Robot::T_Hierarchy hierarchy_;
-};
-
-struct ComVisitor : public ComVisitor_ABC
-{
-	 ComVisitor()
-		: ComVisitor_ABC()
-		, sigmaAi_(0.f)
-		, positionSum_(0, 0, 0)
-	 {
-		// NOTHING
-	 }
-	~ComVisitor()
-	 {
-		// NOTHING
-	 }
-
-	// source http://fr.wikipedia.org/wiki/Fonctions_de_Leibniz#Fonction_vectorielle_de_Leibniz
-void VisitCom(const matrices::Vector3& position, const float& weight)
-	{
-		positionSum_ += weight * position;
-		sigmaAi_ += weight;
-	}
-
-	Vector3 GetCom() const
-	{
-		return ( 1.f / sigmaAi_ ) * positionSum_;
-	}
-
-	float sigmaAi_;
-	Vector3 positionSum_;;
+	std::auto_ptr<Stability> stability_;
 };
 
 Robot::Robot(const Matrix4& transform, Tree* torsoAndHead, manip_core::enums::robot::eRobots robotType)
@@ -118,6 +88,7 @@ Robot::Robot(const Matrix4& transform, Tree* torsoAndHead, manip_core::enums::ro
 	, numTrees_(0)
 	, robotType_(robotType)
 {
+	pImpl_->stability_.reset(new Stability(*this));
 	// which constraints are we going to use ?
 //	pImpl_->ikSolver_.Register(new ForceManipulabilityConstraint);
 }
@@ -197,18 +168,40 @@ Tree* Robot::GetTree(Tree::TREE_ID id) const
 	return id >= numTrees_ ? 0 : pImpl_->trees_[id];
 }
 
+// sum of the cached tree contributions, see Tree::GetComSum
 matrices::Vector3 Robot::ComputeCom() const
 {
-	ComVisitor visitor;
+	Vector3 sum(0,0,0);
+	NUMBER mass = GetMass();
 	for(T_TreeCIT it = pImpl_->trees_.begin(); it!= pImpl_->trees_.end(); ++it)
 	{
-		(*it)->AcceptComVisitor(&visitor);
+		sum += (*it)->GetComSum();
 	}
 	if(pImpl_->torso_)
 	{
-		pImpl_->torso_->AcceptComVisitor(&visitor);
+		sum += pImpl_->torso_->GetComSum();
 	}
-	return visitor.GetCom();
+	return sum / mass;
+}
+
+NUMBER Robot::GetMass() const
+{
+	NUMBER mass = 0;
+	for(T_TreeCIT it = pImpl_->trees_.begin(); it!= pImpl_->trees_.end(); ++it)
+	{
+		mass += (*it)->GetMass();
+	}
+	if(pImpl_->torso_)
+	{
+		mass += pImpl_->torso_->GetMass();
+	}
+	return mass;
+}
+
+void Robot::ComputeComJacobian(const Tree& tree, matrices::MatrixX& jacobian) const
+{
+	tree.ComputeComJacobian(jacobian);
+	jacobian /= GetMass();
 }
 
 
@@ -217,15 +210,18 @@ bool Robot::ComputeCom(double* directionVector) const
 {
 	Vector3 com(ComputeCom());
 	matrices::vect3ToArray(directionVector, com);
-	SupportPolygon sp(*this);
-	return sp.Contains(com);
+	return GetStability().Contains(com);
 }
 
+const Stability& Robot::GetStability() const
+{
+	pImpl_->stability_->Update();
+	return *pImpl_->stability_;
+}
 
 void Robot::ComTarget(double* directionVector) const
 {
-	SupportPolygon sp(*this);
-	Vector3 res = sp.Centroid();
+	Vector3 res = GetStability().Centroid();
 	directionVector[0] = res(0);
 	directionVector[1] = res(1);
 	directionVector[2] = res(2);
@@ -332,6 +328,22 @@ Robot* Robot::Clone() const
 	return res;
 }
 
+// as in Clone, the torso keeps its angles and trees are put back to rest by AddTree
+void Robot::CopyFrom(const Robot& robot)
+{
+	assert(pImpl_->trees_.size() == robot.pImpl_->trees_.size());
+	SetPosOri(robot.ToWorldCoordinates());
+	pImpl_->torso_->CopyFrom(*robot.pImpl_->torso_);
+	for(unsigned int i = 0; i < pImpl_->trees_.size(); ++i)
+	{
+		Tree* tree = pImpl_->trees_[i];
+		tree->CopyFrom(*robot.pImpl_->trees_[i]);
+		tree->ToRest();
+		tree->directionForce_ = Vector3(0,0,1);
+		tree->directionVel_ = Vector3(1,0,0);
+	}
+}
+
 void Robot::Rest()
 {
 	for(T_TreeIT it = pImpl_->trees_.begin(); it!= pImpl_->trees_.end(); ++it)
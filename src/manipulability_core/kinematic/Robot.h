@@ -16,6 +16,7 @@ struct RobotPImpl;
 
 class RobotVisitor_ABC;
 class World;
+class Stability;
 
 namespace manip_core
 {
@@ -49,7 +50,10 @@ public:
 	T_Tree& GetTrees() const;
 	const T_Hierarchy& GetHierarchy() const;
 	matrices::Vector3 ComputeCom() const;
+	NUMBER GetMass() const;
+	void ComputeComJacobian(const Tree& /*tree*/, matrices::MatrixX& /*jacobian*/) const; // derivatives of the com with respect to the joints of tree
 	matrices::Vector3 ComputeTargetCom() const;
+	const Stability& GetStability() const; // support polygon of the locked trees, updated on call
 	const manip_core::enums::robot::eRobots& RobotType() const;
 
 // inherited
@@ -78,6 +82,7 @@ public:
 	void SetPosOri(const matrices::Matrix4& /*transform*/); 
 
 	Robot* Clone() const;
+	void CopyFrom(const Robot& /*robot*/); // same result as robot.Clone() without allocating, robot must have been cloned from the same model
 
 private:
 	std::auto_ptr<RobotPImpl> pImpl_;
@@ -0,0 +1,451 @@
+
+#include "Stability.h"
+#include "Robot.h"
+#include "kinematic/Tree.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+using namespace matrices;
+
+namespace
+{
+	const NUMBER Epsilon = 0.1; // tolerance used when there are less than three contacts, as in SupportPolygon
+
+	struct Contact
+	{
+		NUMBER x_, y_, z_;
+		Tree::TREE_ID id_;
+	};
+
+	// >0 if (x, y) is left of the line going through a then b
+	NUMBER IsLeft(const Contact& a, const Contact& b, NUMBER x, NUMBER y)
+	{
+		return (b.x_ - a.x_) * (y - a.y_) - (x - a.x_) * (b.y_ - a.y_);
+	}
+
+	bool LessXY(const Contact& a, const Contact& b)
+	{
+		return a.x_ < b.x_ || (a.x_ == b.x_ && a.y_ < b.y_);
+	}
+
+	NUMBER DistancePointSegment(NUMBER x, NUMBER y, const Contact& a, const Contact& b)
+	{
+		NUMBER abx = b.x_ - a.x_, aby = b.y_ - a.y_;
+		NUMBER apx = x - a.x_, apy = y - a.y_;
+		NUMBER l2 = abx * abx + aby * aby;
+		NUMBER t = l2 > 0 ? (apx * abx + apy * aby) / l2 : 0;
+		t = t < 0 ? 0 : (t > 1 ? 1 : t);
+		apx -= t * abx; apy -= t * aby;
+		return sqrt(apx * apx + apy * apy);
+	}
+
+	// Andrew's monotone chain ; points are sorted in place and hull receives the counter clockwise
+	// vertices, without repeating the first one. hull must have room for 2 * n points
+	unsigned int BuildHull(Contact* points, unsigned int n, Contact* hull)
+	{
+		if(n < 3)
+		{
+			std::copy(points, points + n, hull);
+			return n;
+		}
+		std::sort(points, points + n, LessXY);
+		unsigned int k = 0;
+		for(unsigned int i = 0; i < n; ++i)
+		{
+			while(k >= 2 && IsLeft(hull[k-2], hull[k-1], points[i].x_, points[i].y_) <= 0) --k;
+			hull[k++] = points[i];
+		}
+		for(unsigned int i = n - 1, t = k + 1; i > 0; --i)
+		{
+			while(k >= t && IsLeft(hull[k-2], hull[k-1], points[i-1].x_, points[i-1].y_) <= 0) --k;
+			hull[k++] = points[i-1];
+		}
+		return k - 1;
+	}
+
+	// inserts p into a counter clockwise hull of at least three points.
+	// The edges seen from p form a single chain, whose inner vertices are replaced by p.
+	// Returns the new number of vertices, 0 if the hull is degenerated.
+	unsigned int InsertHull(Contact* hull, unsigned int h, const Contact& p, Contact* tmp)
+	{
+		unsigned int first = h, last = h, nbVisible = 0;
+		bool previous = IsLeft(hull[h-1], hull[0], p.x_, p.y_) < 0;
+		for(unsigned int i = 0; i < h; ++i)
+		{
+			bool visible = IsLeft(hull[i], hull[(i+1) % h], p.x_, p.y_) < 0;
+			if(visible)
+			{
+				++nbVisible;
+				if(!previous) first = i;
+			}
+			else if(previous)
+			{
+				last = i;
+			}
+			previous = visible;
+		}
+		if(nbVisible == 0)
+		{
+			return h; // p is inside
+		}
+		if(first == h || last == h)
+		{
+			return 0;
+		}
+		unsigned int k = 0;
+		for(unsigned int i = last; ; i = (i+1) % h)
+		{
+			tmp[k++] = hull[i];
+			if(i == first) break;
+		}
+		tmp[k++] = p;
+		std::copy(tmp, tmp + k, hull);
+		return k;
+	}
+
+	bool InPolygon(const Contact* hull, unsigned int h, NUMBER x, NUMBER y)
+	{
+		if(h == 0)
+		{
+			return false;
+		}
+		else if(h == 1)
+		{
+			NUMBER dx = x - hull[0].x_, dy = y - hull[0].y_;
+			return sqrt(dx * dx + dy * dy) < Epsilon;
+		}
+		else if(h == 2)
+		{
+			return DistancePointSegment(x, y, hull[0], hull[1]) < Epsilon;
+		}
+		for(unsigned int i = 0; i < h; ++i)
+		{
+			if(IsLeft(hull[i], hull[(i+1) % h], x, y) < 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// same test as Intersection::IntersectSegments
+	bool Crosses(NUMBER ax, NUMBER ay, NUMBER bx, NUMBER by, const Contact& c, const Contact& d)
+	{
+		Contact a, b;
+		a.x_ = ax; a.y_ = ay; b.x_ = bx; b.y_ = by;
+		return IsLeft(a, b, c.x_, c.y_) * IsLeft(a, b, d.x_, d.y_) < 0
+			&& IsLeft(c, d, a.x_, a.y_) * IsLeft(c, d, b.x_, b.y_) < 0;
+	}
+
+	NUMBER DotNormalized(NUMBER x, NUMBER y, NUMBER dx, NUMBER dy)
+	{
+		NUMBER n = sqrt(x * x + y * y);
+		return n > 0 ? (x * dx + y * dy) / n : 0;
+	}
+
+	NUMBER HullMargin(const Contact* hull, unsigned int h, const Vector3& com)
+	{
+		if(h == 0)
+		{
+			return -std::numeric_limits<NUMBER>::max();
+		}
+		else if(h == 1)
+		{
+			return Epsilon - DistancePointSegment(com.x(), com.y(), hull[0], hull[0]);
+		}
+		else if(h == 2)
+		{
+			return Epsilon - DistancePointSegment(com.x(), com.y(), hull[0], hull[1]);
+		}
+		NUMBER inside = std::numeric_limits<NUMBER>::max();
+		NUMBER outside = std::numeric_limits<NUMBER>::max();
+		for(unsigned int i = 0; i < h; ++i)
+		{
+			const Contact& a = hull[i];
+			const Contact& b = hull[(i+1) % h];
+			NUMBER length = sqrt((b.x_ - a.x_) * (b.x_ - a.x_) + (b.y_ - a.y_) * (b.y_ - a.y_));
+			inside = std::min(inside, IsLeft(a, b, com.x(), com.y()) / length);
+			outside = std::min(outside, DistancePointSegment(com.x(), com.y(), a, b));
+		}
+		return inside >= 0 ? inside : -outside;
+	}
+}
+
+struct StabilityPImpl
+{
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	StabilityPImpl(const Robot& robot)
+		: robot_(robot)
+		, dirty_(true)
+		, nbTrees_(0)
+		, nbHull_(0)
+	{
+		// NOTHING
+	}
+
+	~StabilityPImpl()
+	{
+		// NOTHING
+	}
+
+	void Project(const Tree& tree, Contact& contact) const
+	{
+		Vector3 p = matrix4TimesVect3(toRobot_, tree.GetTarget());
+		contact.x_ = p.x(); contact.y_ = p.y(); contact.z_ = p.z();
+		contact.id_ = tree.GetId();
+	}
+
+	void Update()
+	{
+		const Robot::T_Tree& trees = robot_.GetTrees();
+		unsigned int nbTrees = std::min((unsigned int)(trees.size()), (unsigned int)(Stability::maxContacts));
+		bool rebuild = dirty_ || nbTrees != nbTrees_ || robot_.ToRobotCoordinates() != toRobot_;
+		if(rebuild)
+		{
+			dirty_ = false;
+			nbTrees_ = nbTrees;
+			toRobot_ = robot_.ToRobotCoordinates();
+		}
+		unsigned int added = 0;
+		bool lost = false;
+		Contact newContact;
+		for(unsigned int i = 0; i < nbTrees; ++i)
+		{
+			const Tree* tree = trees[i];
+			if(!rebuild && tree == trees_[i] && tree->GetContactRevision() == revisions_[i])
+			{
+				continue;
+			}
+			lost = lost || (locked_[i] && tree == trees_[i]);
+			trees_[i] = tree;
+			revisions_[i] = tree->GetContactRevision();
+			locked_[i] = tree->IsLocked();
+			if(locked_[i])
+			{
+				Project(*tree, contacts_[i]);
+				newContact = contacts_[i];
+				++added;
+			}
+		}
+		if(rebuild || lost || added > 1 || (added == 1 && nbHull_ < 3))
+		{
+			Rebuild();
+		}
+		else if(added == 1)
+		{
+			nbHull_ = InsertHull(hull_, nbHull_, newContact, scratch_);
+			if(nbHull_ == 0)
+			{
+				Rebuild();
+			}
+		}
+	}
+
+	void Rebuild()
+	{
+		unsigned int n = 0;
+		for(unsigned int i = 0; i < nbTrees_; ++i)
+		{
+			if(locked_[i]) scratch_[n++] = contacts_[i];
+		}
+		nbHull_ = BuildHull(scratch_, n, hull_);
+	}
+
+	// hull edges in the order SupportPolygon's gift wrapping visits them (clockwise, from the left most point)
+	void Edge(unsigned int k, const Contact*& a, const Contact*& b) const
+	{
+		a = &hull_[(nbHull_ - k) % nbHull_];
+		b = &hull_[(2 * nbHull_ - k - 1) % nbHull_];
+	}
+
+	void Centroid(NUMBER& x, NUMBER& y) const
+	{
+		x = 0; y = 0;
+		for(unsigned int i = 0; i < nbHull_; ++i)
+		{
+			x += hull_[i].x_; y += hull_[i].y_;
+		}
+		if(nbHull_ > 0)
+		{
+			x /= nbHull_; y /= nbHull_;
+		}
+	}
+
+	Tree::TREE_ID GetTreeToLift(NUMBER comX, NUMBER comY, const Vector3& direction) const
+	{
+		if(nbHull_ < 2)
+		{
+			return (Tree::TREE_ID) (-1);
+		}
+		NUMBER cx, cy;
+		Centroid(cx, cy);
+		NUMBER dn = sqrt(direction.x() * direction.x() + direction.y() * direction.y());
+		NUMBER dx = dn > 0 ? direction.x() / dn : 0, dy = dn > 0 ? direction.y() / dn : 0;
+		unsigned int nbEdges = nbHull_ == 2 ? 1 : nbHull_;
+		const Contact* A; const Contact* B;
+		for(unsigned int k = 0; k < nbEdges; ++k)
+		{
+			Edge(k, A, B);
+			if(nbHull_ == 2 || Crosses(cx, cy, comX, comY, *A, *B))
+			{
+				// if com to A goes along direction, we lift the other one
+				if(DotNormalized(A->x_ - comX, A->y_ - comY, dx, dy) > 0)
+				{
+					return B->id_;
+				}
+				else if(DotNormalized(B->x_ - comX, B->y_ - comY, dx, dy) > 0)
+				{
+					return A->id_;
+				}
+				else
+				{
+					NUMBER da = (comX - A->x_) * (comX - A->x_) + (comY - A->y_) * (comY - A->y_);
+					NUMBER db = (comX - B->x_) * (comX - B->x_) + (comY - B->y_) * (comY - B->y_);
+					return da > db ? A->id_ : B->id_;
+				}
+			}
+		}
+		return (Tree::TREE_ID) (-1);
+	}
+
+	const Robot& robot_;
+	matrices::Matrix4 toRobot_;
+	bool dirty_;
+	unsigned int nbTrees_;
+	const Tree* trees_[Stability::maxContacts];
+	unsigned long revisions_[Stability::maxContacts];
+	bool locked_[Stability::maxContacts];
+	Contact contacts_[Stability::maxContacts]; // indexed as the robot trees
+	Contact hull_[2 * Stability::maxContacts];
+	Contact scratch_[2 * Stability::maxContacts];
+	unsigned int nbHull_;
+};
+
+Stability::Stability(const Robot& robot)
+	: pImpl_(new StabilityPImpl(robot))
+{
+	// NOTHING
+}
+
+Stability::~Stability()
+{
+	// NOTHING
+}
+
+void Stability::Update()
+{
+	pImpl_->Update();
+}
+
+Vector3 Stability::Centroid() const
+{
+	Vector3 res(0, 0, 0);
+	pImpl_->Centroid(res(0), res(1));
+	unsigned int n = 0;
+	for(unsigned int i = 0; i < pImpl_->nbTrees_; ++i)
+	{
+		if(pImpl_->locked_[i])
+		{
+			res(2) += pImpl_->contacts_[i].z_;
+			++n;
+		}
+	}
+	if(n > 0) res(2) /= n;
+	return res;
+}
+
+unsigned int Stability::GetNumContacts() const
+{
+	unsigned int n = 0;
+	for(unsigned int i = 0; i < pImpl_->nbTrees_; ++i)
+	{
+		if(pImpl_->locked_[i]) ++n;
+	}
+	return n;
+}
+
+bool Stability::Contains(const matrices::Vector3& com) const
+{
+	return InPolygon(pImpl_->hull_, pImpl_->nbHull_, com.x(), com.y());
+}
+
+NUMBER Stability::Margin(const matrices::Vector3& com) const
+{
+	return HullMargin(pImpl_->hull_, pImpl_->nbHull_, com);
+}
+
+bool Stability::WouldContain(const matrices::Vector3& com, Tree::TREE_ID treeId, const matrices::Vector3& target) const
+{
+	Contact points[maxContacts + 1];
+	Contact hull[2 * (maxContacts + 1)];
+	unsigned int n = 0;
+	for(unsigned int i = 0; i < pImpl_->nbTrees_; ++i)
+	{
+		if(pImpl_->locked_[i] && pImpl_->contacts_[i].id_ != treeId)
+		{
+			points[n++] = pImpl_->contacts_[i];
+		}
+	}
+	Vector3 p = matrix4TimesVect3(pImpl_->toRobot_, target);
+	points[n].x_ = p.x(); points[n].y_ = p.y(); points[n].z_ = p.z();
+	points[n++].id_ = treeId;
+	return InPolygon(hull, BuildHull(points, n, hull), com.x(), com.y());
+}
+
+NUMBER Stability::WouldMargin(const matrices::Vector3& com, const Tree::TREE_ID* treeIds, const matrices::Vector3* targets, unsigned int nbTargets) const
+{
+	Contact points[2 * maxContacts];
+	Contact hull[4 * maxContacts];
+	unsigned int n = 0;
+	for(unsigned int i = 0; i < pImpl_->nbTrees_; ++i)
+	{
+		if(pImpl_->locked_[i] && std::find(treeIds, treeIds + nbTargets, pImpl_->contacts_[i].id_) == treeIds + nbTargets)
+		{
+			points[n++] = pImpl_->contacts_[i];
+		}
+	}
+	for(unsigned int i = 0; i < nbTargets && n < 2 * maxContacts; ++i)
+	{
+		// a tree moved several times keeps its last target
+		if(std::find(treeIds + i + 1, treeIds + nbTargets, treeIds[i]) == treeIds + nbTargets)
+		{
+			Vector3 p = matrix4TimesVect3(pImpl_->toRobot_, targets[i]);
+			points[n].x_ = p.x(); points[n].y_ = p.y(); points[n].z_ = p.z();
+			points[n++].id_ = treeIds[i];
+		}
+	}
+	return HullMargin(hull, BuildHull(points, n, hull), com);
+}
+
+Tree::TREE_ID Stability::ComputeTreeToLift(const matrices::Vector3& com, const matrices::Vector3& direction) const
+{
+	return pImpl_->GetTreeToLift(com.x(), com.y(), direction);
+}
+
+Tree::TREE_ID Stability::ComputeTreeToLift(const matrices::Vector3& com, const matrices::Vector3& direction, const std::vector<Tree::TREE_ID>& candidates, Tree::TREE_ID lastLifted) const
+{
+	Tree::TREE_ID res = pImpl_->GetTreeToLift(com.x(), com.y(), direction);
+	// com is not out, just grab the further away from the direction
+	if(res < 0)
+	{
+		NUMBER dn = sqrt(direction.x() * direction.x() + direction.y() * direction.y());
+		NUMBER dx = dn > 0 ? direction.x() / dn : 0, dy = dn > 0 ? direction.y() / dn : 0;
+		NUMBER minCos = 1;
+		for(unsigned int i = 0; i < pImpl_->nbHull_; ++i)
+		{
+			const Contact& a = pImpl_->hull_[i];
+			if(a.id_ != lastLifted && std::find(candidates.begin(), candidates.end(), a.id_) != candidates.end())
+			{
+				NUMBER c = DotNormalized(a.x_ - com.x(), a.y_ - com.y(), dx, dy);
+				if(c <= minCos)
+				{
+					minCos = c;
+					res = a.id_;
+				}
+			}
+		}
+	}
+	return res;
+}
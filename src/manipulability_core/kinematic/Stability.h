@@ -0,0 +1,52 @@
+
+#ifndef _CLASS_STABILITY
+#define _CLASS_STABILITY
+
+#include "MatrixDefs.h"
+#include "kinematic/Tree.h"
+
+#include <memory>
+#include <vector>
+
+struct StabilityPImpl;
+
+class Robot;
+
+/* Support polygon of a robot kept up to date between requests.
+Contacts are the targets of the locked trees, projected in robot coordinates.
+Update only reprojects the trees whose lock changed since the previous call,
+a new contact is inserted into the current hull, and the hull is only rebuilt when a contact is lost
+or when the robot moves.*/
+class Stability
+{
+
+public:
+	enum { maxContacts = 16 };
+
+public:
+	 explicit Stability(const Robot& /*robot*/);
+	~Stability();
+
+private:
+	Stability(const Stability&);
+	Stability& operator=(const Stability&);
+
+public:
+	void Update(); // called by Robot::GetStability
+
+//request
+public:
+	matrices::Vector3 Centroid() const;
+	unsigned int GetNumContacts() const;
+	bool Contains(const matrices::Vector3& /*com*/) const;
+	NUMBER Margin(const matrices::Vector3& /*com*/) const; // distance from com to the polygon border, negative outside
+	bool WouldContain(const matrices::Vector3& /*com*/, Tree::TREE_ID /*treeId*/, const matrices::Vector3& /*target*/) const; // if tree was locked on target (world coordinates)
+	NUMBER WouldMargin(const matrices::Vector3& /*com*/, const Tree::TREE_ID* /*treeIds*/, const matrices::Vector3* /*targets*/, unsigned int /*nbTargets*/) const; // if each tree was locked on its target (world coordinates)
+	Tree::TREE_ID ComputeTreeToLift(const matrices::Vector3& /*com*/, const matrices::Vector3& /*direction*/) const;
+	Tree::TREE_ID ComputeTreeToLift(const matrices::Vector3& /*com*/, const matrices::Vector3& /*direction*/, const std::vector<Tree::TREE_ID>& /*candidates*/, Tree::TREE_ID /*LastLifted*/) const;
+
+private:
+	std::auto_ptr<StabilityPImpl> pImpl_;
+};
+
+#endif //_CLASS_STABILITY
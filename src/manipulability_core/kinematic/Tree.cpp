@@ -13,17 +13,22 @@ using namespace Eigen;
 using namespace manip_core::enums;
 
 Tree::Tree(TREE_ID id, eMembers treeType)
-: sphereRadius_(0)
-, lock_(false)
+: direction_(1,0,0)
+, targetReached_(true)
+, onObstacle_(false)
+, targetSample_(0)
+, worldRevision_(0)
 , jacobian_(0)
+, obsTarget_()
+, obsNormal_(0, 0, 1)
+, lock_(false)
+, contactRevision_(0)
+, comDirty_(true)
+, mass_(0)
 , id_(id)
 , templateId_(id)
+, sphereRadius_(0)
 , treeType_(treeType)
-, targetReached_(true)
-, direction_(1,0,0)
-, obsTarget_(0)
-, onObstacle_(false)
-, targetSample_(0)
 {
 	directionForce_  = Vector3(0, 1, 0);
 	directionVel_ = Vector3(1, 0, 0);
@@ -33,15 +38,20 @@ Tree::Tree(TREE_ID id, eMembers treeType)
 }
 
 Tree::Tree(TREE_ID id, TREE_ID templateId, eMembers treeType)
-: sphereRadius_(0)
-, lock_(false)
+: onObstacle_(false)
+, targetSample_(0)
+, worldRevision_(0)
 , jacobian_(0)
+, obsTarget_()
+, obsNormal_(0, 0, 1)
+, lock_(false)
+, contactRevision_(0)
+, comDirty_(true)
+, mass_(0)
 , id_(id)
 , templateId_(templateId)
+, sphereRadius_(0)
 , treeType_(treeType)
-, obsTarget_(0)
-, onObstacle_(false)
-, targetSample_(0)
 {
 	directionForce_  = Vector3(0, 1, 0);
 	directionVel_ = Vector3(1, 0, 0);
@@ -65,7 +75,18 @@ Tree::~Tree()
 
 void Tree::LockTarget(const matrices::Vector3& target, const Obstacle* obsTarget)
 { 
-	target_ = target; lock_ = true; obsTarget_ = obsTarget; onObstacle_ = true; 
+	target_ = target; lock_ = true; ++contactRevision_;
+	onObstacle_ = obsTarget != 0;
+	obsTarget_ = onObstacle_ ? obsTarget->handle_ : ObstacleHandle();
+	if(onObstacle_)
+	{
+		obsNormal_ = obsTarget->n_;
+	}
+}
+
+void Tree::LockTarget(const matrices::Vector3& target, const ObstacleHandle& obsTarget, const matrices::Vector3& obsNormal)
+{
+	target_ = target; lock_ = true; obsTarget_ = obsTarget; obsNormal_ = obsNormal; onObstacle_ = true; ++contactRevision_;
 }
 
 
@@ -90,7 +111,7 @@ bool Tree::GetObstacleNormal(double* target) const
 {
 	if(onObstacle_)
 	{
-		matrices::vect3ToArray(target, obsTarget_->n_);
+		matrices::vect3ToArray(target, obsNormal_);
 		return true;
 	}
 	else
@@ -249,6 +270,7 @@ void Tree::ComputeTree(Joint* joint)
 void Tree::Compute(void)
 { 
 	ComputeTree(root); 
+	comDirty_ = true;
 }
 
 // Recursively initialize this below the Joint
@@ -307,12 +329,38 @@ Tree* Tree::Clone() const
 		res->LockTarget(target_);
 	}
 	res->obsTarget_ = obsTarget_;
+	res->obsNormal_ = obsNormal_;
 	res->onObstacle_ = onObstacle_;
+	res->worldRevision_ = worldRevision_;
 	res->direction_ = direction_;
 	res->Compute();
 	return res;
 }
 
+void Tree::CopyFrom(const Tree& tree)
+{
+	Joint* n1 = GetRoot();
+	Joint* n2 = tree.GetRoot();
+	while(n1 && n2)
+	{
+		n1->theta_ = n2->theta_;
+		n1 = n1->pChild_;
+		n2 = n2->pChild_;
+	}
+	assert(!n1 && !n2);
+	lock_ = tree.lock_;
+	target_ = tree.target_;
+	targetReached_ = tree.targetReached_;
+	targetSample_ = 0;
+	obsTarget_ = tree.obsTarget_;
+	obsNormal_ = tree.obsNormal_;
+	onObstacle_ = tree.onObstacle_;
+	worldRevision_ = tree.worldRevision_;
+	direction_ = tree.direction_;
+	++contactRevision_;
+	Compute();
+}
+
 void Tree::AcceptComVisitor(ComVisitor_ABC* visitor) const
 {
 	Joint* n = this->GetRoot();
@@ -323,6 +371,69 @@ void Tree::AcceptComVisitor(ComVisitor_ABC* visitor) const
 	}
 }
 
+void Tree::UpdateCom() const
+{
+	if(comDirty_)
+	{
+		comSum_ = Vector3(0,0,0);
+		mass_ = 0;
+		Joint* n = this->GetRoot();
+		while(n)
+		{
+			const Com& com = n->GetCom();
+			if(com.weight_ != 0)
+			{
+				Vector3 proximal = n->pRealparent_ ? n->pRealparent_->GetS() : Vector3(0,0,0);
+				comSum_ += com.weight_ * com.Compute(proximal, n->GetS());
+				mass_ += com.weight_;
+			}
+			n = n->pChild_;
+		}
+		comDirty_ = false;
+	}
+}
+
+const Vector3& Tree::GetComSum() const
+{
+	UpdateCom();
+	return comSum_;
+}
+
+NUMBER Tree::GetMass() const
+{
+	UpdateCom();
+	return mass_;
+}
+
+// rotating a joint moves the coms of the segments below it around its axis,
+// so its column is w x (sum - weight * s) over these segments.
+void Tree::ComputeComJacobian(Joint* joint, MatrixX& jacobian, Vector3& sum, NUMBER& weight) const
+{
+	if(joint != 0)
+	{
+		ComputeComJacobian(joint->pChild_, jacobian, sum, weight);
+		if(joint->seqNumJoint_ > 0)
+		{
+			jacobian.col(joint->seqNumJoint_-1) = joint->GetW().cross(sum - weight * joint->GetS());
+		}
+		const Com& com = joint->GetCom();
+		if(com.weight_ != 0)
+		{
+			Vector3 proximal = joint->pRealparent_ ? joint->pRealparent_->GetS() : Vector3(0,0,0);
+			sum += com.weight_ * com.Compute(proximal, joint->GetS());
+			weight += com.weight_;
+		}
+	}
+}
+
+void Tree::ComputeComJacobian(MatrixX& jacobian) const
+{
+	jacobian = MatrixX::Zero(3, GetNumJoint()-1);
+	Vector3 sum(0,0,0);
+	NUMBER weight = 0;
+	ComputeComJacobian(root, jacobian, sum, weight);
+}
+
 void Tree::Release()
 {
 	delete this;
@@ -348,6 +459,42 @@ bool Tree::IsAnchored() const
 	return IsLocked();
 }
 
+void Tree::CopyContact(const manip_core::TreeI* treeI)
+{
+	const Tree& tree = *static_cast<const Tree*>(treeI);
+	lock_ = tree.lock_;
+	target_ = tree.target_;
+	targetReached_ = tree.targetReached_;
+	targetSample_ = 0;
+	obsTarget_ = tree.obsTarget_;
+	obsNormal_ = tree.obsNormal_;
+	onObstacle_ = tree.onObstacle_;
+	worldRevision_ = tree.worldRevision_;
+	direction_ = tree.direction_;
+	++contactRevision_;
+}
+
+void Tree::SetAngles(const double* angles)
+{
+	for(Joint* j = GetRoot(); j; j = j->pChild_, ++angles)
+	{
+		j->SetTheta(*angles);
+	}
+	Compute();
+}
+
+void Tree::SetAnchored(const bool anchored)
+{
+	if(anchored)
+	{
+		LockTarget(target_);
+	}
+	else
+	{
+		UnLockTarget();
+	}
+}
+
 void Tree::GetTarget(double* target) const
 {
 	matrices::vect3ToArray(target, target_);
@@ -357,6 +504,7 @@ void Tree::GetTarget(double* target) const
 void Tree::SetTarget(double* target)
 {
 	matrices::arrayToVect3(target, target_);
+	++contactRevision_;
 }
 
 void Tree::GetReferenceTarget(double* target) const
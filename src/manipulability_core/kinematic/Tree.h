@@ -45,6 +45,9 @@ public:
 	virtual bool GetObstacleNormal(double* /*target*/) const;
 	virtual const manip_core::JointI* GetRootJointI() const;
 	virtual bool IsAnchored() const;
+	virtual void CopyContact(const manip_core::TreeI* /*tree*/);
+	virtual void SetAngles(const double* /*angles*/);
+	virtual void SetAnchored(const bool /*anchored*/);
 	virtual const int GetNumJoint() const { return nJoint; }
 	virtual double GetManipulability(const double& x, const double& y, const double& z) const; // this is expensive
 	virtual void GetEllipsoidAxes(double* /*u1*/, double* /*u2*/, double* /*u3*/) const; // this is expensive
@@ -61,6 +64,10 @@ public:
 	void ComputeJacobian();
 
 	void AcceptComVisitor(ComVisitor_ABC* /*visitor*/) const;
+	// mass weighted sum of the segment coms and total mass, cached until the next Compute
+	const matrices::Vector3& GetComSum() const;
+	NUMBER GetMass() const;
+	void ComputeComJacobian(matrices::MatrixX& /*jacobian*/) const; // derivatives of GetComSum, one column per joint as in Jacobian
 
 	// Accessors based on node numbers
 	Joint* GetJoint(int) const;
@@ -81,13 +88,15 @@ public:
 
 	// in contact
 	// world coordinates
-	void LockTarget(const matrices::Vector3& target){ target_ = target; lock_ = true; };
+	void LockTarget(const matrices::Vector3& target){ target_ = target; lock_ = true; ++contactRevision_; };
 	void LockTarget(const matrices::Vector3& target, const Obstacle* obsTarget);//{ target_ = target; lock_ = true; obsTarget_ = obsTarget; onObstacle_ = true; };
-	void UnLockTarget(){ lock_ = false; targetReached_ = false; obsTarget_ = 0; onObstacle_ = false; targetSample_ = 0; };
+	void LockTarget(const matrices::Vector3& target, const ObstacleHandle& obsTarget, const matrices::Vector3& obsNormal);
+	void UnLockTarget(){ lock_ = false; targetReached_ = false; obsTarget_ = ObstacleHandle(); onObstacle_ = false; targetSample_ = 0; ++contactRevision_; };
 	bool IsLocked() const{ return lock_; };
+	unsigned long GetContactRevision() const { return contactRevision_; } // bumped each time the lock or the target changes
 
 	const matrices::Vector3& GetTarget() const {return target_;};
-	const Obstacle* GetObstacleTarget() const {return obsTarget_;};
+	const ObstacleHandle& GetObstacleTarget() const {return obsTarget_;}; // the obstacle itself may be gone, only its handle is kept
 
 	void Compute();
 	void Init();
@@ -97,6 +106,7 @@ public:
 	const TREE_ID& GetTemplateId()const { return templateId_; } // share sampling
 
 	Tree* Clone() const;
+	void CopyFrom(const Tree& /*tree*/); // same result as tree.Clone() without allocating, tree must have the same structure
 
 public:
 	matrices::Vector3 direction_;
@@ -108,11 +118,13 @@ public:
 	bool targetReached_;
 	bool onObstacle_;
 	Sample* targetSample_;
+	unsigned long worldRevision_; // world revision against which obsTarget_ was last validated
 
 private:
 
 	Jacobian* jacobian_;
-	const Obstacle* obsTarget_;
+	ObstacleHandle obsTarget_;
+	matrices::Vector3 obsNormal_; // normal of obsTarget_ when it was locked
 
 	Joint* root;
 	int nJoint;			// nJoint = nEffector + nJoint
@@ -122,7 +134,13 @@ private:
 	Joint* SearchEffector(Joint*, int) const;
 	void ComputeTree(Joint*);
 	void InitTree(Joint*);
+	void ComputeComJacobian(Joint*, matrices::MatrixX&, matrices::Vector3&, NUMBER&) const;
+	void UpdateCom() const;
 	bool lock_;
+	unsigned long contactRevision_;
+	mutable bool comDirty_;
+	mutable matrices::Vector3 comSum_;
+	mutable NUMBER mass_;
 	const TREE_ID id_;
 	const TREE_ID templateId_;
 
@@ -0,0 +1,200 @@
+
+#include "GaitScheduler.h"
+
+using namespace manip_core::enums::robot;
+
+namespace
+{
+	GaitScheduler::GaitPhase MakePhase(unsigned long duration, int a, int b = -1, int c = -1, int d = -1)
+	{
+		GaitScheduler::GaitPhase res(duration);
+		int limbs[4] = {a, b, c, d};
+		for(int i = 0; i < 4 && limbs[i] >= 0; ++i)
+		{
+			res.swing_.push_back(limbs[i]);
+		}
+		return res;
+	}
+}
+
+GaitScheduler::GaitScheduler()
+	: cycleLength_(0)
+	, totalelapsed_(0)
+	, cycleTime_(0)
+	, phase_(0)
+	, configured_(false)
+{
+	// NOTHING
+}
+
+GaitScheduler::~GaitScheduler()
+{
+	// NOTHING
+}
+
+bool GaitScheduler::Configure(eRobots type, unsigned long phaseLength)
+{
+	T_Phases phases;
+	switch(type)
+	{
+		case Human:
+		case HumanWalk:
+		case HumanEllipse:
+		case HumanCrouch:
+		case HumanCrouch180:
+		{
+			// legs alternate, arms are left to the criteria
+			phases.push_back(MakePhase(phaseLength, 0));
+			phases.push_back(MakePhase(phaseLength, 1));
+			break;
+		}
+		case Quadruped:
+		case QuadrupedDown:
+		{
+			// lateral walk : right hind, right fore, left hind, left fore (ids 0 RH, 1 LH, 2 LF, 3 RF)
+			phases.push_back(MakePhase(phaseLength, 0));
+			phases.push_back(MakePhase(phaseLength, 3));
+			phases.push_back(MakePhase(phaseLength, 1));
+			phases.push_back(MakePhase(phaseLength, 2));
+			break;
+		}
+		case SpiderRace:
+		{
+			// trot, diagonal pairs
+			phases.push_back(MakePhase(phaseLength, 0, 2));
+			phases.push_back(MakePhase(phaseLength, 1, 3));
+			break;
+		}
+		case SpiderSix:
+		{
+			// alternating tripods
+			phases.push_back(MakePhase(phaseLength, 0, 1, 3));
+			phases.push_back(MakePhase(phaseLength, 2, 4, 5));
+			break;
+		}
+		case Spider:
+		{
+			// alternating tetrapods
+			phases.push_back(MakePhase(phaseLength, 0, 2, 4, 6));
+			phases.push_back(MakePhase(phaseLength, 1, 3, 5, 7));
+			break;
+		}
+		default:
+			return false;
+	}
+	SetPhases(phases);
+	return true;
+}
+
+void GaitScheduler::SetPhases(const T_Phases& phases)
+{
+	phases_ = phases;
+	phaseStarts_.clear();
+	windows_.clear();
+	scheduled_.clear();
+	cycleLength_ = 0;
+	for(T_PhasesCIT it = phases_.begin(); it != phases_.end(); ++it)
+	{
+		phaseStarts_.push_back(cycleLength_);
+		for(std::vector<int>::const_iterator limb = it->swing_.begin(); limb != it->swing_.end(); ++limb)
+		{
+			if(*limb < 0)
+			{
+				continue;
+			}
+			if((std::size_t)(*limb) >= windows_.size())
+			{
+				windows_.resize(*limb + 1);
+				scheduled_.resize(*limb + 1, false);
+			}
+			scheduled_[*limb] = true;
+			T_Windows& windows = windows_[*limb];
+			if(!windows.empty() && windows.back().end_ == cycleLength_)
+			{
+				windows.back().end_ += it->duration_;
+			}
+			else
+			{
+				Window window;
+				window.start_ = cycleLength_;
+				window.end_ = cycleLength_ + it->duration_;
+				windows.push_back(window);
+			}
+		}
+		cycleLength_ += it->duration_;
+	}
+	cycleTime_ = cycleLength_ > 0 ? cycleTime_ % cycleLength_ : 0;
+	phase_ = 0;
+	Update(totalelapsed_);
+	configured_ = true;
+}
+
+bool GaitScheduler::IsConfigured() const
+{
+	return configured_;
+}
+
+void GaitScheduler::Update(unsigned long time)
+{
+	if(cycleLength_ == 0)
+	{
+		totalelapsed_ = time;
+		return;
+	}
+	if(time < totalelapsed_)
+	{
+		// the clock was reset, the schedule starts over
+		cycleTime_ = 0;
+		phase_ = 0;
+	}
+	else
+	{
+		cycleTime_ = (cycleTime_ + (time - totalelapsed_)) % cycleLength_;
+	}
+	totalelapsed_ = time;
+	while(phase_ + 1 < (int)phaseStarts_.size() && phaseStarts_[phase_ + 1] <= cycleTime_)
+	{
+		++phase_;
+	}
+	while(phase_ > 0 && phaseStarts_[phase_] > cycleTime_)
+	{
+		--phase_;
+	}
+}
+
+int GaitScheduler::Phase() const
+{
+	return phase_;
+}
+
+bool GaitScheduler::MidPhase() const
+{
+	return phases_.empty() || cycleTime_ - phaseStarts_[phase_] > phases_[phase_].duration_ / 10;
+}
+
+bool GaitScheduler::IsScheduled(int limb) const
+{
+	return limb >= 0 && (std::size_t)limb < scheduled_.size() && scheduled_[limb];
+}
+
+bool GaitScheduler::InSwing(int limb) const
+{
+	if(!IsScheduled(limb))
+	{
+		return false;
+	}
+	const T_Windows& windows = windows_[limb];
+	for(T_Windows::const_iterator it = windows.begin(); it != windows.end() && it->start_ <= cycleTime_; ++it)
+	{
+		if(cycleTime_ < it->end_)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool GaitScheduler::InStance(int limb) const
+{
+	return IsScheduled(limb) && !InSwing(limb);
+}
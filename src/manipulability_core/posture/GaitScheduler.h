@@ -0,0 +1,66 @@
+
+#ifndef _CLASS_GAIT_SCHEDULER
+#define _CLASS_GAIT_SCHEDULER
+
+#include "API/WorldManagerI.h"
+
+#include <vector>
+
+/* Cyclic gait given as a table of phases, each phase lasting a given time
+and listing the limbs that swing during it. The swing windows of each limb are
+precomputed from the table, so that querying the state of a limb does not depend on the number of phases.
+Limbs absent from the table are not scheduled, their state is left to the posture criteria.*/
+class GaitScheduler
+{
+public:
+	struct GaitPhase
+	{
+		GaitPhase() : duration_(0) {}
+		GaitPhase(unsigned long duration) : duration_(duration) {}
+		unsigned long duration_; // in ms
+		std::vector<int> swing_; // ids of the limbs in the air during the phase
+	};
+	typedef std::vector<GaitPhase>			T_Phases;
+	typedef T_Phases::const_iterator	T_PhasesCIT;
+
+public:
+	 GaitScheduler();
+	~GaitScheduler();
+
+public:
+	bool Configure(manip_core::enums::robot::eRobots /*type*/, unsigned long phaseLength = 600); // default table of the robot type, false if it has none
+	void SetPhases(const T_Phases& /*phases*/);
+	bool IsConfigured() const;
+
+public:
+	// in ms
+	void Update(unsigned long /*time*/);
+	int  Phase() const;
+	bool MidPhase() const;
+
+	bool IsScheduled(int /*limb*/) const;
+	bool InSwing    (int /*limb*/) const;
+	bool InStance   (int /*limb*/) const; // false for limbs that are not scheduled
+
+private:
+	struct Window
+	{
+		unsigned long start_;
+		unsigned long end_;
+	};
+	typedef std::vector<Window>		T_Windows;
+	typedef std::vector<T_Windows>	T_LimbWindows;
+
+private:
+	T_Phases phases_;
+	std::vector<unsigned long> phaseStarts_;
+	T_LimbWindows windows_; // swing windows of each limb, sorted, consecutive phases merged
+	std::vector<bool> scheduled_;
+	unsigned long cycleLength_;
+	unsigned long totalelapsed_;
+	unsigned long cycleTime_; // time in the current cycle
+	int phase_;
+	bool configured_;
+};
+
+#endif //_CLASS_GAIT_SCHEDULER
@@ -2,8 +2,9 @@
 #include "world/World.h"
 #include "kinematic/Tree.h"
 #include "kinematic/Robot.h"
+#include "GaitScheduler.h"
 
-PostureCriteriaToeOffGait::PostureCriteriaToeOffGait(SpiderGaitI* gait)
+PostureCriteriaToeOffGait::PostureCriteriaToeOffGait(const GaitScheduler* gait)
 	: gait_(gait)
 {
 	// NOTHING
@@ -17,6 +18,10 @@ PostureCriteriaToeOffGait::~PostureCriteriaToeOffGait()
 bool PostureCriteriaToeOffGait::Evaluate(const World& world, const Robot& robot, const Tree& tree) const
 {
 	int id =  tree.GetId();
+	if(gait_->IsScheduled(id))
+	{
+		return gait_->InSwing(id);
+	}
 	if(id == 2 || id == 3)
 	{
 		return tree.GetEffectorPosition(tree.GetNumEffector()-1)(0) < -0.5;
@@ -26,13 +31,4 @@ bool PostureCriteriaToeOffGait::Evaluate(const World& world, const Robot& robot,
 		return tree.GetEffectorPosition(tree.GetNumEffector()-1)(0) < 0.2;
 	}
 	return false;
-	//if( gait_->MidPhase() )return false;
-	if (gait_->Phase() == 0)
-	{
-		return id == 5;// :: || id == 2 || id == 4 || id == 6;
-	}
-	else
-	{
-		return id == 0;// || id == 3 || id == 5 || id == 7;
-	}
 }
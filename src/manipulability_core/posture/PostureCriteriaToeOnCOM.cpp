@@ -1,7 +1,7 @@
 #include "PostureCriteriaToeOnCOM.h"
 #include "world/World.h"
 #include "kinematic/Tree.h"
-#include "kinematic/SupportPolygon.h"
+#include "kinematic/Stability.h"
 #include "kinematic/Robot.h"
 #include "MatrixDefs.h"
 
@@ -21,8 +21,7 @@ bool PostureCriteriaToeOnCOM::Evaluate(const World& world, const Robot& robot, c
 {
 	// first let's compute current's com
 	Vector3 com = robot.ComputeCom();
-	SupportPolygon support(robot);
-	if(!support.Contains(com))// && support.WouldContain(com, robot, tree))
+	if(!robot.GetStability().Contains(com))// && support.WouldContain(com, robot, tree))
 	{
 		return true;
 	}
@@ -2,8 +2,9 @@
 #include "world/World.h"
 #include "kinematic/Tree.h"
 #include "kinematic/Robot.h"
+#include "GaitScheduler.h"
 
-PostureCriteriaToeOnGait::PostureCriteriaToeOnGait(SpiderGaitI* gait)
+PostureCriteriaToeOnGait::PostureCriteriaToeOnGait(const GaitScheduler* gait)
 	: gait_(gait)
 {
 	// NOTHING
@@ -16,5 +17,6 @@ PostureCriteriaToeOnGait::~PostureCriteriaToeOnGait()
 
 bool PostureCriteriaToeOnGait::Evaluate(const World& world, const Robot& robot, const Tree& tree) const
 {
-	return true;
+	// a swinging limb waits for the end of its window
+	return !gait_->InSwing(tree.GetId());
 }
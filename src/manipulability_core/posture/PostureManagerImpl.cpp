@@ -12,6 +12,7 @@
 #include "kinematic/Robot.h"
 
 #include "MatrixDefs.h"
+#include "Profiler.h"
 
 using namespace manip_core;
 using namespace manip_core::enums;
@@ -41,7 +42,7 @@ struct SampleCollector : public SampleGeneratorVisitor_ABC
 		sample.LoadIntoTree(*newTree);
 		if(!collide_ || !world_.IsColliding(robot, *newTree))
 		{
-			visitor_->Visit(robot_, newTree);
+			Notify(newTree, sample);
 		}
 	}
 
@@ -50,8 +51,16 @@ struct SampleCollector : public SampleGeneratorVisitor_ABC
 		Tree* newTree = tree.Clone();
 		sample.LoadIntoTree(*newTree);
 		newTree->LockTarget(newTree->attach_, &obstacle);
-		visitor_->Visit(robot_, newTree);
+		Notify(newTree, sample);
 	}
+
+	void Notify(Tree* tree, const Sample& sample)
+	{
+		double jacobianProduct[12];
+		matrices::matrix3ToArrayD(jacobianProduct, sample.GetJacobianProduct());
+		visitor_->VisitWithJacobianProduct(robot_, tree, jacobianProduct);
+	}
+
 	Tree current_;
 	const manip_core::RobotI* robot_;
 	const World& world_;
@@ -62,17 +71,20 @@ struct SampleCollector : public SampleGeneratorVisitor_ABC
 PostureManagerImpl::PostureManagerImpl(const World& world)
 	: pSolver_(world)
 	, initialized_(false)
-	, spiderGait_(0)
 	, world_(world)
+	, gait_(0)
+	, time_(0)
+	, streamStart_(0)
+	, streaming_(false)
 {
 	// NOTHING
 }
 
 PostureManagerImpl::~PostureManagerImpl()
 {
-	if (spiderGait_)
+	if (gait_)
 	{
-		delete spiderGait_;
+		delete gait_;
 	}
 }
 
@@ -88,9 +100,21 @@ void PostureManagerImpl::AddTrajectoryPoint(const float time,const  double* tran
 	trajectory_.AddCheckPoint(time, transf);
 }
 
+void PostureManagerImpl::AddTrajectoryPoints(const float* times, const double* positions, const unsigned int nbPoints)
+{
+	Trajectory::T_TimePositions timePositions;
+	timePositions.reserve(nbPoints);
+	for(unsigned int i = 0; i < nbPoints; ++i)
+	{
+		timePositions.push_back(Trajectory::P_TimePosition(times[i], matrices::Vector3(positions[3*i], positions[3*i+1], positions[3*i+2])));
+	}
+	trajectory_.AddCheckPoints(timePositions);
+}
+
 void PostureManagerImpl::ResetTrajectory()
 {
 	trajectory_.Reset();
+	streaming_ = false;
 }
 
 
@@ -116,20 +140,22 @@ void PostureManagerImpl::AddPostureCriteria(const enums::postureCriteria::ePostu
 			}
 		case postureCriteria::toeOffSpiderGait:
 			{
-				if (spiderGait_ == 0)
+				if (gait_ == 0)
 				{
-					spiderGait_ = new SpiderGait();
+					gait_ = new GaitScheduler();
+					pSolver_.SetGaitScheduler(gait_);
 				}
-				pSolver_.AddToeOffCriteria(new PostureCriteriaToeOffGait(spiderGait_));
+				pSolver_.AddToeOffCriteria(new PostureCriteriaToeOffGait(gait_));
 				break;
 			}
 		case postureCriteria::toeOnSpiderGait:
 			{
-				if (spiderGait_ == 0)
+				if (gait_ == 0)
 				{
-					spiderGait_ = new SpiderGait();
+					gait_ = new GaitScheduler();
+					pSolver_.SetGaitScheduler(gait_);
 				}
-				pSolver_.AddToeOnCriteria(new PostureCriteriaToeOnGait(spiderGait_));
+				pSolver_.AddToeOnCriteria(new PostureCriteriaToeOnGait(gait_));
 				break;
 			}
 		default:
@@ -142,6 +168,22 @@ void PostureManagerImpl::SetJumpToTarget(const bool jump)
 	pSolver_.SetJumpToTarget(jump);
 }
 
+void PostureManagerImpl::SetRootOptimization(const unsigned int maxIterations)
+{
+	RootCriteria criteria;
+	criteria.maxIterations_ = maxIterations;
+	pSolver_.SetRootCriteria(criteria);
+}
+
+void PostureManagerImpl::SetFootstepPlanning(const unsigned int horizon, const unsigned int beamWidth, const float timeBudget)
+{
+	FootstepCriteria criteria;
+	criteria.horizon_ = horizon;
+	criteria.beamWidth_ = beamWidth;
+	criteria.timeBudget_ = timeBudget;
+	pSolver_.SetFootstepCriteria(criteria);
+}
+
 
 void PostureManagerImpl::RegisterPostureCreatedListenerI(PostureCreatedListenerI* listener)	
 {
@@ -219,7 +261,7 @@ void PostureManagerImpl::AcceptSampleVisitor(const RobotI* robot, const TreeI* t
 	{
 		DummyFilter filter;
 		ReachableObstaclesContainer obstacles(world_, *tre, *rob);
-		world_.Accept(obstacles);
+		world_.AcceptReachable(obstacles, *rob, *tre);
 		for(ReachableObstaclesContainer::T_ObstaclesCIT it = obstacles.obstacles_.begin(); it!= obstacles.obstacles_.end(); ++it)
 		{
 			sg->Request(*rob, *tre, &collector, filter, **it);
@@ -242,7 +284,12 @@ void PostureManagerImpl::ComputeOnline(const RobotI* robot, int nbSamples)
 	{
 		InitSamples(rob, nbSamples);
 	}// TODO : this is just horrible. Remove sample generation
-	pSolver_.CreatePostures(*rob, trajectory_);
+	ConfigureGait(*rob);
+	// the first postures are created now, the following ones by Update
+	pSolver_.StreamPostures(*rob, trajectory_);
+	streamStart_ = time_;
+	streaming_ = true;
+	delete rob;
 }
 
 T_CubicTrajectory PostureManagerImpl::NextPosture(RobotI* robot, double* direction, bool closestDistance)
@@ -251,15 +298,57 @@ T_CubicTrajectory PostureManagerImpl::NextPosture(RobotI* robot, double* directi
 	matrices::arrayToVect3(direction, dir);
 	assert(initialized_);
 	Robot * rob = (static_cast<Robot*>(robot));
+	ConfigureGait(*rob);
 	return pSolver_.NextTrajectory(*rob, dir, false, closestDistance);
 }
 
+// the phase table depends on the robot, which is only known once postures are requested
+void PostureManagerImpl::ConfigureGait(const Robot& robot)
+{
+	if(gait_ && !gait_->IsConfigured())
+	{
+		gait_->Configure(robot.GetType());
+	}
+}
+
+void PostureManagerImpl::ReleaseTrajectory(const spline::curve_abc<>* trajectory)
+{
+	bool released = pSolver_.ReleaseTrajectory(trajectory);
+	assert(released);
+	(void)released; // unused with NDEBUG
+}
+
 void PostureManagerImpl::Update(const unsigned long time)
 {
-	if (spiderGait_)
+	time_ = time;
+	if (gait_)
 	{
-		spiderGait_->Update(time);
+		gait_->Update(time);
 	}
+	if (streaming_)
+	{
+		streaming_ = pSolver_.AdvancePostures(time > streamStart_ ? (float)(time - streamStart_) / 1000.f : 0.f);
+	}
+}
+
+void PostureManagerImpl::EnableProfiling(const bool enable)
+{
+	Profiler::GetInstance().Enable(enable);
+}
+
+void PostureManagerImpl::GetStageCounters(const enums::stage::eStage stage, StageCounters& counters) const
+{
+	Profiler::GetInstance().GetCounters(stage, counters);
+}
+
+void PostureManagerImpl::ResetStageCounters()
+{
+	Profiler::GetInstance().Reset();
+}
+
+bool PostureManagerImpl::ExportTrace(const char* filename) const
+{
+	return Profiler::GetInstance().ExportTrace(std::string(filename));
 }
 
 #ifdef PROFILE
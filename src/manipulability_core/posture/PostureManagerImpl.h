@@ -5,7 +5,7 @@
 #include "world/World.h"
 #include "posture/PostureSolver.h"
 #include "posture/Trajectory.h"
-#include "SpiderGait.h"
+#include "GaitScheduler.h"
 #include "spline/exact_cubic.h"
 
 #include "API/PostureManagerI.h"
@@ -31,7 +31,13 @@ public:
 
 	virtual void SetJumpToTarget(const bool /*jump*/);
 
+	virtual void SetRootOptimization(const unsigned int /*maxIterations*/);
+
+	virtual void SetFootstepPlanning(const unsigned int /*horizon*/, const unsigned int /*beamWidth*/, const float /*timeBudget*/);
+
 	virtual void AddTrajectoryPoint(const float time, const double* transform);
+
+	virtual void AddTrajectoryPoints(const float* /*times*/, const double* /*positions*/, const unsigned int /*nbPoints*/);
 	/**
 	Add a criteria either for raising or lowering foot.
 	*/
@@ -51,21 +57,34 @@ public:
 
 	virtual T_CubicTrajectory NextPosture(RobotI* /*robot*/, double* /*dir*/, bool /*closestDistance*/);
 
+	virtual void ReleaseTrajectory(const spline::curve_abc<>* /*trajectory*/);
+
 	virtual void InitSamples(const RobotI* /*robot*/, int /*nbSamples*/);
 	virtual void AcceptSampleVisitor(const RobotI* /*robot*/, const TreeI* /*tree*/,  SampleVisitorI * /*visitor*/, bool /*collide*/);
 
 	virtual void Update(const unsigned long /*time*/);
 
+	virtual void EnableProfiling(const bool /*enable*/);
+	virtual void GetStageCounters(const enums::stage::eStage /*stage*/, StageCounters& /*counters*/) const;
+	virtual void ResetStageCounters();
+	virtual bool ExportTrace(const char* /*filename*/) const;
+
 	#ifdef PROFILE
 	virtual void Log() const;
 	#endif
 
+private:
+	void ConfigureGait(const Robot& /*robot*/);
+
 private:
 	PostureSolver pSolver_;
 	Trajectory trajectory_;
 	bool initialized_;
 	const World& world_;
-	SpiderGait* spiderGait_;
+	GaitScheduler* gait_;
+	unsigned long time_; // last time given to Update
+	unsigned long streamStart_;
+	bool streaming_;
 };
 
 } // namespace manip_core
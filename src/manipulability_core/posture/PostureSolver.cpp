@@ -2,22 +2,30 @@
 
 #include "world/World.h"
 #include "world/ObstacleVisitor_ABC.h"
+#include "world/WorldChangeVisitor_ABC.h"
 #include "world/Obstacle.h"
 #include "PostureCriteria_ABC.h"
+#include "GaitScheduler.h"
 #include "world/Intersection.h"
 #include "sampling/filters/FilterDistanceObstacle.h"
 #include "sampling/filters/FilterDistance.h"
 #include "sampling/SampleGenerator.h"
 #include "sampling/Sample.h"
+#include "sampling/SampleRanking.h"
 #include "kinematic/Tree.h"
 #include "kinematic/Robot.h"
-#include "kinematic/SupportPolygon.h"
+#include "kinematic/Stability.h"
+#include "kinematic/Joint.h"
 
 #include "Trajectory/TrajectoryHandler.h"
+#include "Trajectory/TrajectoryCache.h"
+#include "Profiler.h"
 
 //#include "kinematic/IKSolver.h"
 
 #include <math.h>
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <list>
 
@@ -29,6 +37,67 @@
 using namespace matrices;
 using namespace std;
 
+// walk along a trajectory, shared by CreatePostures and the streaming planner
+struct PostureStream
+{
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	PostureStream()
+		: trajectory_(0)
+		, index_(0)
+		, previous_(0)
+		, ownsPrevious_(false)
+		, hasPending_(false)
+		, streaming_(false)
+		, done_(true)
+	{
+		// NOTHING
+	}
+
+	Trajectory* trajectory_;
+	std::size_t index_; // next checkpoint to reach
+	Matrix4 transformation_;
+	Vector3 oldPosition_;
+	Robot* previous_; // posture the next one is computed from
+	bool ownsPrevious_; // previous_ is the starting posture, not in postures_
+	bool hasPending_; // last posture of postures_ can still be replaced by the next one
+	bool streaming_;
+	bool done_;
+};
+
+// candidates of a tree seen from a robot position, the cells are footstepBucket wide
+const NUMBER footstepBucket = 0.05;
+const std::size_t maxFootsteps = 1024;
+
+struct FootstepKey
+{
+	FootstepKey(Tree::TREE_ID id, const Vector3& position, const Vector3& direction)
+		: id_(id)
+	{
+		for(int i = 0; i < 3; ++i)
+		{
+			cell_[i] = (long)floor(position(i) / footstepBucket);
+			dir_[i] = (long)floor(direction(i) * 8 + 0.5);
+		}
+	}
+
+	bool operator<(const FootstepKey& other) const
+	{
+		if(id_ != other.id_) return id_ < other.id_;
+		for(int i = 0; i < 3; ++i)
+		{
+			if(cell_[i] != other.cell_[i]) return cell_[i] < other.cell_[i];
+			if(dir_[i] != other.dir_[i]) return dir_[i] < other.dir_[i];
+		}
+		return false;
+	}
+
+	Tree::TREE_ID id_;
+	long cell_[3];
+	long dir_[3];
+};
+
+typedef std::map<FootstepKey, SampleRanking::T_Candidates> T_Footsteps;
+
 struct PosturePImpl
 {
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -41,6 +110,11 @@ struct PosturePImpl
 		, lastLifted_(-1)
 		, jumpToTarget_(false)
 		, trajectoryHandler_(world)
+		, cacheRevision_(world.GetRevision())
+		, lookAhead_(1.f)
+		, nbRetained_(16)
+		, footstepRevision_(world.GetRevision())
+		, gait_(0)
 	{
 		//NOTHING
 		#ifdef PROFILE
@@ -51,6 +125,10 @@ struct PosturePImpl
 	~PosturePImpl()
 	{
 		Clear();
+		for(std::vector<Robot*>::iterator it = pool_.begin(); it != pool_.end(); ++it)
+		{
+			delete(*it);
+		}
 		for(T_CriteriaIT it = toeOffs_.begin(); it != toeOffs_.end(); ++it)
 		{
 			delete(*it);
@@ -71,22 +149,66 @@ struct PosturePImpl
 
 	void WarnListeners(NUMBER time, Robot* robot)
 	{
+		ProfileScope scope(manip_core::enums::stage::listenerDispatch);
 		for(T_ListenerIT it = listeners_.begin(); it != listeners_.end(); ++it)
 		{
 			(*it)->OnPostureCreated(time, robot);
 		}
 	}
 
+	// snapshots are taken from the pool of recycled postures when possible
+	Robot* NewSnapshot(const Robot& robot)
+	{
+		if(pool_.empty())
+		{
+			return robot.Clone();
+		}
+		Robot* res = pool_.back();
+		pool_.pop_back();
+		res->CopyFrom(robot);
+		return res;
+	}
+
+	void Recycle(Robot* robot)
+	{
+		pool_.push_back(robot);
+	}
+
+	// swing of the tree locked by a transition, shared by the identical transitions
+	spline::curve_abc<>* ComputeTrajectory(const Robot& robot, const Tree& current, const Tree& estimated, const Tree& locked)
+	{
+		ProfileScope scope(manip_core::enums::stage::trajectoryBuild);
+		if(world_.GetRevision() != cacheRevision_)
+		{
+			trajectoryCache_.Invalidate();
+			cacheRevision_ = world_.GetRevision();
+		}
+		Vector3 from = matrices::matrix4TimesVect3(robot.ToWorldCoordinates(), current.GetEffectorPosition(current.GetNumEffector()-1));
+		spline::curve_abc<>* res = trajectoryCache_.Find(from, locked.GetTarget(), locked.GetObstacleTarget(), locked.GetTemplateId());
+		if(!res)
+		{
+			res = trajectoryHandler_.ComputeTrajectory(robot, current, estimated, locked.GetTarget());
+			trajectoryCache_.Insert(from, locked.GetTarget(), locked.GetObstacleTarget(), locked.GetTemplateId(), res);
+		}
+		return res;
+	}
+
 	void Clear()
 	{
 		for(PostureSolver::T_RobotsIT it = postures_.begin(); it != postures_.end(); ++it)
 		{
-			delete((*it).second);
+			Recycle((*it).second);
 		}
 		postures_.clear();
+		if(stream_.ownsPrevious_)
+		{
+			Recycle(stream_.previous_);
+		}
+		stream_ = PostureStream();
 		currentDir_ = Vector3(1,0,0);
 		oldDir_ = Vector3(1,0,0);
 		lastLifted_ = -1;
+		rootSolver_.Reset();
 	}
 
 	//IKSolver ikSolver_;
@@ -100,7 +222,19 @@ struct PosturePImpl
 	T_Criteria toeOns_;
 	Tree::TREE_ID lastLifted_;
 	bool jumpToTarget_;
+	RankingCriteria rankingCriteria_;
 	TrajectoryHandler trajectoryHandler_;
+	TrajectoryCache trajectoryCache_;
+	unsigned long cacheRevision_;
+	PostureStream stream_;
+	std::vector<Robot*> pool_;
+	float lookAhead_;
+	unsigned int nbRetained_;
+	FootstepCriteria footstepCriteria_;
+	T_Footsteps footsteps_; // candidates of the planned steps
+	unsigned long footstepRevision_;
+	const GaitScheduler* gait_;
+	RootSolver rootSolver_;
 	#ifdef PROFILE
 	TimerPerf timerperf_;
 	std::vector<float> times_;
@@ -135,6 +269,18 @@ struct HandleLockedVisitor : SampleGeneratorVisitor_ABC
 		}
 	}
 
+	virtual bool GetBound(const Robot& /*robot*/, const Obstacle* /*obstacle*/, Vector3& direction, NUMBER& scale) const
+	{
+		direction = currentDir_;
+		scale = 1;
+		return true;
+	}
+
+	virtual NUMBER GetBestScore() const
+	{
+		return currentBestManip_;
+	}
+
 	const Vector3 currentDir_;
 	NUMBER currentBestManip_;
 	Sample* currentBest_;
@@ -142,12 +288,18 @@ struct HandleLockedVisitor : SampleGeneratorVisitor_ABC
 
 struct LockVisitor : public SampleGeneratorVisitor_ABC
 {
-	LockVisitor(const Vector3& currentDir, const World& world)
-		: currentBest_(0)
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	LockVisitor(const Vector3& currentDir, const World& world, const RankingCriteria& criteria = RankingCriteria())
+		: hits_(0)
+		, obs_(0)
 		, currentDir_(currentDir)
 		, currentBestManip_(-100000)
-		, hits_(0)
+		, currentBest_(0)
 		, world_(world)
+		, criteria_(criteria)
+		, ranking_(criteria.nbCandidates_)
+		, prepared_(false)
+		, nbContacts_(0)
 	{
 		// NOTHING
 	}
@@ -157,70 +309,175 @@ struct LockVisitor : public SampleGeneratorVisitor_ABC
 		// NOTHING
 	}
 
-	bool KeepsBalance(const Robot& robot, Tree& tree, const Vector3& target) const
+	// the com does not depend on the target, only the support polygon does
+	bool KeepsBalance(const Robot& robot, const Tree& tree, const Vector3& com, const Vector3& target) const
 	{
-		// TODO this is ugly 
-		bool wasLocked = tree.IsLocked();
-		Vector3 oldtarget = tree.GetTarget();
+		return robot.GetStability().WouldContain(com, tree.GetId(), target);
+	}
 
-		tree.LockTarget(target);
-		Vector3 com = robot.ComputeCom();
-		SupportPolygon support(robot);
-		
-		if(wasLocked)
+	// values that do not depend on the sample are computed once per request
+	void Prepare(const Robot& robot, const Tree& tree)
+	{
+		prepared_ = true;
+		treePosition_ = tree.GetPosition();
+		treeTarget_ = matrix4TimesVect3(robot.ToRobotCoordinates(), tree.GetTarget()) - tree.GetPosition();
+		for(Joint* j = tree.GetRoot(); j; j = j->pChild_)
 		{
-			tree.LockTarget(oldtarget);
+			jointMin_.push_back(j->GetMinTheta());
+			jointRange_.push_back(j->GetMaxTheta() - j->GetMinTheta());
 		}
-		else
+		if(criteria_.comSupport_ != 0)
 		{
-			tree.UnLockTarget();		
+			// in robot coordinates, as the com and the support polygon of Stability
+			com_ = robot.ComputeCom();
+			contacts_ = Vector3::Zero();
+			const Matrix4& toRobot = robot.ToRobotCoordinates();
+			for(Robot::T_TreeCIT it = robot.GetTrees().begin(); it != robot.GetTrees().end(); ++it)
+			{
+				if((*it)->GetId() != tree.GetId() && (*it)->IsLocked())
+				{
+					contacts_ += matrix4TimesVect3(toRobot, (*it)->GetTarget());
+					++nbContacts_;
+				}
+			}
 		}
-		return support.Contains(com);
 	}
 
-	virtual void Visit(const Robot& robot, /*const*/ Tree& tree, Sample& sample, const Obstacle& obstacle)
+	NUMBER Score(const Robot& robot, Sample& sample, const Obstacle& obstacle) const
 	{
-		// remove posture that is not enriching sustentation polygon
-		//if(KeepsBalance(robot, tree, matrix4TimesVect3(robot.ToWorldCoordinates(), sample.GetPosition() + tree.GetPosition())))
-		if(true)
+		NUMBER manip = sample.forceManipulabiliy(currentDir_);
+		// colinear product btw surface and wanted dir. 
+		Vector3 norm = obstacle.n_;
+		Vector3 nDir = currentDir_;
+		nDir.normalize();
+		norm.normalize();
+		if(robot.GetType() != manip_core::enums::robot::HumanEscalade && robot.GetType() != manip_core::enums::robot::HumanEllipse)
 		{
-			hits_++;
-			//TODO Manipulability and other constraints here
-			NUMBER manip = sample.forceManipulabiliy(currentDir_);
-			// colinear product btw surface and wanted dir. 
-			Vector3 norm = obstacle.n_;
-			Vector3 nDir = currentDir_;
-			nDir.normalize();
-			norm.normalize();
-			if(robot.GetType() != manip_core::enums::robot::HumanEscalade && robot.GetType() != manip_core::enums::robot::HumanEllipse)
-			{
-				manip = manip * norm.dot(nDir);
-			}
-			if(manip >= currentBestManip_ )
+			manip = manip * norm.dot(nDir);
+		}
+		NUMBER score = criteria_.manipulability_ * manip;
+		if(criteria_.targetDistance_ != 0)
+		{
+			score -= criteria_.targetDistance_ * (sample.GetPosition() - treeTarget_).norm();
+		}
+		if(criteria_.jointLimits_ != 0)
+		{
+			NUMBER margin = 1;
+			const Sample::LAngles& angles = sample.AngleValues();
+			for(size_t i = 0; i < angles.size() && i < jointRange_.size(); ++i)
 			{
-				Tree* testtree = tree.Clone() ;
-				sample.LoadIntoTree(*testtree);
-				if(!world_.IsColliding(robot, *testtree))
+				if(jointRange_[i] > 0)
 				{
-					currentBest_ = &sample;
-					currentBestManip_ = manip;
-					obs_ = &obstacle;
+					NUMBER fromMin = (angles[i] - jointMin_[i]) / jointRange_[i];
+					margin = std::min(margin, std::min(fromMin, 1 - fromMin));
 				}
 			}
-			/*if(manip > currentBestManip_)
+			score += criteria_.jointLimits_ * margin;
+		}
+		if(criteria_.comSupport_ != 0)
+		{
+			Vector3 centroid = (contacts_ + sample.GetPosition() + treePosition_) / (NUMBER)(nbContacts_ + 1);
+			NUMBER dx = centroid(0) - com_(0); NUMBER dy = centroid(1) - com_(1);
+			score -= criteria_.comSupport_ * sqrt(dx * dx + dy * dy);
+		}
+		return score;
+	}
+
+	virtual void Visit(const Robot& robot, /*const*/ Tree& tree, Sample& sample, const Obstacle& obstacle)
+	{
+		hits_++;
+		if(!prepared_)
+		{
+			Prepare(robot, tree);
+		}
+		// candidates are validated once the request is over
+		ranking_.Add(Score(robot, sample, obstacle), &sample, &obstacle);
+	}
+
+	bool IsValid(const Robot& robot, const Tree& tree, const Vector3& com, Sample& sample) const
+	{
+		std::auto_ptr<Tree> testtree(tree.Clone());
+		sample.LoadIntoTree(*testtree);
+		bool valid = !world_.IsColliding(robot, *testtree);
+		// remove posture that is not enriching sustentation polygon
+		if(valid && criteria_.checkBalance_)
+		{
+			valid = KeepsBalance(robot, tree, com, matrix4TimesVect3(robot.ToWorldCoordinates(), sample.GetPosition() + tree.GetPosition()));
+		}
+		return valid;
+	}
+
+	// runs the collision (and balance) checks in rank order, and retains the first valid candidate
+	bool Validate(const Robot& robot, Tree& tree)
+	{
+		ranking_.Sort();
+		Vector3 com = criteria_.checkBalance_ ? robot.ComputeCom() : Vector3(0,0,0);
+		for(SampleRanking::T_CandidatesCIT it = ranking_.GetCandidates().begin(); it != ranking_.GetCandidates().end(); ++it)
+		{
+			if(IsValid(robot, tree, com, *it->sample_))
 			{
-				currentBest_ = &sample;
-				currentBestManip_ = manip;
-				obs_ = &obstacle;
-			}*/
+				currentBest_ = it->sample_;
+				currentBestManip_ = it->score_;
+				obs_ = it->obstacle_;
+				return true;
+			}
+		}
+		return currentBest_ != 0;
+	}
+
+	// true if no valid candidate was found but some were dropped from the ranking
+	bool MustRetry() const
+	{
+		return currentBest_ == 0 && ranking_.IsTruncated();
+	}
+
+	// the score is the force manipulability, weighted by the alignment of the obstacle normal with the direction
+	virtual bool GetBound(const Robot& robot, const Obstacle* obstacle, Vector3& direction, NUMBER& scale) const
+	{
+		if(!obstacle || criteria_.targetDistance_ != 0 || criteria_.jointLimits_ != 0 || criteria_.comSupport_ != 0)
+		{
+			return false;
 		}
+		direction = currentDir_;
+		scale = criteria_.manipulability_;
+		if(robot.GetType() != manip_core::enums::robot::HumanEscalade && robot.GetType() != manip_core::enums::robot::HumanEllipse)
+		{
+			Vector3 norm = obstacle->n_;
+			Vector3 nDir = currentDir_;
+			nDir.normalize();
+			norm.normalize();
+			scale *= norm.dot(nDir);
+		}
+		return true;
+	}
+
+	virtual NUMBER GetBestScore() const
+	{
+		return ranking_.GetThreshold();
+	}
+
+	// skipped samples may be valid when the kept ones are not
+	virtual void OnPruned()
+	{
+		ranking_.SetTruncated();
 	}
+
 	int hits_;
 	const Obstacle* obs_;
 	const Vector3 currentDir_;
 	NUMBER currentBestManip_;
 	Sample* currentBest_;
 	const World& world_;
+	const RankingCriteria criteria_;
+	SampleRanking ranking_;
+	bool prepared_;
+	Vector3 treePosition_;
+	Vector3 treeTarget_;
+	Vector3 com_;
+	Vector3 contacts_;
+	int nbContacts_;
+	std::vector<NUMBER> jointMin_;
+	std::vector<NUMBER> jointRange_;
 };
 
 struct LockVisitorClosestPoint : public LockVisitor
@@ -292,6 +549,12 @@ struct LockVisitorClosestPoint : public LockVisitor
 			}*/
 		}
 	}
+
+	// distance score, not bounded by the manipulability
+	virtual bool GetBound(const Robot& /*robot*/, const Obstacle* /*obstacle*/, Vector3& /*direction*/, NUMBER& /*scale*/) const
+	{
+		return false;
+	}
 };
 
 
@@ -328,6 +591,116 @@ struct ReachableObstaclesContainer : public ObstacleVisitor_ABC
 };
 
 
+namespace
+{
+	// direction along which the manipulability of the samples is measured, in robot coordinates for the legs
+	Vector3 LockDirection(const Robot& robot, const Tree& tree, const Vector3& currentDir)
+	{
+		Vector3 dirRobot;
+		if(robot.GetType() == manip_core::enums::robot::HumanEscalade)
+		//if(tree.GetTreeType() == manip_core::enums::LeftLegEscalade || tree.GetTreeType() == manip_core::enums::RightLegEscalade
+		//	|| tree.GetTreeType() == manip_core::enums::LeftArmEscalade || tree.GetTreeType() == manip_core::enums::RightArmEscalade)
+		{
+			Vector3 go(currentDir);
+			go.normalize(); // grosse hacke pour manip jambes
+		if(abs(go(0)) > abs(go(1)) || abs(go(2)) > abs(go(1)))	
+		{if(abs(go(0)) > abs(go(2)) + 0.3)
+			{
+				go(2) = -go(0) / 2;
+			}
+			else if(abs(go(2)) > abs(go(0)) + 0.3)
+			{
+				go(0) = go(2) / 2;
+			}
+			go.normalize();
+		}
+			dirRobot = robot.ToRobotCoordinates().block<3,3>(0,0) * go;
+		}
+		if(tree.GetTreeType() == manip_core::enums::LeftLeg || tree.GetTreeType() == manip_core::enums::RightLeg)
+		{
+			Vector3 go(currentDir);
+			go.normalize(); // grosse hacke pour manip jambes
+		if(abs(go(0)) > abs(go(1)) || abs(go(2)) > abs(go(1)))	
+		{if(abs(go(0)) > abs(go(2)) + 0.3)
+			{
+				go(2) = +go(0) / 2;
+			}
+			else if(abs(go(2)) > abs(go(0)) + 0.3)
+			{
+				go(0) =- go(2) / 2;
+			}
+			go.normalize();
+		}
+			dirRobot = robot.ToRobotCoordinates().block<3,3>(0,0) * go;
+		}
+		else
+		{
+			//dirRobot = robot.ToRobotCoordinates().block<3,3>(0,0) * currentDir;
+			dirRobot = currentDir;
+		}
+		dirRobot.normalize();
+		return dirRobot;
+	}
+
+	// requests the samples of the tree close to the reachable obstacles, from being the posture used to select them
+	void RequestSamples(const Robot& robot, const Robot& from, Tree& tree, const ReachableObstaclesContainer& obstacles, const Vector3& dirRobot, SampleGeneratorVisitor_ABC* visitor)
+	{
+		SampleGenerator* sg = SampleGenerator::GetInstance();
+		Intersection intersect;
+		Vector3 treePositionWorld = matrix4TimesVect3(from.ToWorldCoordinates(), tree.GetPosition());
+		for(ReachableObstaclesContainer::T_ObstaclesCIT it = obstacles.obstacles_.begin(); it!= obstacles.obstacles_.end(); ++it)
+		{
+			Vector3 intersectionPoint;
+			if(intersect.IntersectClosest(from, tree, treePositionWorld, (*(*it)), intersectionPoint))
+			{
+				if((treePositionWorld - intersectionPoint).norm() < tree.GetBoundaryRadius())
+				{
+					FilterDistanceObstacle filter;
+					//sg->Request(robot, tree, visitor, filter);
+					sg->Request(robot, tree, visitor, filter, *(*it));
+				}
+			}
+		}
+	}
+}
+
+struct ObstacleTargetUpdater : public WorldChangeVisitor_ABC
+{
+	ObstacleTargetUpdater(Tree& tree)
+		: WorldChangeVisitor_ABC()
+		, tree_(tree)
+		, unlocked_(false)
+	{
+		// NOTHING
+	}
+
+	~ObstacleTargetUpdater()
+	{
+		// NOTHING
+	}
+
+	virtual void Visit(const WorldChange& change)
+	{
+		if(unlocked_ || change.change_ == WorldChange::added || tree_.GetObstacleTarget() != change.handle_)
+		{
+			return;
+		}
+		if(change.change_ == WorldChange::removed)
+		{
+			tree_.UnLockTarget();
+			unlocked_ = true;
+		}
+		else
+		{
+			// target moves along with its obstacle
+			tree_.LockTarget(matrix4TimesVect3(change.transform_, tree_.GetTarget()), change.handle_, change.current_->n_);
+		}
+	}
+
+	Tree& tree_;
+	bool unlocked_;
+};
+
 PostureSolver::PostureSolver(const World& world)
 	: pImpl_(new PosturePImpl(world))
 {
@@ -344,6 +717,21 @@ void PostureSolver::SetJumpToTarget(const bool jump)
 	pImpl_->jumpToTarget_ = jump;
 }
 
+void PostureSolver::SetRankingCriteria(const RankingCriteria& criteria)
+{
+	pImpl_->rankingCriteria_ = criteria;
+}
+
+void PostureSolver::SetGaitScheduler(const GaitScheduler* gait)
+{
+	pImpl_->gait_ = gait;
+}
+
+void PostureSolver::SetRootCriteria(const RootCriteria& criteria)
+{
+	pImpl_->rootSolver_.SetCriteria(criteria);
+}
+
 
 bool PostureSolver::MustLift(const Robot& robot, const Tree& tree) const
 {
@@ -355,6 +743,11 @@ bool PostureSolver::MustLift(const Robot& robot, const Tree& tree) const
 	return off;
 }
 
+bool PostureSolver::InStance(const Tree& tree) const
+{
+	return pImpl_->gait_ && pImpl_->gait_->InStance(tree.GetId());
+}
+
 bool PostureSolver::MustLock(const Robot& robot, const Tree& tree) const
 {
 	bool off = pImpl_->toeOns_.empty();
@@ -365,86 +758,243 @@ bool PostureSolver::MustLock(const Robot& robot, const Tree& tree) const
 	return off;
 }
 
-bool PostureSolver::LockTree(Robot& robot, Tree& tree, bool closestDistance) const
+int PostureSolver::SyncWorld(Robot& robot) const
 {
-	SampleGenerator* sg = SampleGenerator::GetInstance();
-	// Collecting reachable obstacles
-	ReachableObstaclesContainer obstacles(pImpl_->world_, tree, robot);
-	pImpl_->world_.Accept(obstacles);
-	Vector3 dirRobot;
-	if(robot.GetType() == manip_core::enums::robot::HumanEscalade)
-	//if(tree.GetTreeType() == manip_core::enums::LeftLegEscalade || tree.GetTreeType() == manip_core::enums::RightLegEscalade
-	//	|| tree.GetTreeType() == manip_core::enums::LeftArmEscalade || tree.GetTreeType() == manip_core::enums::RightArmEscalade)
+	int unlocked = 0;
+	const World& world = pImpl_->world_;
+	unsigned long revision = world.GetRevision();
+	Robot::T_Tree& trees = robot.GetTrees();
+	for(Robot::T_TreeIT it = trees.begin(); it != trees.end(); ++it)
 	{
-		Vector3 go(pImpl_->currentDir_);
-		go.normalize(); // grosse hacke pour manip jambes
-	if(abs(go(0)) > abs(go(1)) || abs(go(2)) > abs(go(1)))	
-	{if(abs(go(0)) > abs(go(2)) + 0.3)
+		Tree* tree = (*it);
+		if(tree->worldRevision_ != revision && tree->IsLocked() && tree->onObstacle_)
 		{
-			go(2) = -go(0) / 2;
+			ObstacleTargetUpdater updater(*tree);
+			if(!world.AcceptChanges(tree->worldRevision_, updater))
+			{
+				// journal overflow, only keep targets on obstacles that did not change since
+				const Obstacle* obstacle = world.GetObstacle(tree->GetObstacleTarget());
+				if(!obstacle || obstacle->revision_ > tree->worldRevision_)
+				{
+					tree->UnLockTarget();
+					updater.unlocked_ = true;
+				}
+			}
+			if(updater.unlocked_)
+			{
+				++unlocked;
+			}
 		}
-		else if(abs(go(2)) > abs(go(0)) + 0.3)
+		tree->worldRevision_ = revision;
+	}
+	return unlocked;
+}
+
+namespace
+{
+	// steps planned from the current posture, the first one being a candidate of the tree to lock
+	struct FootstepPlan
+	{
+		NUMBER cost_;
+		unsigned int first_; // index of the first step among the candidates of the tree to lock
+		unsigned int nbSteps_;
+		Tree::TREE_ID ids_[FootstepCriteria::maxHorizon];
+		Vector3 targets_[FootstepCriteria::maxHorizon];
+	};
+	typedef std::vector<FootstepPlan> T_FootstepPlans;
+
+	bool CheaperPlan(const FootstepPlan& a, const FootstepPlan& b)
+	{
+		return a.cost_ < b.cost_;
+	}
+
+	bool BetterCandidate(const SampleRanking::Candidate& a, const SampleRanking::Candidate& b)
+	{
+		return a.score_ > b.score_;
+	}
+
+	void KeepBest(SampleRanking::T_Candidates& candidates, std::size_t nb)
+	{
+		nb = std::min(nb, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + nb, candidates.end(), BetterCandidate);
+		candidates.resize(nb);
+	}
+
+	void KeepCheapest(T_FootstepPlans& plans, std::size_t nb)
+	{
+		nb = std::min(nb, plans.size());
+		std::partial_sort(plans.begin(), plans.begin() + nb, plans.end(), CheaperPlan);
+		plans.resize(nb);
+	}
+
+	// distance of the com outside the support polygon once the robot moved of one more step
+	NUMBER SupportPenalty(const Robot& robot, const FootstepPlan& plan, const Vector3& com, const Vector3& step)
+	{
+		Vector3 moved = com + robot.ToRobotCoordinates().block<3,3>(0,0) * (step * (NUMBER)plan.nbSteps_);
+		return std::max((NUMBER)0, -robot.GetStability().WouldMargin(moved, plan.ids_, plan.targets_, plan.nbSteps_));
+	}
+
+	// best candidates of tree once the robot is translated by offset, shared by the poses of a cell
+	const SampleRanking::T_Candidates& FootstepCandidates(PosturePImpl& impl, const Robot& robot, const Tree& tree, const Vector3& offset, const Vector3& step)
+	{
+		Vector3 direction(impl.currentDir_);
+		direction.normalize();
+		Vector3 position = robot.ToWorldCoordinates().block<3,1>(0,3) + offset;
+		std::pair<T_Footsteps::iterator, bool> res = impl.footsteps_.insert(std::make_pair(FootstepKey(tree.GetId(), position, direction), SampleRanking::T_Candidates()));
+		if(res.second)
 		{
-			go(0) = go(2) / 2;
+			Robot* pose = impl.NewSnapshot(robot);
+			pose->Translate(offset);
+			Robot* from = impl.NewSnapshot(*pose);
+			from->Translate(step);
+			Tree* poseTree = pose->GetTree(tree.GetId());
+			ReachableObstaclesContainer obstacles(impl.world_, *poseTree, *pose);
+			impl.world_.AcceptReachable(obstacles, *pose, *poseTree);
+			RankingCriteria criteria(impl.rankingCriteria_);
+			criteria.nbCandidates_ = impl.footstepCriteria_.branching_;
+			LockVisitor visitor(LockDirection(*pose, *poseTree, impl.currentDir_), impl.world_, criteria);
+			RequestSamples(*pose, *from, *poseTree, obstacles, visitor.currentDir_, &visitor);
+			res.first->second = visitor.ranking_.GetCandidates();
+			KeepBest(res.first->second, impl.footstepCriteria_.branching_);
+			impl.Recycle(from);
+			impl.Recycle(pose);
 		}
-		go.normalize();
+		return res.first->second;
 	}
-		dirRobot = robot.ToRobotCoordinates().block<3,3>(0,0) * go;
+}
+
+void PostureSolver::SetFootstepCriteria(const FootstepCriteria& criteria)
+{
+	pImpl_->footstepCriteria_ = criteria;
+	pImpl_->footsteps_.clear();
+}
+
+bool PostureSolver::PlanFootsteps(const Robot& robot, const Tree& tree, LockVisitor& visitor) const
+{
+	const FootstepCriteria& criteria = pImpl_->footstepCriteria_;
+	if(pImpl_->world_.GetRevision() != pImpl_->footstepRevision_ || pImpl_->footsteps_.size() > maxFootsteps)
+	{
+		pImpl_->footsteps_.clear();
+		pImpl_->footstepRevision_ = pImpl_->world_.GetRevision();
 	}
-	if(tree.GetTreeType() == manip_core::enums::LeftLeg || tree.GetTreeType() == manip_core::enums::RightLeg)
+	// wall time, clock() counts the cpu time of every thread of the process
+	Profiler::t_tick deadline = Profiler::Now() + (Profiler::t_tick)(criteria.timeBudget_ * 1e9);
+	unsigned int horizon = std::min<unsigned int>(criteria.horizon_, FootstepCriteria::maxHorizon);
+	SampleRanking::T_Candidates firsts(visitor.ranking_.GetCandidates());
+	KeepBest(firsts, criteria.branching_);
+	if(firsts.empty())
 	{
-		Vector3 go(pImpl_->currentDir_);
-		go.normalize(); // grosse hacke pour manip jambes
-	if(abs(go(0)) > abs(go(1)) || abs(go(2)) > abs(go(1)))	
-	{if(abs(go(0)) > abs(go(2)) + 0.3)
+		return false;
+	}
+	// the tree to lock moves first, then the other supporting trees in turn
+	std::vector<const Tree*> sequence(1, &tree);
+	const Robot::T_Tree& trees = robot.GetTrees();
+	std::size_t start = std::find(trees.begin(), trees.end(), &tree) - trees.begin();
+	for(std::size_t i = 1; i < trees.size(); ++i)
+	{
+		const Tree* other = trees[(start + i) % trees.size()];
+		if(other != &tree && other->IsLocked())
 		{
-			go(2) = +go(0) / 2;
+			sequence.push_back(other);
 		}
-		else if(abs(go(2)) > abs(go(0)) + 0.3)
+	}
+	Vector3 com = robot.ComputeCom();
+	Vector3 step = pImpl_->currentDir_ * criteria.stepLength_;
+	T_FootstepPlans plans, next;
+	for(unsigned int i = 0; i < firsts.size(); ++i)
+	{
+		FootstepPlan plan;
+		plan.first_ = i;
+		plan.nbSteps_ = 1;
+		plan.ids_[0] = tree.GetId();
+		plan.targets_[0] = matrix4TimesVect3(robot.ToWorldCoordinates(), tree.GetPosition() + firsts[i].sample_->GetPosition());
+		plan.cost_ = -firsts[i].score_ + criteria.supportWeight_ * SupportPenalty(robot, plan, com, step);
+		plans.push_back(plan);
+	}
+	KeepCheapest(plans, criteria.beamWidth_);
+	// a depth is always completed, the budget is checked between depths
+	for(unsigned int k = 1; k < horizon && Profiler::Now() < deadline; ++k)
+	{
+		const Tree& moved = *sequence[k % sequence.size()];
+		Vector3 offset = step * (NUMBER)k;
+		const SampleRanking::T_Candidates& candidates = FootstepCandidates(*pImpl_, robot, moved, offset, step);
+		next.clear();
+		for(T_FootstepPlans::const_iterator it = plans.begin(); it != plans.end(); ++it)
 		{
-			go(0) =- go(2) / 2;
+			for(SampleRanking::T_CandidatesCIT cit = candidates.begin(); cit != candidates.end(); ++cit)
+			{
+				FootstepPlan plan(*it);
+				plan.ids_[k] = moved.GetId();
+				plan.targets_[k] = matrix4TimesVect3(robot.ToWorldCoordinates(), moved.GetPosition() + cit->sample_->GetPosition()) + offset;
+				plan.nbSteps_ = k + 1;
+				plan.cost_ += -cit->score_ + criteria.supportWeight_ * SupportPenalty(robot, plan, com, step);
+				next.push_back(plan);
+			}
 		}
-		go.normalize();
-	}
-		dirRobot = robot.ToRobotCoordinates().block<3,3>(0,0) * go;
+		if(next.empty())
+		{
+			break; // no contact further away, the plans stop here
+		}
+		KeepCheapest(next, criteria.beamWidth_);
+		plans.swap(next);
 	}
-	else
+	// first steps are validated in the order of their best plan
+	std::sort(plans.begin(), plans.end(), CheaperPlan);
+	std::vector<bool> tried(firsts.size(), false);
+	for(T_FootstepPlans::const_iterator it = plans.begin(); it != plans.end(); ++it)
 	{
-		//dirRobot = robot.ToRobotCoordinates().block<3,3>(0,0) * pImpl_->currentDir_;
-		dirRobot = pImpl_->currentDir_;
+		if(tried[it->first_])
+		{
+			continue;
+		}
+		tried[it->first_] = true;
+		const SampleRanking::Candidate& first = firsts[it->first_];
+		if(visitor.IsValid(robot, tree, com, *first.sample_))
+		{
+			visitor.currentBest_ = first.sample_;
+			visitor.currentBestManip_ = first.score_;
+			visitor.obs_ = first.obstacle_;
+			return true;
+		}
 	}
-	dirRobot.normalize();
+	return false;
+}
+
+bool PostureSolver::LockTree(Robot& robot, Tree& tree, bool closestDistance) const
+{
+	// Collecting reachable obstacles
+	ReachableObstaclesContainer obstacles(pImpl_->world_, tree, robot);
+	pImpl_->world_.AcceptReachable(obstacles, robot, tree);
+	Vector3 dirRobot = LockDirection(robot, tree, pImpl_->currentDir_);
 	LockVisitor* visitor;
 	if(!closestDistance)
 	{
-		visitor = new LockVisitor(dirRobot, pImpl_->world_);
+		visitor = new LockVisitor(dirRobot, pImpl_->world_, pImpl_->rankingCriteria_);
 	}
 	else
 	{
 		visitor = new LockVisitorClosestPoint(dirRobot, pImpl_->world_);
 	}
-	Intersection intersect;
 	bool ret = false;
 	#ifdef PROFILE
 	float bef = pImpl_->timerperf_.elapsedTime();
 	int hits = 0;
 	#endif
-	Robot* futureRob = robot.Clone();
+	Robot* futureRob = pImpl_->NewSnapshot(robot);
 	futureRob->Translate(pImpl_->currentDir_ * 0.2);
-	for(ReachableObstaclesContainer::T_ObstaclesCIT it = obstacles.obstacles_.begin(); it!= obstacles.obstacles_.end(); ++it)
+	RequestSamples(robot, *futureRob, tree, obstacles, dirRobot, visitor);
+	bool planned = !closestDistance && pImpl_->footstepCriteria_.horizon_ > 1 && PlanFootsteps(robot, tree, *visitor);
+	if(!planned && !visitor->Validate(robot, tree) && visitor->MustRetry())
 	{
-		Vector3 intersectionPoint;
-		Vector3 treePositionWorld = matrix4TimesVect3(futureRob->ToWorldCoordinates(), tree.GetPosition());
-		if(intersect.IntersectClosest(*futureRob, tree, treePositionWorld, (*(*it)), intersectionPoint))
-		{
-			if((treePositionWorld - intersectionPoint).norm() < tree.GetBoundaryRadius())
-			{
-				FilterDistanceObstacle filter(0.1, tree, (*(*it)), *futureRob, dirRobot);
-				//sg->Request(robot, tree, visitor, filter);
-				sg->Request(robot, tree, visitor, filter, *(*it));
-			}
-		}
+		// none of the best candidates is valid, rank all of them
+		RankingCriteria criteria(pImpl_->rankingCriteria_);
+		criteria.nbCandidates_ = 0;
+		delete visitor;
+		visitor = new LockVisitor(dirRobot, pImpl_->world_, criteria);
+		RequestSamples(robot, *futureRob, tree, obstacles, dirRobot, visitor);
+		visitor->Validate(robot, tree);
 	}
+	pImpl_->Recycle(futureRob);
 	if(visitor->currentBest_)
 	{
 		Sample old(tree);
@@ -497,10 +1047,9 @@ bool PostureSolver::LockTree(Robot& robot, Tree& tree, bool closestDistance) con
 
 bool PostureSolver::LockTree(Robot& robot, Tree& tree, Sample& sample, bool closestDistance) const
 {
-	SampleGenerator* sg = SampleGenerator::GetInstance();
 	// Collecting reachable obstacles
 	ReachableObstaclesContainer obstacles(pImpl_->world_, tree, robot);
-	pImpl_->world_.Accept(obstacles);
+	pImpl_->world_.AcceptReachable(obstacles, robot, tree);
 	Vector3 dirRobot;
 	if(robot.GetType() == manip_core::enums::robot::HumanEscalade)
 	//if(tree.GetTreeType() == manip_core::enums::LeftLegEscalade || tree.GetTreeType() == manip_core::enums::RightLegEscalade
@@ -529,31 +1078,28 @@ bool PostureSolver::LockTree(Robot& robot, Tree& tree, Sample& sample, bool clos
 	LockVisitor* visitor;
 	if(!closestDistance)
 	{
-		visitor = new LockVisitor(dirRobot, pImpl_->world_);
+		visitor = new LockVisitor(dirRobot, pImpl_->world_, pImpl_->rankingCriteria_);
 	}
 	else
 	{
 		visitor = new LockVisitorClosestPoint(dirRobot, pImpl_->world_);
 	}
-	Intersection intersect;
 	bool ret = false;
 	#ifdef PROFILE
 	float bef = pImpl_->timerperf_.elapsedTime();
 	int hits = 0;
 	#endif
-	for(ReachableObstaclesContainer::T_ObstaclesCIT it = obstacles.obstacles_.begin(); it!= obstacles.obstacles_.end(); ++it)
+	RequestSamples(robot, robot, tree, obstacles, dirRobot, visitor);
+	bool planned = !closestDistance && pImpl_->footstepCriteria_.horizon_ > 1 && PlanFootsteps(robot, tree, *visitor);
+	if(!planned && !visitor->Validate(robot, tree) && visitor->MustRetry())
 	{
-		Vector3 intersectionPoint;
-		Vector3 treePositionWorld = matrix4TimesVect3(robot.ToWorldCoordinates(), tree.GetPosition());
-		if(intersect.IntersectClosest(robot, tree, treePositionWorld, (*(*it)), intersectionPoint))
-		{
-			if((treePositionWorld - intersectionPoint).norm() < tree.GetBoundaryRadius())
-			{
-				FilterDistanceObstacle filter(0.1, tree, (*(*it)), robot, dirRobot);
-				//sg->Request(robot, tree, visitor, filter);
-				sg->Request(robot, tree, visitor, filter, *(*it));
-			}
-		}
+		// none of the best candidates is valid, rank all of them
+		RankingCriteria criteria(pImpl_->rankingCriteria_);
+		criteria.nbCandidates_ = 0;
+		delete visitor;
+		visitor = new LockVisitor(dirRobot, pImpl_->world_, criteria);
+		RequestSamples(robot, robot, tree, obstacles, dirRobot, visitor);
+		visitor->Validate(robot, tree);
 	}
 	if(visitor->currentBest_)
 	{
@@ -658,7 +1204,7 @@ bool TargetReached(const Robot& robot, const Tree& tree)
 
 int PostureSolver::NextPosture(Robot& robot, const Vector3& direction, bool handleLock)
 {
-	int changes = 0;
+	int changes = SyncWorld(robot);
 	pImpl_->currentDir_ = direction;
 	Robot::T_Tree& trees = robot.GetTrees();
 	for(Robot::T_TreeIT it = trees.begin(); it != trees.end(); ++it)
@@ -666,7 +1212,7 @@ int PostureSolver::NextPosture(Robot& robot, const Vector3& direction, bool hand
 		Tree* tree = (*it);
 		if(tree->IsLocked())
 		{
-			if(MustLift(robot, *tree))
+			if(!InStance(*tree) && MustLift(robot, *tree))
 			{
 				tree->UnLockTarget();
 				++changes;
@@ -682,7 +1228,7 @@ int PostureSolver::NextPosture(Robot& robot, const Vector3& direction, bool hand
 		}
 		else if(!tree->IsLocked())
 		{
-			if(MustLock(robot, *tree))
+			if(InStance(*tree) || MustLock(robot, *tree))
 			{
 				LockTree(robot, *tree);
 				changes++;
@@ -695,7 +1241,7 @@ int PostureSolver::NextPosture(Robot& robot, const Vector3& direction, bool hand
 manip_core::T_CubicTrajectory PostureSolver::NextTrajectory(Robot& robot, const Vector3& direction, bool handleLock, bool closestDistance)
 {
 	manip_core::T_CubicTrajectory cubics;
-	int changes = 0;
+	int changes = SyncWorld(robot);
 	pImpl_->currentDir_ = direction;
 	Vector3 normDir = direction;
 	if (normDir.norm() != 0)
@@ -710,7 +1256,7 @@ manip_core::T_CubicTrajectory PostureSolver::NextTrajectory(Robot& robot, const
 		{
 			NUMBER r = (pImpl_->currentDir_.transpose()*(tree->GetJacobian()->GetJacobianProduct())*pImpl_->currentDir_);
 			r = 1 / sqrt(r);
-			if( /*abs(tree->direction_.dot(normDir)) < 0.3 ||  r < 0.2 ||*/ MustLift(robot, *tree))
+			if( /*abs(tree->direction_.dot(normDir)) < 0.3 ||  r < 0.2 ||*/ !InStance(*tree) && MustLift(robot, *tree))
 			{
 				if (tree->targetReached_)
 					{
@@ -731,14 +1277,14 @@ manip_core::T_CubicTrajectory PostureSolver::NextTrajectory(Robot& robot, const
 		else if(!tree->IsLocked())
 		{
 			spline::curve_abc<>* cubic(0);
-			if(MustLock(robot, *tree))
+			if(InStance(*tree) || MustLock(robot, *tree))
 			{
 				Tree* tree2 = tree->Clone();
 				if(pImpl_->jumpToTarget_)
 				{
 					if(LockTree(robot, *tree, closestDistance))
 					{
-						cubic = pImpl_->trajectoryHandler_.ComputeTrajectory(robot, *tree2, *tree, tree->GetTarget());
+						cubic = pImpl_->ComputeTrajectory(robot, *tree2, *tree, *tree);
 					}
 				}
 				else
@@ -748,9 +1294,10 @@ manip_core::T_CubicTrajectory PostureSolver::NextTrajectory(Robot& robot, const
 					{
 						sample.LoadIntoTree(*tree2);
 						tree2->Compute();
-						cubic = pImpl_->trajectoryHandler_.ComputeTrajectory(robot, *tree, *tree2, tree->GetTarget());
+						cubic = pImpl_->ComputeTrajectory(robot, *tree, *tree2, *tree);
 					}
 				}
+				delete tree2;
 				changes++;
 			}
 			if(cubic)
@@ -763,89 +1310,137 @@ manip_core::T_CubicTrajectory PostureSolver::NextTrajectory(Robot& robot, const
 }
 
 
-const PostureSolver::T_Robots& PostureSolver::CreatePostures(const Robot& previousTransform, Trajectory& trajectory, bool stopAtFirst)
+bool PostureSolver::ReleaseTrajectory(const spline::curve_abc<>* cubic)
+{
+	return pImpl_->trajectoryCache_.Release(cubic);
+}
+
+void PostureSolver::StartPostures(const Robot& previousTransform, Trajectory& trajectory)
 {
-	#ifdef PROFILE
-	float beg = pImpl_->timerperf_.elapsedTime();
-	#endif
 	pImpl_->Clear();
-	Robot* previousPosture(0);
-	Trajectory::T_TimePositions& timepos = trajectory.GetEditableTimePositions();
+	PostureStream& stream = pImpl_->stream_;
+	stream.trajectory_ = &trajectory;
+	stream.transformation_ = previousTransform.ToWorldCoordinates();
+	stream.oldPosition_ = stream.transformation_.block(0,3,3,1);
+	stream.previous_ = pImpl_->NewSnapshot(previousTransform);
+	stream.ownsPrevious_ = true;
+	//current pos as first index
+	stream.index_ = 1;
+	stream.done_ = trajectory.Size() < 2;
+}
+
+bool PostureSolver::StepPostures()
+{
+	PostureStream& stream = pImpl_->stream_;
+	if(stream.done_)
+	{
+		return false;
+	}
+	Trajectory& trajectory = *stream.trajectory_;
+	std::size_t& index = stream.index_;
+	if(index >= trajectory.Size())
+	{
+		stream.done_ = true;
+		return false;
+	}
 	Matrix3 rotation;
 	Matrix4 oldTransformation;
-	Matrix4 tranformation = previousTransform.ToWorldCoordinates();
-	Vector3 oldPosition = tranformation.block(0,3,3,1);
-	float currentTimeStep = 0.f;
-	previousPosture = previousTransform.Clone();
-	
-	//current pos as first index
-	//trajectory.AddCheckPoint(0.f, oldPosition);
-	Trajectory::T_TimePositionsIT it = timepos.begin();
-	++it;
-	for(; it != timepos.end() && pImpl_->postures_.size()<80; ++it)
+	Matrix4& tranformation = stream.transformation_;
+	pImpl_->currentDir_ = (trajectory[index].second - stream.oldPosition_);
+	if(pImpl_->currentDir_.norm() != 0.)
 	{
-		pImpl_->currentDir_ = ((*it).second - oldPosition);		
-		if(pImpl_->currentDir_.norm() != 0.)
+		// only for vlimbing)
+		if(pImpl_->currentDir_(0) <= 0)
 		{
-			// only for vlimbing)
-			if(pImpl_->currentDir_(0) <= 0)
-			{
-				pImpl_->currentDir_(0) = 0.2;
-			}
-			pImpl_->currentDir_.normalize();
+			pImpl_->currentDir_(0) = 0.2;
 		}
-		else
+		pImpl_->currentDir_.normalize();
+	}
+	else
+	{
+		pImpl_->currentDir_ = pImpl_->oldDir_;
+		++index;
+		if(index >= trajectory.Size())
 		{
-			pImpl_->currentDir_ = pImpl_->oldDir_;
-			++it;
-			if( it == timepos.end())
-				break;
+			stream.done_ = true;
+			return false;
 		}
-		oldTransformation = tranformation;
-
-		//compute transformation
-		matrices::GetRotationMatrix(pImpl_->oldDir_, pImpl_->currentDir_, rotation);
-		tranformation.block(0,0,3,3) = tranformation.block(0,0,3,3) * rotation; 
-		tranformation.block(0,3,3,1) = (*it).second; 
-		//End compute transformation
+	}
+	oldTransformation = tranformation;
 
+	//compute transformation
+	matrices::GetRotationMatrix(pImpl_->oldDir_, pImpl_->currentDir_, rotation);
+	tranformation.block(0,0,3,3) = tranformation.block(0,0,3,3) * rotation; 
+	tranformation.block(0,3,3,1) = trajectory[index].second; 
+	//End compute transformation
 
-		Robot* newPosture = previousPosture->Clone();
-		newPosture->SetPosOri(tranformation);
-		int changes = NextPosture(*newPosture, pImpl_->currentDir_, true);
-		
-		if(changes > 1 && trajectory.AddWayPoint(--it)) // it placed on the new waypoint
+	Robot* newPosture = pImpl_->NewSnapshot(*stream.previous_);
+	newPosture->SetPosOri(tranformation);
+	// the root leaves the trajectory to keep the locked trees in their workspace
+	pImpl_->rootSolver_.Solve(*newPosture);
+	int changes = NextPosture(*newPosture, pImpl_->currentDir_, true);
+	
+	if(changes > 1 && trajectory.AddWayPoint(--index)) // index placed on the new waypoint
+	{
+		--index; // because it ll be increased below
+		tranformation = oldTransformation;
+		pImpl_->currentDir_ = pImpl_->oldDir_;
+		pImpl_->Recycle(newPosture);
+	}
+	else
+	{
+		if(changes == 0 && stream.hasPending_)
 		{
-			it--; // because it ll be increased in loop
-			tranformation = oldTransformation;
-			pImpl_->currentDir_ = pImpl_->oldDir_;
+			// nothing changed since the last posture, which is replaced
+			pImpl_->Recycle(pImpl_->postures_.back().second);
+			pImpl_->postures_.pop_back();
+			stream.hasPending_ = false;
 		}
-		else
+		else if(stream.ownsPrevious_)
 		{
-			if((changes == 0) &! (pImpl_->postures_.empty()))
-			{
-				pImpl_->postures_.pop_back();
-			}
-			/*else if(changes > 1)
-			{
-				delete newPosture;
-				newPosture = CreateStillPosture2(*previousPosture);
-				tranformation = oldTransformation;
-				pImpl_->currentDir_ = pImpl_->oldDir_;
-			}*/
-			currentTimeStep = (*it).first;
-			pImpl_->postures_.push_back(std::make_pair(currentTimeStep, newPosture));
-			previousPosture = newPosture;
-			// robot posture can be changed by optimization
-			tranformation = newPosture->ToWorldCoordinates();
-			oldPosition = tranformation.block(0,3,3,1);
-			pImpl_->oldDir_ = pImpl_->currentDir_;
-			if(stopAtFirst)
+			pImpl_->Recycle(stream.previous_);
+			stream.ownsPrevious_ = false;
+		}
+		if(stream.hasPending_ && stream.streaming_)
+		{
+			const PostureSolver::T_Robots::value_type& last = pImpl_->postures_.back();
+			pImpl_->WarnListeners(last.first, last.second);
+		}
+		pImpl_->postures_.push_back(std::make_pair(trajectory[index].first, newPosture));
+		stream.hasPending_ = true;
+		stream.previous_ = newPosture;
+		// robot posture can be changed by optimization
+		tranformation = newPosture->ToWorldCoordinates();
+		stream.oldPosition_ = tranformation.block(0,3,3,1);
+		pImpl_->oldDir_ = pImpl_->currentDir_;
+		if(stream.streaming_)
+		{
+			// only the last finalized postures are kept, the others are reused as snapshots
+			while(pImpl_->postures_.size() > pImpl_->nbRetained_ + 1)
 			{
-				return pImpl_->postures_;
+				pImpl_->Recycle(pImpl_->postures_.front().second);
+				pImpl_->postures_.erase(pImpl_->postures_.begin());
 			}
 		}
 	}
+	++index;
+	return true;
+}
+
+const PostureSolver::T_Robots& PostureSolver::CreatePostures(const Robot& previousTransform, Trajectory& trajectory, bool stopAtFirst)
+{
+	#ifdef PROFILE
+	float beg = pImpl_->timerperf_.elapsedTime();
+	#endif
+	StartPostures(previousTransform, trajectory);
+	while(pImpl_->postures_.size()<80 && StepPostures())
+	{
+		if(stopAtFirst && !pImpl_->postures_.empty())
+		{
+			return pImpl_->postures_;
+		}
+	}
+	pImpl_->stream_.done_ = true;
 	for(PostureSolver::T_RobotsIT it = pImpl_->postures_.begin(); it != pImpl_->postures_.end(); ++it)
 	{
 		pImpl_->WarnListeners((*it).first, (*it).second);
@@ -857,11 +1452,59 @@ const PostureSolver::T_Robots& PostureSolver::CreatePostures(const Robot& previo
 	return pImpl_->postures_;
 }
 
+void PostureSolver::StreamPostures(const Robot& previousTransform, Trajectory& trajectory)
+{
+	StartPostures(previousTransform, trajectory);
+	pImpl_->stream_.streaming_ = true;
+	AdvancePostures(0.f);
+}
+
+bool PostureSolver::AdvancePostures(float time)
+{
+	PostureStream& stream = pImpl_->stream_;
+	if(!stream.streaming_)
+	{
+		return false;
+	}
+	const Trajectory& trajectory = *stream.trajectory_;
+	if(!stream.done_)
+	{
+		float horizon = trajectory[0].first + time + pImpl_->lookAhead_;
+		while(!stream.done_ && stream.index_ < trajectory.Size() && trajectory[stream.index_].first <= horizon)
+		{
+			StepPostures();
+		}
+		stream.done_ = stream.done_ || stream.index_ >= trajectory.Size();
+	}
+	if(stream.done_)
+	{
+		// the last posture can no longer be replaced
+		if(stream.hasPending_)
+		{
+			const PostureSolver::T_Robots::value_type& last = pImpl_->postures_.back();
+			pImpl_->WarnListeners(last.first, last.second);
+			stream.hasPending_ = false;
+		}
+		stream.streaming_ = false;
+	}
+	return stream.streaming_;
+}
+
+void PostureSolver::SetLookAhead(float lookAhead, unsigned int nbRetained)
+{
+	pImpl_->lookAhead_ = lookAhead;
+	pImpl_->nbRetained_ = nbRetained;
+}
 
 void PostureSolver::RegisterPostureListener(manip_core::PostureCreatedListenerI& listener)
 {
 	pImpl_->listeners_.push_back(&listener);
-	for(PostureSolver::T_RobotsIT it = pImpl_->postures_.begin(); it != pImpl_->postures_.end(); ++it)
+	PostureSolver::T_RobotsIT last = pImpl_->postures_.end();
+	if(pImpl_->stream_.streaming_ && pImpl_->stream_.hasPending_)
+	{
+		--last; // not finalized yet
+	}
+	for(PostureSolver::T_RobotsIT it = pImpl_->postures_.begin(); it != last; ++it)
 	{
 		listener.OnPostureCreated((*it).first, (*it).second);
 	}
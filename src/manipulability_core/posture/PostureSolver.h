@@ -9,6 +9,8 @@
 #include "MatrixDefs.h"
 #include "Trajectory.h"
 #include "sampling/Sample.h"
+#include "sampling/SampleRanking.h"
+#include "RootSolver.h"
 
 #include <memory>
 #include <vector>
@@ -18,9 +20,34 @@ class SampleGenerator;
 class World;
 class Tree;
 class PostureCriteria_ABC;
+class GaitScheduler;
 class SupportPolygon;
 
 struct PosturePImpl;
+struct LockVisitor;
+
+// Look ahead used when locking a tree: the next steps of the supporting trees are planned
+// with a beam search over the sampled candidates, and the first step of the best plan is kept.
+struct FootstepCriteria
+{
+	enum { maxHorizon = 8 };
+
+	FootstepCriteria()
+		: horizon_(0)
+		, beamWidth_(4)
+		, branching_(4)
+		, stepLength_(0.2)
+		, supportWeight_(1)
+		, timeBudget_(0.005f)
+	{}
+
+	unsigned int horizon_;   // number of planned steps, 0 or 1 keeps the greedy choice
+	unsigned int beamWidth_; // plans kept at each depth
+	unsigned int branching_; // candidates expanded per step
+	NUMBER stepLength_;      // displacement of the robot between two steps
+	NUMBER supportWeight_;   // penalty per meter of center of mass outside the support polygon
+	float timeBudget_;       // seconds, the search stops after the first depth exceeding it
+};
 
 /* parses sampled configurations in order to find an appropriate posture given a previous posture, 
 the current trajectory and the world*/
@@ -43,11 +70,22 @@ public:
 	void AddToeOffCriteria(PostureCriteria_ABC* /*criteria*/);
 	void AddToeOnCriteria (PostureCriteria_ABC* /*criteria*/);
 	void SetJumpToTarget(const bool /*jump*/);
+	void SetRankingCriteria(const RankingCriteria& /*criteria*/); // how candidate samples are ranked when locking a tree
+	void SetFootstepCriteria(const FootstepCriteria& /*criteria*/);
+	void SetGaitScheduler(const GaitScheduler* /*gait*/); // limbs in stance skip the criteria, 0 to evaluate them all
+	void SetRootCriteria(const RootCriteria& /*criteria*/); // how the root of the postures is moved away from the trajectory
 
 public:
 	manip_core::T_CubicTrajectory	NextTrajectory(Robot& /*robot*/, const matrices::Vector3& /*direction*/,  bool handleLock = false, bool closestDistance = false);
+	bool ReleaseTrajectory(const spline::curve_abc<>* /*cubic*/); // curves returned by NextTrajectory are shared and must be given back, not deleted
 	int				NextPosture(Robot& /*robot*/, const matrices::Vector3& /*direction*/,  bool handleLock = false);
 	const T_Robots& CreatePostures(const Robot& /*previousTransform*/, Trajectory& /*trajectory*/, bool stopAtFirst = false);
+
+	// streaming: postures are created as time advances, and listeners are warned once a posture is final.
+	// Only the last nbRetained postures are kept, older ones are recycled, so listeners must copy the robots they keep.
+	void StreamPostures (const Robot& /*previousTransform*/, Trajectory& /*trajectory*/);
+	bool AdvancePostures(float /*time*/); // creates the postures of the checkpoints up to time + look ahead, time being relative to the first checkpoint ; false once the trajectory is over
+	void SetLookAhead   (float /*lookAhead*/, unsigned int /*nbRetained*/);
 	#ifdef PROFILE
 	void Log() const;
 	#endif
@@ -55,10 +93,15 @@ public:
 private:
 	bool MustLift    (const Robot& /*robot*/, const Tree& /*tree*/) const;
 	bool MustLock    (const Robot& /*robot*/, const Tree& /*tree*/) const;
+	bool InStance    (const Tree& /*tree*/) const;
+	int  SyncWorld   (Robot& /*robot*/) const; // applies world changes to locked targets, returns number of unlocked trees
+	void StartPostures(const Robot& /*previousTransform*/, Trajectory& /*trajectory*/);
+	bool StepPostures(); // computes the posture of the next checkpoint, false at the end of the trajectory
 	
 	bool LockTree		 (Robot& /*robot*/, Tree& /*tree*/, bool closestDistance = false) const;  // Gets sampled tree configuration that suits the best to constraints
 	bool LockTree		 (Robot& /*robot*/, Tree& /*tree*/, Sample& sample, bool closestDistance = false) const;  // Gets sampled tree configuration that suits the best to constraints
 	bool HandleLockedTree(Robot& /*robot*/, Tree& /*tree*/);  // Gets sampled tree configuration that suits the best to constraints
+	bool PlanFootsteps	 (const Robot& /*robot*/, const Tree& /*tree*/, LockVisitor& /*visitor*/) const; // retains in visitor the first step of the best plan, false if none is valid
 
 private:
 	std::auto_ptr<PosturePImpl> pImpl_;
@@ -0,0 +1,190 @@
+
+#include "RootSolver.h"
+#include "kinematic/Robot.h"
+#include "kinematic/Tree.h"
+
+#include <vector>
+
+using namespace matrices;
+
+namespace
+{
+	Matrix3 Cross(const Vector3& v)
+	{
+		Matrix3 res;
+		res <<     0, -v(2),  v(1),
+				 v(2),     0, -v(0),
+				-v(1),  v(0),     0;
+		return res;
+	}
+
+	// rotation vector of a rotation matrix
+	Vector3 Log(const Matrix3& rotation)
+	{
+		Eigen::AngleAxis<NUMBER> angleAxis(rotation);
+		return angleAxis.axis() * angleAxis.angle();
+	}
+
+	Matrix3 Exp(const Vector3& w)
+	{
+		NUMBER angle = w.norm();
+		if(angle < 1e-12)
+		{
+			return Matrix3::Identity();
+		}
+		return Eigen::AngleAxis<NUMBER>(angle, w / angle).toRotationMatrix();
+	}
+}
+
+struct RootSolverPImpl
+{
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	RootSolverPImpl()
+		: offset_(0, 0, 0)
+	{
+		// NOTHING
+	}
+
+	~RootSolverPImpl()
+	{
+		// NOTHING
+	}
+
+	// residuals and jacobian with respect to (translation, rotation on the right)
+	void Linearize(const Vector3& position, const Matrix3& rotation)
+	{
+		const RootCriteria& c = criteria_;
+		unsigned int nbTrees = (unsigned int)targets_.size();
+		residuals_.resize(nbTrees + 8);
+		jacobian_ = MatrixX::Zero(nbTrees + 8, 6);
+		NUMBER wm = sqrt(c.manipulability_);
+		for(unsigned int i = 0; i < nbTrees; ++i)
+		{
+			Vector3 d = targets_[i] - position - rotation * attaches_[i];
+			NUMBER n = d.norm();
+			residuals_(i) = wm * (n - c.reach_ * radii_[i]);
+			if(n > 1e-12)
+			{
+				Vector3 u = d / n;
+				jacobian_.block<1,3>(i, 0) = -wm * u.transpose();
+				jacobian_.block<1,3>(i, 3) = wm * u.transpose() * rotation * Cross(attaches_[i]);
+			}
+		}
+		unsigned int row = nbTrees;
+		NUMBER wc = sqrt(c.comSupport_);
+		Vector3 com = position + rotation * com_;
+		Matrix3 comRotation = -rotation * Cross(com_);
+		for(int k = 0; k < 2; ++k, ++row)
+		{
+			residuals_(row) = wc * (com(k) - centroid_(k));
+			jacobian_(row, k) = wc;
+			jacobian_.block<1,3>(row, 3) = wc * comRotation.row(k);
+		}
+		NUMBER wt = sqrt(c.trajectory_);
+		for(int k = 0; k < 3; ++k, ++row)
+		{
+			residuals_(row) = wt * (position(k) - reference_(k));
+			jacobian_(row, k) = wt;
+		}
+		NUMBER wo = sqrt(c.orientation_);
+		Vector3 w = Log(referenceRotation_.transpose() * rotation);
+		for(int k = 0; k < 3; ++k, ++row)
+		{
+			residuals_(row) = wo * w(k);
+			jacobian_(row, 3 + k) = wo;
+		}
+	}
+
+	RootCriteria criteria_;
+	Vector3 offset_; // between the root and the trajectory at the previous frame
+	Vector3 reference_;
+	Matrix3 referenceRotation_;
+	Vector3 com_;      // robot coordinates
+	Vector3 centroid_; // of the contacts, world coordinates
+	std::vector<Vector3, Eigen::aligned_allocator<Vector3> > targets_;
+	std::vector<Vector3, Eigen::aligned_allocator<Vector3> > attaches_;
+	std::vector<NUMBER> radii_;
+	VectorX residuals_;
+	MatrixX jacobian_;
+};
+
+RootSolver::RootSolver()
+	: pImpl_(new RootSolverPImpl())
+{
+	// NOTHING
+}
+
+RootSolver::~RootSolver()
+{
+	// NOTHING
+}
+
+void RootSolver::SetCriteria(const RootCriteria& criteria)
+{
+	pImpl_->criteria_ = criteria;
+}
+
+const RootCriteria& RootSolver::GetCriteria() const
+{
+	return pImpl_->criteria_;
+}
+
+void RootSolver::Reset()
+{
+	pImpl_->offset_ = Vector3(0, 0, 0);
+}
+
+unsigned int RootSolver::Solve(Robot& robot)
+{
+	RootSolverPImpl& impl = *pImpl_;
+	const RootCriteria& criteria = impl.criteria_;
+	impl.targets_.clear();
+	impl.attaches_.clear();
+	impl.radii_.clear();
+	impl.centroid_ = Vector3(0, 0, 0);
+	for(Robot::T_TreeCIT it = robot.GetTrees().begin(); it != robot.GetTrees().end(); ++it)
+	{
+		if((*it)->IsLocked())
+		{
+			impl.targets_.push_back((*it)->GetTarget());
+			impl.attaches_.push_back((*it)->GetPosition());
+			impl.radii_.push_back((*it)->GetBoundaryRadius());
+			impl.centroid_ += (*it)->GetTarget();
+		}
+	}
+	if(criteria.maxIterations_ == 0 || impl.targets_.empty())
+	{
+		impl.offset_ = Vector3(0, 0, 0);
+		return 0;
+	}
+	impl.centroid_ /= (NUMBER)impl.targets_.size();
+	impl.com_ = robot.ComputeCom();
+	Matrix4 transform = robot.ToWorldCoordinates();
+	impl.reference_ = transform.block<3,1>(0,3);
+	impl.referenceRotation_ = transform.block<3,3>(0,0);
+	// warm start
+	Vector3 position = impl.reference_ + impl.offset_;
+	Matrix3 rotation = impl.referenceRotation_;
+	Eigen::Matrix<NUMBER, 6, 6> normal;
+	Eigen::Matrix<NUMBER, 6, 1> step;
+	unsigned int iterations = 0;
+	while(iterations < criteria.maxIterations_)
+	{
+		++iterations;
+		impl.Linearize(position, rotation);
+		normal = impl.jacobian_.transpose() * impl.jacobian_;
+		normal.diagonal().array() += criteria.damping_;
+		step = normal.ldlt().solve(-impl.jacobian_.transpose() * impl.residuals_);
+		position += step.head<3>();
+		rotation = rotation * Exp(step.tail<3>());
+		if(step.norm() < criteria.tolerance_)
+		{
+			break;
+		}
+	}
+	impl.offset_ = position - impl.reference_;
+	transform.block<3,3>(0,0) = rotation;
+	transform.block<3,1>(0,3) = position;
+	robot.SetPosOri(transform);
+	return iterations;
+}
@@ -0,0 +1,61 @@
+
+#ifndef _CLASS_ROOTSOLVER
+#define _CLASS_ROOTSOLVER
+
+#include "MatrixDefs.h"
+
+#include <memory>
+
+struct RootSolverPImpl;
+
+class Robot;
+
+// Weights of the terms of the root pose optimization
+struct RootCriteria
+{
+	RootCriteria()
+		: maxIterations_(0)
+		, reach_(0.7)
+		, manipulability_(1)
+		, comSupport_(0.5)
+		, trajectory_(1)
+		, orientation_(0.5)
+		, damping_(0.001)
+		, tolerance_(0.0001)
+	{}
+
+	unsigned int maxIterations_; // 0 keeps the root on the trajectory
+	NUMBER reach_;          // preferred distance between the root of a locked tree and its target, relative to the tree boundary radius
+	NUMBER manipulability_; // weight of the reach of the locked trees
+	NUMBER comSupport_;     // horizontal distance between the com and the centroid of the contacts
+	NUMBER trajectory_;     // distance between the root and the trajectory
+	NUMBER orientation_;    // rotation of the torso away from the given pose
+	NUMBER damping_;
+	NUMBER tolerance_;      // iterations stop once the update is smaller
+};
+
+/* Moves the root of a robot so that its locked trees stay well inside their workspace and its com above the contacts.
+Damped Gauss-Newton over the torso position and orientation, the offset to the trajectory found
+at the previous frame is used as a starting point, so that few iterations are needed.*/
+class RootSolver
+{
+public:
+	 RootSolver();
+	~RootSolver();
+
+private:
+	RootSolver(const RootSolver&);
+	RootSolver& operator=(const RootSolver&);
+
+public:
+	void SetCriteria(const RootCriteria& /*criteria*/);
+	const RootCriteria& GetCriteria() const;
+	void Reset(); // forgets the previous frame
+
+	unsigned int Solve(Robot& /*robot*/); // robot is placed on the trajectory pose, returns the number of iterations
+
+private:
+	std::auto_ptr<RootSolverPImpl> pImpl_;
+};
+
+#endif //_CLASS_ROOTSOLVER
@@ -1,5 +1,7 @@
 #include "Trajectory.h"
 
+#include <algorithm>
+
 using namespace matrices;
 
 Trajectory::Trajectory()
@@ -18,78 +20,122 @@ Trajectory::~Trajectory()
 	// NOTHING
 }
 
-bool Trajectory::AddCheckPoint(float time, const Vector3& position)
+namespace
 {
-	bool inserted = false;
-	for(T_TimePositionsIT it = timePositions_.begin(); it!= timePositions_.end(); ++it)
+	bool TimeBefore(const Trajectory::P_TimePosition& a, const Trajectory::P_TimePosition& b)
+	{
+		return a.first < b.first;
+	}
+
+	bool SameTime(const Trajectory::P_TimePosition& a, const Trajectory::P_TimePosition& b)
 	{
-		float cTime = (*it).first;
-		if(cTime == time)
-		{
-			return false;
-		}
-		else if(cTime > time)
-		{
-			timePositions_.insert(it, P_TimePosition(time, position));
-			inserted = true;
-			return true;
-		}
+		return a.first == b.first;
 	}
-	if(!inserted)
+
+	bool TimeBeforeValue(const Trajectory::P_TimePosition& a, float time)
+	{
+		return a.first < time;
+	}
+}
+
+bool Trajectory::AddCheckPoint(float time, const Vector3& position)
+{
+	if(timePositions_.empty() || timePositions_.back().first < time)
 	{
-		if(!timePositions_.empty())
-		{
-			float lastime = timePositions_.back().first;
-			// interpolate trajectory as straight line
-			// TODO Meilleure chelle
-			// compute speed
-			Vector3 oldPosition = timePositions_.back().second;
-			Vector3 speed = (position - oldPosition) / (time - lastime);
-			/*for (float i = lastime + 0.1f; i < time; i = i + 0.1f)
-			{
-				Vector3 newVal = oldPosition + speed * ( i);
-				timePositions_.push_back(P_TimePosition(i, oldPosition + speed * ( i - lastime) ));
-			}*/
-		}
 		timePositions_.push_back(P_TimePosition(time, position));
 		return true;
 	}
-	return false;
+	T_TimePositionsIT it = std::lower_bound(timePositions_.begin(), timePositions_.end(), time, TimeBeforeValue);
+	if((*it).first == time)
+	{
+		return false;
+	}
+	timePositions_.insert(it, P_TimePosition(time, position));
+	return true;
 }
 
-bool Trajectory::AddWayPoint(T_TimePositionsIT& position)
+unsigned int Trajectory::AddCheckPoints(const T_TimePositions& timePositions)
 {
-	T_TimePositionsIT next = position;
-	++next;
-	assert(position != timePositions_.end());
-	Vector3 newWaypoint = ((*position).second + (*next).second) / 2.f;
-	NUMBER distance =  ((*next).second  - newWaypoint).norm();
+	std::size_t size = timePositions_.size();
+	bool sorted = true;
+	const P_TimePosition* previous = timePositions_.empty() ? 0 : &timePositions_.back();
+	for(T_TimePositionsCIT it = timePositions.begin(); it != timePositions.end() && sorted; ++it)
+	{
+		sorted = !previous || previous->first < (*it).first;
+		previous = &(*it);
+	}
+	timePositions_.insert(timePositions_.end(), timePositions.begin(), timePositions.end());
+	if(!sorted)
+	{
+		// stable, so that already marked times keep their position
+		std::stable_sort(timePositions_.begin(), timePositions_.end(), TimeBefore);
+		timePositions_.erase(std::unique(timePositions_.begin(), timePositions_.end(), SameTime), timePositions_.end());
+	}
+	return (unsigned int)(timePositions_.size() - size);
+}
+
+bool Trajectory::AddWayPoint(std::size_t& index)
+{
+	assert(index + 1 < timePositions_.size());
+	const P_TimePosition& position = timePositions_[index];
+	const P_TimePosition& next = timePositions_[index + 1];
+	Vector3 newWaypoint = (position.second + next.second) / 2.f;
+	NUMBER distance =  (next.second  - newWaypoint).norm();
 	if(distance < 0.2)
 	{
 		return false;
 	}
 	else
 	{
-		float newTime = ((*position).first + (*next).first) / 2.f;
-		//The vector is extended by inserting new elements before the element at position.
-		position = timePositions_.insert(next, P_TimePosition(newTime, newWaypoint));
+		float newTime = (position.first + next.first) / 2.f;
+		++index;
+		timePositions_.insert(timePositions_.begin() + index, P_TimePosition(newTime, newWaypoint));
 		return true;
 	}
 }
 
-bool Trajectory::ReplaceWayPoint(T_TimePositionsIT& position, const Vector3& newWaypoint)
+bool Trajectory::ReplaceWayPoint(std::size_t index, const Vector3& newWaypoint)
 {
-	position->second = newWaypoint;
+	timePositions_[index].second = newWaypoint;
 	return true;
 }
 
+std::size_t Trajectory::Size() const
+{
+	return timePositions_.size();
+}
+
+bool Trajectory::Empty() const
+{
+	return timePositions_.empty();
+}
 
-const Trajectory::T_TimePositions& Trajectory::GetTimePositions() const
+const Trajectory::P_TimePosition& Trajectory::operator[](std::size_t index) const
 {
-	return timePositions_;
+	return timePositions_[index];
 }
 
-Trajectory::T_TimePositions& Trajectory::GetEditableTimePositions()
+std::size_t Trajectory::Find(float time) const
+{
+	T_TimePositionsCIT it = std::upper_bound(timePositions_.begin(), timePositions_.end(), P_TimePosition(time, Vector3::Zero()), TimeBefore);
+	return it == timePositions_.begin() ? 0 : (it - timePositions_.begin()) - 1;
+}
+
+Vector3 Trajectory::Interpolate(float time) const
+{
+	assert(!timePositions_.empty());
+	std::size_t index = Find(time);
+	const P_TimePosition& current = timePositions_[index];
+	if(time <= current.first || index + 1 == timePositions_.size())
+	{
+		return current.second;
+	}
+	const P_TimePosition& next = timePositions_[index + 1];
+	NUMBER u = (time - current.first) / (next.first - current.first);
+	return current.second + (next.second - current.second) * u;
+}
+
+const Trajectory::T_TimePositions& Trajectory::GetTimePositions() const
 {
 	return timePositions_;
 }
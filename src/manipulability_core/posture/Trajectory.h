@@ -5,13 +5,14 @@
 #include "MatrixDefs.h"
 //#include <Memory.h>
 
-#include <list>
+#include <vector>
 
+// Checkpoints sorted by time and stored contiguously, positions are accessed by index
 class Trajectory
 {
 public:
 	typedef std::pair  <float, matrices::Vector3>	P_TimePosition;
-    typedef std::list<P_TimePosition, Eigen::aligned_allocator<std::pair<const int, matrices::Matrix4> > > T_TimePositions;
+	typedef std::vector<P_TimePosition, Eigen::aligned_allocator<P_TimePosition> > T_TimePositions;
 	typedef T_TimePositions::iterator				T_TimePositionsIT;
 	typedef T_TimePositions::const_iterator			T_TimePositionsCIT;
 
@@ -24,12 +25,17 @@ public: // constructors / destructors
 public: // actuators
 	void Reset(); // false is time is alreadyt marked
 	bool AddCheckPoint(float /*time*/, const matrices::Vector3& /*position*/); // false is time is alreadyt marked
-	bool AddWayPoint(T_TimePositionsIT& /*position*/);
-	bool ReplaceWayPoint(T_TimePositionsIT& /*position*/, const matrices::Vector3& /*newWaypoint*/);
+	unsigned int AddCheckPoints(const T_TimePositions& /*timePositions*/); // returns the number of checkpoints added, already marked times are ignored
+	bool AddWayPoint(std::size_t& /*index*/); // inserts the middle of index and index + 1, index is then placed on it
+	bool ReplaceWayPoint(std::size_t /*index*/, const matrices::Vector3& /*newWaypoint*/);
 
 public: // helpers
+	std::size_t Size() const;
+	bool Empty() const;
+	const P_TimePosition& operator[](std::size_t /*index*/) const;
+	std::size_t Find(float /*time*/) const; // index of the last checkpoint before time, 0 if time is before the first one
+	matrices::Vector3 Interpolate(float /*time*/) const; // linear, clamped to the first and last checkpoints
 	const T_TimePositions& GetTimePositions() const;
-	T_TimePositions& GetEditableTimePositions();
 
 private:
 	T_TimePositions timePositions_;
@@ -29,6 +29,7 @@ public:
 	const LAngles& AngleValues(){return angles_;}
 	void LoadIntoTree(Tree& /*tree*/) const;
 	const matrices::Vector3& GetPosition() const;
+	const matrices::Matrix3& GetJacobianProduct() const { return jacobianProd_; }
 	
 	NUMBER velocityManipulabiliy(const matrices::Vector3& /*direction*/) const;
 	NUMBER forceManipulabiliy   (const matrices::Vector3& /*direction*/) const ;
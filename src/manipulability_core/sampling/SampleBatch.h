@@ -0,0 +1,45 @@
+
+#ifndef _CLASS_SAMPLEBATCH
+#define _CLASS_SAMPLEBATCH
+
+#include "MatrixDefs.h"
+
+#include <vector>
+
+class Sample;
+
+// indexes of the samples of a batch
+typedef std::vector<unsigned int> T_Selection;
+
+// Structure of arrays copy of the sample positions of a tree, sorted by sample id
+// so that filters can be evaluated in a single pass over contiguous memory.
+struct SampleBatch
+{
+	typedef std::vector<NUMBER>	 T_Coordinates;
+	typedef std::vector<Sample*> T_Samples;
+	typedef std::vector<size_t>	 T_Ids;
+
+	void Clear()
+	{
+		x_.clear(); y_.clear(); z_.clear();
+		samples_.clear();
+		ids_.clear();
+	}
+
+	void Add(size_t id, Sample* sample, const matrices::Vector3& position)
+	{
+		x_.push_back(position(0)); y_.push_back(position(1)); z_.push_back(position(2));
+		samples_.push_back(sample);
+		ids_.push_back(id);
+	}
+
+	size_t Size() const { return ids_.size(); }
+
+	T_Coordinates x_;
+	T_Coordinates y_;
+	T_Coordinates z_;
+	T_Samples samples_;
+	T_Ids ids_;
+};
+
+#endif //_CLASS_SAMPLEBATCH
@@ -0,0 +1,114 @@
+
+#include "SampleClusters.h"
+#include "sampling/Sample.h"
+#include "Pi.h"
+
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace matrices;
+
+namespace
+{
+	const int nbLatitudes = 6;
+	const int nbLongitudes = 12;
+	// absorbs the difference between the eigen decomposition and the direct computation of the manipulability
+	const NUMBER boundSlack = 1.000001;
+
+	struct CompareBounds
+	{
+		CompareBounds(const SampleClusters::T_Bounds& bounds, const std::vector<int>& clusterOf)
+			: bounds_(bounds), clusterOf_(clusterOf) {}
+
+		bool operator()(unsigned int a, unsigned int b) const
+		{
+			NUMBER boundA = bounds_[clusterOf_[a]];
+			NUMBER boundB = bounds_[clusterOf_[b]];
+			return boundA > boundB || (boundA == boundB && a < b);
+		}
+
+		const SampleClusters::T_Bounds& bounds_;
+		const std::vector<int>& clusterOf_;
+	};
+}
+
+SampleClusters::SampleClusters()
+{
+	// NOTHING
+}
+
+SampleClusters::~SampleClusters()
+{
+	// NOTHING
+}
+
+void SampleClusters::Build(const SampleBatch& batch)
+{
+	clusters_.resize(nbLatitudes * nbLongitudes);
+	clusterBounds_.resize(clusters_.size());
+	for(int lat = 0; lat < nbLatitudes; ++lat)
+	{
+		NUMBER theta = (lat + 0.5) * (Pi / 2) / nbLatitudes;
+		for(int lon = 0; lon < nbLongitudes; ++lon)
+		{
+			NUMBER phi = (lon + 0.5) * (2 * Pi) / nbLongitudes - Pi;
+			Cluster& cluster = clusters_[lat * nbLongitudes + lon];
+			cluster.center_ = Vector3(sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta));
+			cluster.cosAlpha_ = 1;
+			cluster.lambdaMin_ = 1e30;
+			cluster.lambdaMid_ = 1e30;
+			cluster.nbSamples_ = 0;
+		}
+	}
+	clusterOf_.resize(batch.Size());
+	for(size_t i = 0; i < batch.Size(); ++i)
+	{
+		// eigen values in increasing order, the first axis is the one of largest force manipulability
+		Eigen::SelfAdjointEigenSolver<Matrix3> solver(batch.samples_[i]->GetJacobianProduct());
+		Vector3 axis = solver.eigenvectors().col(0);
+		axis.normalize();
+		if(axis(2) < 0) axis = -axis;
+		int lat = std::min((int)(acos(std::min(axis(2), (NUMBER)1)) / (Pi / 2) * nbLatitudes), nbLatitudes - 1);
+		int lon = std::min((int)((atan2(axis(1), axis(0)) + Pi) / (2 * Pi) * nbLongitudes), nbLongitudes - 1);
+		int id = lat * nbLongitudes + std::max(lon, 0);
+		Cluster& cluster = clusters_[id];
+		cluster.cosAlpha_ = std::min(cluster.cosAlpha_, (NUMBER)fabs(axis.dot(cluster.center_)));
+		cluster.lambdaMin_ = std::min(cluster.lambdaMin_, (NUMBER)solver.eigenvalues()(0));
+		cluster.lambdaMid_ = std::min(cluster.lambdaMid_, (NUMBER)solver.eigenvalues()(1));
+		++cluster.nbSamples_;
+		clusterOf_[i] = id;
+	}
+}
+
+NUMBER SampleClusters::Bound(int id, const Vector3& direction) const
+{
+	// d.(J * Jt).d >= lambdaMin * t^2 + lambdaMid * (1 - t^2), t being the cosine between d and the sample axis,
+	// and t is at most the cosine of the angle between d and the cluster cone
+	const Cluster& cluster = clusters_[id];
+	NUMBER norm = direction.norm();
+	NUMBER theta = acos(std::min((NUMBER)fabs(direction.dot(cluster.center_)) / norm, (NUMBER)1));
+	NUMBER alpha = acos(std::min(cluster.cosAlpha_, (NUMBER)1));
+	NUMBER t = theta > alpha ? cos(theta - alpha) : 1;
+	NUMBER lambda = cluster.lambdaMin_ * t * t + cluster.lambdaMid_ * (1 - t * t);
+	if(lambda <= 0)
+	{
+		return 1e30;
+	}
+	return boundSlack / (sqrt(lambda) * norm);
+}
+
+void SampleClusters::Sort(const Vector3& direction, T_Selection& selection, T_Bounds& bounds) const
+{
+	for(int i = 0; i < (int)clusters_.size(); ++i)
+	{
+		clusterBounds_[i] = clusters_[i].nbSamples_ > 0 ? Bound(i, direction) : 0;
+	}
+	std::sort(selection.begin(), selection.end(), CompareBounds(clusterBounds_, clusterOf_));
+	bounds.resize(selection.size());
+	for(size_t i = 0; i < selection.size(); ++i)
+	{
+		bounds[i] = clusterBounds_[clusterOf_[selection[i]]];
+	}
+}
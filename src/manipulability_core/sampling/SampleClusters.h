@@ -0,0 +1,52 @@
+
+#ifndef _CLASS_SAMPLECLUSTERS
+#define _CLASS_SAMPLECLUSTERS
+
+#include "MatrixDefs.h"
+#include "sampling/SampleBatch.h"
+
+#include <vector>
+
+/* Groups the samples of a batch by the axis of their largest force manipulability
+(the smallest axis of the J * Jt ellipsoid), on a grid of the half sphere.
+Each cluster keeps enough to bound the force manipulability of its samples
+along any direction, so that requests can visit the best clusters first and
+skip the ones that cannot beat the current best sample.*/
+class SampleClusters {
+
+public:
+	typedef std::vector<NUMBER> T_Bounds;
+
+public:
+	 SampleClusters();
+	~SampleClusters();
+
+public:
+	void Build(const SampleBatch& /*batch*/);
+	// upper bound of Sample::forceManipulabiliy(direction) for every sample of the cluster
+	NUMBER Bound(int /*cluster*/, const matrices::Vector3& /*direction*/) const;
+	// sorts the selection by decreasing bound, bounds receives the bound of each selected sample
+	void Sort(const matrices::Vector3& /*direction*/, T_Selection& /*selection*/, T_Bounds& /*bounds*/) const;
+
+	int GetCluster(unsigned int index) const { return clusterOf_[index]; }
+	int GetNumClusters() const { return (int)clusters_.size(); }
+
+private:
+	struct Cluster
+	{
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+		matrices::Vector3 center_;
+		NUMBER cosAlpha_; // cosine of the largest angle between center and the axis of a sample
+		NUMBER lambdaMin_; // smallest eigen values of J * Jt among the samples
+		NUMBER lambdaMid_;
+		int nbSamples_;
+	};
+	typedef std::vector<Cluster, Eigen::aligned_allocator<Cluster> > T_Clusters;
+
+private:
+	T_Clusters clusters_;
+	std::vector<int> clusterOf_;
+	mutable T_Bounds clusterBounds_;
+};
+
+#endif //_CLASS_SAMPLECLUSTERS
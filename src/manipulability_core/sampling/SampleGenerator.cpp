@@ -7,15 +7,20 @@
 #include "kinematic/Joint.h"
 #include "Pi.h"
 #include "filters\Filter_ABC.h"
+#include "SampleBatch.h"
+#include "SampleClusters.h"
 #include "world/Obstacle.h"
 
 #include <vector>
+#include <deque>
 #include <time.h>
 #include <map>
+#include <algorithm>
 
 #include "MatrixDefs.h"
 
 #include "Octree.h"
+#include "Profiler.h"
 
 using namespace manip_core;
 using namespace matrices;
@@ -118,9 +123,11 @@ struct PImpl
 	//typedef std::vector<LSamples> LLSamples;
 	typedef std::vector<tree::RTree3f*> T_Trees;
 	typedef std::map<tree::EntityId, Sample> T_IdMatches;
-	typedef std::vector<T_IdMatches> LLSamples;
+	typedef std::deque<T_IdMatches> LLSamples; // the batches point to the samples, which must not move
 	typedef T_IdMatches::iterator T_IdMatches_IT;
 	typedef T_IdMatches::const_iterator T_IdMatches_CIT;
+	typedef std::vector<SampleBatch> T_Batches;
+	typedef std::vector<SampleClusters> T_Clusters;
 
 	PImpl()
 	{
@@ -156,8 +163,71 @@ struct PImpl
 			samples.insert(std::make_pair(id, sample));
 		}
 	}
+	// samples are not modified once generated, their positions are copied in id order
+	void InitBatch(T_IdMatches& samples, SampleBatch& batch)
+	{
+		batch.Clear();
+		for (T_IdMatches_IT it = samples.begin(); it != samples.end(); ++it)
+		{
+			batch.Add(it->first, &(it->second), it->second.GetPosition());
+		}
+	}
+
+	void SelectAll(const SampleBatch& batch)
+	{
+		selection_.resize(batch.Size());
+		for (unsigned int i = 0; i < selection_.size(); ++i)
+		{
+			selection_[i] = i;
+		}
+	}
+
+	// visits the selected samples, by decreasing bound when the visitor allows pruning
+	void VisitSelection(const Robot& robot, Tree& tree, SampleGeneratorVisitor_ABC* visitor, size_t id, const Obstacle* obstacle)
+	{
+		const SampleBatch& batch = batches_[id];
+		matrices::Vector3 direction;
+		NUMBER scale;
+		if (visitor->GetBound(robot, obstacle, direction, scale) && scale > 0)
+		{
+			clusters_[id].Sort(direction, selection_, bounds_);
+			for (size_t i = 0; i < selection_.size(); ++i)
+			{
+				if (bounds_[i] * scale < visitor->GetBestScore())
+				{
+					visitor->OnPruned();
+					break;
+				}
+				Visit(robot, tree, visitor, *(batch.samples_[selection_[i]]), obstacle);
+			}
+		}
+		else
+		{
+			for (T_Selection::const_iterator it = selection_.begin(); it != selection_.end(); ++it)
+			{
+				Visit(robot, tree, visitor, *(batch.samples_[*it]), obstacle);
+			}
+		}
+	}
+
+	void Visit(const Robot& robot, Tree& tree, SampleGeneratorVisitor_ABC* visitor, Sample& sample, const Obstacle* obstacle)
+	{
+		if (obstacle)
+		{
+			visitor->Visit(robot, tree, sample, *obstacle);
+		}
+		else
+		{
+			visitor->Visit(robot, tree, sample);
+		}
+	}
+
 	LLSamples allSamples_;
 	T_Trees trees_;
+	T_Batches batches_;
+	T_Clusters clusters_;
+	T_Selection selection_; // reused between requests to avoid allocations
+	SampleClusters::T_Bounds bounds_;
 };
 
 SampleGenerator *SampleGenerator::instance = 0;
@@ -178,7 +248,7 @@ void SampleGenerator::GenerateSamples(Tree& tree, int nbSamples)
 	assert(nbSamples > 0);
 	PImpl::T_IdMatches samples;
 	Tree::TREE_ID id = tree.GetTemplateId();
-	if (pImpl_->allSamples_.size() == id) // TODO this sucks, entries have to be created in sequential order
+	if (pImpl_->allSamples_.size() == (std::size_t)id) // TODO this sucks, entries have to be created in sequential order
 	{
 		pImpl_->allSamples_.push_back(samples);
 		tree::RTree3f * rTree = new tree::RTree3f();
@@ -191,6 +261,10 @@ void SampleGenerator::GenerateSamples(Tree& tree, int nbSamples)
 		}
 
 		rTree->initTree();
+		pImpl_->batches_.push_back(SampleBatch());
+		pImpl_->InitBatch(pImpl_->allSamples_[id], pImpl_->batches_[id]);
+		pImpl_->clusters_.push_back(SampleClusters());
+		pImpl_->clusters_[id].Build(pImpl_->batches_[id]);
 		init.LoadIntoTree(tree);
 	}
 }
@@ -204,11 +278,14 @@ void SampleGenerator::GenerateSamples(Robot& robot, int nbSamples)
 }
 void SampleGenerator::Request(const Robot& robot, Tree& tree, SampleGeneratorVisitor_ABC* visitor, const Filter_ABC& filter) const
 {
-	for (PImpl::T_IdMatches_IT it = pImpl_->allSamples_[tree.GetTemplateId()].begin(); it != pImpl_->allSamples_[tree.GetTemplateId()].end(); ++it)
+	const SampleBatch& batch = pImpl_->batches_[tree.GetTemplateId()];
+	pImpl_->SelectAll(batch);
 	{
-		if (filter.ApplyFilter(it->second))
-			visitor->Visit(robot, tree, it->second);
+		ProfileScope scope(enums::stage::filter);
+		filter.ApplyFilter(batch, pImpl_->selection_);
 	}
+	ProfileScope scope(enums::stage::score);
+	pImpl_->VisitSelection(robot, tree, visitor, tree.GetTemplateId(), 0);
 }
 
 
@@ -253,25 +330,35 @@ TriangleRequest(*this, robot, tree, visitor, filter, rTree, selected, concerned,
 
 void SampleGenerator::Request(const Robot& robot, Tree& tree, SampleGeneratorVisitor_ABC* visitor, const Filter_ABC& filter, const Obstacle& obstacle) const
 {
-	tree::RTree3f* rTree = pImpl_->trees_[tree.GetId()];
-	vector<Triangle3Df> triangles;
-	MakeTriangles(robot, tree, obstacle, triangles);
+	const SampleBatch& batch = pImpl_->batches_[tree.GetTemplateId()];
+	T_Selection& selection = pImpl_->selection_;
+	{
+		ProfileScope scope(enums::stage::sampleQuery);
+		tree::RTree3f* rTree = pImpl_->trees_[tree.GetTemplateId()];
+		vector<Triangle3Df> triangles;
+		MakeTriangles(robot, tree, obstacle, triangles);
 
-	tree::T_Id selected;
+		tree::T_Id selected;
 
-	for (int i = 0; i < triangles.size(); i++){
-		tree::T_Id cur = rTree->select(triangles[i]);
-		selected.insert(selected.end(), cur.begin(), cur.end());
-	}
+		for (int i = 0; i < triangles.size(); i++){
+			tree::T_Id cur = rTree->select(triangles[i]);
+			selected.insert(selected.end(), cur.begin(), cur.end());
+		}
 
-	PImpl::T_IdMatches& concerned = pImpl_->allSamples_[tree.GetId()];
-	PImpl::T_IdMatches_IT itMatches;
-	for (tree::CIT_Id it = selected.begin(); it != selected.end(); ++it)
-	{
-		itMatches = concerned.find(*it);
-		if (itMatches != concerned.end())
+		selection.clear();
+		for (tree::CIT_Id it = selected.begin(); it != selected.end(); ++it)
 		{
-			this->Request(robot, tree, visitor, filter, itMatches->second, obstacle);
+			SampleBatch::T_Ids::const_iterator match = std::lower_bound(batch.ids_.begin(), batch.ids_.end(), *it);
+			if (match != batch.ids_.end() && *match == *it)
+			{
+				selection.push_back((unsigned int)(match - batch.ids_.begin()));
+			}
 		}
 	}
+	{
+		ProfileScope scope(enums::stage::filter);
+		filter.ApplyFilter(batch, selection);
+	}
+	ProfileScope scope(enums::stage::score);
+	pImpl_->VisitSelection(robot, tree, visitor, tree.GetTemplateId(), &obstacle);
 }
\ No newline at end of file
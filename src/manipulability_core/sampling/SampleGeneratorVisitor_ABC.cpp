@@ -18,4 +18,19 @@ void SampleGeneratorVisitor_ABC::Visit(const Robot& /*robot*/, /*const*/Tree& /*
 void SampleGeneratorVisitor_ABC::Visit(const Robot& /*robot*/, /*const*/Tree& /*tree*/, Sample& /*sample*/, const Obstacle& /*obstacle*/)
 {
 	// NOTHING
-}
\ No newline at end of file
+}
+
+bool SampleGeneratorVisitor_ABC::GetBound(const Robot& /*robot*/, const Obstacle* /*obstacle*/, matrices::Vector3& /*direction*/, NUMBER& /*scale*/) const
+{
+	return false;
+}
+
+NUMBER SampleGeneratorVisitor_ABC::GetBestScore() const
+{
+	return 0;
+}
+
+void SampleGeneratorVisitor_ABC::OnPruned()
+{
+	// NOTHING
+}
@@ -2,6 +2,7 @@
 #ifndef _CLASS_SAMPLEGENERATORVISITOR_ABC
 #define _CLASS_SAMPLEGENERATORVISITOR_ABC
 
+#include "MatrixDefs.h"
 
 class Sample;
 class Tree;
@@ -18,6 +19,15 @@ public:
 	// TODO tree must be const
 	virtual void Visit(const Robot& /*robot*/, /*const*/Tree& /*tree*/, Sample& /*sample*/);	
 	virtual void Visit(const Robot& /*robot*/, /*const*/Tree& /*tree*/, Sample& /*sample*/, const Obstacle& /*obstacle*/);	
+
+public:
+	// Optional pruning. Returns true if the score of a sample is at most scale * its force manipulability along direction,
+	// and if only samples whose score is at least GetBestScore() can be retained.
+	// Samples are then visited by decreasing bound, and the ones that cannot be retained are skipped.
+	virtual bool GetBound(const Robot& /*robot*/, const Obstacle* /*obstacle*/, matrices::Vector3& /*direction*/, NUMBER& /*scale*/) const;
+	virtual NUMBER GetBestScore() const;
+	virtual void OnPruned(); // called when the samples left in a request were skipped
+
 private:
 };
 
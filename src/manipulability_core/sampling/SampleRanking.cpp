@@ -0,0 +1,76 @@
+
+#include "SampleRanking.h"
+
+#include <algorithm>
+
+namespace
+{
+	// true if a is ranked before b. Used as heap ordering, it keeps the lowest ranked candidate on top
+	struct RankedBefore
+	{
+		bool operator()(const SampleRanking::Candidate& a, const SampleRanking::Candidate& b) const
+		{
+			return a.score_ > b.score_ || (a.score_ == b.score_ && a.order_ > b.order_);
+		}
+	};
+}
+
+SampleRanking::SampleRanking(size_t nbCandidates)
+	: nbCandidates_(nbCandidates)
+	, order_(0)
+	, dropped_(false)
+{
+	if(nbCandidates_ > 0)
+	{
+		candidates_.reserve(nbCandidates_);
+	}
+}
+
+SampleRanking::~SampleRanking()
+{
+	// NOTHING
+}
+
+void SampleRanking::Add(NUMBER score, Sample* sample, const Obstacle* obstacle)
+{
+	Candidate candidate;
+	candidate.score_ = score;
+	candidate.order_ = order_++;
+	candidate.sample_ = sample;
+	candidate.obstacle_ = obstacle;
+	if(nbCandidates_ == 0 || candidates_.size() < nbCandidates_)
+	{
+		candidates_.push_back(candidate);
+		std::push_heap(candidates_.begin(), candidates_.end(), RankedBefore());
+		return;
+	}
+	// the front of the heap is the lowest ranked candidate
+	dropped_ = true;
+	if(RankedBefore()(candidate, candidates_.front()))
+	{
+		std::pop_heap(candidates_.begin(), candidates_.end(), RankedBefore());
+		candidates_.back() = candidate;
+		std::push_heap(candidates_.begin(), candidates_.end(), RankedBefore());
+	}
+}
+
+void SampleRanking::Sort()
+{
+	std::sort_heap(candidates_.begin(), candidates_.end(), RankedBefore());
+}
+
+void SampleRanking::Clear()
+{
+	candidates_.clear();
+	order_ = 0;
+	dropped_ = false;
+}
+
+NUMBER SampleRanking::GetThreshold() const
+{
+	if(nbCandidates_ == 0 || candidates_.size() < nbCandidates_)
+	{
+		return -1e30;
+	}
+	return candidates_.front().score_;
+}
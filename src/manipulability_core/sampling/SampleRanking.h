@@ -0,0 +1,69 @@
+
+#ifndef _CLASS_SAMPLERANKING
+#define _CLASS_SAMPLERANKING
+
+#include "MatrixDefs.h"
+
+#include <vector>
+
+class Sample;
+class Obstacle;
+
+// Weights of the criteria used to rank the samples of a request. Distances are counted negatively.
+struct RankingCriteria
+{
+	RankingCriteria()
+		: manipulability_(1)
+		, targetDistance_(0)
+		, jointLimits_(0)
+		, comSupport_(0)
+		, nbCandidates_(16)
+		, checkBalance_(false)
+	{}
+
+	NUMBER manipulability_; // force manipulability along the direction, weighted by the alignment with the obstacle normal
+	NUMBER targetDistance_; // distance between the sample and the current target of the tree
+	NUMBER jointLimits_;    // smallest normalized distance of a joint to its limits
+	NUMBER comSupport_;     // horizontal distance between the center of mass and the centroid of the contacts
+	size_t nbCandidates_;   // 0 keeps every candidate
+	bool checkBalance_;     // validation also requires the center of mass to stay in the support polygon
+};
+
+/* Keeps the best candidates of a request in a bounded heap.
+Candidates are only validated once the request is over, in rank order,
+so that expensive checks are run on as few samples as possible.*/
+class SampleRanking {
+
+public:
+	struct Candidate
+	{
+		NUMBER score_;
+		unsigned int order_; // among equal scores, the last visited sample is ranked first
+		Sample* sample_;
+		const Obstacle* obstacle_;
+	};
+	typedef std::vector<Candidate>			T_Candidates;
+	typedef T_Candidates::const_iterator	T_CandidatesCIT;
+
+public:
+	explicit SampleRanking(size_t /*nbCandidates*/); // 0 keeps every candidate
+	~SampleRanking();
+
+public:
+	void Add(NUMBER /*score*/, Sample* /*sample*/, const Obstacle* /*obstacle*/);
+	void Sort(); // candidates by decreasing rank, must be called before GetCandidates
+	void Clear();
+	void SetTruncated() { dropped_ = true; } // candidates were skipped before being added
+
+	const T_Candidates& GetCandidates() const { return candidates_; }
+	bool IsTruncated() const { return dropped_; } // true if some candidates were not kept
+	NUMBER GetThreshold() const; // score a sample must reach to enter the ranking
+
+private:
+	T_Candidates candidates_;
+	const size_t nbCandidates_;
+	unsigned int order_;
+	bool dropped_;
+};
+
+#endif //_CLASS_SAMPLERANKING
@@ -10,12 +10,10 @@ using namespace Eigen;
 
 
 FilterDistance::FilterDistance(NUMBER treshold, const Tree& tree, const Vector3& target)
-	: Filter_ABC()
-	, treshold_(treshold)
-	, target_(target)
-	, treePos_(tree.GetPosition())
+	: FilterPredicate()
 {
-	// NOTHING
+	// check that sample position is inside obstacle radius and not too far from its plan
+	AddReach(target - tree.GetPosition(), treshold);
 }
 
 FilterDistance::~FilterDistance()
@@ -23,9 +21,3 @@ FilterDistance::~FilterDistance()
 	// NOTHING
 }
 
-bool FilterDistance::ApplyFilter(const Sample& sample) const
-{
-	// check that sample position is inside obstacle radius and not too far from its plan
-	return ((sample.GetPosition() + treePos_) - target_).norm() < treshold_;
-}
-
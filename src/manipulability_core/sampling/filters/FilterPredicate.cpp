@@ -0,0 +1,113 @@
+
+#include "FilterPredicate.h"
+
+#include "sampling/Sample.h"
+#include "Pi.h"
+
+#include <math.h>
+
+using namespace matrices;
+
+FilterPredicate::FilterPredicate()
+	: Filter_ABC()
+	, nbLinears_(0)
+	, nbBalls_(0)
+	, nbCones_(0)
+{
+	// NOTHING
+}
+
+FilterPredicate::~FilterPredicate()
+{
+	// NOTHING
+}
+
+void FilterPredicate::AddLinear(NUMBER a, NUMBER b, NUMBER c, NUMBER d)
+{
+	assert(nbLinears_ < maxLinears);
+	linearA_[nbLinears_] = a; linearB_[nbLinears_] = b; linearC_[nbLinears_] = c; linearD_[nbLinears_] = d;
+	++nbLinears_;
+}
+
+void FilterPredicate::AddPlaneDistance(const Matrix4& toPlaneCoordinates, NUMBER treshold)
+{
+	const Matrix4& m = toPlaneCoordinates;
+	AddLinear( m(2,0),  m(2,1),  m(2,2),  m(2,3) - treshold);
+	AddLinear(-m(2,0), -m(2,1), -m(2,2), -m(2,3) - treshold);
+}
+
+void FilterPredicate::AddRectangle(const Matrix4& toPlaneCoordinates, NUMBER width, NUMBER height)
+{
+	const Matrix4& m = toPlaneCoordinates;
+	AddLinear(-m(0,0), -m(0,1), -m(0,2), -m(0,3));
+	AddLinear( m(0,0),  m(0,1),  m(0,2),  m(0,3) - width);
+	AddLinear(-m(1,0), -m(1,1), -m(1,2), -m(1,3));
+	AddLinear( m(1,0),  m(1,1),  m(1,2),  m(1,3) - height);
+}
+
+void FilterPredicate::AddCone(const Vector3& apex, const Vector3& axis, NUMBER halfAngle)
+{
+	assert(nbCones_ < maxCones && halfAngle < Pi / 2);
+	Vector3 dir = axis; dir.normalize();
+	coneX_[nbCones_] = apex(0); coneY_[nbCones_] = apex(1); coneZ_[nbCones_] = apex(2);
+	coneAxisX_[nbCones_] = dir(0); coneAxisY_[nbCones_] = dir(1); coneAxisZ_[nbCones_] = dir(2);
+	coneCos2_[nbCones_] = cos(halfAngle) * cos(halfAngle);
+	++nbCones_;
+}
+
+void FilterPredicate::AddReach(const Vector3& center, NUMBER treshold)
+{
+	assert(nbBalls_ < maxBalls);
+	ballX_[nbBalls_] = center(0); ballY_[nbBalls_] = center(1); ballZ_[nbBalls_] = center(2);
+	ballR2_[nbBalls_] = treshold * treshold;
+	++nbBalls_;
+}
+
+// predicates are combined without branching so that the compiler can vectorize the loops
+inline bool FilterPredicate::Accept(NUMBER x, NUMBER y, NUMBER z) const
+{
+	bool res = true;
+	for(int i = 0; i < nbLinears_; ++i)
+	{
+		res &= linearA_[i] * x + linearB_[i] * y + linearC_[i] * z + linearD_[i] <= 0;
+	}
+	for(int i = 0; i < nbBalls_; ++i)
+	{
+		NUMBER dx = x - ballX_[i]; NUMBER dy = y - ballY_[i]; NUMBER dz = z - ballZ_[i];
+		res &= dx * dx + dy * dy + dz * dz < ballR2_[i];
+	}
+	for(int i = 0; i < nbCones_; ++i)
+	{
+		NUMBER dx = x - coneX_[i]; NUMBER dy = y - coneY_[i]; NUMBER dz = z - coneZ_[i];
+		NUMBER proj = dx * coneAxisX_[i] + dy * coneAxisY_[i] + dz * coneAxisZ_[i];
+		res &= proj >= 0 && proj * proj >= coneCos2_[i] * (dx * dx + dy * dy + dz * dz);
+	}
+	return res;
+}
+
+bool FilterPredicate::ApplyFilter(const Sample& sample) const
+{
+	const Vector3& position = sample.GetPosition();
+	return Accept(position(0), position(1), position(2));
+}
+
+void FilterPredicate::ApplyFilter(const SampleBatch& batch, T_Selection& selection) const
+{
+	if(nbLinears_ + nbBalls_ + nbCones_ == 0 || selection.empty())
+	{
+		return;
+	}
+	const NUMBER* x = &batch.x_[0];
+	const NUMBER* y = &batch.y_[0];
+	const NUMBER* z = &batch.z_[0];
+	const size_t size = selection.size();
+	size_t kept = 0;
+	// compaction in place, the index is always written and only kept when it passes
+	for(size_t i = 0; i < size; ++i)
+	{
+		unsigned int id = selection[i];
+		selection[kept] = id;
+		kept += Accept(x[id], y[id], z[id]) ? 1 : 0;
+	}
+	selection.resize(kept);
+}
@@ -0,0 +1,53 @@
+#ifndef _CLASS_FILTER_PREDICATE
+#define _CLASS_FILTER_PREDICATE
+
+#include "Filter_ABC.h"
+#include "MatrixDefs.h"
+
+class Sample;
+
+/* Conjunction of simple geometric predicates on the sample positions (in tree coordinates).
+The predicates are reduced at construction to linear inequalities, balls and cones
+that are all evaluated in one pass over the sample batch.*/
+class FilterPredicate : public Filter_ABC {
+
+public:
+	 FilterPredicate();
+	~FilterPredicate();
+
+public:
+	// |z| <= treshold once the position is expressed in plane coordinates
+	void AddPlaneDistance(const matrices::Matrix4& /*toPlaneCoordinates*/, NUMBER /*treshold*/);
+	// 0 <= x <= width and 0 <= y <= height once the position is expressed in plane coordinates
+	void AddRectangle(const matrices::Matrix4& /*toPlaneCoordinates*/, NUMBER /*width*/, NUMBER /*height*/);
+	// angle between axis and position - apex lower than halfAngle
+	void AddCone(const matrices::Vector3& /*apex*/, const matrices::Vector3& /*axis*/, NUMBER /*halfAngle*/);
+	// distance between position and center strictly lower than treshold
+	void AddReach(const matrices::Vector3& /*center*/, NUMBER /*treshold*/);
+
+protected:
+	virtual bool ApplyFilter(const Sample& /*sample*/) const;
+	virtual void ApplyFilter(const SampleBatch& /*batch*/, T_Selection& /*selection*/) const;
+
+private:
+	bool Accept(NUMBER /*x*/, NUMBER /*y*/, NUMBER /*z*/) const;
+	void AddLinear(NUMBER /*a*/, NUMBER /*b*/, NUMBER /*c*/, NUMBER /*d*/); // a x + b y + c z + d <= 0
+
+private:
+	enum
+	{
+		maxLinears = 12,
+		maxBalls = 2,
+		maxCones = 2
+	};
+
+	// coefficients are stored per component so that the kernel loops stay simple
+	NUMBER linearA_[maxLinears], linearB_[maxLinears], linearC_[maxLinears], linearD_[maxLinears];
+	NUMBER ballX_[maxBalls], ballY_[maxBalls], ballZ_[maxBalls], ballR2_[maxBalls];
+	NUMBER coneX_[maxCones], coneY_[maxCones], coneZ_[maxCones], coneAxisX_[maxCones], coneAxisY_[maxCones], coneAxisZ_[maxCones], coneCos2_[maxCones];
+	int nbLinears_;
+	int nbBalls_;
+	int nbCones_;
+};
+
+#endif //_CLASS_FILTER_PREDICATE
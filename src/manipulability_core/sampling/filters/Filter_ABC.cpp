@@ -11,3 +11,16 @@ Filter_ABC::~Filter_ABC()
 {
 	// NOTHING
 }
+
+void Filter_ABC::ApplyFilter(const SampleBatch& batch, T_Selection& selection) const
+{
+	size_t kept = 0;
+	for(T_Selection::const_iterator it = selection.begin(); it != selection.end(); ++it)
+	{
+		if(ApplyFilter(*batch.samples_[*it]))
+		{
+			selection[kept++] = *it;
+		}
+	}
+	selection.resize(kept);
+}
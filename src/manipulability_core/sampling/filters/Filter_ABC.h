@@ -1,7 +1,8 @@
-
 #ifndef _CLASS_FILTER_ABC
 #define _CLASS_FILTER_ABC
 
+#include "sampling/SampleBatch.h"
+
 class Sample;
 class Obstacle;
 
@@ -15,6 +16,8 @@ public:
 
 protected:
 	virtual bool ApplyFilter(const Sample& /*sample*/) const  = 0; // this can change
+	// removes from selection the indexes of the batch samples that do not pass the filter, by default calls ApplyFilter on each of them
+	virtual void ApplyFilter(const SampleBatch& /*batch*/, T_Selection& /*selection*/) const;
 };
 
-#endif //_CLASS_FILTER_ABC
\ No newline at end of file
+#endif //_CLASS_FILTER_ABC
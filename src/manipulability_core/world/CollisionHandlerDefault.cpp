@@ -6,6 +6,7 @@
 #include "kinematic/Tree.h"
 #include "kinematic/Joint.h"
 #include "world/Obstacle.h"
+#include "world/DistanceField.h"
 
 
 #include <vector>
@@ -88,13 +89,34 @@ namespace
 		}
 		return res;
 	}
+
+	// true if the distance field proves that no segment can touch an obstacle
+	bool IsFree(const World& world, const T_Point& points)
+	{
+		const DistanceField* field = world.GetDistanceField();
+		if(!field || points.size() < 2) return false;
+		T_Point::const_iterator ptIt = points.begin();
+		T_Point::const_iterator ptIt2 = points.begin(); ++ptIt2;
+		for(;ptIt2 != points.end(); ++ptIt, ++ptIt2)
+		{
+			if(!field->IsFree(*ptIt, *ptIt2))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 }
 
 bool CollisionHandlerDefault::IsColliding(const Robot& robot, const Tree& tree)
 {
-	ReachableObstaclesContainerCollide rc(world_, tree, robot);
-	world_.Accept(rc);
 	T_Point points = TreeToSegments(robot, tree);
+	if(IsFree(world_, points))
+	{
+		return false;
+	}
+	ReachableObstaclesContainerCollide rc(world_, tree, robot);
+	world_.AcceptReachable(rc, robot, tree);
 	if(points.size() >= 2)
 	{
 		for(ReachableObstaclesContainerCollide::T_ObstaclesCIT it = rc.obstacles_.begin(); it!= rc.obstacles_.end(); ++it)
@@ -115,8 +137,6 @@ bool CollisionHandlerDefault::IsColliding(const Robot& robot, const Tree& tree)
 
 bool CollisionHandlerDefault::IsSoftColliding(const Robot& robot, const Tree& tree)
 {
-	ReachableObstaclesContainerCollide rc(world_, tree, robot);
-	world_.Accept(rc);
 	T_Point points = TreeToSegments(robot, tree);
 	if(points.size() >= 2)
 	{
@@ -127,6 +147,12 @@ bool CollisionHandlerDefault::IsSoftColliding(const Robot& robot, const Tree& tr
 			matrices::Vector3 pt1 = points[points.size()-1];
 			points.push_back(pt1 + (pt2 - pt1) * 0.9);
 		}
+		if(IsFree(world_, points))
+		{
+			return false;
+		}
+		ReachableObstaclesContainerCollide rc(world_, tree, robot);
+		world_.AcceptReachable(rc, robot, tree);
 		for(ReachableObstaclesContainerCollide::T_ObstaclesCIT it = rc.obstacles_.begin(); it!= rc.obstacles_.end(); ++it)
 		{
 			T_Point::const_iterator ptIt = points.begin();;
@@ -19,6 +19,7 @@ public:
 //request
 public:
 	virtual void AddObstacle(const Obstacle* /*obstacle*/) = 0;
+	virtual void RemoveObstacle(const Obstacle* /*obstacle*/) {}
 	virtual bool IsColliding(const Robot& /*robot*/, const Tree& /*tree*/) = 0;
 	virtual bool IsSoftColliding(const Robot& robot, const Tree& tree) {return IsColliding(robot, tree);}
 	virtual void Instantiate() = 0;
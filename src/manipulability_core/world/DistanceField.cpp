@@ -0,0 +1,432 @@
+#include "world/DistanceField.h"
+#include "world/World.h"
+#include "world/Obstacle.h"
+#include "world/ObstacleBVH.h"
+#include "world/ObstacleVisitor_ABC.h"
+
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+
+using namespace matrices;
+
+namespace
+{
+	typedef unsigned long long T_Key;
+
+	const T_Key emptyKey = ~0ULL;
+	const T_Key deletedKey = ~0ULL - 1;
+	const int coordinateBits = 21;
+	const long coordinateOffset = 1L << (coordinateBits - 1);
+	const T_Key coordinateMask = (1ULL << coordinateBits) - 1;
+	const unsigned int fileMagic = 0x46445344; // "DSDF"
+	const unsigned int fileVersion = 1;
+
+	// grid corners are packed on 21 bits per axis, which covers +/- 10^6 voxels
+	T_Key MakeKey(long x, long y, long z)
+	{
+		return  (T_Key)((x + coordinateOffset) & coordinateMask)
+			 | ((T_Key)((y + coordinateOffset) & coordinateMask) << coordinateBits)
+			 | ((T_Key)((z + coordinateOffset) & coordinateMask) << (2 * coordinateBits));
+	}
+
+	size_t Hash(T_Key key)
+	{
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		return (size_t)key;
+	}
+
+	NUMBER Trilinear(const float* c, const NUMBER* f)
+	{
+		NUMBER c00 = c[0] * (1 - f[0]) + c[1] * f[0];
+		NUMBER c10 = c[2] * (1 - f[0]) + c[3] * f[0];
+		NUMBER c01 = c[4] * (1 - f[0]) + c[5] * f[0];
+		NUMBER c11 = c[6] * (1 - f[0]) + c[7] * f[0];
+		return (c00 * (1 - f[1]) + c10 * f[1]) * (1 - f[2]) + (c01 * (1 - f[1]) + c11 * f[1]) * f[2];
+	}
+
+	struct ObstacleCollector : public ObstacleVisitor_ABC
+	{
+		ObstacleCollector() {}
+		~ObstacleCollector() {}
+		virtual void Visit(const Obstacle& obstacle)
+		{
+			obstacles_.push_back(&obstacle);
+		}
+		std::vector<const Obstacle*> obstacles_;
+	};
+
+	struct ObstacleSignature : public ObstacleVisitor_ABC
+	{
+		ObstacleSignature() : signature_(2166136261UL) {}
+		~ObstacleSignature() {}
+		virtual void Visit(const Obstacle& obstacle)
+		{
+			const Vector3* points[4] = {&obstacle.GetP1(), &obstacle.GetP2(), &obstacle.GetP3(), &obstacle.GetP4()};
+			for(int p = 0; p < 4; ++p)
+			{
+				for(int i = 0; i < 3; ++i)
+				{
+					float value = (float)((*points[p])(i));
+					const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+					for(size_t b = 0; b < sizeof(float); ++b)
+					{
+						signature_ = (signature_ ^ bytes[b]) * 16777619UL;
+					}
+				}
+			}
+		}
+		unsigned long signature_;
+	};
+}
+
+// open addressing table with linear probing, storing one signed distance per grid corner
+struct DistanceFieldPImpl
+{
+	DistanceFieldPImpl(NUMBER voxelSize, NUMBER bandWidth)
+		: voxelSize_(voxelSize)
+		, bandWidth_(bandWidth)
+		, size_(0)
+		, deleted_(0)
+	{
+		Reset(1024);
+	}
+
+	~DistanceFieldPImpl()
+	{
+		// NOTHING
+	}
+
+	void Reset(size_t capacity)
+	{
+		keys_.assign(capacity, emptyKey);
+		values_.assign(capacity, 0.f);
+		size_ = 0;
+		deleted_ = 0;
+	}
+
+	const float* Find(T_Key key) const
+	{
+		size_t mask = keys_.size() - 1;
+		for(size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+		{
+			if(keys_[i] == key) return &values_[i];
+			if(keys_[i] == emptyKey) return 0;
+		}
+	}
+
+	// keeps the value closest to the surface
+	void Write(T_Key key, float value)
+	{
+		if((size_ + deleted_ + 1) * 2 > keys_.size())
+		{
+			Grow();
+		}
+		size_t mask = keys_.size() - 1;
+		size_t slot = keys_.size();
+		for(size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+		{
+			if(keys_[i] == key)
+			{
+				if(std::fabs(value) < std::fabs(values_[i])) values_[i] = value;
+				return;
+			}
+			if(keys_[i] == deletedKey && slot == keys_.size())
+			{
+				slot = i;
+			}
+			else if(keys_[i] == emptyKey)
+			{
+				if(slot == keys_.size()) slot = i;
+				break;
+			}
+		}
+		if(keys_[slot] == deletedKey) --deleted_;
+		keys_[slot] = key;
+		values_[slot] = value;
+		++size_;
+	}
+
+	void Erase(T_Key key)
+	{
+		size_t mask = keys_.size() - 1;
+		for(size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+		{
+			if(keys_[i] == key)
+			{
+				keys_[i] = deletedKey;
+				--size_;
+				++deleted_;
+				return;
+			}
+			if(keys_[i] == emptyKey) return;
+		}
+	}
+
+	void Grow()
+	{
+		std::vector<T_Key> keys; keys.swap(keys_);
+		std::vector<float> values; values.swap(values_);
+		size_t capacity = keys.size();
+		while(size_ * 4 >= capacity) capacity *= 2;
+		Reset(capacity);
+		for(size_t i = 0; i < keys.size(); ++i)
+		{
+			if(keys[i] != emptyKey && keys[i] != deletedKey)
+			{
+				Write(keys[i], values[i]);
+			}
+		}
+	}
+
+	long Cell(NUMBER coordinate) const
+	{
+		return (long)std::floor(coordinate / voxelSize_);
+	}
+
+	// writes the distance to obstacle for every corner of the band around it that lies in [min, max]
+	void Rasterize(const Obstacle& obstacle, const long* min, const long* max)
+	{
+		NUMBER obsMin[3], obsMax[3];
+		ObstacleBVH::ComputeBounds(obstacle, obsMin, obsMax);
+		long from[3], to[3];
+		for(int i = 0; i < 3; ++i)
+		{
+			from[i] = std::max(min[i], Cell(obsMin[i] - bandWidth_));
+			to[i]   = std::min(max[i], Cell(obsMax[i] + bandWidth_) + 1);
+		}
+		Vector3 point;
+		for(long x = from[0]; x <= to[0]; ++x)
+		{
+			point(0) = x * voxelSize_;
+			for(long y = from[1]; y <= to[1]; ++y)
+			{
+				point(1) = y * voxelSize_;
+				for(long z = from[2]; z <= to[2]; ++z)
+				{
+					point(2) = z * voxelSize_;
+					NUMBER distance = DistanceField::SignedDistance(obstacle, point);
+					if(std::fabs(distance) <= bandWidth_)
+					{
+						Write(MakeKey(x, y, z), (float)distance);
+					}
+				}
+			}
+		}
+	}
+
+	// corner values around point, a missing corner is farther than the band width from any obstacle
+	bool Corners(const Vector3& point, float* values, NUMBER* fractions) const
+	{
+		bool found = false;
+		long cell[3];
+		for(int i = 0; i < 3; ++i)
+		{
+			NUMBER scaled = point(i) / voxelSize_;
+			cell[i] = (long)std::floor(scaled);
+			fractions[i] = scaled - cell[i];
+		}
+		for(int c = 0; c < 8; ++c)
+		{
+			const float* value = Find(MakeKey(cell[0] + (c & 1), cell[1] + ((c >> 1) & 1), cell[2] + ((c >> 2) & 1)));
+			values[c] = value ? *value : (float)bandWidth_;
+			found = found || value;
+		}
+		return found;
+	}
+
+	const NUMBER voxelSize_;
+	const NUMBER bandWidth_;
+	std::vector<T_Key> keys_;
+	std::vector<float> values_;
+	size_t size_;
+	size_t deleted_;
+};
+
+DistanceField::DistanceField(NUMBER voxelSize, NUMBER bandWidth)
+	: pImpl_(new DistanceFieldPImpl(voxelSize, bandWidth))
+{
+	// NOTHING
+}
+
+DistanceField::~DistanceField()
+{
+	// NOTHING
+}
+
+NUMBER DistanceField::SignedDistance(const Obstacle& obstacle, const Vector3& point)
+{
+	Vector3 local = matrix4TimesVect3(obstacle.BasisInv(), point);
+	local(0) = std::min(std::max(local(0), (NUMBER)0), obstacle.GetW());
+	local(1) = std::min(std::max(local(1), (NUMBER)0), obstacle.GetH());
+	NUMBER sign = local(2) < 0 ? -1 : 1;
+	local(2) = 0;
+	return sign * (point - matrix4TimesVect3(obstacle.Basis(), local)).norm();
+}
+
+unsigned long DistanceField::Signature(const World& world)
+{
+	ObstacleSignature signature;
+	world.Accept(signature);
+	return signature.signature_;
+}
+
+void DistanceField::Bake(const World& world)
+{
+	pImpl_->Reset(1024);
+	ObstacleCollector collector;
+	world.Accept(collector);
+	long min[3] = {-coordinateOffset, -coordinateOffset, -coordinateOffset};
+	long max[3] = {coordinateOffset - 1, coordinateOffset - 1, coordinateOffset - 1};
+	for(std::vector<const Obstacle*>::const_iterator it = collector.obstacles_.begin(); it != collector.obstacles_.end(); ++it)
+	{
+		pImpl_->Rasterize(*(*it), min, max);
+	}
+}
+
+void DistanceField::Rebake(const World& world, const NUMBER* min, const NUMBER* max)
+{
+	// every corner within band width of the box may have changed
+	long from[3], to[3];
+	NUMBER queryMin[3], queryMax[3];
+	for(int i = 0; i < 3; ++i)
+	{
+		from[i] = pImpl_->Cell(min[i] - pImpl_->bandWidth_);
+		to[i]   = pImpl_->Cell(max[i] + pImpl_->bandWidth_) + 1;
+		queryMin[i] = from[i] * pImpl_->voxelSize_ - pImpl_->bandWidth_;
+		queryMax[i] = to[i]   * pImpl_->voxelSize_ + pImpl_->bandWidth_;
+	}
+	for(long x = from[0]; x <= to[0]; ++x)
+	{
+		for(long y = from[1]; y <= to[1]; ++y)
+		{
+			for(long z = from[2]; z <= to[2]; ++z)
+			{
+				pImpl_->Erase(MakeKey(x, y, z));
+			}
+		}
+	}
+	ObstacleCollector collector;
+	world.Accept(collector, queryMin, queryMax);
+	for(std::vector<const Obstacle*>::const_iterator it = collector.obstacles_.begin(); it != collector.obstacles_.end(); ++it)
+	{
+		pImpl_->Rasterize(*(*it), from, to);
+	}
+}
+
+bool DistanceField::Save(const std::string& filename, unsigned long signature) const
+{
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+	if(!file.is_open()) return false;
+	unsigned long long sign = signature;
+	unsigned long long count = pImpl_->size_;
+	file.write(reinterpret_cast<const char*>(&fileMagic), sizeof(fileMagic));
+	file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+	file.write(reinterpret_cast<const char*>(&sign), sizeof(sign));
+	file.write(reinterpret_cast<const char*>(&pImpl_->voxelSize_), sizeof(NUMBER));
+	file.write(reinterpret_cast<const char*>(&pImpl_->bandWidth_), sizeof(NUMBER));
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for(size_t i = 0; i < pImpl_->keys_.size(); ++i)
+	{
+		if(pImpl_->keys_[i] != emptyKey && pImpl_->keys_[i] != deletedKey)
+		{
+			file.write(reinterpret_cast<const char*>(&pImpl_->keys_[i]), sizeof(T_Key));
+			file.write(reinterpret_cast<const char*>(&pImpl_->values_[i]), sizeof(float));
+		}
+	}
+	return file.good();
+}
+
+bool DistanceField::Load(const std::string& filename, unsigned long signature)
+{
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if(!file.is_open()) return false;
+	unsigned int magic, version;
+	unsigned long long sign, count;
+	NUMBER voxelSize, bandWidth;
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&sign), sizeof(sign));
+	file.read(reinterpret_cast<char*>(&voxelSize), sizeof(NUMBER));
+	file.read(reinterpret_cast<char*>(&bandWidth), sizeof(NUMBER));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if(!file.good() || magic != fileMagic || version != fileVersion || sign != (unsigned long long)signature
+		|| voxelSize != pImpl_->voxelSize_ || bandWidth != pImpl_->bandWidth_)
+	{
+		return false;
+	}
+	size_t capacity = 1024;
+	while(count * 4 >= capacity) capacity *= 2;
+	pImpl_->Reset(capacity);
+	T_Key key; float value;
+	for(unsigned long long i = 0; i < count; ++i)
+	{
+		file.read(reinterpret_cast<char*>(&key), sizeof(T_Key));
+		file.read(reinterpret_cast<char*>(&value), sizeof(float));
+		if(!file.good())
+		{
+			pImpl_->Reset(1024);
+			return false;
+		}
+		pImpl_->Write(key, value);
+	}
+	return true;
+}
+
+bool DistanceField::Distance(const Vector3& point, NUMBER& distance) const
+{
+	Vector3 gradient;
+	return Distance(point, distance, gradient);
+}
+
+// The sign flips across the plane extension of an obstacle beyond its edges, where the distance is not zero.
+// Magnitudes are therefore interpolated separately, the signed values only giving the side of the closest obstacle.
+bool DistanceField::Distance(const Vector3& point, NUMBER& distance, Vector3& gradient) const
+{
+	float c[8]; NUMBER f[3];
+	bool found = pImpl_->Corners(point, c, f);
+	NUMBER sign = Trilinear(c, f) < 0 ? -1 : 1;
+	for(int i = 0; i < 8; ++i)
+	{
+		c[i] = std::fabs(c[i]);
+	}
+	distance = sign * Trilinear(c, f);
+	NUMBER gx = ((c[1] - c[0]) * (1 - f[1]) + (c[3] - c[2]) * f[1]) * (1 - f[2]) + ((c[5] - c[4]) * (1 - f[1]) + (c[7] - c[6]) * f[1]) * f[2];
+	NUMBER gy = ((c[2] - c[0]) * (1 - f[0]) + (c[3] - c[1]) * f[0]) * (1 - f[2]) + ((c[6] - c[4]) * (1 - f[0]) + (c[7] - c[5]) * f[0]) * f[2];
+	NUMBER gz = ((c[4] - c[0]) * (1 - f[0]) + (c[5] - c[1]) * f[0]) * (1 - f[1]) + ((c[6] - c[2]) * (1 - f[0]) + (c[7] - c[3]) * f[0]) * f[1];
+	gradient = Vector3(gx, gy, gz) * (sign / pImpl_->voxelSize_);
+	return found;
+}
+
+bool DistanceField::IsFree(const Vector3& a, const Vector3& b, const NUMBER margin) const
+{
+	// each corner is at most sqrt(3) voxels away from the middle of the segment,
+	// and the distance to the obstacles is 1-lipschitz
+	Vector3 middle = (a + b) / 2;
+	float c[8]; NUMBER f[3];
+	pImpl_->Corners(middle, c, f);
+	NUMBER clearance = pImpl_->bandWidth_;
+	for(int i = 0; i < 8; ++i)
+	{
+		clearance = std::min(clearance, (NUMBER)std::fabs(c[i]));
+	}
+	return clearance - std::sqrt(3.) * pImpl_->voxelSize_ > (b - a).norm() / 2 + margin;
+}
+
+NUMBER DistanceField::GetVoxelSize() const
+{
+	return pImpl_->voxelSize_;
+}
+
+NUMBER DistanceField::GetBandWidth() const
+{
+	return pImpl_->bandWidth_;
+}
+
+size_t DistanceField::GetNumVoxels() const
+{
+	return pImpl_->size_;
+}
@@ -0,0 +1,54 @@
+
+#ifndef _CLASS_DISTANCEFIELD
+#define _CLASS_DISTANCEFIELD
+
+#include "MatrixDefs.h"
+
+#include <memory>
+#include <string>
+
+struct DistanceFieldPImpl;
+
+class World;
+class Obstacle;
+
+/* Sparse narrow band signed distance field of the world obstacles.
+Distances are sampled at the corners of a regular grid stored in a hash table,
+and only corners closer than the band width to an obstacle are kept.
+The sign is given by the normal of the closest obstacle.*/
+class DistanceField {
+
+public:
+	 DistanceField(NUMBER /*voxelSize*/, NUMBER /*bandWidth*/);
+	~DistanceField();
+
+private:
+	DistanceField(const DistanceField&);
+	DistanceField& operator=(const DistanceField&);
+
+public:
+	void Bake  (const World& /*world*/);
+	void Rebake(const World& /*world*/, const NUMBER* /*min*/, const NUMBER* /*max*/); // recomputes the corners affected by a change inside the box
+	bool Save  (const std::string& /*filename*/, unsigned long /*signature*/) const;
+	bool Load  (const std::string& /*filename*/, unsigned long /*signature*/); // false if the file is missing or was baked for another world
+
+public:
+	// trilinear lookups, return false outside the narrow band (distance is then set to the band width)
+	bool Distance(const matrices::Vector3& /*point*/, NUMBER& /*distance*/) const;
+	bool Distance(const matrices::Vector3& /*point*/, NUMBER& /*distance*/, matrices::Vector3& /*gradient*/) const;
+	// conservative: true only if no obstacle can come closer than margin to segment [a, b]
+	bool IsFree(const matrices::Vector3& /*a*/, const matrices::Vector3& /*b*/, const NUMBER margin = 0) const;
+
+	NUMBER GetVoxelSize() const;
+	NUMBER GetBandWidth() const;
+	size_t GetNumVoxels() const;
+
+public:
+	static NUMBER SignedDistance(const Obstacle& /*obstacle*/, const matrices::Vector3& /*point*/);
+	static unsigned long Signature(const World& /*world*/); // identifies the obstacle set a field was baked for
+
+private:
+	std::auto_ptr<DistanceFieldPImpl> pImpl_;
+};
+
+#endif //_CLASS_DISTANCEFIELD
@@ -32,6 +32,8 @@ Obstacle::Obstacle(const Vector3& p1, const Vector3& p2, const Vector3& p3, cons
 , v_(p1-p4)
 , n_(u_.cross(v_))
 , donttouch_(donttouch)
+, handle_()
+, revision_(0)
 {
 	Vector3 normal = n_;
 	a_ = (float)(normal.x());
@@ -3,6 +3,7 @@
 #define _CLASS_OBSTACLE
 
 #include "MatrixDefs.h"
+#include "world/ObstacleHandle.h"
 
 //#include "Rennes1\SpatialDataStructure\Selectors\Triangle3D.h"
 #include <vector>
@@ -48,6 +49,8 @@ public:
 	const matrices::Vector3 n_; // normal vector
 
 	const bool donttouch_;
+	ObstacleHandle handle_; // set by the world holding the obstacle, kept when it is transformed
+	unsigned long revision_; // world revision at which the obstacle was added or transformed
 
 private:
 	const matrices::Vector3 p1_;
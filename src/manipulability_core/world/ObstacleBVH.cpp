@@ -0,0 +1,316 @@
+#include "world/ObstacleBVH.h"
+#include "world/Obstacle.h"
+#include "world/ObstacleVisitor_ABC.h"
+
+#include <algorithm>
+
+using namespace matrices;
+
+namespace
+{
+	NUMBER Area(const NUMBER* min, const NUMBER* max)
+	{
+		NUMBER dx = max[0] - min[0]; NUMBER dy = max[1] - min[1]; NUMBER dz = max[2] - min[2];
+		return 2 * (dx * dy + dy * dz + dz * dx);
+	}
+
+	void Merge(const NUMBER* minA, const NUMBER* maxA, const NUMBER* minB, const NUMBER* maxB, NUMBER* min, NUMBER* max)
+	{
+		for(int i = 0; i < 3; ++i)
+		{
+			min[i] = std::min(minA[i], minB[i]);
+			max[i] = std::max(maxA[i], maxB[i]);
+		}
+	}
+
+	bool Contains(const NUMBER* outerMin, const NUMBER* outerMax, const NUMBER* min, const NUMBER* max)
+	{
+		for(int i = 0; i < 3; ++i)
+		{
+			if(min[i] < outerMin[i] || max[i] > outerMax[i]) return false;
+		}
+		return true;
+	}
+
+	bool Overlaps(const NUMBER* minA, const NUMBER* maxA, const NUMBER* minB, const NUMBER* maxB)
+	{
+		for(int i = 0; i < 3; ++i)
+		{
+			if(maxA[i] < minB[i] || minA[i] > maxB[i]) return false;
+		}
+		return true;
+	}
+
+	// squared distance between a point and a box
+	NUMBER SquaredDistance(const Vector3& point, const NUMBER* min, const NUMBER* max)
+	{
+		NUMBER res = 0;
+		for(int i = 0; i < 3; ++i)
+		{
+			NUMBER v = point(i);
+			if(v < min[i])		res += (min[i] - v) * (min[i] - v);
+			else if(v > max[i]) res += (v - max[i]) * (v - max[i]);
+		}
+		return res;
+	}
+}
+
+ObstacleBVH::ObstacleBVH(NUMBER margin)
+	: root_(nullProxy)
+	, freeList_(nullProxy)
+	, margin_(margin)
+{
+	// NOTHING
+}
+
+ObstacleBVH::~ObstacleBVH()
+{
+	// NOTHING
+}
+
+void ObstacleBVH::ComputeBounds(const Obstacle& obstacle, NUMBER* min, NUMBER* max)
+{
+	const Vector3* points[4] = {&obstacle.GetP1(), &obstacle.GetP2(), &obstacle.GetP3(), &obstacle.GetP4()};
+	for(int i = 0; i < 3; ++i)
+	{
+		min[i] = (*points[0])(i);
+		max[i] = (*points[0])(i);
+	}
+	for(int p = 1; p < 4; ++p)
+	{
+		for(int i = 0; i < 3; ++i)
+		{
+			min[i] = std::min(min[i], (*points[p])(i));
+			max[i] = std::max(max[i], (*points[p])(i));
+		}
+	}
+}
+
+ObstacleBVH::T_Proxy ObstacleBVH::AllocateNode()
+{
+	T_Proxy res;
+	if(freeList_ != nullProxy)
+	{
+		res = freeList_;
+		freeList_ = nodes_[res].parent_;
+	}
+	else
+	{
+		res = (T_Proxy)nodes_.size();
+		nodes_.push_back(Node());
+	}
+	Node& node = nodes_[res];
+	node.parent_ = nullProxy;
+	node.left_ = nullProxy;
+	node.right_ = nullProxy;
+	node.obstacle_ = 0;
+	return res;
+}
+
+void ObstacleBVH::FreeNode(T_Proxy node)
+{
+	nodes_[node].parent_ = freeList_;
+	nodes_[node].obstacle_ = 0;
+	freeList_ = node;
+}
+
+ObstacleBVH::T_Proxy ObstacleBVH::Insert(const Obstacle* obstacle)
+{
+	assert(obstacle);
+	T_Proxy leaf = AllocateNode();
+	Node& node = nodes_[leaf];
+	node.obstacle_ = obstacle;
+	ComputeBounds(*obstacle, node.min_, node.max_);
+	for(int i = 0; i < 3; ++i)
+	{
+		node.min_[i] -= margin_;
+		node.max_[i] += margin_;
+	}
+	InsertLeaf(leaf);
+	return leaf;
+}
+
+void ObstacleBVH::Remove(T_Proxy proxy)
+{
+	assert(proxy != nullProxy && nodes_[proxy].IsLeaf());
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+}
+
+bool ObstacleBVH::Refit(T_Proxy proxy, const Obstacle* obstacle)
+{
+	assert(proxy != nullProxy && nodes_[proxy].IsLeaf());
+	NUMBER min[3], max[3];
+	ComputeBounds(*obstacle, min, max);
+	nodes_[proxy].obstacle_ = obstacle;
+	if(Contains(nodes_[proxy].min_, nodes_[proxy].max_, min, max))
+	{
+		return false;
+	}
+	RemoveLeaf(proxy);
+	for(int i = 0; i < 3; ++i)
+	{
+		nodes_[proxy].min_[i] = min[i] - margin_;
+		nodes_[proxy].max_[i] = max[i] + margin_;
+	}
+	InsertLeaf(proxy);
+	return true;
+}
+
+void ObstacleBVH::Clear()
+{
+	nodes_.clear();
+	root_ = nullProxy;
+	freeList_ = nullProxy;
+}
+
+void ObstacleBVH::InsertLeaf(T_Proxy leaf)
+{
+	if(root_ == nullProxy)
+	{
+		root_ = leaf;
+		nodes_[root_].parent_ = nullProxy;
+		return;
+	}
+	// descend towards the child whose area grows the least
+	NUMBER min[3], max[3];
+	T_Proxy sibling = root_;
+	while(!nodes_[sibling].IsLeaf())
+	{
+		const Node& current = nodes_[sibling];
+		const Node& left	= nodes_[current.left_];
+		const Node& right	= nodes_[current.right_];
+		Merge(left.min_, left.max_, nodes_[leaf].min_, nodes_[leaf].max_, min, max);
+		NUMBER costLeft = Area(min, max) - Area(left.min_, left.max_);
+		Merge(right.min_, right.max_, nodes_[leaf].min_, nodes_[leaf].max_, min, max);
+		NUMBER costRight = Area(min, max) - Area(right.min_, right.max_);
+		sibling = (costLeft <= costRight) ? current.left_ : current.right_;
+	}
+	T_Proxy oldParent = nodes_[sibling].parent_;
+	T_Proxy newParent = AllocateNode(); // may reallocate nodes_, no references kept above
+	Node& parent = nodes_[newParent];
+	parent.parent_ = oldParent;
+	parent.left_ = sibling;
+	parent.right_ = leaf;
+	Merge(nodes_[sibling].min_, nodes_[sibling].max_, nodes_[leaf].min_, nodes_[leaf].max_, parent.min_, parent.max_);
+	nodes_[sibling].parent_ = newParent;
+	nodes_[leaf].parent_ = newParent;
+	if(oldParent == nullProxy)
+	{
+		root_ = newParent;
+	}
+	else
+	{
+		if(nodes_[oldParent].left_ == sibling)
+		{
+			nodes_[oldParent].left_ = newParent;
+		}
+		else
+		{
+			nodes_[oldParent].right_ = newParent;
+		}
+		RefitAncestors(oldParent);
+	}
+}
+
+void ObstacleBVH::RemoveLeaf(T_Proxy leaf)
+{
+	if(leaf == root_)
+	{
+		root_ = nullProxy;
+		return;
+	}
+	T_Proxy parent = nodes_[leaf].parent_;
+	T_Proxy grandParent = nodes_[parent].parent_;
+	T_Proxy sibling = (nodes_[parent].left_ == leaf) ? nodes_[parent].right_ : nodes_[parent].left_;
+	if(grandParent == nullProxy)
+	{
+		root_ = sibling;
+		nodes_[sibling].parent_ = nullProxy;
+	}
+	else
+	{
+		if(nodes_[grandParent].left_ == parent)
+		{
+			nodes_[grandParent].left_ = sibling;
+		}
+		else
+		{
+			nodes_[grandParent].right_ = sibling;
+		}
+		nodes_[sibling].parent_ = grandParent;
+		RefitAncestors(grandParent);
+	}
+	FreeNode(parent);
+	nodes_[leaf].parent_ = nullProxy;
+}
+
+void ObstacleBVH::RefitAncestors(T_Proxy node)
+{
+	while(node != nullProxy)
+	{
+		Node& current = nodes_[node];
+		const Node& left = nodes_[current.left_];
+		const Node& right = nodes_[current.right_];
+		Merge(left.min_, left.max_, right.min_, right.max_, current.min_, current.max_);
+		node = current.parent_;
+	}
+}
+
+void ObstacleBVH::Query(const Vector3& center, NUMBER radius, ObstacleVisitor_ABC& visitor) const
+{
+	if(root_ == nullProxy) return;
+	NUMBER radius2 = radius * radius;
+	std::vector<T_Proxy> stack;
+	stack.push_back(root_);
+	while(!stack.empty())
+	{
+		const Node& node = nodes_[stack.back()];
+		stack.pop_back();
+		if(SquaredDistance(center, node.min_, node.max_) > radius2) continue;
+		if(node.IsLeaf())
+		{
+			visitor.Visit(*node.obstacle_);
+		}
+		else
+		{
+			stack.push_back(node.right_);
+			stack.push_back(node.left_);
+		}
+	}
+}
+
+void ObstacleBVH::Query(const NUMBER* min, const NUMBER* max, ObstacleVisitor_ABC& visitor) const
+{
+	if(root_ == nullProxy) return;
+	std::vector<T_Proxy> stack;
+	stack.push_back(root_);
+	while(!stack.empty())
+	{
+		const Node& node = nodes_[stack.back()];
+		stack.pop_back();
+		if(!Overlaps(min, max, node.min_, node.max_)) continue;
+		if(node.IsLeaf())
+		{
+			visitor.Visit(*node.obstacle_);
+		}
+		else
+		{
+			stack.push_back(node.right_);
+			stack.push_back(node.left_);
+		}
+	}
+}
+
+int ObstacleBVH::ComputeHeight(T_Proxy node) const
+{
+	if(node == nullProxy) return 0;
+	const Node& current = nodes_[node];
+	if(current.IsLeaf()) return 1;
+	return 1 + std::max(ComputeHeight(current.left_), ComputeHeight(current.right_));
+}
+
+int ObstacleBVH::GetHeight() const
+{
+	return ComputeHeight(root_);
+}
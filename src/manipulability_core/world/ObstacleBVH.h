@@ -0,0 +1,73 @@
+
+#ifndef _CLASS_OBSTACLEBVH
+#define _CLASS_OBSTACLEBVH
+
+#include "MatrixDefs.h"
+
+#include <vector>
+
+class Obstacle;
+class ObstacleVisitor_ABC;
+
+/* Dynamic bounding volume hierarchy over the world obstacles.
+Leaves store a fattened box so that small obstacle motions only
+refit the leaf instead of restructuring the tree.*/
+class ObstacleBVH {
+
+public:
+	typedef int T_Proxy;
+	static const T_Proxy nullProxy = -1;
+
+public:
+	explicit ObstacleBVH(NUMBER margin = 0.05);
+	~ObstacleBVH();
+
+private:
+	ObstacleBVH(const ObstacleBVH&);
+	ObstacleBVH& operator=(const ObstacleBVH&);
+
+public:
+	T_Proxy Insert(const Obstacle* /*obstacle*/);
+	void	Remove(T_Proxy /*proxy*/);
+	bool	Refit (T_Proxy /*proxy*/, const Obstacle* /*obstacle*/); // true if the leaf had to be reinserted
+	void	Clear ();
+
+public:
+	// visits all obstacles whose bounding box intersects the sphere
+	void Query(const matrices::Vector3& /*center*/, NUMBER /*radius*/, ObstacleVisitor_ABC& /*visitor*/) const;
+	// visits all obstacles whose bounding box intersects the box
+	void Query(const NUMBER* /*min*/, const NUMBER* /*max*/, ObstacleVisitor_ABC& /*visitor*/) const;
+	int GetHeight() const;
+
+public:
+	static void ComputeBounds(const Obstacle& /*obstacle*/, NUMBER* /*min*/, NUMBER* /*max*/);
+
+private:
+	struct Node
+	{
+		NUMBER min_[3];
+		NUMBER max_[3];
+		T_Proxy parent_; // next free node when node is not allocated
+		T_Proxy left_;
+		T_Proxy right_;
+		const Obstacle* obstacle_;
+		bool IsLeaf() const { return left_ == nullProxy; }
+	};
+	typedef std::vector<Node>	T_Nodes;
+
+private:
+	T_Proxy AllocateNode();
+	void	FreeNode	(T_Proxy /*node*/);
+	void	InsertLeaf	(T_Proxy /*leaf*/);
+	void	RemoveLeaf	(T_Proxy /*leaf*/);
+	void	RefitAncestors(T_Proxy /*node*/);
+	int		ComputeHeight(T_Proxy /*node*/) const;
+
+private:
+	T_Nodes nodes_;
+	T_Proxy root_;
+	T_Proxy freeList_;
+	const NUMBER margin_;
+};
+
+#endif //_CLASS_OBSTACLEBVH
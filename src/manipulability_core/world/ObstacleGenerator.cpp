@@ -0,0 +1,152 @@
+#include "world/ObstacleGenerator.h"
+
+using namespace matrices;
+
+ObstacleGenerator::ObstacleGenerator(Receiver_ABC& receiver)
+	: receiver_(receiver)
+{
+	// NOTHING
+}
+
+ObstacleGenerator::~ObstacleGenerator()
+{
+	// NOTHING
+}
+
+void ObstacleGenerator::GenerateChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER height, const unsigned int depth)
+{
+	// stop condition, depth = 0, flat rectangle
+	if(0 == depth)
+	{
+		Vector3 nUL (upLeft.x(), upLeft.y(), height);
+		Vector3 nBR (bottomRight.x(), bottomRight.y(), height);
+		Vector3 upRight(bottomRight.x(), upLeft.y(), height);
+		Vector3 downLeft(upLeft.x(), bottomRight.y(), height);
+		receiver_.AddObstacle(nUL, upRight, nBR, downLeft);
+	}
+	else
+	{
+		Vector3 dx((bottomRight.x() - upLeft.x()) / 2., 0, 0);
+		Vector3 dy(0, (upLeft.y() - bottomRight.y()) / 2., 0);
+		unsigned int newDepth = depth - 1;
+		GenerateChess(upLeft, upLeft + dx - dy, height, newDepth);
+		if(depth != 1)
+		{
+			GenerateChess(upLeft + dx, bottomRight + dy, height, newDepth);
+			GenerateChess(upLeft - dy, bottomRight - dx, height, newDepth);
+		}
+		GenerateChess(upLeft + dx - dy, bottomRight, height, newDepth);
+	}
+}
+
+void ObstacleGenerator::GenerateUnevenChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER height, const unsigned int depth)
+{
+	// stop condition, depth = 0, flat rectangle
+	if(0 == depth)
+	{
+		Vector3 nUL (upLeft.x(), upLeft.y(), height);
+		Vector3 nBR (bottomRight.x(), bottomRight.y(), height);
+		Vector3 upRight(bottomRight.x(), upLeft.y(), height);
+		Vector3 downLeft(upLeft.x(), bottomRight.y(), height);
+		receiver_.AddObstacle(nUL, upRight, nBR, downLeft);
+	}
+	else
+	{
+		Vector3 dx((bottomRight.x() - upLeft.x()) / 2., 0, 0);
+		Vector3 dy(0, (upLeft.y() - bottomRight.y()) / 2., 0);
+		unsigned int newDepth = depth - 1;
+		GenerateUnevenChess(upLeft, upLeft + dx - dy, height, newDepth);
+		if(depth != 1)
+		{
+			GenerateUnevenChess(upLeft + dx, bottomRight + dy, height +0.2, newDepth);
+			GenerateUnevenChess(upLeft - dy, bottomRight - dx, height -0.2, newDepth);
+		}
+		GenerateUnevenChess(upLeft + dx - dy, bottomRight, height, newDepth);
+	}
+}
+
+void ObstacleGenerator::GenerateVerticalChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, const unsigned int depth)
+{
+	// stop condition, depth = 0, flat rectangle
+	if(0 == depth)
+	{
+		Vector3 upRight(bottomRight.x(), bottomRight.y(), upLeft.z());
+		Vector3 downLeft(upLeft.x(), upLeft.y(), bottomRight.z());
+		receiver_.AddObstacle(upLeft, upRight, bottomRight, downLeft);
+	}
+	else
+	{
+		Vector3 dz(0, 0, (upLeft.z() - bottomRight.z()) / 2.);
+		Vector3 dy(0, (upLeft.y() - bottomRight.y()) / 2., 0);
+		unsigned int newDepth = depth - 1;
+		GenerateVerticalChess(upLeft, upLeft - dy - dz, newDepth);
+		if(depth != 1)
+		{
+			GenerateVerticalChess(upLeft - dy, bottomRight + dz, newDepth);
+			GenerateVerticalChess(upLeft - dz, bottomRight + dy, newDepth);
+		}
+		GenerateVerticalChess(upLeft - dy - dz, bottomRight, newDepth);
+	}
+}
+
+void ObstacleGenerator::GenerateXInclinedPlank(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight)
+{
+	Vector3 upRight(bottomRight.x(), upLeft.y(), upLeft.z());
+	Vector3 downLeft(upLeft.x(), bottomRight.y(), bottomRight.z());
+	receiver_.AddObstacle(upLeft, upRight, bottomRight, downLeft);
+}
+
+void ObstacleGenerator::GenerateYInclinedPlank(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight)
+{
+	Vector3 upRight(bottomRight.x(), upLeft.y(), bottomRight.z());
+	Vector3 downLeft(upLeft.x(), bottomRight.y(), upLeft.z());
+	receiver_.AddObstacle(upLeft, upRight, bottomRight, downLeft);
+}
+
+void ObstacleGenerator::GenerateStair(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER heightInit, NUMBER heightFinal, const unsigned int depth)
+{
+	NUMBER xLength = bottomRight.x() - upLeft.x();
+	NUMBER yLength = upLeft.y() - bottomRight.y();
+	bool xIsLonger = xLength > yLength;
+	NUMBER deltaHeight = (heightFinal - heightInit) / ((NUMBER) depth);
+	NUMBER deltaCaseWidth = xIsLonger ? (xLength / ((NUMBER) depth)) : (yLength / ((NUMBER) depth));
+	for(unsigned int i = 0; i < depth; ++i)
+	{
+		if(xIsLonger)
+		{
+			Vector3 uL(upLeft.x() + deltaCaseWidth * i, upLeft.y(), heightInit + i * deltaHeight);
+			Vector3 bR(upLeft.x() + deltaCaseWidth * (i+1), bottomRight.y(), heightInit + i * deltaHeight);
+			GenerateXInclinedPlank(uL, bR);
+		}
+		else
+		{
+			Vector3 uL(upLeft.x()     , bottomRight.y() + deltaCaseWidth * (i + 1), heightInit + i * deltaHeight);
+			Vector3 bR(bottomRight.x(), bottomRight.y() + deltaCaseWidth * i      , heightInit + i * deltaHeight);
+			GenerateXInclinedPlank(uL, bR);
+		}
+	}
+}
+
+void ObstacleGenerator::GenerateStairChess(const matrices::Vector3& upLeft, const matrices::Vector3& bottomRight, NUMBER heightInit, NUMBER heightFinal, const unsigned int depth, const unsigned int chessdepth)
+{
+	NUMBER xLength = bottomRight.x() - upLeft.x();
+	NUMBER yLength = upLeft.y() - bottomRight.y();
+	bool xIsLonger = xLength > yLength;
+	NUMBER deltaHeight = (heightFinal - heightInit) / ((NUMBER) depth);
+	NUMBER deltaCaseWidth = xIsLonger ? (xLength / ((NUMBER) depth)) : (yLength / ((NUMBER) depth));
+	for(unsigned int i = 0; i < depth; ++i)
+	{
+		if(xIsLonger)
+		{
+			Vector3 uL(upLeft.x() + deltaCaseWidth * i, upLeft.y(), 0);
+			Vector3 bR(upLeft.x() + deltaCaseWidth * (i+1), bottomRight.y(), 0);
+			GenerateChess(uL, bR, heightInit + i * deltaHeight, chessdepth);
+		}
+		else
+		{
+			Vector3 uL(upLeft.x()     , bottomRight.y() + deltaCaseWidth * (i + 1), 0);
+			Vector3 bR(bottomRight.x(), bottomRight.y() + deltaCaseWidth * i      , 0);
+			GenerateChess(uL, bR, heightInit + i * deltaHeight, chessdepth);
+		}
+	}
+}
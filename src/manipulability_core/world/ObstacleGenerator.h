@@ -0,0 +1,35 @@
+
+#ifndef _CLASS_OBSTACLEGENERATOR
+#define _CLASS_OBSTACLEGENERATOR
+
+#include "MatrixDefs.h"
+
+/* Procedural scenes made of planar obstacles : chess boards, stairs and planks.
+Each quad is handed to the receiver clockwise from upLeft, which decides what to do with it.*/
+class ObstacleGenerator {
+
+public:
+	struct Receiver_ABC
+	{
+		virtual ~Receiver_ABC(){}
+		virtual void AddObstacle(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*upRight*/, const matrices::Vector3& /*downRight*/, const matrices::Vector3& /*downLeft*/) = 0;
+	};
+
+public:
+	explicit ObstacleGenerator(Receiver_ABC& /*receiver*/);
+	~ObstacleGenerator();
+
+public:
+	void GenerateUnevenChess   (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, NUMBER /*height*/, const unsigned int /*depth*/);
+	void GenerateChess		   (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, NUMBER /*height*/, const unsigned int /*depth*/);
+	void GenerateVerticalChess (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, const unsigned int /*depth*/);
+	void GenerateStair		   (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, NUMBER /*heightInit*/, NUMBER /*heightFinal*/, const unsigned int /*depth*/);
+	void GenerateStairChess	   (const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/, NUMBER /*heightInit*/, NUMBER /*heightFinal*/, const unsigned int /*depth*/, const unsigned int /*depthChess*/);
+	void GenerateYInclinedPlank(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/);
+	void GenerateXInclinedPlank(const matrices::Vector3& /*upLeft*/, const matrices::Vector3& /*bottomRight*/);
+
+private:
+	Receiver_ABC& receiver_;
+};
+
+#endif //_CLASS_OBSTACLEGENERATOR
@@ -0,0 +1,17 @@
+
+#ifndef _CLASS_OBSTACLEHANDLE
+#define _CLASS_OBSTACLEHANDLE
+
+// Identifies an obstacle slot. The version is bumped when the obstacle is removed, so that stale handles are detected.
+struct ObstacleHandle
+{
+	ObstacleHandle() : id_(-1), version_(0) {}
+	ObstacleHandle(int id, unsigned int version) : id_(id), version_(version) {}
+	bool operator==(const ObstacleHandle& other) const { return id_ == other.id_ && version_ == other.version_; }
+	bool operator!=(const ObstacleHandle& other) const { return !(*this == other); }
+	bool operator< (const ObstacleHandle& other) const { return id_ < other.id_ || (id_ == other.id_ && version_ < other.version_); }
+	int id_;
+	unsigned int version_;
+};
+
+#endif //_CLASS_OBSTACLEHANDLE
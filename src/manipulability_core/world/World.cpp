@@ -1,42 +1,128 @@
-
 #include "world/World.h"
 #include "ObstacleVisitor_ABC.h"
+#include "WorldChangeVisitor_ABC.h"
 
 #include "world/Intersection.h"
+#include "world/ObstacleBVH.h"
+#include "world/DistanceField.h"
 #include "CollisionHandlerDefault.h"
 #include "world/Obstacle.h"
 #include "kinematic/Tree.h"
 #include "kinematic/Robot.h"
+#include "Profiler.h"
 
 #include <vector>
+#include <deque>
 using namespace std;
 
+namespace
+{
+	// Intersection accepts rectangles slightly beyond the tree boundary sphere (up to sqrt(1.28) times its radius)
+	const NUMBER reachableRadiusFactor = 1.5;
+	// maximum number of changes kept for consumers that have not caught up yet
+	const size_t journalCapacity = 1024;
+}
+
 //TODO : alignement error with obstacle vector ... hence the ugly stuff
 struct WorldPImpl
 {
 	WorldPImpl(const World& world)
-		: instantiated_(false)
-		, collisionHandler_(world)
+		: collisionHandler_(world)
+		, instantiated_(false)
+		, journaling_(false)
+		, revision_(0)
+		, droppedRevision_(0)
 	{
 		//NOTHING
 	}
 
 	~WorldPImpl()
 	{
-		for(T_ObstacleIT it = obstacles_.begin(); it!= obstacles_.end(); ++it)
+		for(T_SlotIT it = slots_.begin(); it!= slots_.end(); ++it)
+		{
+			delete(it->obstacle_);
+		}
+		while(!journal_.empty())
+		{
+			DropOldestChange();
+		}
+	}
+
+	struct Slot
+	{
+		Obstacle* obstacle_;
+		unsigned int version_;
+		ObstacleBVH::T_Proxy proxy_;
+	};
+
+	Slot* GetSlot(const ObstacleHandle& handle)
+	{
+		if(handle.id_ < 0 || handle.id_ >= (int)slots_.size()) return 0;
+		Slot& slot = slots_[handle.id_];
+		return (slot.obstacle_ && slot.version_ == handle.version_) ? &slot : 0;
+	}
+
+	void Journal(WorldChange::eChange change, const ObstacleHandle& handle, const Obstacle* previous, const Obstacle* current, const matrices::Matrix4& transform)
+	{
+		++revision_;
+		if(!journaling_)
 		{
-			delete(*it);
+			delete previous;
+			return;
+		}
+		WorldChange* entry = new WorldChange;
+		entry->change_ = change;
+		entry->revision_ = revision_;
+		entry->handle_ = handle;
+		entry->previous_ = previous;
+		entry->current_ = current;
+		entry->transform_ = transform;
+		journal_.push_back(entry);
+		while(journal_.size() > journalCapacity)
+		{
+			DropOldestChange();
 		}
 	}
 
+	// keeps the distance field consistent with an obstacle that appeared or disappeared
+	void UpdateDistanceField(const World& world, const Obstacle& obstacle)
+	{
+		if(distanceField_.get() && journaling_)
+		{
+			NUMBER min[3], max[3];
+			ObstacleBVH::ComputeBounds(obstacle, min, max);
+			distanceField_->Rebake(world, min, max);
+		}
+	}
+
+	void DropOldestChange()
+	{
+		WorldChange* entry = journal_.front();
+		journal_.pop_front();
+		droppedRevision_ = entry->revision_;
+		delete entry->previous_;
+		delete entry;
+	}
+
 	Intersection intersection_;
 
-	typedef vector<Obstacle*> T_Obstacle;
-	typedef T_Obstacle::iterator T_ObstacleIT;
-	typedef T_Obstacle::const_iterator T_ObstacleCIT;
-	T_Obstacle obstacles_;
+	typedef vector<Slot> T_Slot;
+	typedef T_Slot::iterator T_SlotIT;
+	typedef T_Slot::const_iterator T_SlotCIT;
+	typedef std::deque<WorldChange*> T_Journal;
+	typedef T_Journal::const_iterator T_JournalCIT;
+
+	T_Slot slots_;
+	std::vector<int> freeSlots_;
+	ObstacleBVH bvh_;
+	T_Journal journal_;
+	std::auto_ptr<DistanceField> distanceField_;
+	std::string distanceFieldCache_;
 	CollisionHandlerDefault collisionHandler_;
 	bool instantiated_;
+	bool journaling_;
+	unsigned long revision_;
+	unsigned long droppedRevision_;
 };
 
 using namespace matrices;
@@ -60,33 +146,172 @@ void World::Instantiate(bool activateCollision)
 		pImpl_->collisionHandler_.Instantiate();
 		pImpl_->instantiated_ = true;
 	}
+	if(pImpl_->distanceField_.get())
+	{
+		DistanceField& field = *(pImpl_->distanceField_);
+		unsigned long signature = DistanceField::Signature(*this);
+		if(pImpl_->distanceFieldCache_.empty() || !field.Load(pImpl_->distanceFieldCache_, signature))
+		{
+			field.Bake(*this);
+			if(!pImpl_->distanceFieldCache_.empty())
+			{
+				field.Save(pImpl_->distanceFieldCache_, signature);
+			}
+		}
+	}
+	// from now on modifications are journaled so that dependent caches can be updated
+	pImpl_->journaling_ = true;
 }
 
-void World::AddObstacle(Obstacle* obstacle)
+ObstacleHandle World::AddObstacle(Obstacle* obstacle)
 {
 	assert(obstacle);
-	assert(!(pImpl_->instantiated_));
-	pImpl_->obstacles_.push_back(obstacle);
+	int id;
+	if(pImpl_->freeSlots_.empty())
+	{
+		id = (int)pImpl_->slots_.size();
+		WorldPImpl::Slot slot;
+		slot.version_ = 0;
+		pImpl_->slots_.push_back(slot);
+	}
+	else
+	{
+		id = pImpl_->freeSlots_.back();
+		pImpl_->freeSlots_.pop_back();
+	}
+	WorldPImpl::Slot& slot = pImpl_->slots_[id];
+	slot.obstacle_ = obstacle;
+	obstacle->handle_ = ObstacleHandle(id, slot.version_);
+	slot.proxy_ = pImpl_->bvh_.Insert(obstacle);
 	pImpl_->collisionHandler_.AddObstacle(obstacle);
+	pImpl_->UpdateDistanceField(*this, *obstacle);
+	ObstacleHandle handle(id, slot.version_);
+	pImpl_->Journal(WorldChange::added, handle, 0, obstacle, Matrix4::Identity());
+	obstacle->revision_ = pImpl_->revision_;
+	return handle;
+}
+
+bool World::RemoveObstacle(const ObstacleHandle& handle)
+{
+	WorldPImpl::Slot* slot = pImpl_->GetSlot(handle);
+	if(!slot)
+	{
+		return false;
+	}
+	Obstacle* obstacle = slot->obstacle_;
+	pImpl_->bvh_.Remove(slot->proxy_);
+	pImpl_->collisionHandler_.RemoveObstacle(obstacle);
+	slot->obstacle_ = 0;
+	slot->proxy_ = ObstacleBVH::nullProxy;
+	++(slot->version_);
+	pImpl_->freeSlots_.push_back(handle.id_);
+	pImpl_->UpdateDistanceField(*this, *obstacle);
+	pImpl_->Journal(WorldChange::removed, handle, obstacle, 0, Matrix4::Identity());
+	return true;
+}
+
+bool World::TransformObstacle(const ObstacleHandle& handle, const Matrix4& transform)
+{
+	WorldPImpl::Slot* slot = pImpl_->GetSlot(handle);
+	if(!slot)
+	{
+		return false;
+	}
+	Obstacle* previous = slot->obstacle_;
+	Obstacle* current = new Obstacle(matrix4TimesVect3(transform, previous->GetP1()), matrix4TimesVect3(transform, previous->GetP2()),
+									 matrix4TimesVect3(transform, previous->GetP3()), matrix4TimesVect3(transform, previous->GetP4()), previous->donttouch_);
+	current->handle_ = handle;
+	slot->obstacle_ = current;
+	pImpl_->bvh_.Refit(slot->proxy_, current);
+	pImpl_->collisionHandler_.RemoveObstacle(previous);
+	pImpl_->collisionHandler_.AddObstacle(current);
+	pImpl_->UpdateDistanceField(*this, *previous);
+	pImpl_->UpdateDistanceField(*this, *current);
+	pImpl_->Journal(WorldChange::transformed, handle, previous, current, transform);
+	current->revision_ = pImpl_->revision_;
+	return true;
+}
+
+bool World::IsValid(const ObstacleHandle& handle) const
+{
+	return pImpl_->GetSlot(handle) != 0;
+}
+
+const Obstacle* World::GetObstacle(const ObstacleHandle& handle) const
+{
+	WorldPImpl::Slot* slot = pImpl_->GetSlot(handle);
+	return slot ? slot->obstacle_ : 0;
+}
+
+void World::EnableDistanceField(NUMBER voxelSize, NUMBER bandWidth, const std::string& cacheFile)
+{
+	assert(!pImpl_->journaling_);
+	pImpl_->distanceField_.reset(new DistanceField(voxelSize, bandWidth));
+	pImpl_->distanceFieldCache_ = cacheFile;
+}
+
+const DistanceField* World::GetDistanceField() const
+{
+	return pImpl_->distanceField_.get();
+}
+
+unsigned long World::GetRevision() const
+{
+	return pImpl_->revision_;
+}
+
+bool World::AcceptChanges(unsigned long sinceRevision, WorldChangeVisitor_ABC& visitor) const
+{
+	if(sinceRevision < pImpl_->droppedRevision_)
+	{
+		return false;
+	}
+	for(WorldPImpl::T_JournalCIT it = pImpl_->journal_.begin(); it!= pImpl_->journal_.end(); ++it)
+	{
+		if((*it)->revision_ > sinceRevision)
+		{
+			visitor.Visit(*(*it));
+		}
+	}
+	return true;
 }
 
 void World::Accept(ObstacleVisitor_ABC& visitor) const
 {
 	//assert(pImpl_->instantiated_);
-	for(WorldPImpl::T_ObstacleIT it = pImpl_->obstacles_.begin(); it!= pImpl_->obstacles_.end(); ++it)
+	for(WorldPImpl::T_SlotIT it = pImpl_->slots_.begin(); it!= pImpl_->slots_.end(); ++it)
 	{
-		visitor.Visit(*(*it));
+		if(it->obstacle_)
+		{
+			visitor.Visit(*(it->obstacle_));
+		}
 	}
 }
 
+void World::Accept(ObstacleVisitor_ABC& visitor, const Vector3& center, NUMBER radius) const
+{
+	pImpl_->bvh_.Query(center, radius, visitor);
+}
+
+void World::Accept(ObstacleVisitor_ABC& visitor, const NUMBER* min, const NUMBER* max) const
+{
+	pImpl_->bvh_.Query(min, max, visitor);
+}
+
+void World::AcceptReachable(ObstacleVisitor_ABC& visitor, const Robot& robot, const Tree& tree) const
+{
+	Vector3 treePositionWorld = matrix4TimesVect3(robot.ToWorldCoordinates(), tree.GetPosition());
+	Accept(visitor, treePositionWorld, tree.GetBoundaryRadius() * reachableRadiusFactor);
+}
+
 bool World::GetTarget(const Robot& robot, const Tree& tree, const Vector3& direction, Vector3& target) const
 {
 	//TODO : pattern patron pour choisir mthode de slection 
 	//phase 1 : le premier qui intersecte ...
 	assert(pImpl_->instantiated_);
-	for(WorldPImpl::T_ObstacleIT it = pImpl_->obstacles_.begin(); it!= pImpl_->obstacles_.end(); ++it)
+	for(WorldPImpl::T_SlotIT it = pImpl_->slots_.begin(); it!= pImpl_->slots_.end(); ++it)
 	{
-		if(pImpl_->intersection_.Intersect(robot, tree, *(*it), target))
+		if(it->obstacle_ && pImpl_->intersection_.Intersect(robot, tree, *(it->obstacle_), target))
 		{
 			return true;
 		}
@@ -101,9 +326,9 @@ bool World::GetClosestTarget(const Robot& robot, const Tree& tree, const Vector3
 	Vector3 currentTarget;
 	bool found = false;
 	// get closest obstacle
-	for(WorldPImpl::T_ObstacleIT it = pImpl_->obstacles_.begin(); it!= pImpl_->obstacles_.end(); ++it)
+	for(WorldPImpl::T_SlotIT it = pImpl_->slots_.begin(); it!= pImpl_->slots_.end(); ++it)
 	{
-		if(pImpl_->intersection_.IntersectClosest(robot, tree, from, (*(*it)), currentTarget))
+		if(it->obstacle_ && pImpl_->intersection_.IntersectClosest(robot, tree, from, *(it->obstacle_), currentTarget))
 		{
 			NUMBER currentDistance = (currentTarget-from).norm();
 			if(currentDistance < minDistance)
@@ -119,12 +344,14 @@ bool World::GetClosestTarget(const Robot& robot, const Tree& tree, const Vector3
 
 bool World::IsColliding(const Robot& robot, const Tree& tree) const
 {
+	ProfileScope scope(manip_core::enums::stage::collision);
 	return pImpl_->instantiated_ && pImpl_->collisionHandler_.IsColliding(robot, tree);
 }
 
 
 bool World::IsSoftColliding(const Robot& robot, const Tree& tree) const
 {
+	ProfileScope scope(manip_core::enums::stage::collision);
 	return pImpl_->instantiated_ && pImpl_->collisionHandler_.IsSoftColliding(robot, tree);
 }
 
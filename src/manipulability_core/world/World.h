@@ -3,14 +3,37 @@
 #define _CLASS_WORLD
 
 #include "MatrixDefs.h"
+#include "world/ObstacleHandle.h"
 
 #include <memory>
+#include <string>
 struct WorldPImpl;
 
 class Obstacle;
 class Tree;
 class Robot;
 class ObstacleVisitor_ABC;
+class WorldChangeVisitor_ABC;
+class DistanceField;
+
+// Journal entry describing a modification of the world after it was created
+struct WorldChange
+{
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	enum eChange
+	{
+		added = 0,
+		removed,
+		transformed
+	};
+
+	eChange change_;
+	unsigned long revision_;
+	ObstacleHandle handle_;
+	const Obstacle* previous_; // replaced obstacle, remains allocated as long as the change is journaled
+	const Obstacle* current_;
+	matrices::Matrix4 transform_; // transformation applied to previous_ to obtain current_
+};
 
 class World {
 
@@ -19,7 +42,11 @@ public:
 	~World();
 
 	 void Instantiate(bool /*activateCollision*/);
-	 void AddObstacle		(Obstacle* /*obstacle*/);
+	 ObstacleHandle AddObstacle	(Obstacle* /*obstacle*/);
+	 bool RemoveObstacle		(const ObstacleHandle& /*handle*/);
+	 bool TransformObstacle		(const ObstacleHandle& /*handle*/, const matrices::Matrix4& /*transform*/); // transform expressed in world coordinates
+	 bool IsValid				(const ObstacleHandle& /*handle*/) const;
+	 const Obstacle* GetObstacle(const ObstacleHandle& /*handle*/) const;
 	 bool IsReachable		(const Robot& /*robot*/, const Tree& /*tree*/, const matrices::Vector3& /*target*/) const;
 	 bool IsReachable		(const Robot& /*robot*/, const Tree& /*tree*/, const Obstacle& /*obstacle*/) const;
 	 bool GetTarget			(const Robot& /*robot*/, const Tree& /*tree*/, const matrices::Vector3& /*direction*/, matrices::Vector3& /*target*/) const;
@@ -27,9 +54,23 @@ public:
 	 bool IsColliding		(const Robot& /*robot*/, const Tree& /*tree*/) const;
 	 bool IsSoftColliding	(const Robot& /*robot*/, const Tree& /*tree*/) const;
 	 void Accept(ObstacleVisitor_ABC& /*visitor*/) const;
+	 void Accept(ObstacleVisitor_ABC& /*visitor*/, const matrices::Vector3& /*center*/, NUMBER /*radius*/) const; // only obstacles whose bounds intersect the sphere
+	 void Accept(ObstacleVisitor_ABC& /*visitor*/, const NUMBER* /*min*/, const NUMBER* /*max*/) const; // only obstacles whose bounds intersect the box
+	 void AcceptReachable(ObstacleVisitor_ABC& /*visitor*/, const Robot& /*robot*/, const Tree& /*tree*/) const; // superset of the obstacles reachable by tree
+
+// distance field
+public:
+	 // must be called before Instantiate ; the field is loaded from cacheFile if it matches the world, otherwise baked and saved there
+	 void EnableDistanceField(NUMBER /*voxelSize*/, NUMBER /*bandWidth*/, const std::string& /*cacheFile*/ = std::string());
+	 const DistanceField* GetDistanceField() const; // 0 if not enabled
+
+// change journal
+public:
+	 unsigned long GetRevision() const;
+	 bool AcceptChanges(unsigned long /*sinceRevision*/, WorldChangeVisitor_ABC& /*visitor*/) const; // false if the journal no longer covers sinceRevision
 
 private:
 	std::auto_ptr<WorldPImpl> pImpl_;
 };
 
-#endif //_CLASS_WORLD
\ No newline at end of file
+#endif //_CLASS_WORLD
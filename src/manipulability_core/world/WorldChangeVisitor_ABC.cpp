@@ -0,0 +1,11 @@
+#include "WorldChangeVisitor_ABC.h"
+
+WorldChangeVisitor_ABC::WorldChangeVisitor_ABC()
+{
+	// NOTHING
+}
+
+WorldChangeVisitor_ABC::~WorldChangeVisitor_ABC()
+{
+	// NOTHING
+}
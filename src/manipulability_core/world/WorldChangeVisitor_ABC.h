@@ -0,0 +1,19 @@
+
+#ifndef _CLASS_WORLDCHANGEVISITOR_ABC
+#define _CLASS_WORLDCHANGEVISITOR_ABC
+
+
+struct WorldChange;
+
+class WorldChangeVisitor_ABC {
+
+public:
+	 WorldChangeVisitor_ABC();
+	~WorldChangeVisitor_ABC();
+
+public:
+	virtual void Visit(const WorldChange& /*change*/) = 0;	
+private:
+};
+
+#endif //_CLASS_WORLDCHANGEVISITOR_ABC